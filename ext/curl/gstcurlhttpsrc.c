@@ -160,6 +160,7 @@ enum
   PROP_MAXCONCURRENT_PROXY,
   PROP_MAXCONCURRENT_GLOBAL,
   PROP_HTTPVERSION,
+  PROP_HTTP2_MULTIPLEX,
   PROP_IRADIO_MODE,
   PROP_MAX
 };
@@ -213,6 +214,7 @@ static gboolean gst_curl_http_src_urihandler_set_uri (GstURIHandler * handler,
 static void gst_curl_http_src_curl_multi_loop (gpointer thread_data);
 static CURL *gst_curl_http_src_create_easy_handle (GstCurlHttpSrc * s);
 static inline void gst_curl_http_src_destroy_easy_handle (GstCurlHttpSrc * src);
+static void gst_curl_http_src_update_stats (GstCurlHttpSrc * src);
 static size_t gst_curl_http_src_get_header (void *header, size_t size,
     size_t nmemb, void *src);
 static size_t gst_curl_http_src_get_chunks (void *chunk, size_t size,
@@ -229,6 +231,10 @@ static int gst_curl_http_src_get_debug (CURL * handle, curl_infotype type,
 static curl_version_info_data *gst_curl_http_src_curl_capabilities = NULL;
 static GstCurlHttpVersion pref_http_ver;
 
+/* The transfers only run in the curl_multi_loop thread, but the easy handles
+ * using the share are set up and cleaned up from the streaming threads */
+static GMutex gst_curl_http_src_share_locks[CURL_LOCK_DATA_LAST];
+
 #define GST_TYPE_CURL_HTTP_VERSION (gst_curl_http_version_get_type ())
 
 static GType
@@ -466,6 +472,26 @@ gst_curl_http_src_class_init (GstCurlHttpSrcClass * klass)
           GST_TYPE_CURL_HTTP_VERSION, pref_http_ver,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstCurlHttpSrc:http2-multiplex:
+   *
+   * Multiplex the HTTP/2 requests over the connections already opened to
+   * the same server by any curlhttpsrc, waiting for such a connection to be
+   * established instead of opening a new one. Only has an effect when
+   * #GstCurlHttpSrc:http-version is 2.0.
+   *
+   * Once an instance requested it, multiplexing stays enabled on the
+   * connection pool shared by all the instances until none of them is
+   * left in the READY state or higher.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_HTTP2_MULTIPLEX,
+      g_param_spec_boolean ("http2-multiplex", "HTTP/2 Multiplex",
+          "Multiplex HTTP/2 requests over existing connections",
+          GSTCURL_DEFAULT_HTTP2_MULTIPLEX,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /* Add a debugging task so it's easier to debug in the Multi worker thread */
   GST_DEBUG_CATEGORY_INIT (gst_curl_loop_debug, "curl_multi_loop", 0,
       "libcURL loop thread debugging");
@@ -479,6 +505,8 @@ gst_curl_http_src_class_init (GstCurlHttpSrcClass * klass)
   klass->multi_task_context.queue = NULL;
   klass->multi_task_context.state = GSTCURL_MULTI_LOOP_STATE_STOP;
   klass->multi_task_context.multi_handle = NULL;
+  klass->multi_task_context.multiplex = FALSE;
+  klass->multi_task_context.share_handle = NULL;
   g_mutex_init (&klass->multi_task_context.mutex);
   g_cond_init (&klass->multi_task_context.signal);
 
@@ -580,6 +608,9 @@ gst_curl_http_src_set_property (GObject * object, guint prop_id,
     case PROP_MAXCONCURRENT_GLOBAL:
       source->max_conns_global = g_value_get_uint (value);
       break;
+    case PROP_HTTP2_MULTIPLEX:
+      source->http2_multiplex = g_value_get_boolean (value);
+      break;
     case PROP_HTTPVERSION:
       source->preferred_http_version = g_value_get_enum (value);
       break;
@@ -666,6 +697,9 @@ gst_curl_http_src_get_property (GObject * object, guint prop_id,
     case PROP_HTTPVERSION:
       g_value_set_enum (value, source->preferred_http_version);
       break;
+    case PROP_HTTP2_MULTIPLEX:
+      g_value_set_boolean (value, source->http2_multiplex);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -704,6 +738,13 @@ gst_curl_http_src_init (GstCurlHttpSrc * source)
   source->strict_ssl = GSTCURL_HANDLE_DEFAULT_CURLOPT_SSL_VERIFYPEER;
   source->custom_ca_file = NULL;
   source->preferred_http_version = pref_http_ver;
+  source->http2_multiplex = GSTCURL_DEFAULT_HTTP2_MULTIPLEX;
+  source->stats_requests = 0;
+  source->stats_new_connections = 0;
+  source->stats_reused_connections = 0;
+  source->stats_http_version = CURL_HTTP_VERSION_NONE;
+  source->stats_connect_time = GST_CLOCK_TIME_NONE;
+  source->stats_tls_time = GST_CLOCK_TIME_NONE;
   source->total_retries = GSTCURL_HANDLE_DEFAULT_RETRIES;
   source->retries_remaining = source->total_retries;
   source->slist = NULL;
@@ -741,6 +782,48 @@ gst_curl_http_src_init (GstCurlHttpSrc * source)
   GSTCURL_FUNCTION_EXIT (source);
 }
 
+static void
+gst_curl_http_src_share_lock (CURL * handle, curl_lock_data data,
+    curl_lock_access access, void *userptr)
+{
+  g_mutex_lock (&gst_curl_http_src_share_locks[data]);
+}
+
+static void
+gst_curl_http_src_share_unlock (CURL * handle, curl_lock_data data,
+    void *userptr)
+{
+  g_mutex_unlock (&gst_curl_http_src_share_locks[data]);
+}
+
+/*
+ * Create the share handle through which all the easy handles reuse each
+ * other's DNS cache entries, TLS sessions and, when libcurl supports it,
+ * connections.
+ */
+static CURLSH *
+gst_curl_http_src_share_new (void)
+{
+  CURLSH *share;
+
+  share = curl_share_init ();
+  if (share == NULL) {
+    GSTCURL_WARNING_PRINT ("Couldn't create a curl share handle");
+    return NULL;
+  }
+
+  curl_share_setopt (share, CURLSHOPT_LOCKFUNC, gst_curl_http_src_share_lock);
+  curl_share_setopt (share, CURLSHOPT_UNLOCKFUNC,
+      gst_curl_http_src_share_unlock);
+  curl_share_setopt (share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt (share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+  curl_share_setopt (share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+
+  return share;
+}
+
 /*
  * Check if the Curl multi loop has been started. If not, initialise it and
  * start it running. If it is already running, increment the refcount.
@@ -768,6 +851,10 @@ gst_curl_http_src_ref_multi (GstCurlHttpSrc * src)
 
     curl_multi_setopt (klass->multi_task_context.multi_handle,
         CURLMOPT_PIPELINING, 1);
+    klass->multi_task_context.multiplex = FALSE;
+
+    if (klass->multi_task_context.share_handle == NULL)
+      klass->multi_task_context.share_handle = gst_curl_http_src_share_new ();
 #ifdef CURLMOPT_MAX_HOST_CONNECTIONS
     curl_multi_setopt (klass->multi_task_context.multi_handle,
         CURLMOPT_MAX_HOST_CONNECTIONS, 1);
@@ -1019,14 +1106,20 @@ retry:
         break;
       case GSTCURL_REMOVED:
         GST_WARNING_OBJECT (src, "Transfer got removed from the curl queue");
+        src->transfer_begun = FALSE;
+        gst_curl_http_src_destroy_easy_handle (src);
         ret = GST_FLOW_EOS;
         break;
       case GSTCURL_BAD_QUEUE_REQUEST:
         GST_ERROR_OBJECT (src, "Bad Queue Request!");
+        src->transfer_begun = FALSE;
+        gst_curl_http_src_destroy_easy_handle (src);
         ret = GST_FLOW_ERROR;
         break;
       case GSTCURL_TOTAL_ERROR:
         GST_ERROR_OBJECT (src, "Critical, unrecoverable error!");
+        src->transfer_begun = FALSE;
+        gst_curl_http_src_destroy_easy_handle (src);
         ret = GST_FLOW_ERROR;
         break;
       case GSTCURL_PIPELINE_NULL:
@@ -1075,10 +1168,14 @@ _headers_to_curl_slist (GQuark field_id, const GValue * value, gpointer ptr)
 static CURL *
 gst_curl_http_src_create_easy_handle (GstCurlHttpSrc * s)
 {
+  GstCurlHttpSrcClass *klass;
   CURL *handle;
   gint i;
   GSTCURL_FUNCTION_ENTRY (s);
 
+  klass = G_TYPE_INSTANCE_GET_CLASS (s, GST_TYPE_CURL_HTTP_SRC,
+      GstCurlHttpSrcClass);
+
   /* This is mandatory and yet not default option, so if this is NULL
    * then something very bad is going on. */
   if (s->uri == NULL) {
@@ -1106,6 +1203,11 @@ gst_curl_http_src_create_easy_handle (GstCurlHttpSrc * s)
   }
 #endif
 
+  if (klass->multi_task_context.share_handle != NULL) {
+    gst_curl_setopt_generic (s, handle, CURLOPT_SHARE,
+        klass->multi_task_context.share_handle);
+  }
+
   gst_curl_setopt_str (s, handle, CURLOPT_URL, s->uri);
   gst_curl_setopt_str (s, handle, CURLOPT_USERNAME, s->username);
   gst_curl_setopt_str (s, handle, CURLOPT_PASSWORD, s->password);
@@ -1188,6 +1290,10 @@ gst_curl_http_src_create_easy_handle (GstCurlHttpSrc * s)
         } else {
           GST_INFO_OBJECT (s, "HTTP/2 unsupported by libcurl at this time");
         }
+      } else if (s->http2_multiplex) {
+        /* rather wait for a connection that can be multiplexed than open
+         * a new one */
+        gst_curl_setopt_bool (s, handle, CURLOPT_PIPEWAIT, TRUE);
       }
       break;
 #endif
@@ -1403,13 +1509,57 @@ gst_curl_http_src_negotiate_caps (GstCurlHttpSrc * src)
 }
 
 /*
- * Cleanup the CURL easy handle once we're done with it.
+ * Account for the request that is done with, whether it completed, failed
+ * or was cancelled, mostly to tell whether it had to open a new connection
+ * or could reuse one.
+ */
+static void
+gst_curl_http_src_update_stats (GstCurlHttpSrc * src)
+{
+  glong num_connects = 0, http_version = CURL_HTTP_VERSION_NONE;
+  glong local_port = 0;
+  gdouble connect_time = 0, appconnect_time = 0;
+
+  /* the request never got a connection, new or existing */
+  curl_easy_getinfo (src->curl_handle, CURLINFO_LOCAL_PORT, &local_port);
+  if (local_port == 0)
+    return;
+
+  curl_easy_getinfo (src->curl_handle, CURLINFO_NUM_CONNECTS, &num_connects);
+  curl_easy_getinfo (src->curl_handle, CURLINFO_HTTP_VERSION, &http_version);
+  curl_easy_getinfo (src->curl_handle, CURLINFO_CONNECT_TIME, &connect_time);
+  curl_easy_getinfo (src->curl_handle, CURLINFO_APPCONNECT_TIME,
+      &appconnect_time);
+
+  GST_DEBUG_OBJECT (src, "Request for URI %s used %s connection", src->uri,
+      num_connects > 0 ? "a new" : "an existing");
+
+  GST_OBJECT_LOCK (src);
+  src->stats_requests++;
+  if (num_connects > 0)
+    src->stats_new_connections++;
+  else
+    src->stats_reused_connections++;
+  src->stats_http_version = http_version;
+  src->stats_connect_time = connect_time * GST_SECOND;
+  /* the TLS handshake, if any, directly follows the TCP connect */
+  if (appconnect_time > connect_time)
+    src->stats_tls_time = (appconnect_time - connect_time) * GST_SECOND;
+  else
+    src->stats_tls_time = 0;
+  GST_OBJECT_UNLOCK (src);
+}
+
+/*
+ * Cleanup the CURL easy handle once we're done with it, after accounting
+ * for the request it made.
  */
 static inline void
 gst_curl_http_src_destroy_easy_handle (GstCurlHttpSrc * src)
 {
   /* Thank you Handles, and well done. Well done, mate. */
   if (src->curl_handle != NULL) {
+    gst_curl_http_src_update_stats (src);
     curl_easy_cleanup (src->curl_handle);
     src->curl_handle = NULL;
   }
@@ -1512,6 +1662,44 @@ gst_curl_http_src_cleanup_instance (GstCurlHttpSrc * src)
   gst_curl_http_src_destroy_easy_handle (src);
 }
 
+static const gchar *
+gst_curl_http_src_http_version_to_string (glong version)
+{
+  switch (version) {
+    case CURL_HTTP_VERSION_1_0:
+      return "1.0";
+    case CURL_HTTP_VERSION_1_1:
+      return "1.1";
+    case CURL_HTTP_VERSION_2_0:
+      return "2.0";
+    default:
+      return NULL;
+  }
+}
+
+/*
+ * Add the statistics about the requests completed so far to the
+ * HTTP_STATS_NAME structure of a custom query. The times are the ones of the
+ * last request, and are 0 when it reused an already established connection.
+ */
+static void
+gst_curl_http_src_fill_stats (GstCurlHttpSrc * src, GstStructure * s)
+{
+  const gchar *version;
+
+  GST_OBJECT_LOCK (src);
+  gst_structure_set (s,
+      "requests", G_TYPE_UINT64, src->stats_requests,
+      "new-connections", G_TYPE_UINT64, src->stats_new_connections,
+      "reused-connections", G_TYPE_UINT64, src->stats_reused_connections,
+      "connect-time", G_TYPE_UINT64, src->stats_connect_time,
+      "tls-handshake-time", G_TYPE_UINT64, src->stats_tls_time, NULL);
+  version = gst_curl_http_src_http_version_to_string (src->stats_http_version);
+  if (version)
+    gst_structure_set (s, "http-version", G_TYPE_STRING, version, NULL);
+  GST_OBJECT_UNLOCK (src);
+}
+
 static gboolean
 gst_curl_http_src_query (GstBaseSrc * bsrc, GstQuery * query)
 {
@@ -1529,6 +1717,17 @@ gst_curl_http_src_query (GstBaseSrc * bsrc, GstQuery * query)
       g_mutex_unlock (&src->uri_mutex);
       ret = TRUE;
       break;
+    case GST_QUERY_CUSTOM:{
+      GstStructure *s = gst_query_writable_structure (query);
+
+      if (gst_structure_has_name (s, HTTP_STATS_NAME)) {
+        gst_curl_http_src_fill_stats (src, s);
+        ret = TRUE;
+      } else {
+        ret = GST_BASE_SRC_CLASS (parent_class)->query (bsrc, query);
+      }
+      break;
+    }
     default:
       ret = GST_BASE_SRC_CLASS (parent_class)->query (bsrc, query);
       break;
@@ -1802,6 +2001,14 @@ gst_curl_http_src_curl_multi_loop (gpointer thread_data)
       active++;
       if (g_atomic_int_compare_and_exchange (&qelement->running, 0, 1)) {
         GSTCURL_DEBUG_PRINT ("Adding easy handle for URI %s", qelement->p->uri);
+        if (elt->http2_multiplex && !context->multiplex) {
+          /* Only set from this thread, as libcurl is using the multi handle
+           * from here without holding the mutex */
+          GSTCURL_INFO_PRINT ("Enabling HTTP/2 multiplexing");
+          curl_multi_setopt (context->multi_handle, CURLMOPT_PIPELINING,
+              (long) (CURLPIPE_HTTP1 | CURLPIPE_MULTIPLEX));
+          context->multiplex = TRUE;
+        }
         curl_multi_add_handle (context->multi_handle, qelement->p->curl_handle);
       }
     }
@@ -90,6 +90,7 @@ typedef struct _GstCurlHttpSrcQueueElement GstCurlHttpSrcQueueElement;
 #define REQUEST_HEADERS_NAME    "request-headers"
 #define RESPONSE_HEADERS_NAME   "response-headers"
 #define REDIRECT_URI_NAME       "redirection-uri"
+#define HTTP_STATS_NAME         "curl-http-src-stats"
 
 typedef enum
   {
@@ -127,6 +128,12 @@ struct _GstCurlHttpSrcMultiTaskContext
 
   /* < private > */
   CURLM *multi_handle;
+  /* whether HTTP/2 multiplexing got enabled on multi_handle */
+  gboolean multiplex;
+  /* connections, DNS and TLS sessions shared by all the transfers. Unlike
+   * multi_handle it is kept when the last instance goes away, so that the
+   * next one can still reuse them. */
+  CURLSH *share_handle;
 };
 
 struct _GstCurlHttpSrcClass
@@ -188,6 +195,15 @@ struct _GstCurlHttpSrc
 
   /* Some stuff for HTTP/2 */
   GstCurlHttpVersion preferred_http_version;
+  gboolean http2_multiplex;     /* CURLOPT_PIPEWAIT */
+
+  /* Statistics about the completed requests, protected by the object lock */
+  guint64 stats_requests;
+  guint64 stats_new_connections;
+  guint64 stats_reused_connections;
+  glong stats_http_version;
+  GstClockTime stats_connect_time;
+  GstClockTime stats_tls_time;
 
   enum
   {
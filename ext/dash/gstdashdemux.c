@@ -378,6 +378,9 @@ static gboolean gst_dash_demux_process_manifest (GstAdaptiveDemux * ademux,
 static gboolean gst_dash_demux_seek (GstAdaptiveDemux * demux, GstEvent * seek);
 static GstFlowReturn
 gst_dash_demux_stream_update_fragment_info (GstAdaptiveDemuxStream * stream);
+static GstFlowReturn
+gst_dash_demux_stream_peek_fragment (GstAdaptiveDemuxStream * stream, guint n,
+    GstAdaptiveDemuxStreamFragment * fragment);
 static GstFlowReturn gst_dash_demux_stream_seek (GstAdaptiveDemuxStream *
     stream, gboolean forward, GstSeekFlags flags, GstClockTime ts,
     GstClockTime * final_ts);
@@ -638,6 +641,8 @@ gst_dash_demux_class_init (GstDashDemuxClass * klass)
       gst_dash_demux_stream_select_bitrate;
   gstadaptivedemux_class->stream_update_fragment_info =
       gst_dash_demux_stream_update_fragment_info;
+  gstadaptivedemux_class->stream_peek_fragment =
+      gst_dash_demux_stream_peek_fragment;
   gstadaptivedemux_class->stream_free = gst_dash_demux_stream_free;
   gstadaptivedemux_class->get_live_seek_range =
       gst_dash_demux_get_live_seek_range;
@@ -1724,6 +1729,37 @@ gst_dash_demux_stream_advance_subfragment (GstAdaptiveDemuxStream * stream)
   return !fragment_finished;
 }
 
+static GstFlowReturn
+gst_dash_demux_stream_peek_fragment (GstAdaptiveDemuxStream * stream, guint n,
+    GstAdaptiveDemuxStreamFragment * fragment)
+{
+  GstDashDemuxStream *dashstream = (GstDashDemuxStream *) stream;
+  GstDashDemux *dashdemux = GST_DASH_DEMUX_CAST (stream->demux);
+  GstMediaFragmentInfo info;
+
+  /* With the on-demand profile fragments are subsegments located through the
+   * sidx, and in key unit trick mode only parts of them are downloaded. Only
+   * whole segments in forward playback can be known in advance */
+  if (gst_mpd_client_has_isoff_ondemand_profile (dashdemux->client)
+      || GST_ADAPTIVE_DEMUX_IN_TRICKMODE_KEY_UNITS (dashdemux)
+      || stream->demux->segment.rate < 0.0)
+    return GST_FLOW_EOS;
+
+  if (!gst_mpd_client_peek_fragment (dashdemux->client, dashstream->index, n,
+          &info))
+    return GST_FLOW_EOS;
+
+  fragment->uri = info.uri;
+  info.uri = NULL;
+  fragment->range_start = MAX (info.range_start, dashstream->sidx_base_offset);
+  fragment->range_end = info.range_end;
+  fragment->duration = info.duration;
+
+  gst_mpdparser_media_fragment_info_clear (&info);
+
+  return GST_FLOW_OK;
+}
+
 static gboolean
 gst_dash_demux_stream_has_next_fragment (GstAdaptiveDemuxStream * stream)
 {
@@ -2410,7 +2446,8 @@ gst_dash_demux_update_manifest_data (GstAdaptiveDemux * demux,
   new_client->mpd_base_uri = g_strdup (demux->manifest_base_uri);
   gst_buffer_map (buffer, &mapinfo, GST_MAP_READ);
 
-  if (gst_mpd_client_parse (new_client, (gchar *) mapinfo.data, mapinfo.size)) {
+  if (gst_mpd_client_parse_update (new_client, dashdemux->client,
+          (gchar *) mapinfo.data, mapinfo.size)) {
     const gchar *period_id;
     guint period_idx;
     GList *iter;
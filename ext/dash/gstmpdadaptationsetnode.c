@@ -75,6 +75,8 @@ gst_mpd_adaptation_set_node_finalize (GObject * object)
 {
   GstMPDAdaptationSetNode *self = GST_MPD_ADAPTATION_SET_NODE (object);
 
+  gst_mpd_helper_digest_clear (&self->digest);
+  gst_mpd_helper_digest_clear (&self->header_digest);
   if (self->lang)
     xmlFree (self->lang);
   if (self->contentType)
@@ -73,6 +73,11 @@ struct _GstMPDAdaptationSetNode
 
   gchar *xlink_href;
   GstMPDXLinkActuate actuate;
+
+  /* digest of the XML the node was parsed from */
+  GstMPDDigest digest;
+  /* same, leaving out the Representation children */
+  GstMPDDigest header_digest;
 };
 
 GstMPDAdaptationSetNode * gst_mpd_adaptation_set_node_new (void);
@@ -477,10 +477,20 @@ gst_mpd_client_free (GstMPDClient * client)
 gboolean
 gst_mpd_client_parse (GstMPDClient * client, const gchar * data, gint size)
 {
-  gboolean ret = FALSE;
+  return gst_mpd_client_parse_update (client, NULL, data, size);
+}
 
+/* Same as gst_mpd_client_parse(), for a refresh of the manifest of
+ * @previous: the nodes that didn't change are shared with it instead of
+ * being parsed again */
+gboolean
+gst_mpd_client_parse_update (GstMPDClient * client, GstMPDClient * previous,
+    const gchar * data, gint size)
+{
+  gboolean ret = FALSE;
 
-  ret = gst_mpdparser_get_mpd_root_node (&client->mpd_root_node, data, size);
+  ret = gst_mpdparser_get_mpd_root_node (&client->mpd_root_node,
+      previous ? previous->mpd_root_node : NULL, data, size);
 
   if (ret) {
     gst_mpd_client_check_profiles (client);
@@ -777,6 +787,65 @@ gst_mpd_client_get_segment_end_time (GstMPDClient * client,
   return end;
 }
 
+/* Returns the index of the first segment that ends after @ts, or the number
+ * of segments if there is none. Segments are sorted and don't overlap, so
+ * their end times are increasing. */
+static guint
+gst_mpd_client_find_segment (GstMPDClient * client, GPtrArray * segments,
+    GstClockTime ts, gboolean forward)
+{
+  guint lo = 0, hi = segments->len;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+    const GstMediaSegment *segment = g_ptr_array_index (segments, mid);
+    GstClockTime end_time;
+
+    end_time =
+        gst_mpd_client_get_segment_end_time (client, segments, segment, mid);
+
+    /* avoid downloading another fragment just for 1ns in reverse mode */
+    if (forward ? ts < end_time : ts <= end_time)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+
+  return lo;
+}
+
+/* Extends the last segment by @repeat + 1 repetitions if they directly
+ * follow it with the same duration, so that a timeline of S nodes without
+ * @r is kept as a single run */
+static gboolean
+gst_mpd_client_extend_media_segment (GstActiveStream * stream, guint number,
+    gint repeat, guint64 scale_start, guint64 scale_duration,
+    GstClockTime start, GstClockTime duration)
+{
+  GstMediaSegment *last;
+  guint count;
+
+  if (stream->segments->len == 0 || repeat < 0)
+    return FALSE;
+
+  last = g_ptr_array_index (stream->segments, stream->segments->len - 1);
+  if (last->SegmentURL != NULL || last->repeat < 0)
+    return FALSE;
+
+  count = last->repeat + 1;
+  if (last->scale_duration != scale_duration || last->duration != duration
+      || last->number + count != number
+      || last->scale_start + count * scale_duration != scale_start
+      || last->start + count * duration != start)
+    return FALSE;
+
+  last->repeat += repeat + 1;
+  GST_LOG ("Extended segment number %d to repeat %d", last->number,
+      last->repeat);
+
+  return TRUE;
+}
+
 static gboolean
 gst_mpd_client_add_media_segment (GstActiveStream * stream,
     GstMPDSegmentURLNode * url_node, guint number, gint repeat,
@@ -1044,9 +1113,16 @@ gst_mpd_client_setup_representation (GstMPDClient * client,
                 + PeriodStart - presentationTimeOffset;
           }
 
-          if (!gst_mpd_client_add_media_segment (stream, NULL, i, S->r, start,
+          /* Only runs that end within the period can be merged, segments
+           * crossing the period end are clipped below */
+          if ((GST_CLOCK_TIME_IS_VALID (PeriodEnd) && S->r >= 0
+                  && start_time + duration * (S->r + 1) > PeriodEnd)
+              || !gst_mpd_client_extend_media_segment (stream, i, S->r, start,
                   S->d, start_time, duration)) {
-            return FALSE;
+            if (!gst_mpd_client_add_media_segment (stream, NULL, i, S->r,
+                    start, S->d, start_time, duration)) {
+              return FALSE;
+            }
           }
           i += S->r + 1;
           start += S->d * (S->r + 1);
@@ -1670,67 +1746,55 @@ gst_mpd_client_stream_seek (GstMPDClient * client, GstActiveStream * stream,
   g_return_val_if_fail (stream != NULL, 0);
 
   if (stream->segments) {
-    for (index = 0; index < stream->segments->len; index++) {
-      gboolean in_segment = FALSE;
-      GstMediaSegment *segment = g_ptr_array_index (stream->segments, index);
-      GstClockTime end_time;
-
-      GST_DEBUG ("Looking at fragment sequence chunk %d / %d", index,
-          stream->segments->len);
+    index = gst_mpd_client_find_segment (client, stream->segments, ts,
+        forward);
 
-      end_time =
-          gst_mpd_client_get_segment_end_time (client, stream->segments,
-          segment, index);
-
-      /* avoid downloading another fragment just for 1ns in reverse mode */
-      if (forward)
-        in_segment = ts < end_time;
-      else
-        in_segment = ts <= end_time;
+    GST_DEBUG ("Found fragment sequence chunk %d / %d", index,
+        stream->segments->len);
 
-      if (in_segment) {
-        GstClockTime chunk_time;
+    if (index < stream->segments->len) {
+      GstMediaSegment *segment = g_ptr_array_index (stream->segments, index);
+      GstClockTime chunk_time;
 
-        selectedChunk = segment;
-        repeat_index = (ts - segment->start) / segment->duration;
+      selectedChunk = segment;
+      repeat_index = (ts - segment->start) / segment->duration;
 
-        chunk_time = segment->start + segment->duration * repeat_index;
+      chunk_time = segment->start + segment->duration * repeat_index;
 
-        /* At the end of a segment in reverse mode, start from the previous fragment */
-        if (!forward && repeat_index > 0
-            && ((ts - segment->start) % segment->duration == 0))
-          repeat_index--;
+      /* At the end of a segment in reverse mode, start from the previous
+       * fragment */
+      if (!forward && repeat_index > 0
+          && ((ts - segment->start) % segment->duration == 0))
+        repeat_index--;
 
-        if ((flags & GST_SEEK_FLAG_SNAP_NEAREST) == GST_SEEK_FLAG_SNAP_NEAREST) {
-          if (repeat_index + 1 < segment->repeat) {
-            if (ts - chunk_time > chunk_time + segment->duration - ts)
-              repeat_index++;
-          } else if (index + 1 < stream->segments->len) {
-            GstMediaSegment *next_segment =
-                g_ptr_array_index (stream->segments, index + 1);
+      if ((flags & GST_SEEK_FLAG_SNAP_NEAREST) == GST_SEEK_FLAG_SNAP_NEAREST) {
+        if (repeat_index < segment->repeat) {
+          if (ts - chunk_time > chunk_time + segment->duration - ts)
+            repeat_index++;
+        } else if (index + 1 < stream->segments->len) {
+          GstMediaSegment *next_segment =
+              g_ptr_array_index (stream->segments, index + 1);
 
-            if (ts - chunk_time > next_segment->start - ts) {
-              repeat_index = 0;
-              selectedChunk = next_segment;
-              index++;
-            }
+          if (ts - chunk_time > next_segment->start - ts) {
+            repeat_index = 0;
+            selectedChunk = next_segment;
+            index++;
           }
-        } else if (((forward && flags & GST_SEEK_FLAG_SNAP_AFTER) ||
-                (!forward && flags & GST_SEEK_FLAG_SNAP_BEFORE)) &&
-            ts != chunk_time) {
-
-          if (repeat_index + 1 < segment->repeat) {
-            repeat_index++;
+        }
+      } else if (((forward && flags & GST_SEEK_FLAG_SNAP_AFTER) ||
+              (!forward && flags & GST_SEEK_FLAG_SNAP_BEFORE)) &&
+          ts != chunk_time) {
+
+        if (repeat_index < segment->repeat) {
+          repeat_index++;
+        } else {
+          repeat_index = 0;
+          if (index + 1 >= stream->segments->len) {
+            selectedChunk = NULL;
           } else {
-            repeat_index = 0;
-            if (index + 1 >= stream->segments->len) {
-              selectedChunk = NULL;
-            } else {
-              selectedChunk = g_ptr_array_index (stream->segments, ++index);
-            }
+            selectedChunk = g_ptr_array_index (stream->segments, ++index);
           }
         }
-        break;
       }
     }
 
@@ -2278,6 +2342,37 @@ done:
   return ret;
 }
 
+/* Like gst_mpd_client_get_next_fragment() for the fragment @n segments
+ * after the current one, leaving the stream position unchanged */
+gboolean
+gst_mpd_client_peek_fragment (GstMPDClient * client, guint indexStream,
+    guint n, GstMediaFragmentInfo * fragment)
+{
+  GstActiveStream *stream;
+  gint segment_index;
+  guint segment_repeat_index;
+  gboolean ret = FALSE;
+
+  stream = gst_mpd_client_get_active_stream_by_index (client, indexStream);
+  g_return_val_if_fail (stream != NULL, FALSE);
+
+  segment_index = stream->segment_index;
+  segment_repeat_index = stream->segment_repeat_index;
+
+  for (; n > 0; n--) {
+    if (gst_mpd_client_advance_segment (client, stream, TRUE) != GST_FLOW_OK)
+      goto done;
+  }
+
+  ret = gst_mpd_client_get_next_fragment (client, indexStream, fragment);
+
+done:
+  stream->segment_index = segment_index;
+  stream->segment_repeat_index = segment_repeat_index;
+
+  return ret;
+}
+
 gboolean
 gst_mpd_client_get_next_header (GstMPDClient * client, gchar ** uri,
     guint stream_idx, gint64 * range_start, gint64 * range_end)
@@ -59,6 +59,7 @@ void gst_mpd_client_free (GstMPDClient * client);
 
 /* main mpd parsing methods from xml data */
 gboolean gst_mpd_client_parse (GstMPDClient * client, const gchar * data, gint size);
+gboolean gst_mpd_client_parse_update (GstMPDClient * client, GstMPDClient * previous, const gchar * data, gint size);
 
 /* xml generator */
 gboolean gst_mpd_client_get_xml_content (GstMPDClient * client, gchar ** data, gint * size);
@@ -78,6 +79,7 @@ GstClockTime gst_mpd_client_get_maximum_segment_duration (GstMPDClient * client)
 gboolean gst_mpd_client_get_last_fragment_timestamp_end (GstMPDClient * client, guint stream_idx, GstClockTime * ts);
 gboolean gst_mpd_client_get_next_fragment_timestamp (GstMPDClient * client, guint stream_idx, GstClockTime * ts);
 gboolean gst_mpd_client_get_next_fragment (GstMPDClient *client, guint indexStream, GstMediaFragmentInfo * fragment);
+gboolean gst_mpd_client_peek_fragment (GstMPDClient *client, guint indexStream, guint n, GstMediaFragmentInfo * fragment);
 gboolean gst_mpd_client_get_next_header (GstMPDClient *client, gchar **uri, guint stream_idx, gint64 * range_start, gint64 * range_end);
 gboolean gst_mpd_client_get_next_header_index (GstMPDClient *client, gchar **uri, guint stream_idx, gint64 * range_start, gint64 * range_end);
 gboolean gst_mpd_client_is_live (GstMPDClient * client);
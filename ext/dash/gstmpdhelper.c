@@ -195,3 +195,11 @@ gst_mpd_helper_strncmp_ext (const char *s1, const char *s2)
     return 1;
   return strncmp (s1, s2, strlen (s2));
 }
+
+void
+gst_mpd_helper_digest_clear (GstMPDDigest * digest)
+{
+  if (digest->data)
+    g_byte_array_unref (digest->data);
+  memset (digest, 0, sizeof (GstMPDDigest));
+}
@@ -56,6 +56,17 @@ typedef enum
   GST_MPD_XLINK_ACTUATE_ON_LOAD
 } GstMPDXLinkActuate;
 
+/* digest of the XML a node was parsed from. A zero @hash means the node
+ * can't be reused. @length is the number of bytes that went into @hash and
+ * @data the bytes themselves, a matching @hash is only trusted once those
+ * compare equal as well */
+typedef struct
+{
+  guint64 hash;
+  guint64 length;
+  GByteArray *data;
+} GstMPDDigest;
+
 
 gboolean gst_mpd_helper_get_mpd_type (xmlNode * a_node, const gchar * property_name, GstMPDFileType * property_value);
 gboolean gst_mpd_helper_get_SAP_type (xmlNode * a_node, const gchar * property_name, GstMPDSAPType * property_value);
@@ -65,6 +76,7 @@ const gchar * gst_mpd_helper_get_video_codec_from_mime (GstCaps * caps);
 const gchar * gst_mpd_helper_get_audio_codec_from_mime (GstCaps * caps);
 GstUri *gst_mpd_helper_combine_urls (GstUri * base, GList * list, gchar ** query, guint idx);
 int gst_mpd_helper_strncmp_ext (const char *s1, const char *s2);
+void gst_mpd_helper_digest_clear (GstMPDDigest * digest);
 
 G_END_DECLS
 #endif /* __GST_MPDHELPER_H__ */
@@ -25,12 +25,26 @@
  */
 
 #include <string.h>
+#include <libxml/xmlreader.h>
 
 #include "gstmpdparser.h"
 #include "gstdash_debug.h"
 
 #define GST_CAT_DEFAULT gst_dash_demux_debug
 
+/* Per-parse state. When @track is set, the Period, AdaptationSet and
+ * Representation nodes remember a digest of the XML they were built from,
+ * so that the next refresh of a dynamic MPD can reuse the unchanged ones */
+typedef struct
+{
+  gboolean track;
+  guint parsed_periods;
+  guint reused_periods;
+  guint parsed_adapt_sets;
+  guint reused_adapt_sets;
+  guint parsed_representations;
+  guint reused_representations;
+} GstMPDParseState;
 
 /* XML node parsing */
 static void gst_mpdparser_parse_baseURL_node (GList ** list, xmlNode * a_node);
@@ -60,22 +74,25 @@ gst_mpdparser_parse_representation_base (GstMPDRepresentationBaseNode *
     pointer, xmlNode * a_node);
 static gboolean gst_mpdparser_parse_representation_node (GList ** list,
     xmlNode * a_node, GstMPDAdaptationSetNode * parent,
-    GstMPDPeriodNode * period_node);
+    GstMPDPeriodNode * period_node, GList * previous,
+    GstMPDParseState * state);
 static gboolean gst_mpdparser_parse_adaptation_set_node (GList ** list,
-    xmlNode * a_node, GstMPDPeriodNode * parent);
+    xmlNode * a_node, GstMPDPeriodNode * parent, GList * previous,
+    GstMPDParseState * state);
 static void gst_mpdparser_parse_subset_node (GList ** list, xmlNode * a_node);
 static gboolean
 gst_mpdparser_parse_segment_template_node (GstMPDSegmentTemplateNode ** pointer,
     xmlNode * a_node, GstMPDSegmentTemplateNode * parent);
 static gboolean gst_mpdparser_parse_period_node (GList ** list,
-    xmlNode * a_node);
+    xmlNode * a_node, GList * previous, GstMPDParseState * state);
 static void gst_mpdparser_parse_program_info_node (GList ** list,
     xmlNode * a_node);
 static void gst_mpdparser_parse_metrics_range_node (GList ** list,
     xmlNode * a_node);
 static void gst_mpdparser_parse_metrics_node (GList ** list, xmlNode * a_node);
 static gboolean gst_mpdparser_parse_root_node (GstMPDRootNode ** pointer,
-    xmlNode * a_node);
+    xmlTextReaderPtr reader, GstMPDRootNode * previous,
+    GstMPDParseState * state);
 static void gst_mpdparser_parse_utctiming_node (GList ** list,
     xmlNode * a_node);
 
@@ -592,14 +609,211 @@ gst_mpdparser_parse_representation_base (GstMPDRepresentationBaseNode *
   }
 }
 
+#define MPD_DIGEST_INIT G_GUINT64_CONSTANT (0xcbf29ce484222325)
+#define MPD_DIGEST_PRIME G_GUINT64_CONSTANT (0x100000001b3)
+
+/* 64 bits FNV-1a, including the terminator so that adjacent strings can't
+ * be confused with each other. The bytes hashed are kept as well, so that
+ * two subtrees with the same hash and length are only taken for each other
+ * once their bytes were compared */
+static void
+gst_mpdparser_digest_bytes (GstMPDDigest * digest, const guint8 * bytes,
+    gsize size)
+{
+  gsize i;
+
+  for (i = 0; i < size; i++) {
+    digest->hash ^= bytes[i];
+    digest->hash *= MPD_DIGEST_PRIME;
+  }
+  digest->length += size;
+  g_byte_array_append (digest->data, bytes, size);
+}
+
+static void
+gst_mpdparser_digest_byte (GstMPDDigest * digest, guint8 byte)
+{
+  gst_mpdparser_digest_bytes (digest, &byte, 1);
+}
+
+static void
+gst_mpdparser_digest_string (GstMPDDigest * digest, const xmlChar * str)
+{
+  if (str)
+    gst_mpdparser_digest_bytes (digest, str, xmlStrlen (str) + 1);
+  else
+    gst_mpdparser_digest_byte (digest, 0);
+}
+
+static void
+gst_mpdparser_digest_subtree (GstMPDDigest * digest, xmlNode * a_node,
+    const gchar * skip, gboolean * reusable)
+{
+  xmlAttr *attr;
+  xmlNode *cur_node;
+
+  gst_mpdparser_digest_byte (digest, a_node->type);
+  if (a_node->type != XML_ELEMENT_NODE) {
+    gst_mpdparser_digest_string (digest, a_node->content);
+    return;
+  }
+
+  gst_mpdparser_digest_string (digest, a_node->name);
+  gst_mpdparser_digest_string (digest, a_node->ns ? a_node->ns->href : NULL);
+
+  for (attr = a_node->properties; attr; attr = attr->next) {
+    /* the client resolves xlink references in place in the parsed nodes,
+     * so those can't be handed over to another manifest */
+    if (attr->ns && xmlStrcmp (attr->ns->href,
+            (xmlChar *) "http://www.w3.org/1999/xlink") == 0
+        && xmlStrcmp (attr->name, (xmlChar *) "href") == 0)
+      *reusable = FALSE;
+
+    gst_mpdparser_digest_string (digest, attr->name);
+    gst_mpdparser_digest_string (digest, attr->ns ? attr->ns->href : NULL);
+    for (cur_node = attr->children; cur_node; cur_node = cur_node->next)
+      gst_mpdparser_digest_string (digest, cur_node->content);
+  }
+
+  for (cur_node = a_node->children; cur_node; cur_node = cur_node->next) {
+    if (skip && cur_node->type == XML_ELEMENT_NODE
+        && xmlStrcmp (cur_node->name, (xmlChar *) skip) == 0)
+      continue;
+    gst_mpdparser_digest_subtree (digest, cur_node, NULL, reusable);
+  }
+}
+
+/* Computes the @digest of @a_node and all its descendants, left zeroed if
+ * the node must not be reused. @header, if set, receives the digest of
+ * everything but the children elements named @split, which the children
+ * inherit from */
+static void
+gst_mpdparser_digest_node (xmlNode * a_node, GstMPDDigest * digest,
+    const gchar * split, GstMPDDigest * header)
+{
+  gboolean reusable = TRUE;
+
+  digest->hash = MPD_DIGEST_INIT;
+  digest->length = 0;
+  digest->data = g_byte_array_new ();
+  gst_mpdparser_digest_subtree (digest, a_node, NULL, &reusable);
+  if (header) {
+    header->hash = MPD_DIGEST_INIT;
+    header->length = 0;
+    header->data = g_byte_array_new ();
+    gst_mpdparser_digest_subtree (header, a_node, split, &reusable);
+  }
+
+  if (!reusable) {
+    gst_mpd_helper_digest_clear (digest);
+    if (header)
+      gst_mpd_helper_digest_clear (header);
+  }
+}
+
+/* A zeroed digest never matches. The hash and length are only a quick way
+ * to tell different subtrees apart, equal ones are confirmed byte by byte */
+static gboolean
+gst_mpdparser_digest_equal (const GstMPDDigest * a, const GstMPDDigest * b)
+{
+  return a->hash != 0 && a->hash == b->hash && a->length == b->length
+      && memcmp (a->data->data, b->data->data, a->length) == 0;
+}
+
+static GstMPDRepresentationNode *
+gst_mpdparser_find_previous_representation (GList * previous,
+    xmlNode * a_node)
+{
+  GstMPDRepresentationNode *representation = NULL;
+  xmlChar *id;
+  GList *list;
+
+  id = xmlGetProp (a_node, (xmlChar *) "id");
+  if (id == NULL)
+    return NULL;
+
+  for (list = previous; list; list = g_list_next (list)) {
+    if (g_strcmp0 (GST_MPD_REPRESENTATION_NODE (list->data)->id,
+            (gchar *) id) == 0) {
+      representation = list->data;
+      break;
+    }
+  }
+  xmlFree (id);
+
+  return representation;
+}
+
+static GstMPDAdaptationSetNode *
+gst_mpdparser_find_previous_adaptation_set (GList * previous,
+    xmlNode * a_node)
+{
+  GList *list;
+  guint id;
+
+  /* the id is optional, and defaults to 0 for all AdaptationSets */
+  if (!gst_xml_helper_get_prop_unsigned_integer (a_node, "id", 0, &id))
+    return NULL;
+
+  for (list = previous; list; list = g_list_next (list)) {
+    if (GST_MPD_ADAPTATION_SET_NODE (list->data)->id == id)
+      return list->data;
+  }
+
+  return NULL;
+}
+
+static GstMPDPeriodNode *
+gst_mpdparser_find_previous_period (GList * previous, xmlNode * a_node)
+{
+  GstMPDPeriodNode *period = NULL;
+  xmlChar *id;
+  GList *list;
+
+  id = xmlGetProp (a_node, (xmlChar *) "id");
+  if (id == NULL)
+    return NULL;
+
+  for (list = previous; list; list = g_list_next (list)) {
+    if (g_strcmp0 (GST_MPD_PERIOD_NODE (list->data)->id, (gchar *) id) == 0) {
+      period = list->data;
+      break;
+    }
+  }
+  xmlFree (id);
+
+  return period;
+}
+
 static gboolean
 gst_mpdparser_parse_representation_node (GList ** list, xmlNode * a_node,
-    GstMPDAdaptationSetNode * parent, GstMPDPeriodNode * period_node)
+    GstMPDAdaptationSetNode * parent, GstMPDPeriodNode * period_node,
+    GList * previous, GstMPDParseState * state)
 {
   xmlNode *cur_node;
   GstMPDRepresentationNode *new_representation;
+  GstMPDRepresentationNode *old_representation = NULL;
+  GstMPDDigest digest = { 0, };
+
+  if (state && state->track) {
+    gst_mpdparser_digest_node (a_node, &digest, NULL, NULL);
+    if (digest.hash)
+      old_representation =
+          gst_mpdparser_find_previous_representation (previous, a_node);
+    if (old_representation
+        && gst_mpdparser_digest_equal (&old_representation->digest, &digest)) {
+      GST_LOG ("reusing unchanged Representation %s", old_representation->id);
+      gst_mpd_helper_digest_clear (&digest);
+      *list = g_list_append (*list, gst_object_ref (old_representation));
+      state->reused_representations++;
+      return TRUE;
+    }
+  }
+  if (state)
+    state->parsed_representations++;
 
   new_representation = gst_mpd_representation_node_new ();
+  new_representation->digest = digest;
 
   GST_LOG ("attributes of Representation node:");
   if (!gst_xml_helper_get_prop_string_no_whitespace (a_node, "id",
@@ -664,13 +878,37 @@ error:
 
 static gboolean
 gst_mpdparser_parse_adaptation_set_node (GList ** list, xmlNode * a_node,
-    GstMPDPeriodNode * parent)
+    GstMPDPeriodNode * parent, GList * previous, GstMPDParseState * state)
 {
   xmlNode *cur_node;
   GstMPDAdaptationSetNode *new_adap_set;
+  GstMPDAdaptationSetNode *old_adap_set = NULL;
+  GList *old_representations = NULL;
+  GstMPDDigest digest = { 0, }, header_digest = { 0, };
   gchar *actuate;
 
+  if (state && state->track) {
+    gst_mpdparser_digest_node (a_node, &digest, "Representation",
+        &header_digest);
+    if (digest.hash)
+      old_adap_set =
+          gst_mpdparser_find_previous_adaptation_set (previous, a_node);
+    if (old_adap_set
+        && gst_mpdparser_digest_equal (&old_adap_set->digest, &digest)) {
+      GST_LOG ("reusing unchanged AdaptationSet %u", old_adap_set->id);
+      gst_mpd_helper_digest_clear (&digest);
+      gst_mpd_helper_digest_clear (&header_digest);
+      *list = g_list_append (*list, gst_object_ref (old_adap_set));
+      state->reused_adapt_sets++;
+      return TRUE;
+    }
+  }
+  if (state)
+    state->parsed_adapt_sets++;
+
   new_adap_set = gst_mpd_adaptation_set_node_new ();
+  new_adap_set->digest = digest;
+  new_adap_set->header_digest = header_digest;
 
   GST_LOG ("attributes of AdaptationSet node:");
 
@@ -763,11 +1001,18 @@ gst_mpdparser_parse_adaptation_set_node (GList ** list, xmlNode * a_node,
    * has been parsed because certain Representation child elements can inherit
    * attributes specified by the same element in the AdaptationSet
    */
+  /* and for the same reason the previous Representations can only be reused
+   * if nothing they could have inherited changed */
+  if (old_adap_set && gst_mpdparser_digest_equal (&old_adap_set->header_digest,
+          &header_digest))
+    old_representations = old_adap_set->Representations;
+
   for (cur_node = a_node->children; cur_node; cur_node = cur_node->next) {
     if (cur_node->type == XML_ELEMENT_NODE) {
       if (xmlStrcmp (cur_node->name, (xmlChar *) "Representation") == 0) {
         if (!gst_mpdparser_parse_representation_node
-            (&new_adap_set->Representations, cur_node, new_adap_set, parent))
+            (&new_adap_set->Representations, cur_node, new_adap_set, parent,
+                old_representations, state))
           goto error;
       }
     }
@@ -847,13 +1092,37 @@ error:
 }
 
 static gboolean
-gst_mpdparser_parse_period_node (GList ** list, xmlNode * a_node)
+gst_mpdparser_parse_period_node (GList ** list, xmlNode * a_node,
+    GList * previous, GstMPDParseState * state)
 {
   xmlNode *cur_node;
   GstMPDPeriodNode *new_period;
+  GstMPDPeriodNode *old_period = NULL;
+  GList *old_adapt_sets = NULL;
+  GstMPDDigest digest = { 0, }, header_digest = { 0, };
   gchar *actuate;
 
+  if (state && state->track) {
+    gst_mpdparser_digest_node (a_node, &digest, "AdaptationSet",
+        &header_digest);
+    if (digest.hash)
+      old_period = gst_mpdparser_find_previous_period (previous, a_node);
+    if (old_period
+        && gst_mpdparser_digest_equal (&old_period->digest, &digest)) {
+      GST_LOG ("reusing unchanged Period %s", old_period->id);
+      gst_mpd_helper_digest_clear (&digest);
+      gst_mpd_helper_digest_clear (&header_digest);
+      *list = g_list_append (*list, gst_object_ref (old_period));
+      state->reused_periods++;
+      return TRUE;
+    }
+  }
+  if (state)
+    state->parsed_periods++;
+
   new_period = gst_mpd_period_node_new ();
+  new_period->digest = digest;
+  new_period->header_digest = header_digest;
 
   GST_LOG ("attributes of Period node:");
 
@@ -901,11 +1170,16 @@ gst_mpdparser_parse_period_node (GList ** list, xmlNode * a_node)
    * parsed because certain AdaptationSet child elements can inherit attributes
    * specified by the same element in the Period
    */
+  if (old_period && gst_mpdparser_digest_equal (&old_period->header_digest,
+          &header_digest))
+    old_adapt_sets = old_period->AdaptationSets;
+
   for (cur_node = a_node->children; cur_node; cur_node = cur_node->next) {
     if (cur_node->type == XML_ELEMENT_NODE) {
       if (xmlStrcmp (cur_node->name, (xmlChar *) "AdaptationSet") == 0) {
         if (!gst_mpdparser_parse_adaptation_set_node
-            (&new_period->AdaptationSets, cur_node, new_period))
+            (&new_period->AdaptationSets, cur_node, new_period,
+                old_adapt_sets, state))
           goto error;
       }
     }
@@ -1032,10 +1306,16 @@ gst_mpdparser_parse_utctiming_node (GList ** list, xmlNode * a_node)
 }
 
 static gboolean
-gst_mpdparser_parse_root_node (GstMPDRootNode ** pointer, xmlNode * a_node)
+gst_mpdparser_parse_root_node (GstMPDRootNode ** pointer,
+    xmlTextReaderPtr reader, GstMPDRootNode * previous,
+    GstMPDParseState * state)
 {
-  xmlNode *cur_node;
+  xmlNode *a_node, *cur_node;
   GstMPDRootNode *new_mpd_root;
+  GList *old_periods = previous ? previous->Periods : NULL;
+  int ret;
+
+  a_node = xmlTextReaderCurrentNode (reader);
 
   gst_mpd_root_node_free (*pointer);
   *pointer = NULL;
@@ -1074,29 +1354,50 @@ gst_mpdparser_parse_root_node (GstMPDRootNode ** pointer, xmlNode * a_node)
   gst_xml_helper_get_prop_duration (a_node, "maxSubsegmentDuration",
       GST_MPD_DURATION_NONE, &new_mpd_root->maxSubsegmentDuration);
 
-  /* explore children Period nodes */
-  for (cur_node = a_node->children; cur_node; cur_node = cur_node->next) {
-    if (cur_node->type == XML_ELEMENT_NODE) {
-      if (xmlStrcmp (cur_node->name, (xmlChar *) "Period") == 0) {
-        if (!gst_mpdparser_parse_period_node (&new_mpd_root->Periods, cur_node))
-          goto error;
-      } else if (xmlStrcmp (cur_node->name,
-              (xmlChar *) "ProgramInformation") == 0) {
-        gst_mpdparser_parse_program_info_node (&new_mpd_root->ProgramInfos,
-            cur_node);
-      } else if (xmlStrcmp (cur_node->name, (xmlChar *) "BaseURL") == 0) {
-        gst_mpdparser_parse_baseURL_node (&new_mpd_root->BaseURLs, cur_node);
-      } else if (xmlStrcmp (cur_node->name, (xmlChar *) "Location") == 0) {
-        gst_mpdparser_parse_location_node (&new_mpd_root->Locations, cur_node);
-      } else if (xmlStrcmp (cur_node->name, (xmlChar *) "Metrics") == 0) {
-        gst_mpdparser_parse_metrics_node (&new_mpd_root->Metrics, cur_node);
-      } else if (xmlStrcmp (cur_node->name, (xmlChar *) "UTCTiming") == 0) {
-        gst_mpdparser_parse_utctiming_node (&new_mpd_root->UTCTimings,
-            cur_node);
-      }
+  /* only dynamic MPDs get refreshed, don't bother tracking changes else */
+  state->track = new_mpd_root->type == GST_MPD_FILE_TYPE_DYNAMIC;
+
+  /* explore children nodes one at a time: the reader only builds the tree of
+   * the child being parsed, and releases it once we skip past it */
+  ret = xmlTextReaderIsEmptyElement (reader) ? 0 : xmlTextReaderRead (reader);
+  while (ret == 1 && xmlTextReaderDepth (reader) > 0) {
+    if (xmlTextReaderNodeType (reader) != XML_READER_TYPE_ELEMENT) {
+      ret = xmlTextReaderRead (reader);
+      continue;
     }
+
+    cur_node = xmlTextReaderExpand (reader);
+    if (cur_node == NULL)
+      goto error;
+
+    if (xmlStrcmp (cur_node->name, (xmlChar *) "Period") == 0) {
+      if (!gst_mpdparser_parse_period_node (&new_mpd_root->Periods, cur_node,
+              old_periods, state))
+        goto error;
+    } else if (xmlStrcmp (cur_node->name,
+            (xmlChar *) "ProgramInformation") == 0) {
+      gst_mpdparser_parse_program_info_node (&new_mpd_root->ProgramInfos,
+          cur_node);
+    } else if (xmlStrcmp (cur_node->name, (xmlChar *) "BaseURL") == 0) {
+      gst_mpdparser_parse_baseURL_node (&new_mpd_root->BaseURLs, cur_node);
+    } else if (xmlStrcmp (cur_node->name, (xmlChar *) "Location") == 0) {
+      gst_mpdparser_parse_location_node (&new_mpd_root->Locations, cur_node);
+    } else if (xmlStrcmp (cur_node->name, (xmlChar *) "Metrics") == 0) {
+      gst_mpdparser_parse_metrics_node (&new_mpd_root->Metrics, cur_node);
+    } else if (xmlStrcmp (cur_node->name, (xmlChar *) "UTCTiming") == 0) {
+      gst_mpdparser_parse_utctiming_node (&new_mpd_root->UTCTimings,
+          cur_node);
+    }
+
+    ret = xmlTextReaderNext (reader);
   }
 
+  /* make sure the rest of the document is well-formed too */
+  while (ret == 1)
+    ret = xmlTextReaderRead (reader);
+  if (ret < 0)
+    goto error;
+
   *pointer = new_mpd_root;
   return TRUE;
 
@@ -1208,17 +1509,22 @@ gst_mpdparser_media_fragment_info_clear (GstMediaFragmentInfo * fragment)
 /* API */
 gboolean
 gst_mpdparser_get_mpd_root_node (GstMPDRootNode ** mpd_root_node,
-    const gchar * data, gint size)
+    GstMPDRootNode * previous, const gchar * data, gint size)
 {
   gboolean ret = FALSE;
 
   if (data) {
-    xmlDocPtr doc;
+    xmlTextReaderPtr reader;
     xmlNode *root_element = NULL;
+    GstMPDParseState state = { 0, };
+    gint64 start_time;
+    int res;
 
     GST_DEBUG ("MPD file fully buffered, start parsing...");
+    start_time = g_get_monotonic_time ();
 
-    /* parse the complete MPD file into a tree (using the libxml2 default parser API) */
+    /* parse the MPD file with the libxml2 streaming reader, so that only the
+     * top-level element being parsed is ever held as a tree */
 
     /* this initialize the library and check potential ABI mismatches
      * between the version it was compiled for and the actual shared
@@ -1226,27 +1532,49 @@ gst_mpdparser_get_mpd_root_node (GstMPDRootNode ** mpd_root_node,
      */
     LIBXML_TEST_VERSION;
 
-    /* parse "data" into a document (which is a libxml2 tree structure xmlDoc) */
-    doc = xmlReadMemory (data, size, "noname.xml", NULL, XML_PARSE_NONET);
-    if (doc == NULL) {
+    reader = xmlReaderForMemory (data, size, "noname.xml", NULL,
+        XML_PARSE_NONET);
+    if (reader == NULL) {
+      GST_ERROR ("failed to parse the MPD file");
+      return FALSE;
+    }
+
+    /* keep the previous nodes alive in case they belong to *mpd_root_node */
+    if (previous)
+      gst_object_ref (previous);
+
+    /* move to the root element */
+    do {
+      res = xmlTextReaderRead (reader);
+    } while (res == 1 && xmlTextReaderNodeType (reader) !=
+        XML_READER_TYPE_ELEMENT);
+    if (res == 1)
+      root_element = xmlTextReaderCurrentNode (reader);
+
+    if (root_element == NULL) {
       GST_ERROR ("failed to parse the MPD file");
       ret = FALSE;
+    } else if (xmlStrcmp (root_element->name, (xmlChar *) "MPD") != 0) {
+      GST_ERROR
+          ("can not find the root element MPD, failed to parse the MPD file");
+      ret = FALSE;              /* used to return TRUE before, but this seems wrong */
     } else {
-      /* get the root element node */
-      root_element = xmlDocGetRootElement (doc);
-
-      if (root_element->type != XML_ELEMENT_NODE
-          || xmlStrcmp (root_element->name, (xmlChar *) "MPD") != 0) {
-        GST_ERROR
-            ("can not find the root element MPD, failed to parse the MPD file");
-        ret = FALSE;            /* used to return TRUE before, but this seems wrong */
-      } else {
-        /* now we can parse the MPD root node and all children nodes, recursively */
-        ret = gst_mpdparser_parse_root_node (mpd_root_node, root_element);
-      }
-      /* free the document */
-      xmlFreeDoc (doc);
+      /* now we can parse the MPD root node and all children nodes, recursively */
+      ret = gst_mpdparser_parse_root_node (mpd_root_node, reader, previous,
+          &state);
     }
+
+    xmlFreeTextReader (reader);
+    if (previous)
+      gst_object_unref (previous);
+
+    GST_DEBUG ("MPD parsed in %" G_GINT64_FORMAT " us, %u/%u Periods, "
+        "%u/%u AdaptationSets, %u/%u Representations reused",
+        g_get_monotonic_time () - start_time, state.reused_periods,
+        state.reused_periods + state.parsed_periods, state.reused_adapt_sets,
+        state.reused_adapt_sets + state.parsed_adapt_sets,
+        state.reused_representations,
+        state.reused_representations + state.parsed_representations);
   }
 
   return ret;
@@ -1298,7 +1626,7 @@ gst_mpdparser_get_external_periods (const gchar * data, gint size)
     for (iter = root_element->children; iter; iter = iter->next) {
       if (iter->type == XML_ELEMENT_NODE) {
         if (xmlStrcmp (iter->name, (xmlChar *) "Period") == 0) {
-          gst_mpdparser_parse_period_node (&new_periods, iter);
+          gst_mpdparser_parse_period_node (&new_periods, iter, NULL, NULL);
         } else {
           goto error;
         }
@@ -1338,7 +1666,7 @@ gst_mpdparser_get_external_adaptation_sets (const gchar * data, gint size,
     if (root_element->type == XML_ELEMENT_NODE &&
         xmlStrcmp (root_element->name, (xmlChar *) "AdaptationSet") == 0) {
       gst_mpdparser_parse_adaptation_set_node (&new_adaptation_sets,
-          root_element, period);
+          root_element, period, NULL, NULL);
     }
   }
 
@@ -88,6 +88,8 @@ gst_mpd_period_node_finalize (GObject * object)
 {
   GstMPDPeriodNode *self = GST_MPD_PERIOD_NODE (object);
 
+  gst_mpd_helper_digest_clear (&self->digest);
+  gst_mpd_helper_digest_clear (&self->header_digest);
   if (self->id)
     xmlFree (self->id);
   gst_mpd_segment_base_node_free (self->SegmentBase);
@@ -55,6 +55,11 @@ struct _GstMPDPeriodNode
 
   gchar *xlink_href;
   int actuate;
+
+  /* digest of the XML the node was parsed from */
+  GstMPDDigest digest;
+  /* same, leaving out the AdaptationSet children */
+  GstMPDDigest header_digest;
 };
 
 GstMPDPeriodNode * gst_mpd_period_node_new (void);
@@ -82,6 +82,7 @@ gst_mpd_representation_node_finalize (GObject * object)
 {
   GstMPDRepresentationNode *self = GST_MPD_REPRESENTATION_NODE (object);
 
+  gst_mpd_helper_digest_clear (&self->digest);
   if (self->id)
     xmlFree (self->id);
   g_strfreev (self->dependencyId);
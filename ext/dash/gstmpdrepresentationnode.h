@@ -50,6 +50,9 @@ struct _GstMPDRepresentationNode
   GstMPDSegmentTemplateNode *SegmentTemplate;
   /* SegmentList node */
   GstMPDSegmentListNode *SegmentList;
+
+  /* digest of the XML the node was parsed from */
+  GstMPDDigest digest;
 };
 
 
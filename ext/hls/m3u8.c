@@ -107,6 +107,7 @@ gst_m3u8_unref (GstM3U8 * self)
 
     g_list_foreach (self->files, (GFunc) gst_m3u8_media_file_unref, NULL);
     g_list_free (self->files);
+    g_free (self->file_ring);
 
     g_free (self->last_data);
     g_mutex_clear (&self->lock);
@@ -186,6 +187,126 @@ gst_m3u8_init_file_unref (GstM3U8InitFile * self)
   }
 }
 
+/* call with M3U8_LOCK held */
+static GList *
+m3u8_ring_nth (GstM3U8 * self, guint n)
+{
+  return self->file_ring[(self->file_ring_head + n) % self->file_ring_size];
+}
+
+/* Returns the link of @files for @sequence, or NULL.
+ * call with M3U8_LOCK held */
+static GList *
+m3u8_lookup_file (GstM3U8 * self, gint64 sequence)
+{
+  gint64 first;
+
+  if (self->file_ring_len == 0)
+    return NULL;
+
+  first = GST_M3U8_MEDIA_FILE (m3u8_ring_nth (self, 0)->data)->sequence;
+  if (sequence < first || sequence - first >= self->file_ring_len)
+    return NULL;
+
+  return m3u8_ring_nth (self, sequence - first);
+}
+
+/* call with M3U8_LOCK held */
+static void
+m3u8_ring_push (GstM3U8 * self, GList * link)
+{
+  if (self->file_ring_len == self->file_ring_size) {
+    guint i, size = MAX (64, self->file_ring_size * 2);
+    GList **ring = g_new (GList *, size);
+
+    for (i = 0; i < self->file_ring_len; i++)
+      ring[i] = m3u8_ring_nth (self, i);
+
+    g_free (self->file_ring);
+    self->file_ring = ring;
+    self->file_ring_size = size;
+    self->file_ring_head = 0;
+  }
+
+  self->file_ring[(self->file_ring_head + self->file_ring_len) %
+      self->file_ring_size] = link;
+  self->file_ring_len++;
+  self->files_duration += GST_M3U8_MEDIA_FILE (link->data)->duration;
+}
+
+/* Re-indexes all of @files, whose sequence numbers must be contiguous.
+ * call with M3U8_LOCK held */
+static void
+m3u8_index_files (GstM3U8 * self)
+{
+  GList *l;
+
+  self->file_ring_head = 0;
+  self->file_ring_len = 0;
+  self->files_duration = 0;
+
+  for (l = self->files; l != NULL; l = l->next)
+    m3u8_ring_push (self, l);
+}
+
+/* call with M3U8_LOCK held */
+static void
+m3u8_append_file (GstM3U8 * self, GstM3U8MediaFile * file)
+{
+  GList *link = g_list_alloc ();
+
+  link->data = file;
+  link->next = NULL;
+  link->prev = self->file_ring_len > 0 ?
+      m3u8_ring_nth (self, self->file_ring_len - 1) : NULL;
+
+  if (link->prev)
+    link->prev->next = link;
+  else
+    self->files = link;
+
+  m3u8_ring_push (self, link);
+}
+
+/* Drops the files before @sequence from the start of the playlist.
+ * call with M3U8_LOCK held */
+static void
+m3u8_evict_before (GstM3U8 * self, gint64 sequence)
+{
+  while (self->file_ring_len > 0) {
+    GList *link = m3u8_ring_nth (self, 0);
+    GstM3U8MediaFile *file = link->data;
+
+    if (file->sequence >= sequence)
+      break;
+
+    self->file_ring_head = (self->file_ring_head + 1) % self->file_ring_size;
+    self->file_ring_len--;
+    self->files_duration -= file->duration;
+    self->files = g_list_delete_link (self->files, link);
+    gst_m3u8_media_file_unref (file);
+  }
+}
+
+/* Drops the files after @sequence from the end of the playlist.
+ * call with M3U8_LOCK held */
+static void
+m3u8_evict_after (GstM3U8 * self, gint64 sequence)
+{
+  while (self->file_ring_len > 0) {
+    GList *link = m3u8_ring_nth (self, self->file_ring_len - 1);
+    GstM3U8MediaFile *file = link->data;
+
+    if (file->sequence <= sequence)
+      break;
+
+    self->file_ring_len--;
+    self->files_duration -= file->duration;
+    self->files = g_list_delete_link (self->files, link);
+    gst_m3u8_media_file_unref (file);
+  }
+}
+
 static gboolean
 int_from_string (gchar * ptr, gchar ** endptr, gint * val)
 {
@@ -476,6 +597,46 @@ generate_media_seqnums (GstM3U8 * self, GList * previous_files)
   }
 }
 
+/* Called at the first media segment of an update. If the playlist has a
+ * MEDIA-SEQUENCE that doesn't go backwards, it is merged into the files we
+ * already have by m3u8_merge_update() once fully parsed. Otherwise all files
+ * are parsed again and checked against the @previous_files afterwards.
+ * Returns TRUE if the files are merged. */
+static gboolean
+m3u8_start_update (GstM3U8 * self, gboolean have_mediasequence,
+    gint64 mediasequence, GList ** previous_files)
+{
+  if (have_mediasequence && self->files != NULL &&
+      mediasequence >= GST_M3U8_MEDIA_FILE (self->files->data)->sequence)
+    return TRUE;
+
+  *previous_files = self->files;
+  self->files = NULL;
+  m3u8_index_files (self);
+
+  return FALSE;
+}
+
+/* Merges an update with the segments from @first_sequence to
+ * @end_sequence - 1: the files that left the playlist are evicted, the
+ * @new_files are appended and all others are kept as they are. Nothing is
+ * touched before, so that a refused update keeps the files we had.
+ * call with M3U8_LOCK held */
+static void
+m3u8_merge_update (GstM3U8 * self, gint64 first_sequence,
+    gint64 end_sequence, GList * new_files)
+{
+  GList *l;
+
+  m3u8_evict_before (self, first_sequence);
+  /* The playlist may also have become shorter at the end */
+  m3u8_evict_after (self, end_sequence - 1);
+
+  for (l = new_files; l != NULL; l = l->next)
+    m3u8_append_file (self, l->data);
+  g_list_free (new_files);
+}
+
 /*
  * @data: a m3u8 playlist text data, taking ownership
  */
@@ -493,6 +654,11 @@ gst_m3u8_update (GstM3U8 * self, gchar * data)
   gint64 mediasequence;
   GList *previous_files = NULL;
   gboolean have_mediasequence = FALSE;
+  gboolean have_segment = FALSE;
+  gboolean incremental = FALSE;
+  gint64 first_sequence = 0;
+  GList *new_files = NULL;
+  GstM3U8MediaFile *prev_file = NULL;
   GstM3U8InitFile *last_init_file = NULL;
 
   g_return_val_if_fail (self != NULL, FALSE);
@@ -527,8 +693,6 @@ gst_m3u8_update (GstM3U8 * self, gchar * data)
   self->last_data = data;
 
   self->current_file = NULL;
-  previous_files = self->files;
-  self->files = NULL;
   self->duration = GST_CLOCK_TIME_NONE;
   mediasequence = 0;
 
@@ -550,11 +714,44 @@ gst_m3u8_update (GstM3U8 * self, gchar * data)
       *r = '\0';
 
     if (data[0] != '#' && data[0] != '\0') {
+      GList *link = NULL;
+
       if (duration <= 0) {
         GST_LOG ("%s: got line without EXTINF, dropping", data);
         goto next_line;
       }
 
+      if (!have_segment) {
+        have_segment = TRUE;
+        incremental = m3u8_start_update (self, have_mediasequence,
+            mediasequence, &previous_files);
+        first_sequence = mediasequence;
+      }
+
+      if (incremental)
+        link = m3u8_lookup_file (self, mediasequence);
+
+      if (link != NULL) {
+        GstM3U8MediaFile *file = link->data;
+
+        /* We already have this one, only check it's still the same */
+        if (!g_str_has_suffix (file->uri, data)) {
+          GST_ERROR ("Media URIs inconsistent (sequence %" G_GINT64_FORMAT
+              "): had '%s', got '%s'", file->sequence, file->uri, data);
+          goto inconsistent;
+        }
+
+        mediasequence++;
+        prev_file = file;
+
+        g_free (title);
+        duration = 0;
+        title = NULL;
+        discontinuity = FALSE;
+        size = offset = -1;
+        goto next_line;
+      }
+
       data = uri_join (self->base_uri ? self->base_uri : self->uri, data);
       if (data != NULL) {
         GstM3U8MediaFile *file;
@@ -576,12 +773,10 @@ gst_m3u8_update (GstM3U8 * self, gchar * data)
           if (offset != -1) {
             file->offset = offset;
           } else {
-            GstM3U8MediaFile *prev = self->files ? self->files->data : NULL;
-
-            if (!prev) {
+            if (!prev_file) {
               offset = 0;
             } else {
-              offset = prev->offset + prev->size;
+              offset = prev_file->offset + prev_file->size;
             }
             file->offset = offset;
           }
@@ -598,7 +793,12 @@ gst_m3u8_update (GstM3U8 * self, gchar * data)
         title = NULL;
         discontinuity = FALSE;
         size = offset = -1;
-        self->files = g_list_prepend (self->files, file);
+        prev_file = file;
+
+        if (incremental)
+          new_files = g_list_prepend (new_files, file);
+        else
+          self->files = g_list_prepend (self->files, file);
       }
 
     } else if (g_str_has_prefix (data, "#EXTINF:")) {
@@ -710,6 +910,44 @@ gst_m3u8_update (GstM3U8 * self, gchar * data)
         } else {
           goto next_line;
         }
+      } else if (g_str_has_prefix (data_ext_x, "SKIP:")) {
+        gchar *v, *a;
+        gint skipped = 0;
+        GList *link = NULL;
+
+        data = data + 12;
+
+        while (data != NULL && parse_attributes (&data, &a, &v)) {
+          if (strcmp (a, "SKIPPED-SEGMENTS") == 0 &&
+              !int_from_string (v, NULL, &skipped))
+            skipped = 0;
+        }
+
+        if (skipped <= 0) {
+          GST_WARNING ("Can't read SKIPPED-SEGMENTS");
+          goto next_line;
+        }
+
+        /* A delta update replaces the first segments with EXT-X-SKIP, all
+         * of which we must already have */
+        if (!have_segment && have_mediasequence &&
+            m3u8_lookup_file (self, mediasequence) != NULL)
+          link = m3u8_lookup_file (self, mediasequence + skipped - 1);
+
+        if (link == NULL) {
+          GST_ERROR ("Delta update skips %d segments from sequence %"
+              G_GINT64_FORMAT " that we don't have", skipped, mediasequence);
+          goto inconsistent;
+        }
+
+        have_segment = TRUE;
+        incremental = m3u8_start_update (self, have_mediasequence,
+            mediasequence, &previous_files);
+        first_sequence = mediasequence;
+        mediasequence += skipped;
+        prev_file = link->data;
+        if (!last_init_file && prev_file->init_file)
+          last_init_file = gst_m3u8_init_file_ref (prev_file->init_file);
       } else if (g_str_has_prefix (data_ext_x, "MAP:")) {
         gchar *v, *a, *header_uri = NULL;
 
@@ -767,11 +1005,23 @@ gst_m3u8_update (GstM3U8 * self, gchar * data)
   g_free (current_key);
   current_key = NULL;
 
-  self->files = g_list_reverse (self->files);
-
   if (last_init_file)
     gst_m3u8_init_file_unref (last_init_file);
 
+  if (!have_segment) {
+    /* No media segments at all, this is reported below */
+    m3u8_start_update (self, FALSE, 0, &previous_files);
+  }
+
+  if (incremental) {
+    m3u8_merge_update (self, first_sequence, mediasequence,
+        g_list_reverse (new_files));
+    new_files = NULL;
+  } else {
+    self->files = g_list_reverse (self->files);
+    m3u8_index_files (self);
+  }
+
   if (previous_files) {
     gboolean consistent = TRUE;
 
@@ -801,47 +1051,37 @@ gst_m3u8_update (GstM3U8 * self, gchar * data)
   /* calculate the start and end times of this media playlist. */
   {
     GList *walk;
-    GstM3U8MediaFile *file;
-    GstClockTime duration = 0;
+    GstM3U8MediaFile *file = self->files->data;
 
-    mediasequence = -1;
+    /* Only the files we didn't see before move the end */
+    if (self->highest_sequence_number < file->sequence)
+      walk = self->files;
+    else
+      walk = m3u8_lookup_file (self, self->highest_sequence_number + 1);
 
-    for (walk = self->files; walk; walk = walk->next) {
+    for (; walk; walk = walk->next) {
       file = walk->data;
 
-      if (mediasequence == -1) {
-        mediasequence = file->sequence;
-      } else if (mediasequence >= file->sequence) {
-        GST_ERROR ("Non-increasing media sequence");
-        GST_M3U8_UNLOCK (self);
-        return FALSE;
-      } else {
-        mediasequence = file->sequence;
-      }
-
-      duration += file->duration;
-      if (file->sequence > self->highest_sequence_number) {
-        if (self->highest_sequence_number >= 0) {
-          /* if an update of the media playlist has been missed, there
-             will be a gap between self->highest_sequence_number and the
-             first sequence number in this media playlist. In this situation
-             assume that the missing fragments had a duration of
-             targetduration each */
-          self->last_file_end +=
-              (file->sequence - self->highest_sequence_number -
-              1) * self->targetduration;
-        }
-        self->last_file_end += file->duration;
-        self->highest_sequence_number = file->sequence;
+      if (self->highest_sequence_number >= 0) {
+        /* if an update of the media playlist has been missed, there
+           will be a gap between self->highest_sequence_number and the
+           first sequence number in this media playlist. In this situation
+           assume that the missing fragments had a duration of
+           targetduration each */
+        self->last_file_end +=
+            (file->sequence - self->highest_sequence_number -
+            1) * self->targetduration;
       }
+      self->last_file_end += file->duration;
+      self->highest_sequence_number = file->sequence;
     }
     if (GST_M3U8_IS_LIVE (self)) {
-      self->first_file_start = self->last_file_end - duration;
+      self->first_file_start = self->last_file_end - self->files_duration;
       GST_DEBUG ("Live playlist range %" GST_TIME_FORMAT " -> %"
           GST_TIME_FORMAT, GST_TIME_ARGS (self->first_file_start),
           GST_TIME_ARGS (self->last_file_end));
     }
-    self->duration = duration;
+    self->duration = self->files_duration;
   }
 
   /* first-time setup */
@@ -852,7 +1092,7 @@ gst_m3u8_update (GstM3U8 * self, gchar * data)
       gint i;
       GstClockTime sequence_pos = 0;
 
-      file = g_list_last (self->files);
+      file = m3u8_ring_nth (self, self->file_ring_len - 1);
 
       if (self->last_file_end >= GST_M3U8_MEDIA_FILE (file->data)->duration) {
         sequence_pos =
@@ -878,43 +1118,52 @@ gst_m3u8_update (GstM3U8 * self, gchar * data)
   }
 
   GST_LOG ("processed media playlist %s, %u fragments", self->name,
-      g_list_length (self->files));
+      self->file_ring_len);
 
   GST_M3U8_UNLOCK (self);
 
   return TRUE;
+
+inconsistent:
+  g_free (title);
+  g_free (current_key);
+  if (last_init_file)
+    gst_m3u8_init_file_unref (last_init_file);
+
+  /* An incremental update only changes the files once fully parsed */
+  g_list_free_full (new_files, (GDestroyNotify) gst_m3u8_media_file_unref);
+
+  if (have_segment && !incremental) {
+    /* Keep the files we had before */
+    g_list_foreach (self->files, (GFunc) gst_m3u8_media_file_unref, NULL);
+    g_list_free (self->files);
+    self->files = previous_files;
+    m3u8_index_files (self);
+  }
+
+  GST_M3U8_UNLOCK (self);
+
+  return FALSE;
 }
 
 /* call with M3U8_LOCK held */
 static GList *
 m3u8_find_next_fragment (GstM3U8 * m3u8, gboolean forward)
 {
-  GstM3U8MediaFile *file;
-  GList *l = m3u8->files;
+  GList *first, *last;
 
-  if (forward) {
-    while (l) {
-      file = l->data;
-
-      if (file->sequence >= m3u8->sequence)
-        break;
-
-      l = l->next;
-    }
-  } else {
-    l = g_list_last (l);
-
-    while (l) {
-      file = l->data;
+  if (m3u8->file_ring_len == 0)
+    return NULL;
 
-      if (file->sequence <= m3u8->sequence)
-        break;
+  first = m3u8_ring_nth (m3u8, 0);
+  last = m3u8_ring_nth (m3u8, m3u8->file_ring_len - 1);
 
-      l = l->prev;
-    }
-  }
+  if (m3u8->sequence < GST_M3U8_MEDIA_FILE (first->data)->sequence)
+    return forward ? first : NULL;
+  if (m3u8->sequence > GST_M3U8_MEDIA_FILE (last->data)->sequence)
+    return forward ? NULL : last;
 
-  return l;
+  return m3u8_lookup_file (m3u8, m3u8->sequence);
 }
 
 GstM3U8MediaFile *
@@ -958,6 +1207,36 @@ out:
   return file;
 }
 
+/* Returns the fragment @n positions after the current one in the playback
+ * direction, without advancing */
+GstM3U8MediaFile *
+gst_m3u8_peek_fragment (GstM3U8 * m3u8, gboolean forward, guint n)
+{
+  GstM3U8MediaFile *file = NULL;
+  GList *l;
+
+  g_return_val_if_fail (m3u8 != NULL, NULL);
+
+  GST_M3U8_LOCK (m3u8);
+
+  l = m3u8->current_file;
+  if (l == NULL)
+    l = m3u8_find_next_fragment (m3u8, forward);
+
+  if (l != NULL && n > 0) {
+    gint64 sequence = GST_M3U8_MEDIA_FILE (l->data)->sequence;
+
+    l = m3u8_lookup_file (m3u8, forward ? sequence + n : sequence - n);
+  }
+
+  if (l)
+    file = gst_m3u8_media_file_ref (l->data);
+
+  GST_M3U8_UNLOCK (m3u8);
+
+  return file;
+}
+
 gboolean
 gst_m3u8_has_next_fragment (GstM3U8 * m3u8, gboolean forward)
 {
@@ -990,7 +1269,6 @@ m3u8_alternate_advance (GstM3U8 * m3u8, gboolean forward)
 {
   gint targetnum = m3u8->sequence;
   GList *tmp;
-  GstM3U8MediaFile *mf;
 
   /* figure out the target seqnum */
   if (forward)
@@ -998,11 +1276,7 @@ m3u8_alternate_advance (GstM3U8 * m3u8, gboolean forward)
   else
     targetnum -= 1;
 
-  for (tmp = m3u8->files; tmp; tmp = tmp->next) {
-    mf = (GstM3U8MediaFile *) tmp->data;
-    if (mf->sequence == targetnum)
-      break;
-  }
+  tmp = m3u8_lookup_file (m3u8, targetnum);
   if (tmp == NULL) {
     GST_WARNING ("Can't find next fragment");
     return;
@@ -1036,15 +1310,8 @@ gst_m3u8_advance_fragment (GstM3U8 * m3u8, gboolean forward)
         GST_TIME_ARGS (m3u8->sequence_position));
   }
   if (!m3u8->current_file) {
-    GList *l;
-
     GST_DEBUG ("Looking for fragment %" G_GINT64_FORMAT, m3u8->sequence);
-    for (l = m3u8->files; l != NULL; l = l->next) {
-      if (GST_M3U8_MEDIA_FILE (l->data)->sequence == m3u8->sequence) {
-        m3u8->current_file = l;
-        break;
-      }
-    }
+    m3u8->current_file = m3u8_lookup_file (m3u8, m3u8->sequence);
     if (m3u8->current_file == NULL) {
       GST_DEBUG
           ("Could not find current fragment, trying next fragment directly");
@@ -1055,8 +1322,8 @@ gst_m3u8_advance_fragment (GstM3U8 * m3u8, gboolean forward)
         /* for live streams, start GST_M3U8_LIVE_MIN_FRAGMENT_DISTANCE from
            the end of the playlist. See section 6.3.3 of HLS draft */
         gint pos =
-            g_list_length (m3u8->files) - GST_M3U8_LIVE_MIN_FRAGMENT_DISTANCE;
-        m3u8->current_file = g_list_nth (m3u8->files, pos >= 0 ? pos : 0);
+            m3u8->file_ring_len - GST_M3U8_LIVE_MIN_FRAGMENT_DISTANCE;
+        m3u8->current_file = m3u8_ring_nth (m3u8, pos >= 0 ? pos : 0);
         m3u8->current_file_duration =
             GST_M3U8_MEDIA_FILE (m3u8->current_file->data)->duration;
 
@@ -1108,13 +1375,8 @@ gst_m3u8_get_duration (GstM3U8 * m3u8)
   if (!m3u8->endlist)
     goto out;
 
-  if (!GST_CLOCK_TIME_IS_VALID (m3u8->duration) && m3u8->files != NULL) {
-    GList *f;
-
-    m3u8->duration = 0;
-    for (f = m3u8->files; f != NULL; f = f->next)
-      m3u8->duration += GST_M3U8_MEDIA_FILE (f)->duration;
-  }
+  if (!GST_CLOCK_TIME_IS_VALID (m3u8->duration) && m3u8->files != NULL)
+    m3u8->duration = m3u8->files_duration;
   duration = m3u8->duration;
 
 out:
@@ -1224,10 +1486,8 @@ gboolean
 gst_m3u8_get_seek_range (GstM3U8 * m3u8, gint64 * start, gint64 * stop)
 {
   GstClockTime duration = 0;
-  GList *walk;
-  GstM3U8MediaFile *file;
-  guint count;
   guint min_distance = 0;
+  guint i;
 
   g_return_val_if_fail (m3u8 != NULL, FALSE);
 
@@ -1242,12 +1502,14 @@ gst_m3u8_get_seek_range (GstM3U8 * m3u8, gint64 * start, gint64 * stop)
        playlist - see 6.3.3. "Playing the Playlist file" of the HLS draft */
     min_distance = GST_M3U8_LIVE_MIN_FRAGMENT_DISTANCE;
   }
-  count = g_list_length (m3u8->files);
 
-  for (walk = m3u8->files; walk && count > min_distance; walk = walk->next) {
-    file = walk->data;
-    --count;
-    duration += file->duration;
+  if (m3u8->file_ring_len > min_distance) {
+    duration = m3u8->files_duration;
+    for (i = m3u8->file_ring_len - min_distance; i < m3u8->file_ring_len; i++) {
+      GstM3U8MediaFile *file = m3u8_ring_nth (m3u8, i)->data;
+
+      duration -= file->duration;
+    }
   }
 
   if (duration <= 0)
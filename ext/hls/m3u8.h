@@ -81,6 +81,14 @@ struct _GstM3U8
   gchar *last_data;
   GMutex lock;
 
+  /* Ring of the links of @files, indexed by sequence number relative to
+   * the first file. Sequence numbers in a playlist are contiguous. */
+  GList **file_ring;
+  guint file_ring_size;
+  guint file_ring_head;
+  guint file_ring_len;
+  GstClockTime files_duration;        /* sum of the durations of @files */
+
   gint ref_count;               /* ATOMIC */
 };
 
@@ -132,6 +140,10 @@ GstM3U8MediaFile * gst_m3u8_get_next_fragment    (GstM3U8      * m3u8,
 gboolean           gst_m3u8_has_next_fragment    (GstM3U8 * m3u8,
                                                   gboolean  forward);
 
+GstM3U8MediaFile * gst_m3u8_peek_fragment        (GstM3U8 * m3u8,
+                                                  gboolean  forward,
+                                                  guint     n);
+
 void               gst_m3u8_advance_fragment     (GstM3U8 * m3u8,
                                                   gboolean  forward);
 
@@ -33,9 +33,10 @@
  * For each reference frame, IQA will post a message containing
  * a structure named IQA.
  *
- * The only metric supported for now is "dssim", which will be available
- * if https://github.com/pornel/dssim was installed on the system
- * at the time that plugin was compiled.
+ * The "dssim" metric will be available if https://github.com/pornel/dssim
+ * was installed on the system at the time that plugin was compiled. The
+ * cheaper "psnr" and "ssim" metrics only produce scores, and don't draw the
+ * output frames.
  *
  * For each metric activated, this structure will contain another
  * structure, named after the metric.
@@ -61,6 +62,8 @@
 #include "config.h"
 #endif
 
+#include <math.h>
+
 #include "iqa.h"
 
 #ifdef HAVE_DSSIM
@@ -76,6 +79,7 @@ GST_DEBUG_CATEGORY_STATIC (gst_iqa_debug);
 
 #define SRC_FORMAT " { RGBA } "
 #define DEFAULT_DSSIM_ERROR_THRESHOLD -1.0
+#define DEFAULT_N_THREADS 0
 
 static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_SRC,
@@ -86,9 +90,12 @@ static GstStaticPadTemplate src_factory = GST_STATIC_PAD_TEMPLATE ("src",
 enum
 {
   PROP_0,
-  PROP_DO_SSIM,
+  PROP_DO_DSSIM,
   PROP_SSIM_ERROR_THRESHOLD,
   PROP_MODE,
+  PROP_DO_PSNR,
+  PROP_DO_SSIM,
+  PROP_N_THREADS,
   PROP_LAST,
 };
 
@@ -177,6 +184,48 @@ gst_iqa_mode_flags_get_type (void)
 G_DEFINE_TYPE_WITH_CODE (GstIqa, gst_iqa, GST_TYPE_VIDEO_AGGREGATOR,
     G_IMPLEMENT_INTERFACE (GST_TYPE_CHILD_PROXY, gst_iqa_child_proxy_init));
 
+/* Per compared pad state, kept across frames */
+typedef struct
+{
+  GstVideoFrame *cmp;
+  gchar *padname;
+
+#ifdef HAVE_DSSIM
+  dssim_attr *attr;
+  unsigned char **ref_rows;
+  unsigned char **cmp_rows;
+  gint n_rows;
+  dssim_ssim_map map;
+  gdouble dssim;
+#endif
+
+  guint64 sse;
+  gdouble ssim_sum;
+  guint64 n_ssim;
+} GstIqaStream;
+
+/* Either the DSSIM of a whole frame, or the PSNR and SSIM sums over a band
+ * of rows of it */
+typedef struct
+{
+  GstIqa *self;
+  GstVideoFrame *ref;
+  guint stream;
+  gboolean dssim;
+  gboolean psnr;
+  gboolean ssim;
+  gint y_start;
+  gint y_end;
+
+  /* 4x4 block sums of two rows of blocks, for SSIM */
+  gint32 *sums;
+  gint n_sums;
+
+  guint64 sse;
+  gdouble ssim_sum;
+  guint64 n_ssim;
+} GstIqaTask;
+
 #ifdef HAVE_DSSIM
 inline static unsigned char
 to_byte (float in)
@@ -188,146 +237,331 @@ to_byte (float in)
   return in * 256.f;
 }
 
-static gboolean
-do_dssim (GstIqa * self, GstVideoFrame * ref, GstVideoFrame * cmp,
-    GstBuffer * outbuf, GstStructure * msg_structure, gchar * padname)
+static void
+iqa_task_run_dssim (GstIqaTask * task)
 {
-  dssim_attr *attr;
-  gint y;
-  unsigned char **ptrs, **ptrs2;
-  GstMapInfo ref_info;
-  GstMapInfo cmp_info;
-  GstMapInfo out_info;
+  GstIqaStream *stream =
+      &g_array_index (task->self->streams, GstIqaStream, task->stream);
+  gint width = GST_VIDEO_FRAME_WIDTH (task->ref);
+  gint height = GST_VIDEO_FRAME_HEIGHT (task->ref);
+  guint8 *ref_data = GST_VIDEO_FRAME_PLANE_DATA (task->ref, 0);
+  guint8 *cmp_data = GST_VIDEO_FRAME_PLANE_DATA (stream->cmp, 0);
+  gint ref_stride = GST_VIDEO_FRAME_PLANE_STRIDE (task->ref, 0);
+  gint cmp_stride = GST_VIDEO_FRAME_PLANE_STRIDE (stream->cmp, 0);
   dssim_image *ref_image;
   dssim_image *cmp_image;
-  double dssim;
-  dssim_ssim_map map_meta;
-  float *map;
-  gint i;
-  dssim_rgba *out;
-  GstStructure *dssim_structure;
-  gboolean ret = TRUE;
+  gint y;
 
-  if (ref->info.width != cmp->info.width ||
-      ref->info.height != cmp->info.height) {
-    GST_OBJECT_UNLOCK (self);
+  if (!stream->attr) {
+    stream->attr = dssim_create_attr ();
+    dssim_set_save_ssim_maps (stream->attr, 1, 1);
+  }
 
-    GST_ELEMENT_ERROR (self, STREAM, FAILED,
-        ("Video streams do not have the same sizes (add videoscale"
-            " and force the sizes to be equal on all sink pads.)"),
-        ("Reference width %d - compared width: %d. "
-            "Reference height %d - compared height: %d",
-            ref->info.width, cmp->info.width, ref->info.height,
-            cmp->info.height));
+  if (stream->n_rows != height) {
+    stream->ref_rows = g_renew (unsigned char *, stream->ref_rows, height);
+    stream->cmp_rows = g_renew (unsigned char *, stream->cmp_rows, height);
+    stream->n_rows = height;
+  }
 
-    GST_OBJECT_LOCK (self);
-    return FALSE;
+  for (y = 0; y < height; y++) {
+    stream->ref_rows[y] = ref_data + ref_stride * y;
+    stream->cmp_rows[y] = cmp_data + cmp_stride * y;
   }
 
-  gst_structure_get (msg_structure, "dssim", GST_TYPE_STRUCTURE,
-      &dssim_structure, NULL);
+  ref_image =
+      dssim_create_image (stream->attr, stream->ref_rows, DSSIM_RGBA, width,
+      height, 0.45455);
+  cmp_image =
+      dssim_create_image (stream->attr, stream->cmp_rows, DSSIM_RGBA, width,
+      height, 0.45455);
 
-  attr = dssim_create_attr ();
-  dssim_set_save_ssim_maps (attr, 1, 1);
+  stream->dssim = dssim_compare (stream->attr, ref_image, cmp_image);
+  stream->map = dssim_pop_ssim_map (stream->attr, 0, 0);
 
-  gst_buffer_map (ref->buffer, &ref_info, GST_MAP_READ);
-  gst_buffer_map (cmp->buffer, &cmp_info, GST_MAP_READ);
-  gst_buffer_map (outbuf, &out_info, GST_MAP_WRITE);
-  out = (dssim_rgba *) out_info.data;
+  dssim_dealloc_image (ref_image);
+  dssim_dealloc_image (cmp_image);
+}
+#endif
 
-  ptrs = g_malloc (sizeof (char **) * ref->info.height);
+/* The kernels below are kept simple enough for the compiler to vectorize */
 
-  for (y = 0; y < ref->info.height; y++) {
-    ptrs[y] = ref_info.data + (ref->info.width * 4 * y);
+#define IQA_LUMA(p) ((77 * (p)[0] + 150 * (p)[1] + 29 * (p)[2] + 128) >> 8)
+
+static guint32
+iqa_sse_row (const guint8 * ref, const guint8 * cmp, gint width)
+{
+  guint32 sse = 0;
+  gint x;
+
+  /* fits up to 8K wide rows */
+  for (x = 0; x < width * 4; x += 4) {
+    gint32 dr = ref[x] - cmp[x];
+    gint32 dg = ref[x + 1] - cmp[x + 1];
+    gint32 db = ref[x + 2] - cmp[x + 2];
+
+    sse += dr * dr + dg * dg + db * db;
   }
 
-  ref_image =
-      dssim_create_image (attr, ptrs, DSSIM_RGBA, ref->info.width,
-      ref->info.height, 0.45455);
+  return sse;
+}
 
-  ptrs2 = g_malloc (sizeof (char **) * cmp->info.height);
+/* Sums of the luma of each 4x4 block of a row of blocks */
+static void
+iqa_ssim_block_row (const guint8 * ref, gint ref_stride, const guint8 * cmp,
+    gint cmp_stride, gint n_blocks, gint32 * sums)
+{
+  gint b, x, y;
+
+  for (b = 0; b < n_blocks; b++) {
+    gint32 s1 = 0, s2 = 0, ss = 0, s12 = 0;
+
+    for (y = 0; y < 4; y++) {
+      const guint8 *r = ref + ref_stride * y + b * 16;
+      const guint8 *c = cmp + cmp_stride * y + b * 16;
 
-  for (y = 0; y < cmp->info.height; y++) {
-    ptrs2[y] = cmp_info.data + (cmp->info.width * 4 * y);
+      for (x = 0; x < 16; x += 4) {
+        gint32 a = IQA_LUMA (r + x);
+        gint32 d = IQA_LUMA (c + x);
+
+        s1 += a;
+        s2 += d;
+        ss += a * a + d * d;
+        s12 += a * d;
+      }
+    }
+
+    sums[b * 4] = s1;
+    sums[b * 4 + 1] = s2;
+    sums[b * 4 + 2] = ss;
+    sums[b * 4 + 3] = s12;
   }
+}
 
-  cmp_image =
-      dssim_create_image (attr, ptrs2, DSSIM_RGBA, cmp->info.width,
-      cmp->info.height, 0.45455);
-  dssim = dssim_compare (attr, ref_image, cmp_image);
-
-  map_meta = dssim_pop_ssim_map (attr, 0, 0);
-
-  /* Comparing floats... should not be a big deal anyway */
-  if (self->ssim_threshold > 0 && dssim > self->ssim_threshold) {
-    /* We do not really care about our state... we are going to error ou
-     * anyway! */
-    GST_OBJECT_UNLOCK (self);
-
-    GST_ELEMENT_ERROR (self, STREAM, FAILED,
-        ("Dssim check failed on %s at %"
-            GST_TIME_FORMAT " with dssim %f > %f",
-            padname,
-            GST_TIME_ARGS (GST_AGGREGATOR_PAD (GST_AGGREGATOR (self)->
-                    srcpad)->segment.position), dssim, self->ssim_threshold),
-        (NULL));
-
-    GST_OBJECT_LOCK (self);
-
-    ret = FALSE;
-    goto cleanup_return;
+/* SSIM of an 8x8 window from its sums, as in x264 */
+static gdouble
+iqa_ssim_window (gint32 s1, gint32 s2, gint32 ss, gint32 s12)
+{
+  const gdouble c1 = .01 * .01 * 255 * 255 * 64;
+  const gdouble c2 = .03 * .03 * 255 * 255 * 64 * 63;
+  gdouble vars = (gdouble) ss * 64 - (gdouble) s1 * s1 - (gdouble) s2 * s2;
+  gdouble covar = (gdouble) s12 * 64 - (gdouble) s1 * s2;
+
+  return (2.0 * s1 * s2 + c1) * (2.0 * covar + c2) /
+      (((gdouble) s1 * s1 + (gdouble) s2 * s2 + c1) * (vars + c2));
+}
+
+static void
+iqa_task_run_band (GstIqaTask * task)
+{
+  GstIqaStream *stream =
+      &g_array_index (task->self->streams, GstIqaStream, task->stream);
+  gint width = GST_VIDEO_FRAME_WIDTH (task->ref);
+  gint height = GST_VIDEO_FRAME_HEIGHT (task->ref);
+  const guint8 *ref_data = GST_VIDEO_FRAME_PLANE_DATA (task->ref, 0);
+  const guint8 *cmp_data = GST_VIDEO_FRAME_PLANE_DATA (stream->cmp, 0);
+  gint ref_stride = GST_VIDEO_FRAME_PLANE_STRIDE (task->ref, 0);
+  gint cmp_stride = GST_VIDEO_FRAME_PLANE_STRIDE (stream->cmp, 0);
+  gint y;
+
+  task->sse = 0;
+  task->ssim_sum = 0.0;
+  task->n_ssim = 0;
+
+  if (task->psnr) {
+    for (y = task->y_start; y < task->y_end; y++)
+      task->sse += iqa_sse_row (ref_data + ref_stride * y,
+          cmp_data + cmp_stride * y, width);
   }
 
-  if (dssim > self->max_dssim) {
-    map = map_meta.data;
+  /* 8x8 windows every 4 pixels, the band owning those starting in it */
+  if (task->ssim && width >= 8 && height >= 8) {
+    gint n_blocks = width / 4;
+    gint first = task->y_start / 4;
+    gint last = MIN ((task->y_end + 3) / 4, (height - 8) / 4 + 1);
+    gint32 *prev, *cur, *tmp;
+    gint b;
+
+    if (task->n_sums < n_blocks * 8) {
+      task->sums = g_renew (gint32, task->sums, n_blocks * 8);
+      task->n_sums = n_blocks * 8;
+    }
+    prev = task->sums;
+    cur = task->sums + n_blocks * 4;
 
-    for (i = 0; i < map_meta.width * map_meta.height; i++) {
-      const float max = 1.0 - map[i];
-      const float maxsq = max * max;
-      out[i] = (dssim_rgba) {
-      .r = to_byte (max * 3.0),.g = to_byte (maxsq * 6.0),.b =
-            to_byte (max / ((1.0 - map_meta.dssim) * 4.0)),.a = 255,};
+    if (first < last)
+      iqa_ssim_block_row (ref_data + ref_stride * first * 4, ref_stride,
+          cmp_data + cmp_stride * first * 4, cmp_stride, n_blocks, prev);
+
+    for (y = first; y < last; y++) {
+      iqa_ssim_block_row (ref_data + ref_stride * (y + 1) * 4, ref_stride,
+          cmp_data + cmp_stride * (y + 1) * 4, cmp_stride, n_blocks, cur);
+
+      for (b = 0; b + 1 < n_blocks; b++) {
+        const gint32 *p = prev + b * 4;
+        const gint32 *c = cur + b * 4;
+
+        task->ssim_sum += iqa_ssim_window (p[0] + p[4] + c[0] + c[4],
+            p[1] + p[5] + c[1] + c[5], p[2] + p[6] + c[2] + c[6],
+            p[3] + p[7] + c[3] + c[7]);
+      }
+      task->n_ssim += n_blocks - 1;
+
+      tmp = prev;
+      prev = cur;
+      cur = tmp;
     }
-    self->max_dssim = dssim;
   }
+}
 
-  gst_structure_set (dssim_structure, padname, G_TYPE_DOUBLE, dssim, NULL);
-  gst_structure_set (msg_structure, "dssim", GST_TYPE_STRUCTURE,
-      dssim_structure, NULL);
+static void
+gst_iqa_task_run (GstIqaTask * task)
+{
+#ifdef HAVE_DSSIM
+  if (task->dssim) {
+    iqa_task_run_dssim (task);
+    return;
+  }
+#endif
 
-  ret = TRUE;
+  iqa_task_run_band (task);
+}
 
-cleanup_return:
+static void
+gst_iqa_task_func (gpointer data, gpointer user_data)
+{
+  GstIqa *self = user_data;
 
-  gst_structure_free (dssim_structure);
+  gst_iqa_task_run (data);
 
-  free (map_meta.data);
-  g_free (ptrs);
-  g_free (ptrs2);
-  gst_buffer_unmap (ref->buffer, &ref_info);
-  gst_buffer_unmap (cmp->buffer, &cmp_info);
-  gst_buffer_unmap (outbuf, &out_info);
-  dssim_dealloc_image (ref_image);
-  dssim_dealloc_image (cmp_image);
-  dssim_dealloc_attr (attr);
+  g_mutex_lock (&self->tasks_lock);
+  self->tasks_pending--;
+  if (self->tasks_pending == 0)
+    g_cond_signal (&self->tasks_cond);
+  g_mutex_unlock (&self->tasks_lock);
+}
 
-  return ret;
+static GstIqaTask *
+gst_iqa_add_task (GstIqa * self, guint * n_tasks, GstVideoFrame * ref,
+    guint stream)
+{
+  GstIqaTask *task;
+
+  /* tasks are kept around with their buffers, only reset what changes */
+  if (*n_tasks == self->tasks->len)
+    g_array_set_size (self->tasks, *n_tasks + 1);
+  task = &g_array_index (self->tasks, GstIqaTask, *n_tasks);
+  (*n_tasks)++;
+
+  task->self = self;
+  task->ref = ref;
+  task->stream = stream;
+  task->dssim = FALSE;
+  task->psnr = FALSE;
+  task->ssim = FALSE;
+
+  return task;
 }
-#endif
 
-static gboolean
-compare_frames (GstIqa * self, GstVideoFrame * ref, GstVideoFrame * cmp,
-    GstBuffer * outbuf, GstStructure * msg_structure, gchar * padname)
+static void
+gst_iqa_run_tasks (GstIqa * self, guint n_tasks, guint n_threads)
 {
+  guint i;
+
+  if (n_threads <= 1 || n_tasks <= 1) {
+    for (i = 0; i < n_tasks; i++)
+      gst_iqa_task_run (&g_array_index (self->tasks, GstIqaTask, i));
+    return;
+  }
+
+  if (!self->pool)
+    self->pool = g_thread_pool_new (gst_iqa_task_func, self, n_threads,
+        FALSE, NULL);
+  else
+    g_thread_pool_set_max_threads (self->pool, n_threads, NULL);
+
+  self->tasks_pending = n_tasks;
+  for (i = 0; i < n_tasks; i++)
+    g_thread_pool_push (self->pool, &g_array_index (self->tasks, GstIqaTask,
+            i), NULL);
+
+  g_mutex_lock (&self->tasks_lock);
+  while (self->tasks_pending > 0)
+    g_cond_wait (&self->tasks_cond, &self->tasks_lock);
+  g_mutex_unlock (&self->tasks_lock);
+}
+
 #ifdef HAVE_DSSIM
-  if (self->do_dssim) {
-    if (!do_dssim (self, ref, cmp, outbuf, msg_structure, padname))
-      return FALSE;
+static gboolean
+collect_dssim (GstIqa * self, guint n_streams, gdouble ssim_threshold,
+    GstBuffer * outbuf, GstStructure * msg_structure)
+{
+  GstStructure *dssim_structure = gst_structure_new_empty ("dssim");
+  GstIqaStream *max_stream = NULL;
+  gboolean ret = TRUE;
+  guint i;
+
+  self->max_dssim = 0.0;
+
+  for (i = 0; i < n_streams; i++) {
+    GstIqaStream *stream = &g_array_index (self->streams, GstIqaStream, i);
+
+    /* Comparing floats... should not be a big deal anyway */
+    if (ret && ssim_threshold > 0 && stream->dssim > ssim_threshold) {
+      GST_ELEMENT_ERROR (self, STREAM, FAILED,
+          ("Dssim check failed on %s at %"
+              GST_TIME_FORMAT " with dssim %f > %f",
+              stream->padname,
+              GST_TIME_ARGS (GST_AGGREGATOR_PAD (GST_AGGREGATOR (self)->
+                      srcpad)->segment.position), stream->dssim,
+              ssim_threshold), (NULL));
+      ret = FALSE;
+    }
+
+    if (stream->dssim > self->max_dssim) {
+      self->max_dssim = stream->dssim;
+      max_stream = stream;
+    }
+
+    gst_structure_set (dssim_structure, stream->padname, G_TYPE_DOUBLE,
+        stream->dssim, NULL);
   }
-#endif
 
-  return TRUE;
+  /* The output is the heat map of the most different stream */
+  if (ret && max_stream) {
+    dssim_ssim_map *map_meta = &max_stream->map;
+    float *map = map_meta->data;
+    GstMapInfo out_info;
+    dssim_rgba *out;
+    gint j;
+
+    gst_buffer_map (outbuf, &out_info, GST_MAP_WRITE);
+    out = (dssim_rgba *) out_info.data;
+
+    for (j = 0; j < map_meta->width * map_meta->height; j++) {
+      const float max = 1.0 - map[j];
+      const float maxsq = max * max;
+      out[j] = (dssim_rgba) {
+      .r = to_byte (max * 3.0),.g = to_byte (maxsq * 6.0),.b =
+            to_byte (max / ((1.0 - map_meta->dssim) * 4.0)),.a = 255,};
+    }
+
+    gst_buffer_unmap (outbuf, &out_info);
+  }
+
+  for (i = 0; i < n_streams; i++) {
+    GstIqaStream *stream = &g_array_index (self->streams, GstIqaStream, i);
+
+    free (stream->map.data);
+    stream->map.data = NULL;
+  }
+
+  gst_structure_set (msg_structure, "dssim", GST_TYPE_STRUCTURE,
+      dssim_structure, NULL);
+  gst_structure_free (dssim_structure);
+
+  return ret;
 }
+#endif
 
 static GstFlowReturn
 gst_iqa_aggregate_frames (GstVideoAggregator * vagg, GstBuffer * outbuf)
@@ -338,14 +572,22 @@ gst_iqa_aggregate_frames (GstVideoAggregator * vagg, GstBuffer * outbuf)
   GstStructure *msg_structure = gst_structure_new_empty ("IQA");
   GstMessage *m = gst_message_new_element (GST_OBJECT (self), msg_structure);
   GstAggregator *agg = GST_AGGREGATOR (vagg);
-
-  if (self->do_dssim) {
-    gst_structure_set (msg_structure, "dssim", GST_TYPE_STRUCTURE,
-        gst_structure_new_empty ("dssim"), NULL);
-    self->max_dssim = 0.0;
-  }
+  gboolean do_dssim, do_psnr, do_ssim;
+#ifdef HAVE_DSSIM
+  gdouble ssim_threshold;
+#endif
+  guint n_threads, n_streams = 0, n_tasks = 0;
+  guint i;
 
   GST_OBJECT_LOCK (vagg);
+  do_dssim = self->do_dssim;
+  do_psnr = self->do_psnr;
+  do_ssim = self->do_ssim;
+#ifdef HAVE_DSSIM
+  ssim_threshold = self->ssim_threshold;
+#endif
+  n_threads = self->n_threads ? self->n_threads : g_get_num_processors ();
+
   for (l = GST_ELEMENT (vagg)->sinkpads; l; l = l->next) {
     GstVideoAggregatorPad *pad = l->data;
     GstVideoFrame *prepared_frame =
@@ -355,16 +597,33 @@ gst_iqa_aggregate_frames (GstVideoAggregator * vagg, GstBuffer * outbuf)
       if (!ref_frame) {
         ref_frame = prepared_frame;
       } else {
-        gboolean res;
-        gchar *padname = gst_pad_get_name (pad);
         GstVideoFrame *cmp_frame = prepared_frame;
+        GstIqaStream *stream;
+
+        if ((do_dssim || do_psnr || do_ssim) &&
+            (ref_frame->info.width != cmp_frame->info.width ||
+                ref_frame->info.height != cmp_frame->info.height)) {
+          GST_OBJECT_UNLOCK (vagg);
 
-        res = compare_frames (self, ref_frame, cmp_frame, outbuf, msg_structure,
-            padname);
-        g_free (padname);
+          GST_ELEMENT_ERROR (self, STREAM, FAILED,
+              ("Video streams do not have the same sizes (add videoscale"
+                  " and force the sizes to be equal on all sink pads.)"),
+              ("Reference width %d - compared width: %d. "
+                  "Reference height %d - compared height: %d",
+                  ref_frame->info.width, cmp_frame->info.width,
+                  ref_frame->info.height, cmp_frame->info.height));
 
-        if (!res)
           goto failed;
+        }
+
+        if (n_streams == self->streams->len)
+          g_array_set_size (self->streams, n_streams + 1);
+        stream = &g_array_index (self->streams, GstIqaStream, n_streams);
+        n_streams++;
+
+        stream->cmp = cmp_frame;
+        g_free (stream->padname);
+        stream->padname = gst_pad_get_name (pad);
       }
     } else if ((self->mode & GST_IQA_MODE_STRICT) && ref_frame) {
       GST_OBJECT_UNLOCK (vagg);
@@ -381,6 +640,90 @@ gst_iqa_aggregate_frames (GstVideoAggregator * vagg, GstBuffer * outbuf)
 
   GST_OBJECT_UNLOCK (vagg);
 
+  /* DSSIM works on whole frames, one task per compared stream, while PSNR
+   * and SSIM are split in bands of rows */
+  for (i = 0; i < n_streams && do_dssim; i++) {
+    GstIqaTask *task = gst_iqa_add_task (self, &n_tasks, ref_frame, i);
+
+    task->dssim = TRUE;
+  }
+
+  if (n_streams > 0 && (do_psnr || do_ssim)) {
+    gint height = GST_VIDEO_FRAME_HEIGHT (ref_frame);
+    guint n_bands = CLAMP (height / 64, 1, n_threads);
+    gint band_height = GST_ROUND_UP_4 ((height + n_bands - 1) / n_bands);
+
+    for (i = 0; i < n_streams * n_bands; i++) {
+      gint y_start = (i % n_bands) * band_height;
+      GstIqaTask *task;
+
+      if (y_start >= height)
+        continue;
+
+      task = gst_iqa_add_task (self, &n_tasks, ref_frame, i / n_bands);
+      task->psnr = do_psnr;
+      task->ssim = do_ssim;
+      task->y_start = y_start;
+      task->y_end = MIN (y_start + band_height, height);
+    }
+  }
+
+  gst_iqa_run_tasks (self, n_tasks, n_threads);
+
+#ifdef HAVE_DSSIM
+  if (do_dssim &&
+      !collect_dssim (self, n_streams, ssim_threshold, outbuf, msg_structure))
+    goto failed;
+#endif
+
+  if (do_psnr || do_ssim) {
+    GstStructure *psnr_structure = gst_structure_new_empty ("psnr");
+    GstStructure *ssim_structure = gst_structure_new_empty ("ssim");
+
+    for (i = 0; i < n_streams; i++) {
+      GstIqaStream *stream = &g_array_index (self->streams, GstIqaStream, i);
+
+      stream->sse = 0;
+      stream->ssim_sum = 0.0;
+      stream->n_ssim = 0;
+    }
+
+    for (i = 0; i < n_tasks; i++) {
+      GstIqaTask *task = &g_array_index (self->tasks, GstIqaTask, i);
+      GstIqaStream *stream =
+          &g_array_index (self->streams, GstIqaStream, task->stream);
+
+      if (task->dssim)
+        continue;
+
+      stream->sse += task->sse;
+      stream->ssim_sum += task->ssim_sum;
+      stream->n_ssim += task->n_ssim;
+    }
+
+    for (i = 0; i < n_streams; i++) {
+      GstIqaStream *stream = &g_array_index (self->streams, GstIqaStream, i);
+      gdouble n_samples = 3.0 * GST_VIDEO_FRAME_WIDTH (ref_frame) *
+          GST_VIDEO_FRAME_HEIGHT (ref_frame);
+
+      gst_structure_set (psnr_structure, stream->padname, G_TYPE_DOUBLE,
+          stream->sse ? 10.0 * log10 (255.0 * 255.0 * n_samples /
+              stream->sse) : INFINITY, NULL);
+      gst_structure_set (ssim_structure, stream->padname, G_TYPE_DOUBLE,
+          stream->n_ssim ? stream->ssim_sum / stream->n_ssim : 1.0, NULL);
+    }
+
+    if (do_psnr)
+      gst_structure_set (msg_structure, "psnr", GST_TYPE_STRUCTURE,
+          psnr_structure, NULL);
+    if (do_ssim)
+      gst_structure_set (msg_structure, "ssim", GST_TYPE_STRUCTURE,
+          ssim_structure, NULL);
+
+    gst_structure_free (psnr_structure);
+    gst_structure_free (ssim_structure);
+  }
+
   /* We only post the message here, because we can't post it while the object
    * is locked.
    */
@@ -390,7 +733,7 @@ gst_iqa_aggregate_frames (GstVideoAggregator * vagg, GstBuffer * outbuf)
   return GST_FLOW_OK;
 
 failed:
-  GST_OBJECT_UNLOCK (vagg);
+  gst_message_unref (m);
 
   return GST_FLOW_ERROR;
 }
@@ -402,7 +745,7 @@ _set_property (GObject * object, guint prop_id, const GValue * value,
   GstIqa *self = GST_IQA (object);
 
   switch (prop_id) {
-    case PROP_DO_SSIM:
+    case PROP_DO_DSSIM:
       GST_OBJECT_LOCK (self);
       self->do_dssim = g_value_get_boolean (value);
       GST_OBJECT_UNLOCK (self);
@@ -417,6 +760,21 @@ _set_property (GObject * object, guint prop_id, const GValue * value,
       self->mode = g_value_get_flags (value);
       GST_OBJECT_UNLOCK (self);
       break;
+    case PROP_DO_PSNR:
+      GST_OBJECT_LOCK (self);
+      self->do_psnr = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_DO_SSIM:
+      GST_OBJECT_LOCK (self);
+      self->do_ssim = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (self);
+      self->n_threads = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -430,7 +788,7 @@ _get_property (GObject * object,
   GstIqa *self = GST_IQA (object);
 
   switch (prop_id) {
-    case PROP_DO_SSIM:
+    case PROP_DO_DSSIM:
       GST_OBJECT_LOCK (self);
       g_value_set_boolean (value, self->do_dssim);
       GST_OBJECT_UNLOCK (self);
@@ -445,12 +803,59 @@ _get_property (GObject * object,
       g_value_set_flags (value, self->mode);
       GST_OBJECT_UNLOCK (self);
       break;
+    case PROP_DO_PSNR:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, self->do_psnr);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_DO_SSIM:
+      GST_OBJECT_LOCK (self);
+      g_value_set_boolean (value, self->do_ssim);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->n_threads);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static void
+gst_iqa_finalize (GObject * object)
+{
+  GstIqa *self = GST_IQA (object);
+  guint i;
+
+  if (self->pool)
+    g_thread_pool_free (self->pool, FALSE, TRUE);
+
+  for (i = 0; i < self->streams->len; i++) {
+    GstIqaStream *stream = &g_array_index (self->streams, GstIqaStream, i);
+
+    g_free (stream->padname);
+#ifdef HAVE_DSSIM
+    if (stream->attr)
+      dssim_dealloc_attr (stream->attr);
+    g_free (stream->ref_rows);
+    g_free (stream->cmp_rows);
+#endif
+  }
+  g_array_free (self->streams, TRUE);
+
+  for (i = 0; i < self->tasks->len; i++)
+    g_free (g_array_index (self->tasks, GstIqaTask, i).sums);
+  g_array_free (self->tasks, TRUE);
+
+  g_mutex_clear (&self->tasks_lock);
+  g_cond_clear (&self->tasks_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 /* GObject boilerplate */
 static void
 gst_iqa_class_init (GstIqaClass * klass)
@@ -469,9 +874,10 @@ gst_iqa_class_init (GstIqaClass * klass)
 
   gobject_class->set_property = _set_property;
   gobject_class->get_property = _get_property;
+  gobject_class->finalize = gst_iqa_finalize;
 
 #ifdef HAVE_DSSIM
-  g_object_class_install_property (gobject_class, PROP_DO_SSIM,
+  g_object_class_install_property (gobject_class, PROP_DO_DSSIM,
       g_param_spec_boolean ("do-dssim", "do-dssim",
           "Run structural similarity checks", FALSE, G_PARAM_READWRITE));
 
@@ -494,6 +900,48 @@ gst_iqa_class_init (GstIqaClass * klass)
           "Controls the frame comparison mode.", GST_TYPE_IQA_MODE,
           0, G_PARAM_READWRITE));
 
+  /**
+   * iqa:do-psnr:
+   *
+   * Compute the PSNR of the RGB components of each compared stream. This is
+   * much cheaper than DSSIM, and available even when the plugin was built
+   * without the dssim library.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_DO_PSNR,
+      g_param_spec_boolean ("do-psnr", "do-psnr",
+          "Compute the peak signal-to-noise ratio", FALSE, G_PARAM_READWRITE));
+
+  /**
+   * iqa:do-ssim:
+   *
+   * Compute the mean SSIM of the luma of each compared stream, over 8x8
+   * windows. Unlike DSSIM, no similarity map is produced, so the output
+   * frames are not drawn. Like #iqa:do-psnr, it does not need the dssim
+   * library.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_DO_SSIM,
+      g_param_spec_boolean ("do-ssim", "do-ssim",
+          "Compute the mean structural similarity of the luma", FALSE,
+          G_PARAM_READWRITE));
+
+  /**
+   * iqa:n-threads:
+   *
+   * Maximum number of threads used to compare the streams. Each compared
+   * stream is scored in parallel, and PSNR and SSIM also split the frames
+   * in bands of rows.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Maximum number of threads to use, 0 for the number of processors",
+          0, G_MAXINT, DEFAULT_N_THREADS, G_PARAM_READWRITE));
+
   gst_type_mark_as_plugin_api (GST_TYPE_IQA_MODE, 0);
 
   gst_element_class_set_static_metadata (gstelement_class, "Iqa",
@@ -505,6 +953,11 @@ gst_iqa_class_init (GstIqaClass * klass)
 static void
 gst_iqa_init (GstIqa * self)
 {
+  self->n_threads = DEFAULT_N_THREADS;
+  self->streams = g_array_new (FALSE, TRUE, sizeof (GstIqaStream));
+  self->tasks = g_array_new (FALSE, TRUE, sizeof (GstIqaTask));
+  g_mutex_init (&self->tasks_lock);
+  g_cond_init (&self->tasks_cond);
 }
 
 static gboolean
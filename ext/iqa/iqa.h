@@ -49,9 +49,22 @@ struct _GstIqa
   GstVideoAggregator videoaggregator;
 
   gboolean do_dssim;
+  gboolean do_psnr;
+  gboolean do_ssim;
   gdouble ssim_threshold;
   gdouble max_dssim;
   gint mode;
+  guint n_threads;
+
+  /* GstIqaStream, one per compared pad, kept across frames */
+  GArray *streams;
+  /* GstIqaTask, the work of the current frame */
+  GArray *tasks;
+
+  GThreadPool *pool;
+  GMutex tasks_lock;
+  GCond tasks_cond;
+  guint tasks_pending;
 };
 
 struct _GstIqaClass
@@ -74,17 +74,50 @@ enum
   PROP_LAST
 };
 
+G_STATIC_ASSERT (PROP_LAST <= GST_SRT_OBJECT_PROP_LAST);
+
+typedef struct
+{
+  GstBuffer *buffer;
+  gsize offset;
+  gboolean header;
+} SRTQueueItem;
+
 typedef struct
 {
   SRTSOCKET sock;
   gint poll_id;
   GSocketAddress *sockaddr;
   gboolean sent_headers;
+
+  /* send queue of SRTQueueItem, only used with caller-queue-size > 0 */
+  GQueue queue;
+  guint queued_buffers;
+  guint64 dropped_buffers;
+  guint64 dropped_bytes;
 } SRTCaller;
 
 static GstStructure *gst_srt_object_accumulate_stats (GstSRTObject * srtobject,
     SRTSOCKET srtsock);
 
+static SRTQueueItem *
+srt_queue_item_new (GstBuffer * buffer, gboolean header)
+{
+  SRTQueueItem *item = g_slice_new (SRTQueueItem);
+  item->buffer = gst_buffer_ref (buffer);
+  item->offset = 0;
+  item->header = header;
+
+  return item;
+}
+
+static void
+srt_queue_item_free (SRTQueueItem * item)
+{
+  gst_buffer_unref (item->buffer);
+  g_slice_free (SRTQueueItem, item);
+}
+
 static SRTCaller *
 srt_caller_new (void)
 {
@@ -92,6 +125,7 @@ srt_caller_new (void)
   caller->sock = SRT_INVALID_SOCK;
   caller->poll_id = SRT_ERROR;
   caller->sent_headers = FALSE;
+  g_queue_init (&caller->queue);
 
   return caller;
 }
@@ -111,6 +145,9 @@ srt_caller_free (SRTCaller * caller)
     srt_epoll_release (caller->poll_id);
   }
 
+  while (!g_queue_is_empty (&caller->queue))
+    srt_queue_item_free (g_queue_pop_head (&caller->queue));
+
   g_free (caller);
 }
 
@@ -130,6 +167,22 @@ srt_caller_signal_removed (SRTCaller * caller, GstSRTObject * srtobject)
       caller->sockaddr);
 }
 
+/* called with sock_lock */
+static void
+srt_caller_remove (SRTCaller * caller, GstSRTObject * srtobject)
+{
+  srtobject->callers = g_list_remove (srtobject->callers, caller);
+
+  if (srtobject->sender_poll_id != SRT_ERROR) {
+    srt_epoll_remove_usock (srtobject->sender_poll_id, caller->sock);
+    if (!g_queue_is_empty (&caller->queue))
+      srtobject->pending_callers--;
+  }
+
+  srt_caller_signal_removed (caller, srtobject);
+  srt_caller_free (caller);
+}
+
 struct srt_constant_params
 {
   const gchar *name;
@@ -366,8 +419,12 @@ gst_srt_object_new (GstElement * element)
   srtobject->listener_poll_id = SRT_ERROR;
   srtobject->sent_headers = FALSE;
   srtobject->wait_for_connection = GST_SRT_DEFAULT_WAIT_FOR_CONNECTION;
+  srtobject->caller_queue_size = GST_SRT_DEFAULT_CALLER_QUEUE_SIZE;
+  srtobject->caller_drop_policy = GST_SRT_DEFAULT_CALLER_DROP_POLICY;
+  srtobject->sender_poll_id = SRT_ERROR;
 
   g_cond_init (&srtobject->sock_cond);
+  g_cond_init (&srtobject->sender_cond);
   return srtobject;
 }
 
@@ -382,6 +439,7 @@ gst_srt_object_destroy (GstSRTObject * srtobject)
   }
 
   g_cond_clear (&srtobject->sock_cond);
+  g_cond_clear (&srtobject->sender_cond);
 
   GST_DEBUG_OBJECT (srtobject->element, "Destroying srtobject");
   gst_structure_free (srtobject->parameters);
@@ -986,6 +1044,13 @@ thread_func (gpointer data)
 
       g_mutex_lock (&srtobject->sock_lock);
       srtobject->callers = g_list_append (srtobject->callers, caller);
+      if (srtobject->sender_poll_id != SRT_ERROR) {
+        /* only watch for errors until there is something to send */
+        gint sender_flag = SRT_EPOLL_ERR;
+
+        srt_epoll_add_usock (srtobject->sender_poll_id, caller_sock,
+            &sender_flag);
+      }
       g_cond_signal (&srtobject->sock_cond);
       g_mutex_unlock (&srtobject->sock_lock);
 
@@ -1056,6 +1121,206 @@ reject:
   return -1;
 }
 
+/* called with sock_lock */
+static void
+srt_caller_set_pending (GstSRTObject * srtobject, SRTCaller * caller,
+    gboolean pending)
+{
+  gint flag = SRT_EPOLL_ERR;
+
+  if (pending) {
+    flag |= SRT_EPOLL_OUT;
+    if (srtobject->pending_callers++ == 0)
+      g_cond_signal (&srtobject->sender_cond);
+  } else {
+    srtobject->pending_callers--;
+  }
+
+  srt_epoll_update_usock (srtobject->sender_poll_id, caller->sock, &flag);
+}
+
+/* Sends as much of the queue as the socket takes without blocking.
+ * Returns FALSE if the caller has to be dropped. Called with sock_lock */
+static gboolean
+srt_caller_send_queue (GstSRTObject * srtobject, SRTCaller * caller)
+{
+  SRTQueueItem *item;
+  gint payload_size, optlen = sizeof (payload_size);
+
+  if (srt_getsockflag (caller->sock, SRTO_PAYLOADSIZE, &payload_size,
+          &optlen)) {
+    GST_WARNING_OBJECT (srtobject->element, "%s", srt_getlasterror_str ());
+    return FALSE;
+  }
+
+  while ((item = g_queue_peek_head (&caller->queue)) != NULL) {
+    GstMapInfo mapinfo;
+
+    if (!gst_buffer_map (item->buffer, &mapinfo, GST_MAP_READ)) {
+      GST_WARNING_OBJECT (srtobject->element, "Could not map buffer %"
+          GST_PTR_FORMAT, item->buffer);
+      goto next;
+    }
+
+    while (item->offset < mapinfo.size) {
+      gint rest = MIN (mapinfo.size - item->offset, payload_size);
+      gint sent;
+
+      sent = srt_sendmsg2 (caller->sock, (char *) (mapinfo.data + item->offset),
+          rest, 0);
+      if (sent < 0) {
+        gst_buffer_unmap (item->buffer, &mapinfo);
+
+        /* The send buffer is full, wait for the socket to be writable */
+        if (srt_getlasterror (NULL) == SRT_EASYNCSND)
+          return TRUE;
+
+        GST_WARNING_OBJECT (srtobject->element, "Dropping caller %d: %s",
+            caller->sock, srt_getlasterror_str ());
+        return FALSE;
+      }
+      item->offset += sent;
+    }
+
+    gst_buffer_unmap (item->buffer, &mapinfo);
+
+  next:
+    g_queue_pop_head (&caller->queue);
+    if (!item->header)
+      caller->queued_buffers--;
+    srt_queue_item_free (item);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+srt_socket_in (SRTSOCKET sock, const SRTSOCKET * socks, gint n_socks)
+{
+  gint i;
+
+  for (i = 0; i < n_socks; i++) {
+    if (socks[i] == sock)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+#define SENDER_POLL_TIMEOUT 100
+#define SENDER_MAX_SOCKETS 256
+
+/* Drains the queues of all callers: only the callers with something queued
+ * are watched for being writable, and each writable one is sent as much as
+ * it takes before moving to the next one */
+static gpointer
+sender_thread_func (gpointer data)
+{
+  GstSRTObject *srtobject = data;
+  SRTSOCKET rsocks[SENDER_MAX_SOCKETS];
+  SRTSOCKET wsocks[SENDER_MAX_SOCKETS];
+
+  g_mutex_lock (&srtobject->sock_lock);
+  while (srtobject->sender_running) {
+    gint rsocklen = SENDER_MAX_SOCKETS;
+    gint wsocklen = SENDER_MAX_SOCKETS;
+    GList *callers;
+    gint ret;
+
+    if (srtobject->pending_callers == 0) {
+      g_cond_wait (&srtobject->sender_cond, &srtobject->sock_lock);
+      continue;
+    }
+
+    g_mutex_unlock (&srtobject->sock_lock);
+    ret = srt_epoll_wait (srtobject->sender_poll_id, rsocks, &rsocklen,
+        wsocks, &wsocklen, SENDER_POLL_TIMEOUT, NULL, 0, NULL, 0);
+    g_mutex_lock (&srtobject->sock_lock);
+
+    if (ret < 0) {
+      if (srt_getlasterror (NULL) != SRT_ETIMEOUT) {
+        GST_DEBUG_OBJECT (srtobject->element, "Polling callers failed: %s",
+            srt_getlasterror_str ());
+        g_cond_wait_until (&srtobject->sender_cond, &srtobject->sock_lock,
+            g_get_monotonic_time () + SENDER_POLL_TIMEOUT * 1000);
+      }
+      continue;
+    }
+
+    callers = srtobject->callers;
+    while (callers != NULL) {
+      SRTCaller *caller = callers->data;
+      gboolean pending = !g_queue_is_empty (&caller->queue);
+      gboolean failed;
+
+      callers = callers->next;
+
+      /* We never ask for SRT_EPOLL_IN, so being readable means an error */
+      failed = srt_socket_in (caller->sock, rsocks, rsocklen);
+      if (!failed && pending &&
+          srt_socket_in (caller->sock, wsocks, wsocklen)) {
+        failed = !srt_caller_send_queue (srtobject, caller);
+        if (!failed && g_queue_is_empty (&caller->queue))
+          srt_caller_set_pending (srtobject, caller, FALSE);
+      }
+
+      if (failed)
+        srt_caller_remove (caller, srtobject);
+    }
+  }
+  g_mutex_unlock (&srtobject->sock_lock);
+
+  return NULL;
+}
+
+static gboolean
+gst_srt_object_start_sender (GstSRTObject * srtobject, GError ** error)
+{
+  srtobject->sender_poll_id = srt_epoll_create ();
+  if (srtobject->sender_poll_id == SRT_ERROR) {
+    g_set_error (error, GST_LIBRARY_ERROR, GST_LIBRARY_ERROR_INIT, "%s",
+        srt_getlasterror_str ());
+    return FALSE;
+  }
+
+  srtobject->pending_callers = 0;
+  srtobject->sender_running = TRUE;
+  srtobject->sender_thread =
+      g_thread_try_new ("GstSRTObjectSender", sender_thread_func, srtobject,
+      error);
+  if (srtobject->sender_thread == NULL) {
+    GST_ERROR_OBJECT (srtobject->element, "Failed to start sender thread");
+    srtobject->sender_running = FALSE;
+    srt_epoll_release (srtobject->sender_poll_id);
+    srtobject->sender_poll_id = SRT_ERROR;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* called with sock_lock */
+static void
+gst_srt_object_stop_sender (GstSRTObject * srtobject)
+{
+  GThread *thread;
+
+  if (srtobject->sender_thread == NULL)
+    return;
+
+  srtobject->sender_running = FALSE;
+  g_cond_signal (&srtobject->sender_cond);
+
+  thread = g_steal_pointer (&srtobject->sender_thread);
+  g_mutex_unlock (&srtobject->sock_lock);
+  g_thread_join (thread);
+  g_mutex_lock (&srtobject->sock_lock);
+
+  srt_epoll_release (srtobject->sender_poll_id);
+  srtobject->sender_poll_id = SRT_ERROR;
+  srtobject->pending_callers = 0;
+}
+
 static gboolean
 gst_srt_object_wait_connect (GstSRTObject * srtobject,
     GCancellable * cancellable, gpointer sa, size_t sa_len, GError ** error)
@@ -1063,6 +1328,7 @@ gst_srt_object_wait_connect (GstSRTObject * srtobject,
   SRTSOCKET sock = SRT_INVALID_SOCK;
   const gchar *local_address = NULL;
   guint local_port = 0;
+  guint caller_queue_size;
   gint sock_flags = SRT_EPOLL_ERR | SRT_EPOLL_IN;
 
   gpointer bind_sa;
@@ -1078,6 +1344,8 @@ gst_srt_object_wait_connect (GstSRTObject * srtobject,
   if (local_address == NULL)
     local_address = GST_SRT_DEFAULT_LOCALADDRESS;
 
+  caller_queue_size = srtobject->caller_queue_size;
+
   GST_OBJECT_UNLOCK (srtobject->element);
 
   bind_addr =
@@ -1140,6 +1408,13 @@ gst_srt_object_wait_connect (GstSRTObject * srtobject,
     goto failed;
   }
 
+  if (caller_queue_size > 0 &&
+      gst_uri_handler_get_uri_type (GST_URI_HANDLER (srtobject->element)) ==
+      GST_URI_SINK) {
+    if (!gst_srt_object_start_sender (srtobject, error))
+      goto failed;
+  }
+
   srtobject->thread =
       g_thread_try_new ("GstSRTObjectListener", thread_func, srtobject, error);
   if (srtobject->thread == NULL) {
@@ -1151,6 +1426,10 @@ gst_srt_object_wait_connect (GstSRTObject * srtobject,
 
 failed:
 
+  g_mutex_lock (&srtobject->sock_lock);
+  gst_srt_object_stop_sender (srtobject);
+  g_mutex_unlock (&srtobject->sock_lock);
+
   if (srtobject->listener_poll_id != SRT_ERROR) {
     srt_epoll_release (srtobject->listener_poll_id);
   }
@@ -1437,6 +1716,8 @@ gst_srt_object_close (GstSRTObject * srtobject)
     srtobject->listener_sock = SRT_INVALID_SOCK;
   }
 
+  gst_srt_object_stop_sender (srtobject);
+
   if (srtobject->callers) {
     GList *callers = g_steal_pointer (&srtobject->callers);
     g_list_foreach (callers, (GFunc) srt_caller_signal_removed, srtobject);
@@ -1665,6 +1946,103 @@ gst_srt_object_send_headers (GstSRTObject * srtobject, SRTSOCKET sock,
   return TRUE;
 }
 
+/* called with sock_lock */
+static void
+srt_caller_enqueue (GstSRTObject * srtobject, SRTCaller * caller,
+    GstBuffer * buffer, gboolean header)
+{
+  if (g_queue_is_empty (&caller->queue))
+    srt_caller_set_pending (srtobject, caller, TRUE);
+
+  g_queue_push_tail (&caller->queue, srt_queue_item_new (buffer, header));
+  if (!header)
+    caller->queued_buffers++;
+}
+
+/* Drops the oldest buffer that was not started to be sent yet. Headers
+ * are never dropped. Called with sock_lock */
+static gboolean
+srt_caller_drop_oldest (GstSRTObject * srtobject, SRTCaller * caller)
+{
+  GList *l;
+
+  for (l = caller->queue.head; l != NULL; l = l->next) {
+    SRTQueueItem *item = l->data;
+
+    if (item->header || item->offset > 0)
+      continue;
+
+    caller->queued_buffers--;
+    caller->dropped_buffers++;
+    caller->dropped_bytes += gst_buffer_get_size (item->buffer);
+    GST_LOG_OBJECT (srtobject->element, "Dropping oldest buffer %"
+        GST_PTR_FORMAT " of caller %d", item->buffer, caller->sock);
+
+    g_queue_delete_link (&caller->queue, l);
+    srt_queue_item_free (item);
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+static gssize
+gst_srt_object_queue_to_callers (GstSRTObject * srtobject,
+    GstBufferList * headers, GstBuffer * buffer,
+    GstSRTCallerDropPolicy drop_policy)
+{
+  GList *callers;
+
+  g_mutex_lock (&srtobject->sock_lock);
+  callers = srtobject->callers;
+  while (callers != NULL) {
+    SRTCaller *caller = callers->data;
+    gboolean drop = FALSE;
+
+    callers = callers->next;
+
+    if (!caller->sent_headers) {
+      guint i, n = headers ? gst_buffer_list_length (headers) : 0;
+
+      for (i = 0; i < n; i++) {
+        srt_caller_enqueue (srtobject, caller,
+            gst_buffer_list_get (headers, i), TRUE);
+      }
+      caller->sent_headers = TRUE;
+    }
+
+    if (caller->queued_buffers >= srtobject->caller_queue_size) {
+      switch (drop_policy) {
+        case GST_SRT_CALLER_DROP_POLICY_OLDEST:
+          /* Everything queued may be partially sent or headers */
+          drop = !srt_caller_drop_oldest (srtobject, caller);
+          break;
+        case GST_SRT_CALLER_DROP_POLICY_NEWEST:
+          drop = TRUE;
+          break;
+        case GST_SRT_CALLER_DROP_POLICY_DISCONNECT:
+          GST_WARNING_OBJECT (srtobject->element,
+              "Queue of caller %d is full, dropping caller", caller->sock);
+          srt_caller_remove (caller, srtobject);
+          continue;
+      }
+    }
+
+    if (drop) {
+      caller->dropped_buffers++;
+      caller->dropped_bytes += gst_buffer_get_size (buffer);
+      GST_LOG_OBJECT (srtobject->element, "Queue of caller %d is full, "
+          "dropping buffer %" GST_PTR_FORMAT, caller->sock, buffer);
+      continue;
+    }
+
+    srt_caller_enqueue (srtobject, caller, buffer, FALSE);
+  }
+  g_mutex_unlock (&srtobject->sock_lock);
+
+  return gst_buffer_get_size (buffer);
+}
+
 static gssize
 gst_srt_object_write_to_callers (GstSRTObject * srtobject,
     GstBufferList * headers,
@@ -1715,9 +2093,7 @@ gst_srt_object_write_to_callers (GstSRTObject * srtobject,
     continue;
 
   err:
-    srtobject->callers = g_list_remove (srtobject->callers, caller);
-    srt_caller_signal_removed (caller, srtobject);
-    srt_caller_free (caller);
+    srt_caller_remove (caller, srtobject);
   }
 
   g_mutex_unlock (&srtobject->sock_lock);
@@ -1820,11 +2196,13 @@ gst_srt_object_write_one (GstSRTObject * srtobject,
 gssize
 gst_srt_object_write (GstSRTObject * srtobject,
     GstBufferList * headers,
-    const GstMapInfo * mapinfo, GCancellable * cancellable, GError ** error)
+    GstBuffer * buffer, GCancellable * cancellable, GError ** error)
 {
   gssize len = 0;
   GstSRTConnectionMode connection_mode = GST_SRT_CONNECTION_MODE_NONE;
+  GstSRTCallerDropPolicy drop_policy;
   gboolean wait_for_connection;
+  GstMapInfo mapinfo;
 
   /* Only sink element can write data */
   g_return_val_if_fail (gst_uri_handler_get_uri_type (GST_URI_HANDLER
@@ -1834,6 +2212,7 @@ gst_srt_object_write (GstSRTObject * srtobject,
   gst_structure_get_enum (srtobject->parameters, "mode",
       GST_TYPE_SRT_CONNECTION_MODE, (gint *) & connection_mode);
   wait_for_connection = srtobject->wait_for_connection;
+  drop_policy = srtobject->caller_drop_policy;
   GST_OBJECT_UNLOCK (srtobject->element);
 
   if (connection_mode == GST_SRT_CONNECTION_MODE_LISTENER) {
@@ -1841,15 +2220,31 @@ gst_srt_object_write (GstSRTObject * srtobject,
       if (!gst_srt_object_wait_caller (srtobject, cancellable, error))
         return -1;
     }
+
+    /* The sender thread only runs when callers have their own queues */
+    if (srtobject->sender_thread != NULL)
+      return gst_srt_object_queue_to_callers (srtobject, headers, buffer,
+          drop_policy);
+  }
+
+  if (!gst_buffer_map (buffer, &mapinfo, GST_MAP_READ)) {
+    g_set_error (error, GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_READ,
+        "Could not map the input stream");
+    return -1;
+  }
+
+  if (connection_mode == GST_SRT_CONNECTION_MODE_LISTENER) {
     len =
-        gst_srt_object_write_to_callers (srtobject, headers, mapinfo,
+        gst_srt_object_write_to_callers (srtobject, headers, &mapinfo,
         cancellable, error);
   } else {
     len =
-        gst_srt_object_write_one (srtobject, headers, mapinfo, cancellable,
+        gst_srt_object_write_one (srtobject, headers, &mapinfo, cancellable,
         error);
   }
 
+  gst_buffer_unmap (buffer, &mapinfo);
+
   return len;
 }
 
@@ -1949,6 +2344,15 @@ gst_srt_object_get_stats (GstSRTObject * srtobject)
       gst_structure_set (tmp, "caller-address", G_TYPE_SOCKET_ADDRESS,
           caller->sockaddr, NULL);
 
+      if (srtobject->sender_poll_id != SRT_ERROR) {
+        gst_structure_set (tmp,
+            /* number of buffers waiting in the caller's send queue */
+            "queue-depth", G_TYPE_UINT, caller->queued_buffers,
+            /* buffers and bytes dropped because the queue was full */
+            "dropped-buffers", G_TYPE_UINT64, caller->dropped_buffers,
+            "dropped-bytes", G_TYPE_UINT64, caller->dropped_bytes, NULL);
+      }
+
       g_value_array_append (callers_stats, NULL);
       v = g_value_array_get_nth (callers_stats, callers_stats->n_values - 1);
       g_value_init (v, GST_TYPE_STRUCTURE);
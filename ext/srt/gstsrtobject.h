@@ -42,6 +42,12 @@ G_BEGIN_DECLS
 #define GST_SRT_DEFAULT_LATENCY 125
 #define GST_SRT_DEFAULT_MSG_SIZE 1316
 #define GST_SRT_DEFAULT_WAIT_FOR_CONNECTION (TRUE)
+#define GST_SRT_DEFAULT_CALLER_QUEUE_SIZE 0
+#define GST_SRT_DEFAULT_CALLER_DROP_POLICY GST_SRT_CALLER_DROP_POLICY_OLDEST
+
+/* The properties installed by gst_srt_object_install_properties_helper()
+ * use ids below this one, element specific properties start from it */
+#define GST_SRT_OBJECT_PROP_LAST 64
 
 typedef struct _GstSRTObject GstSRTObject;
 
@@ -73,6 +79,16 @@ struct _GstSRTObject
   gboolean                     authentication;
 
   guint64                      previous_bytes;
+
+  /* Listener sink with per caller send queues, all drained by the
+   * sender thread. The sender fields are protected by sock_lock. */
+  guint                        caller_queue_size;
+  GstSRTCallerDropPolicy       caller_drop_policy;
+  GThread                      *sender_thread;
+  gint                         sender_poll_id;
+  gboolean                     sender_running;
+  GCond                        sender_cond;
+  guint                        pending_callers;
 };
 
 GstSRTObject   *gst_srt_object_new              (GstElement *element);
@@ -105,7 +121,7 @@ gssize          gst_srt_object_read     (GstSRTObject * srtobject,
 
 gssize          gst_srt_object_write    (GstSRTObject * srtobject,
                                          GstBufferList * headers,
-                                         const GstMapInfo * mapinfo,
+                                         GstBuffer * buffer,
                                          GCancellable *cancellable,
                                          GError **err);
 
@@ -63,6 +63,12 @@ enum
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
+enum
+{
+  PROP_CALLER_QUEUE_SIZE = GST_SRT_OBJECT_PROP_LAST,
+  PROP_CALLER_DROP_POLICY
+};
+
 static void gst_srt_sink_uri_handler_init (gpointer g_iface,
     gpointer iface_data);
 static gchar *gst_srt_sink_uri_get_uri (GstURIHandler * handler);
@@ -104,9 +110,23 @@ gst_srt_sink_set_property (GObject * object,
 {
   GstSRTSink *self = GST_SRT_SINK (object);
 
-  if (!gst_srt_object_set_property_helper (self->srtobject, prop_id, value,
-          pspec)) {
-    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+  switch (prop_id) {
+    case PROP_CALLER_QUEUE_SIZE:
+      GST_OBJECT_LOCK (self);
+      self->srtobject->caller_queue_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_CALLER_DROP_POLICY:
+      GST_OBJECT_LOCK (self);
+      self->srtobject->caller_drop_policy = g_value_get_enum (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      if (!gst_srt_object_set_property_helper (self->srtobject, prop_id, value,
+              pspec)) {
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      }
+      break;
   }
 }
 
@@ -116,9 +136,23 @@ gst_srt_sink_get_property (GObject * object,
 {
   GstSRTSink *self = GST_SRT_SINK (object);
 
-  if (!gst_srt_object_get_property_helper (self->srtobject, prop_id, value,
-          pspec)) {
-    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+  switch (prop_id) {
+    case PROP_CALLER_QUEUE_SIZE:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->srtobject->caller_queue_size);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_CALLER_DROP_POLICY:
+      GST_OBJECT_LOCK (self);
+      g_value_set_enum (value, self->srtobject->caller_drop_policy);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      if (!gst_srt_object_get_property_helper (self->srtobject, prop_id, value,
+              pspec)) {
+        G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      }
+      break;
   }
 }
 
@@ -177,7 +211,6 @@ gst_srt_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 {
   GstSRTSink *self = GST_SRT_SINK (sink);
   GstFlowReturn ret = GST_FLOW_OK;
-  GstMapInfo info;
   GError *error = NULL;
 
   if (g_cancellable_is_cancelled (self->cancellable)) {
@@ -190,13 +223,7 @@ gst_srt_sink_render (GstBaseSink * sink, GstBuffer * buffer)
     return GST_FLOW_OK;
   }
 
-  if (!gst_buffer_map (buffer, &info, GST_MAP_READ)) {
-    GST_ELEMENT_ERROR (self, RESOURCE, READ,
-        ("Could not map the input stream"), (NULL));
-    return GST_FLOW_ERROR;
-  }
-
-  if (gst_srt_object_write (self->srtobject, self->headers, &info,
+  if (gst_srt_object_write (self->srtobject, self->headers, buffer,
           self->cancellable, &error) < 0) {
     GST_ELEMENT_ERROR (self, RESOURCE, WRITE,
         ("Failed to write to SRT socket: %s",
@@ -205,8 +232,6 @@ gst_srt_sink_render (GstBaseSink * sink, GstBuffer * buffer)
     ret = GST_FLOW_ERROR;
   }
 
-  gst_buffer_unmap (buffer, &info);
-
   GST_TRACE_OBJECT (self, "sending buffer %p, offset %"
       G_GINT64_FORMAT ", offset_end %" G_GINT64_FORMAT
       ", timestamp %" GST_TIME_FORMAT ", duration %" GST_TIME_FORMAT
@@ -366,6 +391,41 @@ gst_srt_sink_class_init (GstSRTSinkClass * klass)
 
   gst_srt_object_install_properties_helper (gobject_class);
 
+  /**
+   * GstSRTSink:caller-queue-size:
+   *
+   * In listener mode, the number of buffers that can be queued for each
+   * caller. When not 0, buffers are not sent to the callers one after
+   * the other from the streaming thread anymore but queued, and a single
+   * thread sends them to whichever caller can take more data. A slow
+   * caller then only fills up its own queue, see
+   * #GstSRTSink:caller-drop-policy, instead of holding back the others.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_CALLER_QUEUE_SIZE,
+      g_param_spec_uint ("caller-queue-size", "Caller queue size",
+          "Number of buffers queued for each caller in listener mode "
+          "(0 = send synchronously)", 0, G_MAXUINT,
+          GST_SRT_DEFAULT_CALLER_QUEUE_SIZE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSRTSink:caller-drop-policy:
+   *
+   * What to do when the queue of a caller is full, applied to each
+   * caller independently.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_CALLER_DROP_POLICY,
+      g_param_spec_enum ("caller-drop-policy", "Caller drop policy",
+          "What to do when the queue of a caller is full",
+          GST_TYPE_SRT_CALLER_DROP_POLICY, GST_SRT_DEFAULT_CALLER_DROP_POLICY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  gst_type_mark_as_plugin_api (GST_TYPE_SRT_CALLER_DROP_POLICY, 0);
+
   gst_element_class_add_static_pad_template (gstelement_class, &sink_template);
   gst_element_class_set_metadata (gstelement_class,
       "SRT sink", "Sink/Network",
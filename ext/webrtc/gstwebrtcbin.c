@@ -355,6 +355,7 @@ enum
   ON_ICE_CANDIDATE_SIGNAL,
   ON_NEW_TRANSCEIVER_SIGNAL,
   GET_STATS_SIGNAL,
+  GET_STATS_SNAPSHOT_SIGNAL,
   ADD_TRANSCEIVER_SIGNAL,
   GET_TRANSCEIVER_SIGNAL,
   GET_TRANSCEIVERS_SIGNAL,
@@ -799,15 +800,9 @@ _free_op (GstWebRTCBinTask * op)
   g_free (op);
 }
 
-/*
- * @promise is for correctly signalling the failure case to the caller when
- * the user supplies it.  Without passing it in, the promise would never
- * be replied to in the case that @webrtc becomes closed between the idle
- * source addition and the the execution of the idle source.
- */
-gboolean
-gst_webrtc_bin_enqueue_task (GstWebRTCBin * webrtc, GstWebRTCBinFunc func,
-    gpointer data, GDestroyNotify notify, GstPromise * promise)
+static gboolean
+_enqueue_task_full (GstWebRTCBin * webrtc, GstWebRTCBinFunc func,
+    gpointer data, GDestroyNotify notify, GstPromise * promise, gint priority)
 {
   GstWebRTCBinTask *op;
   GMainContext *ctx;
@@ -835,7 +830,7 @@ gst_webrtc_bin_enqueue_task (GstWebRTCBin * webrtc, GstWebRTCBinFunc func,
     op->promise = gst_promise_ref (promise);
 
   source = g_idle_source_new ();
-  g_source_set_priority (source, G_PRIORITY_DEFAULT);
+  g_source_set_priority (source, priority);
   g_source_set_callback (source, (GSourceFunc) _execute_op, op,
       (GDestroyNotify) _free_op);
   g_source_attach (source, ctx);
@@ -845,6 +840,20 @@ gst_webrtc_bin_enqueue_task (GstWebRTCBin * webrtc, GstWebRTCBinFunc func,
   return TRUE;
 }
 
+/*
+ * @promise is for correctly signalling the failure case to the caller when
+ * the user supplies it.  Without passing it in, the promise would never
+ * be replied to in the case that @webrtc becomes closed between the idle
+ * source addition and the the execution of the idle source.
+ */
+gboolean
+gst_webrtc_bin_enqueue_task (GstWebRTCBin * webrtc, GstWebRTCBinFunc func,
+    gpointer data, GDestroyNotify notify, GstPromise * promise)
+{
+  return _enqueue_task_full (webrtc, func, data, notify, promise,
+      G_PRIORITY_DEFAULT);
+}
+
 /* https://www.w3.org/TR/webrtc/#dom-rtciceconnectionstate */
 static GstWebRTCICEConnectionState
 _collate_ice_connection_states (GstWebRTCBin * webrtc)
@@ -5283,11 +5292,14 @@ _free_get_stats (struct get_stats *stats)
 static void
 _get_stats_task (GstWebRTCBin * webrtc, struct get_stats *stats)
 {
+  GstStructure *s;
+
   /* Our selector is the pad,
    * https://www.w3.org/TR/webrtc/#dfn-stats-selection-algorithm
    */
-  gst_promise_reply (stats->promise, gst_webrtc_bin_create_stats (webrtc,
-          stats->pad));
+  s = gst_webrtc_bin_create_stats (webrtc, stats->pad);
+  gst_webrtc_bin_update_stats_snapshot (webrtc, s, stats->pad == NULL);
+  gst_promise_reply (stats->promise, s);
 }
 
 static void
@@ -5319,6 +5331,46 @@ gst_webrtc_bin_get_stats (GstWebRTCBin * webrtc, GstPad * pad,
   }
 }
 
+static void
+_refresh_stats_snapshot_task (GstWebRTCBin * webrtc, gpointer data)
+{
+  GstStructure *s;
+
+  s = gst_webrtc_bin_create_stats (webrtc, NULL);
+  gst_webrtc_bin_update_stats_snapshot (webrtc, s, TRUE);
+  gst_structure_free (s);
+}
+
+static void
+_refresh_stats_snapshot_done (GstWebRTCBin * webrtc)
+{
+  g_mutex_lock (&webrtc->priv->stats_lock);
+  webrtc->priv->stats_refresh_pending = FALSE;
+  g_mutex_unlock (&webrtc->priv->stats_lock);
+}
+
+static GstStructure *
+gst_webrtc_bin_get_stats_snapshot_action (GstWebRTCBin * webrtc,
+    const gchar * type, const gchar * id, guint64 since)
+{
+  gboolean refresh;
+
+  /* at most one refresh is queued at a time, whatever the number of
+   * readers, and it runs after any pending negotiation work */
+  g_mutex_lock (&webrtc->priv->stats_lock);
+  refresh = !webrtc->priv->stats_refresh_pending;
+  webrtc->priv->stats_refresh_pending = TRUE;
+  g_mutex_unlock (&webrtc->priv->stats_lock);
+
+  if (refresh)
+    _enqueue_task_full (webrtc,
+        (GstWebRTCBinFunc) _refresh_stats_snapshot_task, webrtc,
+        (GDestroyNotify) _refresh_stats_snapshot_done, NULL,
+        G_PRIORITY_LOW);
+
+  return gst_webrtc_bin_get_stats_snapshot (webrtc, type, id, since);
+}
+
 static GstWebRTCRTPTransceiver *
 gst_webrtc_bin_add_transceiver (GstWebRTCBin * webrtc,
     GstWebRTCRTPTransceiverDirection direction, GstCaps * caps)
@@ -6479,6 +6531,9 @@ gst_webrtc_bin_finalize (GObject * object)
     gst_webrtc_session_description_free (webrtc->priv->last_generated_offer);
   webrtc->priv->last_generated_offer = NULL;
 
+  g_hash_table_destroy (webrtc->priv->stats_snapshot);
+  g_mutex_clear (&webrtc->priv->stats_lock);
+
   g_mutex_clear (ICE_GET_LOCK (webrtc));
   g_mutex_clear (PC_GET_LOCK (webrtc));
   g_cond_clear (PC_GET_COND (webrtc));
@@ -6785,6 +6840,42 @@ gst_webrtc_bin_class_init (GstWebRTCBinClass * klass)
       G_CALLBACK (gst_webrtc_bin_get_stats), NULL, NULL, NULL,
       G_TYPE_NONE, 2, GST_TYPE_PAD, GST_TYPE_PROMISE);
 
+  /**
+   * GstWebRTCBin::get-stats-snapshot:
+   * @object: the #webrtcbin
+   * @type: (nullable): only return stats of this type, e.g. "inbound-rtp"
+   * @id: (nullable): only return the stats with this identifier
+   * @since: only return the stats that changed after this generation
+   *
+   * Returns the statistics cached from the last complete stats collection,
+   * without waiting for the operation thread. The cache is filled by
+   * #GstWebRTCBin::get-stats and by a refresh that this signal queues at
+   * low priority, so the returned values are at most one call old.
+   *
+   * The returned structure has the same layout as the #GstWebRTCBin::get-stats
+   * reply, with an additional "generation" field (G_TYPE_UINT64). Passing it
+   * as @since on the next call only returns the entries that changed
+   * in between, the "timestamp" of an entry being ignored for that purpose.
+   * Entries keep the timestamp of the collection that last changed them.
+   *
+   * When entries that existed at generation @since were removed in between,
+   * e.g. because their pad was released, the reply also has a "removed"
+   * field (#GST_TYPE_ARRAY of G_TYPE_STRING) listing their identifiers.
+   * Removals are only remembered for 32 generations. If @since is older
+   * than a removal that was forgotten, the reply contains all entries, as
+   * for a @since of 0, and has a "reset" field (G_TYPE_BOOLEAN) set to
+   * %TRUE telling the caller to drop the entries it kept.
+   *
+   * Returns: (transfer full): a #GstStructure
+   *
+   * Since: 1.20
+   */
+  gst_webrtc_bin_signals[GET_STATS_SNAPSHOT_SIGNAL] =
+      g_signal_new_class_handler ("get-stats-snapshot",
+      G_TYPE_FROM_CLASS (klass), G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_CALLBACK (gst_webrtc_bin_get_stats_snapshot_action), NULL, NULL, NULL,
+      GST_TYPE_STRUCTURE, 3, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_UINT64);
+
   /**
    * GstWebRTCBin::on-negotiation-needed:
    * @object: the #webrtcbin
@@ -6943,6 +7034,9 @@ gst_webrtc_bin_init (GstWebRTCBin * webrtc)
 
   g_mutex_init (ICE_GET_LOCK (webrtc));
 
+  g_mutex_init (&webrtc->priv->stats_lock);
+  webrtc->priv->stats_snapshot = gst_webrtc_bin_stats_snapshot_new ();
+
   webrtc->rtpbin = _create_rtpbin (webrtc);
   gst_bin_add (GST_BIN (webrtc), webrtc->rtpbin);
 
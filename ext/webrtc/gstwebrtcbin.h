@@ -141,6 +141,16 @@ struct _GstWebRTCBinPrivate
   GstWebRTCSessionDescription *last_generated_answer;
 
   gboolean tos_attached;
+
+  /* stats collected by the last full walk, for get-stats-snapshot.
+   * Protected by stats_lock so that it can be read from any thread */
+  GMutex stats_lock;
+  GHashTable *stats_snapshot;
+  guint64 stats_generation;
+  /* newest generation at which an entry was removed whose tombstone was
+   * dropped since */
+  guint64 stats_pruned;
+  gboolean stats_refresh_pending;
 };
 
 typedef void (*GstWebRTCBinFunc) (GstWebRTCBin * webrtc, gpointer data);
@@ -849,3 +849,219 @@ gst_webrtc_bin_create_stats (GstWebRTCBin * webrtc, GstPad * pad)
 
   return s;
 }
+
+/* number of generations during which removed entries are reported */
+#define STATS_TOMBSTONE_GENERATIONS 32
+
+typedef struct
+{
+  /* NULL once removed, the entry then being kept as a tombstone */
+  GstStructure *stats;
+  GQuark type;
+  /* generation of the update that added the entry */
+  guint64 added;
+  /* generation of the update that last changed or added the entry */
+  guint64 changed;
+  /* generation of the update that last reported the entry */
+  guint64 seen;
+  /* generation of the update that removed the entry */
+  guint64 removed;
+} StatsSnapshotEntry;
+
+static void
+_free_stats_snapshot_entry (StatsSnapshotEntry * entry)
+{
+  if (entry->stats)
+    gst_structure_free (entry->stats);
+  g_free (entry);
+}
+
+GHashTable *
+gst_webrtc_bin_stats_snapshot_new (void)
+{
+  return g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+      (GDestroyNotify) _free_stats_snapshot_entry);
+}
+
+static gboolean
+_stats_field_equal (GQuark field_id, const GValue * value,
+    const GstStructure * other)
+{
+  const GValue *other_value;
+
+  /* the timestamp changes with every walk, whatever the values */
+  if (field_id == g_quark_from_static_string ("timestamp"))
+    return TRUE;
+
+  other_value = gst_structure_id_get_value (other, field_id);
+
+  return other_value && gst_value_compare (value,
+      other_value) == GST_VALUE_EQUAL;
+}
+
+static gboolean
+_stats_equal (const GstStructure * a, const GstStructure * b)
+{
+  return gst_structure_n_fields (a) == gst_structure_n_fields (b)
+      && gst_structure_has_name (b, gst_structure_get_name (a))
+      && gst_structure_foreach (a,
+      (GstStructureForeachFunc) _stats_field_equal, (gpointer) b);
+}
+
+/* Merges the result of gst_webrtc_bin_create_stats() into the snapshot.
+ * Entries are only replaced when one of their values changed. When @stats
+ * is @complete, i.e. not restricted to a pad, the entries it doesn't
+ * contain anymore are dropped. Their identifiers are kept as tombstones
+ * for STATS_TOMBSTONE_GENERATIONS updates, or until they come back, so
+ * that incremental readers learn about the removal. */
+void
+gst_webrtc_bin_update_stats_snapshot (GstWebRTCBin * webrtc,
+    const GstStructure * stats, gboolean complete)
+{
+  GHashTable *snapshot = webrtc->priv->stats_snapshot;
+  StatsSnapshotEntry *entry;
+  guint64 generation;
+  guint i, n_fields, n_changed = 0, n_removed = 0, n_pruned = 0;
+
+  _init_debug ();
+
+  n_fields = gst_structure_n_fields (stats);
+
+  g_mutex_lock (&webrtc->priv->stats_lock);
+  generation = ++webrtc->priv->stats_generation;
+
+  for (i = 0; i < n_fields; i++) {
+    const gchar *id = gst_structure_nth_field_name (stats, i);
+    const GValue *value = gst_structure_get_value (stats, id);
+    const GstStructure *s;
+
+    if (!GST_VALUE_HOLDS_STRUCTURE (value))
+      continue;
+    s = gst_value_get_structure (value);
+
+    entry = g_hash_table_lookup (snapshot, id);
+    if (!entry) {
+      entry = g_new0 (StatsSnapshotEntry, 1);
+      g_hash_table_insert (snapshot, g_strdup (id), entry);
+    }
+
+    if (entry->stats && _stats_equal (entry->stats, s)) {
+      entry->seen = generation;
+      continue;
+    }
+
+    if (entry->stats) {
+      gst_structure_free (entry->stats);
+    } else {
+      /* new, or back after a removal */
+      entry->added = generation;
+      entry->removed = 0;
+    }
+
+    entry->stats = gst_structure_copy (s);
+    entry->type = g_quark_from_string (gst_structure_get_name (s));
+    entry->changed = generation;
+    entry->seen = generation;
+    n_changed++;
+  }
+
+  if (complete) {
+    GHashTableIter iter;
+
+    g_hash_table_iter_init (&iter, snapshot);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & entry)) {
+      if (entry->stats && entry->seen != generation) {
+        g_clear_pointer (&entry->stats, gst_structure_free);
+        entry->removed = generation;
+        n_removed++;
+      } else if (!entry->stats
+          && generation - entry->removed >= STATS_TOMBSTONE_GENERATIONS) {
+        webrtc->priv->stats_pruned =
+            MAX (webrtc->priv->stats_pruned, entry->removed);
+        g_hash_table_iter_remove (&iter);
+        n_pruned++;
+      }
+    }
+  }
+
+  GST_LOG_OBJECT (webrtc, "stats snapshot generation %" G_GUINT64_FORMAT
+      ", %u of %u entries changed, %u removed, %u tombstones dropped",
+      generation, n_changed, n_fields, n_removed, n_pruned);
+
+  g_mutex_unlock (&webrtc->priv->stats_lock);
+}
+
+static void
+_add_snapshot_entry (GstStructure * s, GValue * removed, const gchar * id,
+    StatsSnapshotEntry * entry, const gchar * type, guint64 since)
+{
+  if (type && g_strcmp0 (g_quark_to_string (entry->type), type) != 0)
+    return;
+
+  if (!entry->stats) {
+    /* only the readers that could have seen the entry need to know */
+    if (entry->removed > since && entry->added <= since) {
+      GValue v = G_VALUE_INIT;
+
+      g_value_init (&v, G_TYPE_STRING);
+      g_value_set_string (&v, id);
+      gst_value_array_append_and_take_value (removed, &v);
+    }
+    return;
+  }
+
+  if (entry->changed <= since)
+    return;
+
+  gst_structure_set (s, id, GST_TYPE_STRUCTURE, entry->stats, NULL);
+}
+
+/* Returns the entries of the snapshot that changed after generation @since,
+ * optionally restricted to one @type or @id, along with the current
+ * generation and the identifiers of the entries removed since then. If
+ * some of those removals were forgotten already, all entries are returned
+ * instead and the reply is flagged as a reset. Doesn't need the PC lock. */
+GstStructure *
+gst_webrtc_bin_get_stats_snapshot (GstWebRTCBin * webrtc, const gchar * type,
+    const gchar * id, guint64 since)
+{
+  GstStructure *s = gst_structure_new_empty ("application/x-webrtc-stats");
+  GHashTable *snapshot = webrtc->priv->stats_snapshot;
+  StatsSnapshotEntry *entry;
+  GValue removed = G_VALUE_INIT;
+
+  g_value_init (&removed, GST_TYPE_ARRAY);
+
+  g_mutex_lock (&webrtc->priv->stats_lock);
+
+  if (since > 0 && since < webrtc->priv->stats_pruned) {
+    since = 0;
+    gst_structure_set (s, "reset", G_TYPE_BOOLEAN, TRUE, NULL);
+  }
+
+  if (id) {
+    entry = g_hash_table_lookup (snapshot, id);
+    if (entry)
+      _add_snapshot_entry (s, &removed, id, entry, type, since);
+  } else {
+    GHashTableIter iter;
+    const gchar *key;
+
+    g_hash_table_iter_init (&iter, snapshot);
+    while (g_hash_table_iter_next (&iter, (gpointer *) & key,
+            (gpointer *) & entry))
+      _add_snapshot_entry (s, &removed, key, entry, type, since);
+  }
+
+  gst_structure_set (s, "generation", G_TYPE_UINT64,
+      webrtc->priv->stats_generation, NULL);
+
+  if (gst_value_array_get_size (&removed) > 0)
+    gst_structure_take_value (s, "removed", &removed);
+  else
+    g_value_unset (&removed);
+
+  g_mutex_unlock (&webrtc->priv->stats_lock);
+
+  return s;
+}
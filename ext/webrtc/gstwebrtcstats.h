@@ -31,6 +31,20 @@ G_GNUC_INTERNAL
 GstStructure *     gst_webrtc_bin_create_stats         (GstWebRTCBin * webrtc,
                                                         GstPad * pad);
 
+G_GNUC_INTERNAL
+GHashTable *       gst_webrtc_bin_stats_snapshot_new   (void);
+
+G_GNUC_INTERNAL
+void               gst_webrtc_bin_update_stats_snapshot (GstWebRTCBin * webrtc,
+                                                        const GstStructure * s,
+                                                        gboolean complete);
+
+G_GNUC_INTERNAL
+GstStructure *     gst_webrtc_bin_get_stats_snapshot   (GstWebRTCBin * webrtc,
+                                                        const gchar * type,
+                                                        const gchar * id,
+                                                        guint64 since);
+
 G_END_DECLS
 
 #endif /* __GST_WEBRTC_STATS_H__ */
@@ -50,6 +50,10 @@ G_DEFINE_TYPE_WITH_CODE (WebRTCDataChannel, webrtc_data_channel,
     GST_DEBUG_CATEGORY_INIT (webrtc_data_channel_debug, "webrtcdatachannel", 0,
         "webrtcdatachannel"););
 
+static guint on_message_data_signal;
+static guint on_message_string_signal;
+static guint on_message_buffer_signal;
+
 typedef enum
 {
   DATA_CHANNEL_PPID_WEBRTC_CONTROL = 50,
@@ -495,18 +499,129 @@ buffer_unmap_and_unref (struct map_info *info)
   g_free (info);
 }
 
+static gboolean
+_has_handler (WebRTCDataChannel * channel, guint signal_id)
+{
+  return g_signal_has_handler_pending (channel, signal_id, 0, FALSE);
+}
+
+/* Emits a received message to the signals that have handlers, so that
+ * nothing gets mapped or copied for the ones nobody listens to */
 static void
-_emit_have_data (WebRTCDataChannel * channel, GBytes * data)
+_emit_message (WebRTCDataChannel * channel, GstBuffer * buffer)
 {
-  gst_webrtc_data_channel_on_message_data (GST_WEBRTC_DATA_CHANNEL (channel),
-      data);
+  GstWebRTCDataChannel *base_channel = GST_WEBRTC_DATA_CHANNEL (channel);
+  GstSctpReceiveMeta *receive = gst_sctp_buffer_get_receive_meta (buffer);
+  gboolean is_string = FALSE, empty = FALSE;
+
+  switch (receive->ppid) {
+    case DATA_CHANNEL_PPID_WEBRTC_STRING:
+    case DATA_CHANNEL_PPID_WEBRTC_STRING_PARTIAL:
+      is_string = TRUE;
+      break;
+    case DATA_CHANNEL_PPID_WEBRTC_STRING_EMPTY:
+      is_string = TRUE;
+      empty = TRUE;
+      break;
+    case DATA_CHANNEL_PPID_WEBRTC_BINARY_EMPTY:
+      empty = TRUE;
+      break;
+    default:
+      break;
+  }
+
+  if (_has_handler (channel, on_message_buffer_signal)) {
+    if (empty) {
+      GstBuffer *empty_buffer = gst_buffer_new ();
+
+      gst_webrtc_data_channel_on_message_buffer (base_channel, empty_buffer,
+          is_string);
+      gst_buffer_unref (empty_buffer);
+    } else {
+      gst_webrtc_data_channel_on_message_buffer (base_channel, buffer,
+          is_string);
+    }
+  }
+
+  if (is_string && _has_handler (channel, on_message_string_signal)) {
+    GstMapInfo info = GST_MAP_INFO_INIT;
+    gchar *str = NULL;
+
+    if (!empty) {
+      if (!gst_buffer_map (buffer, &info, GST_MAP_READ))
+        goto map_failed;
+      str = g_strndup ((gchar *) info.data, info.size);
+      gst_buffer_unmap (buffer, &info);
+    }
+    gst_webrtc_data_channel_on_message_string (base_channel, str);
+    g_free (str);
+  } else if (!is_string && _has_handler (channel, on_message_data_signal)) {
+    GBytes *data = NULL;
+
+    if (!empty) {
+      struct map_info *info = g_new0 (struct map_info, 1);
+
+      if (!gst_buffer_map (buffer, &info->map_info, GST_MAP_READ)) {
+        g_free (info);
+        goto map_failed;
+      }
+      info->buffer = gst_buffer_ref (buffer);
+      data = g_bytes_new_with_free_func (info->map_info.data,
+          info->map_info.size, (GDestroyNotify) buffer_unmap_and_unref, info);
+    }
+    gst_webrtc_data_channel_on_message_data (base_channel, data);
+    if (data)
+      g_bytes_unref (data);
+  }
+
+  return;
+
+map_failed:
+  {
+    GError *error = NULL;
+
+    g_set_error (&error, GST_WEBRTC_BIN_ERROR,
+        GST_WEBRTC_BIN_ERROR_DATA_CHANNEL_FAILURE,
+        "Failed to map received buffer");
+    _channel_store_error (channel, error);
+    _channel_enqueue_task (channel, (ChannelTask) _close_procedure, NULL, NULL);
+  }
 }
 
 static void
-_emit_have_string (GstWebRTCDataChannel * channel, gchar * str)
+_emit_pending_messages (WebRTCDataChannel * channel, gpointer user_data)
 {
-  gst_webrtc_data_channel_on_message_string (GST_WEBRTC_DATA_CHANNEL (channel),
-      str);
+  GQueue messages;
+  GstBuffer *buffer;
+
+  g_mutex_lock (&channel->pending_lock);
+  messages = channel->pending_messages;
+  g_queue_init (&channel->pending_messages);
+  g_mutex_unlock (&channel->pending_lock);
+
+  GST_LOG_OBJECT (channel, "Emitting %u received messages", messages.length);
+
+  while ((buffer = g_queue_pop_head (&messages))) {
+    _emit_message (channel, buffer);
+    gst_buffer_unref (buffer);
+  }
+}
+
+static void
+_channel_queue_message (WebRTCDataChannel * channel, GstBuffer * buffer)
+{
+  gboolean first;
+
+  g_mutex_lock (&channel->pending_lock);
+  first = g_queue_is_empty (&channel->pending_messages);
+  g_queue_push_tail (&channel->pending_messages, gst_buffer_ref (buffer));
+  g_mutex_unlock (&channel->pending_lock);
+
+  /* a single task emits all the messages received until it runs, instead
+   * of one task per message */
+  if (first)
+    _channel_enqueue_task (channel, (ChannelTask) _emit_pending_messages,
+        NULL, NULL);
 }
 
 static GstFlowReturn
@@ -550,45 +665,13 @@ _data_channel_have_sample (WebRTCDataChannel * channel, GstSample * sample,
       break;
     }
     case DATA_CHANNEL_PPID_WEBRTC_STRING:
-    case DATA_CHANNEL_PPID_WEBRTC_STRING_PARTIAL:{
-      GstMapInfo info = GST_MAP_INFO_INIT;
-      if (!gst_buffer_map (buffer, &info, GST_MAP_READ)) {
-        g_set_error (error, GST_WEBRTC_BIN_ERROR,
-            GST_WEBRTC_BIN_ERROR_DATA_CHANNEL_FAILURE,
-            "Failed to map received buffer");
-        ret = GST_FLOW_ERROR;
-      } else {
-        gchar *str = g_strndup ((gchar *) info.data, info.size);
-        _channel_enqueue_task (channel, (ChannelTask) _emit_have_string, str,
-            g_free);
-        gst_buffer_unmap (buffer, &info);
-      }
-      break;
-    }
+    case DATA_CHANNEL_PPID_WEBRTC_STRING_PARTIAL:
     case DATA_CHANNEL_PPID_WEBRTC_BINARY:
-    case DATA_CHANNEL_PPID_WEBRTC_BINARY_PARTIAL:{
-      struct map_info *info = g_new0 (struct map_info, 1);
-      if (!gst_buffer_map (buffer, &info->map_info, GST_MAP_READ)) {
-        g_set_error (error, GST_WEBRTC_BIN_ERROR,
-            GST_WEBRTC_BIN_ERROR_DATA_CHANNEL_FAILURE,
-            "Failed to map received buffer");
-        ret = GST_FLOW_ERROR;
-      } else {
-        GBytes *data = g_bytes_new_with_free_func (info->map_info.data,
-            info->map_info.size, (GDestroyNotify) buffer_unmap_and_unref, info);
-        info->buffer = gst_buffer_ref (buffer);
-        _channel_enqueue_task (channel, (ChannelTask) _emit_have_data, data,
-            (GDestroyNotify) g_bytes_unref);
-      }
-      break;
-    }
+    case DATA_CHANNEL_PPID_WEBRTC_BINARY_PARTIAL:
     case DATA_CHANNEL_PPID_WEBRTC_BINARY_EMPTY:
-      _channel_enqueue_task (channel, (ChannelTask) _emit_have_data, NULL,
-          NULL);
-      break;
     case DATA_CHANNEL_PPID_WEBRTC_STRING_EMPTY:
-      _channel_enqueue_task (channel, (ChannelTask) _emit_have_string, NULL,
-          NULL);
+      /* mapped, if needed at all, when emitted */
+      _channel_queue_message (channel, buffer);
       break;
     default:
       g_set_error (error, GST_WEBRTC_BIN_ERROR,
@@ -834,6 +917,84 @@ webrtc_data_channel_send_string (GstWebRTCDataChannel * base_channel,
   }
 }
 
+static void
+webrtc_data_channel_send_buffer_list (GstWebRTCDataChannel * base_channel,
+    GstBufferList * list, gboolean is_string)
+{
+  WebRTCDataChannel *channel = WEBRTC_DATA_CHANNEL (base_channel);
+  GstSctpSendMetaPartiallyReliability reliability;
+  guint rel_param;
+  GstBufferList *messages;
+  GstFlowReturn ret;
+  guint64 total = 0;
+  guint i, n;
+
+  if (!channel->parent.negotiated)
+    g_return_if_fail (channel->opened);
+  g_return_if_fail (channel->sctp_transport != NULL);
+
+  n = gst_buffer_list_length (list);
+  if (n == 0)
+    return;
+
+  _get_sctp_reliability (channel, &reliability, &rel_param);
+
+  messages = gst_buffer_list_new_sized (n);
+  for (i = 0; i < n; i++) {
+    GstBuffer *buffer = gst_buffer_list_get (list, i);
+    gsize size = gst_buffer_get_size (buffer);
+    guint32 ppid;
+
+    if (!_is_within_max_message_size (channel, size)) {
+      GError *error = NULL;
+      g_set_error (&error, GST_WEBRTC_BIN_ERROR,
+          GST_WEBRTC_BIN_ERROR_DATA_CHANNEL_FAILURE,
+          "Requested to send data that is too large");
+      _channel_store_error (channel, error);
+      _channel_enqueue_task (channel, (ChannelTask) _close_procedure, NULL,
+          NULL);
+      gst_buffer_list_unref (messages);
+      return;
+    }
+
+    if (size == 0) {
+      buffer = gst_buffer_new ();
+      ppid = is_string ? DATA_CHANNEL_PPID_WEBRTC_STRING_EMPTY :
+          DATA_CHANNEL_PPID_WEBRTC_BINARY_EMPTY;
+    } else {
+      /* only the metadata is copied, the memory is shared */
+      buffer = gst_buffer_copy (buffer);
+      ppid = is_string ? DATA_CHANNEL_PPID_WEBRTC_STRING :
+          DATA_CHANNEL_PPID_WEBRTC_BINARY;
+    }
+
+    gst_sctp_buffer_add_send_meta (buffer, ppid, channel->parent.ordered,
+        reliability, rel_param);
+    gst_buffer_list_add (messages, buffer);
+    total += size;
+  }
+
+  GST_LOG_OBJECT (channel, "Sending %u messages, %" G_GUINT64_FORMAT
+      " bytes", n, total);
+
+  /* accounted once for the whole list, the probe on the appsrc pad also
+   * sees the list as a whole */
+  GST_WEBRTC_DATA_CHANNEL_LOCK (channel);
+  channel->parent.buffered_amount += total;
+  GST_WEBRTC_DATA_CHANNEL_UNLOCK (channel);
+
+  ret = gst_app_src_push_buffer_list (GST_APP_SRC (channel->appsrc),
+      messages);
+
+  if (ret != GST_FLOW_OK) {
+    GError *error = NULL;
+    g_set_error (&error, GST_WEBRTC_BIN_ERROR,
+        GST_WEBRTC_BIN_ERROR_DATA_CHANNEL_FAILURE, "Failed to send data");
+    _channel_store_error (channel, error);
+    _channel_enqueue_task (channel, (ChannelTask) _close_procedure, NULL, NULL);
+  }
+}
+
 static void
 _on_sctp_notify_state_unlocked (GObject * sctp_transport,
     WebRTCDataChannel * channel)
@@ -951,6 +1112,10 @@ gst_webrtc_data_channel_finalize (GObject * object)
   g_clear_object (&channel->appsrc);
   g_clear_object (&channel->appsink);
 
+  while (!g_queue_is_empty (&channel->pending_messages))
+    gst_buffer_unref (g_queue_pop_head (&channel->pending_messages));
+  g_mutex_clear (&channel->pending_lock);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -966,12 +1131,22 @@ webrtc_data_channel_class_init (WebRTCDataChannelClass * klass)
 
   channel_class->send_data = webrtc_data_channel_send_data;
   channel_class->send_string = webrtc_data_channel_send_string;
+  channel_class->send_buffer_list = webrtc_data_channel_send_buffer_list;
   channel_class->close = webrtc_data_channel_close;
+
+  on_message_data_signal =
+      g_signal_lookup ("on-message-data", GST_TYPE_WEBRTC_DATA_CHANNEL);
+  on_message_string_signal =
+      g_signal_lookup ("on-message-string", GST_TYPE_WEBRTC_DATA_CHANNEL);
+  on_message_buffer_signal =
+      g_signal_lookup ("on-message-buffer", GST_TYPE_WEBRTC_DATA_CHANNEL);
 }
 
 static void
 webrtc_data_channel_init (WebRTCDataChannel * channel)
 {
+  g_mutex_init (&channel->pending_lock);
+  g_queue_init (&channel->pending_messages);
 }
 
 static void
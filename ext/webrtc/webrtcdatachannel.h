@@ -52,6 +52,10 @@ struct _WebRTCDataChannel
   gulong                            src_probe;
   GError                           *stored_error;
 
+  /* received messages waiting to be emitted from the webrtcbin thread */
+  GMutex                            pending_lock;
+  GQueue                            pending_messages;
+
   gpointer                          _padding[GST_PADDING];
 };
 
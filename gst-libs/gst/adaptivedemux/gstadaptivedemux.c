@@ -131,6 +131,8 @@ GST_DEBUG_CATEGORY (adaptivedemux_debug);
 #define DEFAULT_BITRATE_LIMIT 0.8f
 #define SRC_QUEUE_MAX_BYTES 20 * 1024 * 1024    /* For safety. Large enough to hold a segment. */
 #define NUM_LOOKBACK_FRAGMENTS 3
+#define DEFAULT_PREFETCH_FRAGMENTS 0
+#define MAX_PREFETCH_FRAGMENTS 16
 
 #define GST_MANIFEST_GET_LOCK(d) (&(GST_ADAPTIVE_DEMUX_CAST(d)->priv->manifest_lock))
 #define GST_MANIFEST_LOCK(d) G_STMT_START { \
@@ -157,6 +159,7 @@ enum
   PROP_0,
   PROP_CONNECTION_SPEED,
   PROP_BITRATE_LIMIT,
+  PROP_PREFETCH_FRAGMENTS,
   PROP_LAST
 };
 
@@ -207,8 +210,33 @@ struct _GstAdaptiveDemuxPrivate
   GMutex segment_lock;
 
   GstClockTime qos_earliest_time;
+
+  /* number of upcoming fragments downloaded in parallel per stream */
+  guint prefetch_fragments;     /* protected by manifest_lock */
+  GThreadPool *prefetch_pool;   /* MT safe */
 };
 
+/* A fragment downloaded ahead of time by a prefetch_pool thread with its
+ * own GstUriDownloader. Queued in stream->prefetch_queue in fragment order */
+typedef struct _GstAdaptiveDemuxPrefetch
+{
+  volatile gint ref_count;
+
+  GstUriDownloader *downloader;
+  gchar *uri;
+  gint64 range_start;
+  gint64 range_end;
+
+  GMutex lock;
+  GCond cond;
+  gboolean done;                /* protected by lock */
+  gboolean cancelled;           /* protected by lock */
+  GstBuffer *buffer;            /* protected by lock */
+  GError *error;                /* protected by lock */
+  GstClockTime start_time;      /* protected by lock */
+  GstClockTime stop_time;       /* protected by lock */
+} GstAdaptiveDemuxPrefetch;
+
 typedef struct _GstAdaptiveDemuxTimer
 {
   volatile gint ref_count;
@@ -306,6 +334,10 @@ static gboolean gst_adaptive_demux_clock_callback (GstClock * clock,
 static gboolean
 gst_adaptive_demux_requires_periodical_playlist_update_default (GstAdaptiveDemux
     * demux);
+static void gst_adaptive_demux_prefetch_func (gpointer data,
+    gpointer user_data);
+static void gst_adaptive_demux_stream_clear_prefetch (GstAdaptiveDemuxStream *
+    stream);
 
 /* we can't use G_DEFINE_ABSTRACT_TYPE because we need the klass in the _init
  * method to get to the padtemplates */
@@ -363,6 +395,9 @@ gst_adaptive_demux_set_property (GObject * object, guint prop_id,
     case PROP_BITRATE_LIMIT:
       demux->bitrate_limit = g_value_get_float (value);
       break;
+    case PROP_PREFETCH_FRAGMENTS:
+      demux->priv->prefetch_fragments = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -387,6 +422,9 @@ gst_adaptive_demux_get_property (GObject * object, guint prop_id,
     case PROP_BITRATE_LIMIT:
       g_value_set_float (value, demux->bitrate_limit);
       break;
+    case PROP_PREFETCH_FRAGMENTS:
+      g_value_set_uint (value, demux->priv->prefetch_fragments);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -432,6 +470,23 @@ gst_adaptive_demux_class_init (GstAdaptiveDemuxClass * klass)
           0, 1, DEFAULT_BITRATE_LIMIT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstAdaptiveDemux:prefetch-fragments:
+   *
+   * Number of upcoming fragments of each stream to download in parallel with
+   * the current one. The fragments are still pushed downstream in order.
+   * Only used for non-live streams and if the subclass implements
+   * stream_peek_fragment().
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_PREFETCH_FRAGMENTS,
+      g_param_spec_uint ("prefetch-fragments", "Prefetch fragments",
+          "Number of upcoming fragments to download in parallel "
+          "(0 = disabled)", 0, MAX_PREFETCH_FRAGMENTS,
+          DEFAULT_PREFETCH_FRAGMENTS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = gst_adaptive_demux_change_state;
 
   gstbin_class->handle_message = gst_adaptive_demux_handle_message;
@@ -509,6 +564,11 @@ gst_adaptive_demux_init (GstAdaptiveDemux * demux,
   g_cond_init (&demux->priv->preroll_cond);
   g_mutex_init (&demux->priv->preroll_lock);
 
+  /* threads are only spawned when fragments are actually prefetched */
+  demux->priv->prefetch_pool =
+      g_thread_pool_new (gst_adaptive_demux_prefetch_func, demux, -1, FALSE,
+      NULL);
+
   pad_template =
       gst_element_class_get_pad_template (GST_ELEMENT_CLASS (klass), "sink");
   g_return_if_fail (pad_template != NULL);
@@ -522,6 +582,7 @@ gst_adaptive_demux_init (GstAdaptiveDemux * demux,
   /* Properties */
   demux->bitrate_limit = DEFAULT_BITRATE_LIMIT;
   demux->connection_speed = DEFAULT_CONNECTION_SPEED;
+  demux->priv->prefetch_fragments = DEFAULT_PREFETCH_FRAGMENTS;
 
   gst_element_add_pad (GST_ELEMENT (demux), demux->sinkpad);
 }
@@ -534,6 +595,9 @@ gst_adaptive_demux_finalize (GObject * object)
 
   GST_DEBUG_OBJECT (object, "finalize");
 
+  /* pending prefetches were cancelled when the streams were freed */
+  g_thread_pool_free (priv->prefetch_pool, FALSE, TRUE);
+
   g_object_unref (priv->input_adapter);
   g_object_unref (demux->downloader);
 
@@ -1340,6 +1404,9 @@ gst_adaptive_demux_stream_new (GstAdaptiveDemux * demux, GstPad * pad)
   g_cond_init (&stream->fragment_download_cond);
   g_mutex_init (&stream->fragment_download_lock);
 
+  g_queue_init (&stream->prefetch_queue);
+  stream->busy_start = GST_CLOCK_TIME_NONE;
+
   demux->next_streams = g_list_append (demux->next_streams, stream);
 
   return stream;
@@ -1403,6 +1470,7 @@ gst_adaptive_demux_stream_free (GstAdaptiveDemuxStream * stream)
     stream->download_task = NULL;
   }
 
+  gst_adaptive_demux_stream_clear_prefetch (stream);
   gst_adaptive_demux_stream_fragment_clear (&stream->fragment);
 
   if (stream->pending_segment) {
@@ -2145,6 +2213,9 @@ gst_adaptive_demux_stop_tasks (GstAdaptiveDemux * demux, gboolean stop_updates)
       gst_task_stop (stream->download_task);
       g_cond_signal (&stream->fragment_download_cond);
       g_mutex_unlock (&stream->fragment_download_lock);
+
+      /* also wakes up a download task waiting for a prefetched fragment */
+      gst_adaptive_demux_stream_clear_prefetch (stream);
     }
     list_to_process = demux->prepared_streams;
   }
@@ -2272,6 +2343,42 @@ _update_average_bitrate (GstAdaptiveDemux * demux,
   return stream->moving_bitrate / stream->moving_index;
 }
 
+/* must be called with manifest_lock taken.
+ * Accounts for a fragment downloaded between @start and @stop. When fragments
+ * are prefetched their downloads overlap and the time of each one alone
+ * underestimates the link, so the bytes of the last fragments are divided by
+ * the time during which at least one of them was downloading instead */
+static void
+gst_adaptive_demux_stream_account_download (GstAdaptiveDemuxStream * stream,
+    GstClockTime start, GstClockTime stop, guint64 bytes)
+{
+  if (stop <= start || bytes == 0)
+    return;
+
+  if (!GST_CLOCK_TIME_IS_VALID (stream->busy_start)
+      || start > stream->busy_end
+      || stream->busy_fragments >= NUM_LOOKBACK_FRAGMENTS) {
+    stream->busy_start = start;
+    stream->busy_end = stop;
+    stream->busy_bytes = 0;
+    stream->busy_fragments = 0;
+  } else {
+    stream->busy_start = MIN (stream->busy_start, start);
+    stream->busy_end = MAX (stream->busy_end, stop);
+  }
+  stream->busy_bytes += bytes;
+  stream->busy_fragments++;
+
+  stream->last_bitrate = gst_util_uint64_scale (stream->busy_bytes,
+      8 * GST_SECOND, stream->busy_end - stream->busy_start);
+
+  GST_DEBUG_OBJECT (stream->pad, "%u fragments, %" G_GUINT64_FORMAT
+      " bytes in %" GST_TIME_FORMAT " bitrate %" G_GUINT64_FORMAT " bps",
+      stream->busy_fragments, stream->busy_bytes,
+      GST_TIME_ARGS (stream->busy_end - stream->busy_start),
+      stream->last_bitrate);
+}
+
 /* must be called with manifest_lock taken */
 static guint64
 gst_adaptive_demux_stream_update_current_bitrate (GstAdaptiveDemux * demux,
@@ -2578,31 +2685,16 @@ gst_adaptive_demux_requires_periodical_playlist_update_default (GstAdaptiveDemux
   return TRUE;
 }
 
+/* must be called with manifest_lock taken.
+ * Handles a buffer of the current fragment, coming either from the src
+ * element or from a prefetched download */
 static GstFlowReturn
-_src_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+gst_adaptive_demux_stream_handle_buffer (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStream * stream, GstBuffer * buffer)
 {
-  GstAdaptiveDemuxStream *stream;
-  GstAdaptiveDemux *demux;
-  GstAdaptiveDemuxClass *klass;
+  GstAdaptiveDemuxClass *klass = GST_ADAPTIVE_DEMUX_GET_CLASS (demux);
   GstFlowReturn ret = GST_FLOW_OK;
 
-  demux = GST_ADAPTIVE_DEMUX_CAST (parent);
-  stream = gst_pad_get_element_private (pad);
-  klass = GST_ADAPTIVE_DEMUX_GET_CLASS (demux);
-
-  GST_MANIFEST_LOCK (demux);
-
-  /* do not make any changes if the stream is cancelled */
-  g_mutex_lock (&stream->fragment_download_lock);
-  if (G_UNLIKELY (stream->cancelled)) {
-    g_mutex_unlock (&stream->fragment_download_lock);
-    gst_buffer_unref (buffer);
-    ret = stream->last_ret = GST_FLOW_FLUSHING;
-    GST_MANIFEST_UNLOCK (demux);
-    return ret;
-  }
-  g_mutex_unlock (&stream->fragment_download_lock);
-
   /* starting_fragment is set to TRUE at the beginning of
    * _stream_download_fragment()
    * /!\ If there is a header/index being downloaded, then this will
@@ -2664,7 +2756,7 @@ _src_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
        * and we don't have a birate from the sub-class, then see if we
        * can work it out from the fragment size and duration */
       if (stream->fragment.bitrate == 0 &&
-          stream->fragment.duration != 0 &&
+          stream->fragment.duration != 0 && stream->uri_handler &&
           gst_element_query_duration (stream->uri_handler, GST_FORMAT_BYTES,
               &chunk_size) && chunk_size != -1) {
         guint bitrate = MIN (G_MAXUINT, gst_util_uint64_scale (chunk_size,
@@ -2695,7 +2787,6 @@ _src_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     g_mutex_lock (&stream->fragment_download_lock);
     if (G_UNLIKELY (stream->cancelled)) {
       g_mutex_unlock (&stream->fragment_download_lock);
-      GST_MANIFEST_UNLOCK (demux);
       return ret;
     }
     g_mutex_unlock (&stream->fragment_download_lock);
@@ -2735,6 +2826,34 @@ _src_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
 error:
 
+  return ret;
+}
+
+static GstFlowReturn
+_src_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstAdaptiveDemuxStream *stream;
+  GstAdaptiveDemux *demux;
+  GstFlowReturn ret;
+
+  demux = GST_ADAPTIVE_DEMUX_CAST (parent);
+  stream = gst_pad_get_element_private (pad);
+
+  GST_MANIFEST_LOCK (demux);
+
+  /* do not make any changes if the stream is cancelled */
+  g_mutex_lock (&stream->fragment_download_lock);
+  if (G_UNLIKELY (stream->cancelled)) {
+    g_mutex_unlock (&stream->fragment_download_lock);
+    gst_buffer_unref (buffer);
+    ret = stream->last_ret = GST_FLOW_FLUSHING;
+    GST_MANIFEST_UNLOCK (demux);
+    return ret;
+  }
+  g_mutex_unlock (&stream->fragment_download_lock);
+
+  ret = gst_adaptive_demux_stream_handle_buffer (demux, stream, buffer);
+
   GST_MANIFEST_UNLOCK (demux);
 
   return ret;
@@ -2789,6 +2908,17 @@ gst_adaptive_demux_eos_handling (GstAdaptiveDemuxStream * stream)
       stream->fragment.bitrate = bitrate;
       stream->bitrate_changed = TRUE;
     }
+
+    /* downloads overlap with prefetching, the bitrate of this one alone
+     * is meaningless */
+    if (stream->demux->priv->prefetch_fragments > 0 &&
+        !stream->downloading_index && !stream->downloading_header) {
+      GstClockTime start = stream->download_start_time * GST_USECOND;
+
+      gst_adaptive_demux_stream_account_download (stream, start,
+          start + stream->last_download_time,
+          stream->fragment_bytes_downloaded);
+    }
     ret = klass->finish_fragment (stream->demux, stream);
   }
   gst_adaptive_demux_stream_fragment_download_finish (stream, ret, NULL);
@@ -3385,6 +3515,252 @@ gst_adaptive_demux_stream_download_header_fragment (GstAdaptiveDemuxStream *
   return ret;
 }
 
+static GstAdaptiveDemuxPrefetch *
+gst_adaptive_demux_prefetch_new (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStreamFragment * fragment)
+{
+  GstAdaptiveDemuxPrefetch *prefetch = g_new0 (GstAdaptiveDemuxPrefetch, 1);
+
+  prefetch->ref_count = 1;
+  prefetch->downloader = gst_uri_downloader_new ();
+  gst_uri_downloader_set_parent (prefetch->downloader,
+      GST_ELEMENT_CAST (demux));
+  prefetch->uri = g_strdup (fragment->uri);
+  prefetch->range_start = fragment->range_start;
+  prefetch->range_end = fragment->range_end;
+  g_mutex_init (&prefetch->lock);
+  g_cond_init (&prefetch->cond);
+  prefetch->start_time = GST_CLOCK_TIME_NONE;
+  prefetch->stop_time = GST_CLOCK_TIME_NONE;
+
+  return prefetch;
+}
+
+static GstAdaptiveDemuxPrefetch *
+gst_adaptive_demux_prefetch_ref (GstAdaptiveDemuxPrefetch * prefetch)
+{
+  g_atomic_int_inc (&prefetch->ref_count);
+  return prefetch;
+}
+
+static void
+gst_adaptive_demux_prefetch_unref (GstAdaptiveDemuxPrefetch * prefetch)
+{
+  if (!g_atomic_int_dec_and_test (&prefetch->ref_count))
+    return;
+
+  g_object_unref (prefetch->downloader);
+  g_free (prefetch->uri);
+  if (prefetch->buffer)
+    gst_buffer_unref (prefetch->buffer);
+  g_clear_error (&prefetch->error);
+  g_mutex_clear (&prefetch->lock);
+  g_cond_clear (&prefetch->cond);
+  g_free (prefetch);
+}
+
+static void
+gst_adaptive_demux_prefetch_cancel (GstAdaptiveDemuxPrefetch * prefetch)
+{
+  g_mutex_lock (&prefetch->lock);
+  prefetch->cancelled = TRUE;
+  g_cond_broadcast (&prefetch->cond);
+  g_mutex_unlock (&prefetch->lock);
+
+  gst_uri_downloader_cancel (prefetch->downloader);
+}
+
+/* runs in a prefetch_pool thread, without any demux lock */
+static void
+gst_adaptive_demux_prefetch_func (gpointer data, gpointer user_data)
+{
+  GstAdaptiveDemuxPrefetch *prefetch = data;
+  GstAdaptiveDemux *demux = user_data;
+  GstFragment *download;
+  GstClockTime start_time;
+  GError *err = NULL;
+
+  start_time = gst_adaptive_demux_get_monotonic_time (demux);
+
+  GST_DEBUG_OBJECT (demux, "Prefetching %s, range:%" G_GINT64_FORMAT " - %"
+      G_GINT64_FORMAT, prefetch->uri, prefetch->range_start,
+      prefetch->range_end);
+
+  download = gst_uri_downloader_fetch_uri_with_range (prefetch->downloader,
+      prefetch->uri, NULL, FALSE, FALSE, TRUE, prefetch->range_start,
+      prefetch->range_end, &err);
+
+  g_mutex_lock (&prefetch->lock);
+  prefetch->start_time = start_time;
+  prefetch->stop_time = gst_adaptive_demux_get_monotonic_time (demux);
+  if (download) {
+    prefetch->buffer = gst_fragment_get_buffer (download);
+    g_object_unref (download);
+  }
+  prefetch->error = err;
+  prefetch->done = TRUE;
+  g_cond_broadcast (&prefetch->cond);
+  g_mutex_unlock (&prefetch->lock);
+
+  GST_DEBUG_OBJECT (demux, "Prefetch of %s done: %s", prefetch->uri,
+      prefetch->buffer ? "ok" : "failed");
+
+  gst_adaptive_demux_prefetch_unref (prefetch);
+}
+
+/* must be called with manifest_lock taken */
+static void
+gst_adaptive_demux_stream_clear_prefetch (GstAdaptiveDemuxStream * stream)
+{
+  GstAdaptiveDemuxPrefetch *prefetch;
+
+  while ((prefetch = g_queue_pop_head (&stream->prefetch_queue))) {
+    gst_adaptive_demux_prefetch_cancel (prefetch);
+    gst_adaptive_demux_prefetch_unref (prefetch);
+  }
+}
+
+/* must be called with manifest_lock taken.
+ * Makes sure the fragments following the current one are being prefetched
+ * and returns the prefetch of the current fragment, if there is one */
+static GstAdaptiveDemuxPrefetch *
+gst_adaptive_demux_stream_prefetch (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStream * stream)
+{
+  GstAdaptiveDemuxClass *klass = GST_ADAPTIVE_DEMUX_GET_CLASS (demux);
+  GstAdaptiveDemuxPrefetch *current;
+  guint n;
+
+  /* the queue only goes out of sync with the stream after a bitrate or
+   * representation switch, start over in that case */
+  current = g_queue_peek_head (&stream->prefetch_queue);
+  if (current && (g_strcmp0 (current->uri, stream->fragment.uri) != 0
+          || current->range_start != stream->fragment.range_start
+          || current->range_end != stream->fragment.range_end)) {
+    GST_DEBUG_OBJECT (stream->pad, "Discarding %u prefetched fragments",
+        g_queue_get_length (&stream->prefetch_queue));
+    gst_adaptive_demux_stream_clear_prefetch (stream);
+    current = NULL;
+  }
+
+  n = g_queue_get_length (&stream->prefetch_queue);
+  if (current == NULL)
+    n++;
+
+  for (; n <= demux->priv->prefetch_fragments; n++) {
+    GstAdaptiveDemuxStreamFragment fragment = { 0, };
+    GstAdaptiveDemuxPrefetch *prefetch;
+
+    fragment.range_end = -1;
+    if (klass->stream_peek_fragment (stream, n, &fragment) != GST_FLOW_OK
+        || fragment.uri == NULL) {
+      gst_adaptive_demux_stream_fragment_clear (&fragment);
+      break;
+    }
+
+    prefetch = gst_adaptive_demux_prefetch_new (demux, &fragment);
+    gst_adaptive_demux_stream_fragment_clear (&fragment);
+
+    g_queue_push_tail (&stream->prefetch_queue, prefetch);
+    g_thread_pool_push (demux->priv->prefetch_pool,
+        gst_adaptive_demux_prefetch_ref (prefetch), NULL);
+  }
+
+  return current ? gst_adaptive_demux_prefetch_ref (current) : NULL;
+}
+
+/* must be called with manifest_lock taken.
+ * Can temporarily release manifest_lock
+ *
+ * Waits for @prefetch to complete and handles its data as if it had been
+ * downloaded by the src element. Returns %FALSE if the prefetch failed and
+ * the fragment has to be downloaded again */
+static gboolean
+gst_adaptive_demux_stream_download_prefetched (GstAdaptiveDemux * demux,
+    GstAdaptiveDemuxStream * stream, GstAdaptiveDemuxPrefetch * prefetch,
+    GstFlowReturn * ret)
+{
+  GstBuffer *buffer = NULL;
+  GstClockTime start_time = GST_CLOCK_TIME_NONE, stop_time = 0;
+
+  GST_DEBUG_OBJECT (stream->pad, "Waiting for prefetched fragment %s",
+      prefetch->uri);
+
+  GST_MANIFEST_UNLOCK (demux);
+  g_mutex_lock (&prefetch->lock);
+  while (!prefetch->done && !prefetch->cancelled)
+    g_cond_wait (&prefetch->cond, &prefetch->lock);
+  if (prefetch->done) {
+    if (prefetch->buffer) {
+      buffer = gst_buffer_ref (prefetch->buffer);
+      start_time = prefetch->start_time;
+      stop_time = prefetch->stop_time;
+    } else {
+      GST_WARNING_OBJECT (stream->pad, "Prefetching %s failed: %s",
+          prefetch->uri, prefetch->error ? prefetch->error->message :
+          "unknown error");
+    }
+  }
+  g_mutex_unlock (&prefetch->lock);
+  GST_MANIFEST_LOCK (demux);
+
+  g_mutex_lock (&stream->fragment_download_lock);
+  if (G_UNLIKELY (stream->cancelled)) {
+    g_mutex_unlock (&stream->fragment_download_lock);
+    if (buffer)
+      gst_buffer_unref (buffer);
+    *ret = stream->last_ret = GST_FLOW_FLUSHING;
+    return TRUE;
+  }
+  g_mutex_unlock (&stream->fragment_download_lock);
+
+  if (g_queue_peek_head (&stream->prefetch_queue) == prefetch)
+    gst_adaptive_demux_prefetch_unref (g_queue_pop_head
+        (&stream->prefetch_queue));
+
+  if (buffer == NULL)
+    return FALSE;
+
+  /* what _uri_handler_probe() would have measured */
+  stream->download_start_time = GST_TIME_AS_USECONDS (start_time);
+  stream->last_download_time = stop_time - start_time;
+  stream->fragment_bytes_downloaded = gst_buffer_get_size (buffer);
+  if (stream->last_download_time > 0)
+    stream->last_bitrate =
+        gst_util_uint64_scale (stream->fragment_bytes_downloaded,
+        8 * GST_SECOND, stream->last_download_time);
+
+  /* the src element still reports the size of its last download, use the
+   * one of the buffer for the nominal bitrate */
+  if (stream->fragment.bitrate == 0 && stream->fragment.duration != 0)
+    stream->fragment.bitrate = MIN (G_MAXUINT,
+        gst_util_uint64_scale (stream->fragment_bytes_downloaded,
+            8 * GST_SECOND, stream->fragment.duration));
+
+  g_mutex_lock (&stream->fragment_download_lock);
+  stream->download_finished = FALSE;
+  stream->downloading_first_buffer = TRUE;
+  g_mutex_unlock (&stream->fragment_download_lock);
+
+  *ret = gst_adaptive_demux_stream_handle_buffer (demux, stream, buffer);
+
+  g_mutex_lock (&stream->fragment_download_lock);
+  if (G_UNLIKELY (stream->cancelled)) {
+    g_mutex_unlock (&stream->fragment_download_lock);
+    *ret = stream->last_ret = GST_FLOW_FLUSHING;
+    return TRUE;
+  }
+  g_mutex_unlock (&stream->fragment_download_lock);
+
+  /* the src element would send EOS after anything but flushing */
+  if (*ret != GST_FLOW_FLUSHING)
+    gst_adaptive_demux_eos_handling (stream);
+
+  *ret = stream->last_ret;
+
+  return TRUE;
+}
+
 /* must be called with manifest_lock taken.
  * Can temporarily release manifest_lock
  */
@@ -3395,7 +3771,8 @@ gst_adaptive_demux_stream_download_fragment (GstAdaptiveDemuxStream * stream)
   GstAdaptiveDemuxClass *klass = GST_ADAPTIVE_DEMUX_GET_CLASS (demux);
   gchar *url = NULL;
   GstFlowReturn ret;
-  gboolean retried_once = FALSE, live;
+  gboolean retried_once = FALSE, live, chunked;
+  GstAdaptiveDemuxPrefetch *prefetch;
   guint http_status;
   guint last_status_code;
 
@@ -3432,9 +3809,21 @@ again:
   stream->last_ret = GST_FLOW_OK;
   http_status = 200;
 
+  chunked = klass->need_another_chunk && klass->need_another_chunk (stream)
+      && stream->fragment.chunk_size != 0;
+
+  /* Keep the next fragments downloading while handling this one */
+  prefetch = NULL;
+  if (!chunked && !retried_once && demux->priv->prefetch_fragments > 0
+      && klass->stream_peek_fragment && !gst_adaptive_demux_is_live (demux))
+    prefetch = gst_adaptive_demux_stream_prefetch (demux, stream);
+
   /* Download the actual fragment, either in fragments or in one go */
-  if (klass->need_another_chunk && klass->need_another_chunk (stream)
-      && stream->fragment.chunk_size != 0) {
+  if (prefetch && gst_adaptive_demux_stream_download_prefetched (demux, stream,
+          prefetch, &ret)) {
+    GST_DEBUG_OBJECT (stream->pad, "Prefetched fragment result: %d %s",
+        stream->last_ret, gst_flow_get_name (stream->last_ret));
+  } else if (chunked) {
     /* Handle chunk downloading */
     gint64 range_start, range_end, chunk_start, chunk_end;
     guint64 download_total_bytes;
@@ -3509,6 +3898,8 @@ again:
     GST_DEBUG_OBJECT (stream->pad, "Fragment download result: %d (%d) %s",
         stream->last_ret, http_status, gst_flow_get_name (stream->last_ret));
   }
+  if (prefetch)
+    gst_adaptive_demux_prefetch_unref (prefetch);
   if (ret == GST_FLOW_OK)
     goto beach;
 
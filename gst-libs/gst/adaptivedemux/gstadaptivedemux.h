@@ -195,6 +195,17 @@ struct _GstAdaptiveDemuxStream
   gboolean eos;
 
   gboolean do_block; /* TRUE if stream should block on preroll */
+
+  /* upcoming fragments being downloaded in parallel, see the
+   * prefetch-fragments property */
+  GQueue prefetch_queue;
+
+  /* hull of the overlapping download intervals of the last fragments
+   * (pre-queue2), used to estimate the bitrate when prefetching */
+  GstClockTime busy_start;
+  GstClockTime busy_end;
+  guint64 busy_bytes;
+  guint busy_fragments;
 };
 
 /**
@@ -482,6 +493,24 @@ struct _GstAdaptiveDemuxClass
    * Return: %TRUE if the playlist needs to be refreshed periodically by the demuxer.
    */
   gboolean (*requires_periodical_playlist_update) (GstAdaptiveDemux * demux);
+
+  /**
+   * stream_peek_fragment:
+   * @stream: #GstAdaptiveDemuxStream
+   * @n: position of the fragment to look at, 1 being the one following the
+   *     current fragment
+   * @fragment: #GstAdaptiveDemuxStreamFragment to fill
+   *
+   * Optional. Sets the uri, range and duration of the fragment @n positions
+   * after the current one in @fragment, without advancing the stream. Used
+   * to download upcoming fragments in parallel when the
+   * #GstAdaptiveDemux:prefetch-fragments property is set.
+   *
+   * Returns: #GST_FLOW_OK if the fragment is known, #GST_FLOW_EOS otherwise
+   *
+   * Since: 1.20
+   */
+  GstFlowReturn (*stream_peek_fragment) (GstAdaptiveDemuxStream * stream, guint n, GstAdaptiveDemuxStreamFragment * fragment);
 };
 
 GST_ADAPTIVE_DEMUX_API
@@ -36,6 +36,7 @@
 #endif
 
 #include "nalutils.h"
+#include "startcodeutils.h"
 #include <string.h>
 
 /* Compute Ceil(Log2(v)) */
@@ -64,6 +65,33 @@ ceil_log2 (guint32 v)
 
 /****** Nal parser ******/
 
+/* Returns the position of the first emulation_prevention_three_byte at or
+ * after @pos, or the size of the data if there is none */
+static guint
+nal_reader_find_epb (const NalReader * nr, guint pos)
+{
+  const guint8 *data = nr->data;
+  guint size = nr->size;
+  guint i;
+
+  /* the 0x03 of an emulation prevention byte is preceded by two zeros */
+  i = pos >= 2 ? pos - 2 : 0;
+
+  while (i + 3 <= size) {
+    if (data[i + 2] > 3) {
+      i += 3;
+    } else if (data[i + 1]) {
+      i += 2;
+    } else if (data[i] || data[i + 2] != 3) {
+      i++;
+    } else {
+      return i + 2;
+    }
+  }
+
+  return size;
+}
+
 void
 nal_reader_init (NalReader * nr, const guint8 * data, guint size)
 {
@@ -73,39 +101,65 @@ nal_reader_init (NalReader * nr, const guint8 * data, guint size)
 
   nr->byte = 0;
   nr->bits_in_cache = 0;
-  /* fill with something other than 0 to detect emulation prevention bytes */
-  nr->first_byte = 0xff;
-  nr->epb_cache = 0xff;
-  nr->cache = 0xff;
+  nr->cache = 0;
+  nr->next_epb = nal_reader_find_epb (nr, 0);
 }
 
-gboolean
-nal_reader_read (NalReader * nr, guint nbits)
+/* Tries to have at least @nbits (<= 32) available in the cache.
+ *
+ * The cache is filled with as many bytes as fit in it, up to the next
+ * emulation prevention byte. That byte is only skipped (if @skip_epb) once
+ * the bits preceding it are not enough to satisfy the request, so as long
+ * as the caller consumes @nbits, all the skipped bytes are before the
+ * current position and nal_reader_get_pos() and nal_reader_get_epb_count()
+ * remain exact. */
+static inline gboolean
+nal_reader_fill (NalReader * nr, guint nbits, gboolean skip_epb)
 {
-  if (G_UNLIKELY (nr->byte * 8 + (nbits - nr->bits_in_cache) > nr->size * 8)) {
-    GST_DEBUG ("Can not read %u bits, bits in cache %u, Byte * 8 %u, size in "
-        "bits %u", nbits, nr->bits_in_cache, nr->byte * 8, nr->size * 8);
-    return FALSE;
-  }
-
   while (nr->bits_in_cache < nbits) {
-    guint8 byte;
+    guint avail, n;
 
-  next_byte:
-    if (G_UNLIKELY (nr->byte >= nr->size))
-      return FALSE;
+    if (G_UNLIKELY (nr->byte == nr->next_epb && nr->byte < nr->size)) {
+      if (!skip_epb)
+        return FALSE;
+      nr->byte++;
+      nr->n_epb++;
+      nr->next_epb = nal_reader_find_epb (nr, nr->byte);
+    }
 
-    byte = nr->data[nr->byte++];
-    nr->epb_cache = (nr->epb_cache << 8) | byte;
+    avail = nr->next_epb - nr->byte;
+    if (G_UNLIKELY (avail == 0))
+      return FALSE;
 
-    /* check if the byte is a emulation_prevention_three_byte */
-    if ((nr->epb_cache & 0xffffff) == 0x3) {
-      nr->n_epb++;
-      goto next_byte;
+    /* number of whole bytes that fit in the cache */
+    n = (64 - nr->bits_in_cache) >> 3;
+
+    if (G_LIKELY (avail >= n && nr->byte + 8 <= nr->size)) {
+      guint64 val = GST_READ_UINT64_BE (nr->data + nr->byte);
+
+      nr->cache |= (val >> (64 - 8 * n)) << (64 - nr->bits_in_cache - 8 * n);
+      nr->byte += n;
+      nr->bits_in_cache += 8 * n;
+    } else {
+      n = MIN (n, avail);
+      while (n--) {
+        nr->cache |=
+            (guint64) nr->data[nr->byte++] << (56 - nr->bits_in_cache);
+        nr->bits_in_cache += 8;
+      }
     }
-    nr->cache = (nr->cache << 8) | nr->first_byte;
-    nr->first_byte = byte;
-    nr->bits_in_cache += 8;
+  }
+
+  return TRUE;
+}
+
+gboolean
+nal_reader_read (NalReader * nr, guint nbits)
+{
+  if (G_UNLIKELY (!nal_reader_fill (nr, nbits, TRUE))) {
+    GST_DEBUG ("Can not read %u bits, bits in cache %u, Byte * 8 %u, size in "
+        "bits %u", nbits, nr->bits_in_cache, nr->byte * 8, nr->size * 8);
+    return FALSE;
   }
 
   return TRUE;
@@ -118,10 +172,16 @@ nal_reader_skip (NalReader * nr, guint nbits)
 {
   g_assert (nbits <= 8 * sizeof (nr->cache));
 
-  if (G_UNLIKELY (!nal_reader_read (nr, nbits)))
-    return FALSE;
+  while (nbits > 0) {
+    guint n = MIN (nbits, 32);
 
-  nr->bits_in_cache -= nbits;
+    if (G_UNLIKELY (!nal_reader_read (nr, n)))
+      return FALSE;
+
+    nr->cache <<= n;
+    nr->bits_in_cache -= n;
+    nbits -= n;
+  }
 
   return TRUE;
 }
@@ -130,8 +190,7 @@ nal_reader_skip (NalReader * nr, guint nbits)
 gboolean
 nal_reader_skip_long (NalReader * nr, guint nbits)
 {
-  /* Leave out enough bits in the cache once we are finished */
-  const guint skip_size = 4 * sizeof (nr->cache);
+  const guint skip_size = 32;
   guint remaining = nbits;
 
   nbits %= skip_size;
@@ -166,21 +225,22 @@ nal_reader_get_epb_count (const NalReader * nr)
 gboolean \
 nal_reader_get_bits_uint##bits (NalReader *nr, guint##bits *val, guint nbits) \
 { \
-  guint shift; \
-  \
-  if (!nal_reader_read (nr, nbits)) \
+  /* a read wider than @val keeps its least significant bits, some syntax \
+   * elements have a bitstream defined length exceeding their storage */ \
+  if (G_UNLIKELY (nbits > 32)) \
     return FALSE; \
   \
-  /* bring the required bits down and truncate */ \
-  shift = nr->bits_in_cache - nbits; \
-  *val = nr->first_byte >> shift; \
+  if (G_UNLIKELY (nbits == 0)) { \
+    *val = 0; \
+    return TRUE; \
+  } \
   \
-  *val |= nr->cache << (8 - shift); \
-  /* mask out required bits */ \
-  if (nbits < bits) \
-    *val &= ((guint##bits)1 << nbits) - 1; \
+  if (G_UNLIKELY (nr->bits_in_cache < nbits && !nal_reader_read (nr, nbits))) \
+    return FALSE; \
   \
-  nr->bits_in_cache = shift; \
+  *val = (guint##bits) (nr->cache >> (64 - nbits)); \
+  nr->cache <<= nbits; \
+  nr->bits_in_cache -= nbits; \
   \
   return TRUE; \
 } \
@@ -208,6 +268,25 @@ nal_reader_get_ue (NalReader * nr, guint32 * val)
   guint8 bit;
   guint32 value;
 
+  /* Fast path: the whole code is in the cache. The code may be shorter than
+   * what is loaded here, so don't go past emulation prevention bytes */
+  if (nr->bits_in_cache < 32)
+    nal_reader_fill (nr, 32, FALSE);
+
+  if (G_LIKELY (nr->cache >> 32)) {
+    /* bits past bits_in_cache are zero, so the leading one is valid */
+    i = 31 - g_bit_nth_msf ((gulong) (nr->cache >> 32), -1);
+
+    if (G_LIKELY (2 * i + 1 <= nr->bits_in_cache)) {
+      value = i ? (guint32) ((nr->cache << (i + 1)) >> (64 - i)) : 0;
+      nr->cache <<= 2 * i + 1;
+      nr->bits_in_cache -= 2 * i + 1;
+      *val = (1 << i) - 1 + value;
+      return TRUE;
+    }
+    i = 0;
+  }
+
   if (G_UNLIKELY (!nal_reader_get_bits_uint8 (nr, &bit, 1)))
     return FALSE;
 
@@ -247,7 +326,7 @@ nal_reader_get_se (NalReader * nr, gint32 * val)
 gboolean
 nal_reader_is_byte_aligned (NalReader * nr)
 {
-  if (nr->bits_in_cache != 0)
+  if (nr->bits_in_cache % 8 != 0)
     return FALSE;
   return TRUE;
 }
@@ -298,12 +377,8 @@ nal_reader_has_more_data (NalReader * nr)
 gint
 scan_for_start_codes (const guint8 * data, guint size)
 {
-  GstByteReader br;
-  gst_byte_reader_init (&br, data, size);
-
   /* NALU not empty, so we can at least expect 1 (even 2) bytes following sc */
-  return gst_byte_reader_masked_scan_uint32 (&br, 0xffffff00, 0x00000100,
-      0, size);
+  return find_start_code (data, size);
 }
 
 void
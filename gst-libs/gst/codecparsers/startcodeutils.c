@@ -0,0 +1,229 @@
+/* Gstreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * 0x000001 start code scanning shared by the MPEG-1/2/4, VC-1, H.264 and
+ * H.265 parsers. The SIMD variants compare 16 (or 32) candidate positions
+ * at once and only look at the 3 bytes pattern when the middle byte of at
+ * least one candidate is zero, which is the rare case in coded slice data.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "startcodeutils.h"
+
+#if defined (__SSE2__) || defined (_M_X64) || \
+    (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_SCAN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined (HAVE_SCAN_SSE2) && defined (__GNUC__) && \
+    (defined (__x86_64__) || defined (__i386__)) && \
+    (defined (__clang__) || __GNUC__ > 4 || \
+        (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define HAVE_SCAN_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined (__ARM_NEON) && defined (__aarch64__)
+#define HAVE_SCAN_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef gint (*FindStartCodeFunc) (const guint8 * data, guint size);
+
+static FindStartCodeFunc find_start_code_func;
+
+/* Scalar version, starting the search at offset @i */
+static inline gint
+find_start_code_c_from (const guint8 * data, guint size, guint i)
+{
+  /* we can't find the pattern with less than 4 bytes */
+  if (G_UNLIKELY (size < 4))
+    return -1;
+
+  while (i <= (size - 4)) {
+    if (data[i + 2] > 1) {
+      i += 3;
+    } else if (data[i + 1]) {
+      i += 2;
+    } else if (data[i] || data[i + 2] != 1) {
+      i++;
+    } else {
+      return i;
+    }
+  }
+
+  /* nothing found */
+  return -1;
+}
+
+static gint
+find_start_code_c (const guint8 * data, guint size)
+{
+  return find_start_code_c_from (data, size, 0);
+}
+
+#ifdef HAVE_SCAN_SSE2
+static gint
+find_start_code_sse2 (const guint8 * data, guint size)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  const __m128i one = _mm_set1_epi8 (1);
+  guint i = 0;
+
+  /* 16 candidates per iteration, each needing 4 readable bytes */
+  while (i + 19 <= size) {
+    __m128i v0, v1, v2, m;
+    gint mask;
+
+    v1 = _mm_loadu_si128 ((const __m128i *) (data + i + 1));
+    m = _mm_cmpeq_epi8 (v1, zero);
+    if (G_LIKELY (_mm_movemask_epi8 (m) == 0)) {
+      i += 16;
+      continue;
+    }
+
+    v0 = _mm_loadu_si128 ((const __m128i *) (data + i));
+    v2 = _mm_loadu_si128 ((const __m128i *) (data + i + 2));
+    m = _mm_and_si128 (m, _mm_cmpeq_epi8 (v0, zero));
+    m = _mm_and_si128 (m, _mm_cmpeq_epi8 (v2, one));
+
+    mask = _mm_movemask_epi8 (m);
+    if (mask)
+      return i + g_bit_nth_lsf ((guint32) mask, -1);
+
+    i += 16;
+  }
+
+  return find_start_code_c_from (data, size, i);
+}
+#endif
+
+#ifdef HAVE_SCAN_AVX2
+__attribute__ ((target ("avx2")))
+static gint
+find_start_code_avx2 (const guint8 * data, guint size)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i one = _mm256_set1_epi8 (1);
+  guint i = 0;
+
+  /* 32 candidates per iteration, each needing 4 readable bytes */
+  while (i + 35 <= size) {
+    __m256i v0, v1, v2, m;
+    guint32 mask;
+
+    v1 = _mm256_loadu_si256 ((const __m256i *) (data + i + 1));
+    m = _mm256_cmpeq_epi8 (v1, zero);
+    if (G_LIKELY (_mm256_movemask_epi8 (m) == 0)) {
+      i += 32;
+      continue;
+    }
+
+    v0 = _mm256_loadu_si256 ((const __m256i *) (data + i));
+    v2 = _mm256_loadu_si256 ((const __m256i *) (data + i + 2));
+    m = _mm256_and_si256 (m, _mm256_cmpeq_epi8 (v0, zero));
+    m = _mm256_and_si256 (m, _mm256_cmpeq_epi8 (v2, one));
+
+    mask = (guint32) _mm256_movemask_epi8 (m);
+    if (mask)
+      return i + g_bit_nth_lsf (mask, -1);
+
+    i += 32;
+  }
+
+  return find_start_code_c_from (data, size, i);
+}
+#endif
+
+#ifdef HAVE_SCAN_NEON
+static gint
+find_start_code_neon (const guint8 * data, guint size)
+{
+  const uint8x16_t zero = vdupq_n_u8 (0);
+  const uint8x16_t one = vdupq_n_u8 (1);
+  guint i = 0;
+
+  /* 16 candidates per iteration, each needing 4 readable bytes */
+  while (i + 19 <= size) {
+    uint8x16_t v0, v1, v2, m;
+    guint8 hits[16];
+    guint j;
+
+    v1 = vld1q_u8 (data + i + 1);
+    m = vceqq_u8 (v1, zero);
+    if (G_LIKELY (vmaxvq_u8 (m) == 0)) {
+      i += 16;
+      continue;
+    }
+
+    v0 = vld1q_u8 (data + i);
+    v2 = vld1q_u8 (data + i + 2);
+    m = vandq_u8 (m, vceqq_u8 (v0, zero));
+    m = vandq_u8 (m, vceqq_u8 (v2, one));
+
+    if (vmaxvq_u8 (m) != 0) {
+      vst1q_u8 (hits, m);
+      for (j = 0; j < 16; j++) {
+        if (hits[j])
+          return i + j;
+      }
+    }
+
+    i += 16;
+  }
+
+  return find_start_code_c_from (data, size, i);
+}
+#endif
+
+static gpointer
+find_start_code_init (gpointer data)
+{
+  find_start_code_func = find_start_code_c;
+
+#ifdef HAVE_SCAN_SSE2
+  find_start_code_func = find_start_code_sse2;
+#endif
+
+#ifdef HAVE_SCAN_AVX2
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    find_start_code_func = find_start_code_avx2;
+#endif
+
+#ifdef HAVE_SCAN_NEON
+  find_start_code_func = find_start_code_neon;
+#endif
+
+  return NULL;
+}
+
+gint
+find_start_code (const guint8 * data, guint size)
+{
+  static GOnce once = G_ONCE_INIT;
+
+  g_once (&once, find_start_code_init, NULL);
+
+  return find_start_code_func (data, size);
+}
@@ -0,0 +1,33 @@
+/* Gstreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __START_CODE_UTILS_H__
+#define __START_CODE_UTILS_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* Returns the offset of the first 0x00 0x00 0x01 start code prefix in @data
+ * that is followed by at least one byte, or -1 if there is none */
+G_GNUC_INTERNAL
+gint find_start_code (const guint8 * data, guint size);
+
+G_END_DECLS
+
+#endif /* __START_CODE_UTILS_H__ */
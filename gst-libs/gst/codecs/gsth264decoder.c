@@ -237,33 +237,21 @@ gst_h264_decoder_init (GstH264Decoder * self)
 
   priv->ref_pic_list_p0 = g_array_sized_new (FALSE, TRUE,
       sizeof (GstH264Picture *), 32);
-  g_array_set_clear_func (priv->ref_pic_list_p0,
-      (GDestroyNotify) gst_h264_picture_clear);
 
   priv->ref_pic_list_b0 = g_array_sized_new (FALSE, TRUE,
       sizeof (GstH264Picture *), 32);
-  g_array_set_clear_func (priv->ref_pic_list_b0,
-      (GDestroyNotify) gst_h264_picture_clear);
 
   priv->ref_pic_list_b1 = g_array_sized_new (FALSE, TRUE,
       sizeof (GstH264Picture *), 32);
-  g_array_set_clear_func (priv->ref_pic_list_b1,
-      (GDestroyNotify) gst_h264_picture_clear);
 
   priv->ref_frame_list_0_short_term = g_array_sized_new (FALSE, TRUE,
       sizeof (GstH264Picture *), 32);
-  g_array_set_clear_func (priv->ref_frame_list_0_short_term,
-      (GDestroyNotify) gst_h264_picture_clear);
 
   priv->ref_frame_list_1_short_term = g_array_sized_new (FALSE, TRUE,
       sizeof (GstH264Picture *), 32);
-  g_array_set_clear_func (priv->ref_frame_list_1_short_term,
-      (GDestroyNotify) gst_h264_picture_clear);
 
   priv->ref_frame_list_long_term = g_array_sized_new (FALSE, TRUE,
       sizeof (GstH264Picture *), 32);
-  g_array_set_clear_func (priv->ref_frame_list_long_term,
-      (GDestroyNotify) gst_h264_picture_clear);
 
   priv->ref_pic_list0 = g_array_sized_new (FALSE, TRUE,
       sizeof (GstH264Picture *), 32);
@@ -1741,7 +1729,8 @@ gst_h264_decoder_sliding_window_picture_marking (GstH264Decoder * self,
         "Unmark reference flag of picture %p (frame_num %d, poc %d)",
         to_unmark, to_unmark->frame_num, to_unmark->pic_order_cnt);
 
-    gst_h264_picture_set_reference (to_unmark, GST_H264_PICTURE_REF_NONE, TRUE);
+    gst_h264_dpb_set_reference (priv->dpb, to_unmark,
+        GST_H264_PICTURE_REF_NONE, TRUE);
     gst_h264_picture_unref (to_unmark);
 
     num_ref_pics--;
@@ -2232,6 +2221,37 @@ long_term_pic_num_asc_compare (const GstH264Picture ** a,
   return (*a)->long_term_pic_num - (*b)->long_term_pic_num;
 }
 
+/* The reference picture lists don't hold a reference on the pictures, which
+ * are kept alive by the DPB while the current picture is being decoded */
+static void
+append_short_term_refs (GstH264Decoder * self, gboolean include_non_existing,
+    gboolean include_second_field, GArray * out)
+{
+  GstH264Dpb *dpb = self->priv->dpb;
+  guint len = out->len;
+  guint n_refs = gst_h264_dpb_get_size (dpb);
+
+  g_array_set_size (out, len + n_refs);
+  n_refs = gst_h264_dpb_get_short_term_refs (dpb, include_non_existing,
+      include_second_field, &g_array_index (out, GstH264Picture *, len),
+      n_refs);
+  g_array_set_size (out, len + n_refs);
+}
+
+static void
+append_long_term_refs (GstH264Decoder * self, gboolean include_second_field,
+    GArray * out)
+{
+  GstH264Dpb *dpb = self->priv->dpb;
+  guint len = out->len;
+  guint n_refs = gst_h264_dpb_get_size (dpb);
+
+  g_array_set_size (out, len + n_refs);
+  n_refs = gst_h264_dpb_get_long_term_refs (dpb, include_second_field,
+      &g_array_index (out, GstH264Picture *, len), n_refs);
+  g_array_set_size (out, len + n_refs);
+}
+
 static void
 construct_ref_pic_lists_p (GstH264Decoder * self,
     GstH264Picture * current_picture)
@@ -2245,13 +2265,11 @@ construct_ref_pic_lists_p (GstH264Decoder * self,
    */
   g_array_set_size (priv->ref_pic_list_p0, 0);
 
-  gst_h264_dpb_get_pictures_short_term_ref (priv->dpb,
-      TRUE, FALSE, priv->ref_pic_list_p0);
+  append_short_term_refs (self, TRUE, FALSE, priv->ref_pic_list_p0);
   g_array_sort (priv->ref_pic_list_p0, (GCompareFunc) pic_num_desc_compare);
 
   pos = priv->ref_pic_list_p0->len;
-  gst_h264_dpb_get_pictures_long_term_ref (priv->dpb,
-      FALSE, priv->ref_pic_list_p0);
+  append_long_term_refs (self, FALSE, priv->ref_pic_list_p0);
   g_qsort_with_data (&g_array_index (priv->ref_pic_list_p0, gpointer, pos),
       priv->ref_pic_list_p0->len - pos, sizeof (gpointer),
       (GCompareDataFunc) long_term_pic_num_asc_compare, NULL);
@@ -2298,7 +2316,6 @@ init_picture_refs_fields_1 (GstH264Decoder * self, GstH264PictureField field,
     for (; i < ref_frame_list->len; i++) {
       GstH264Picture *pic = g_array_index (ref_frame_list, GstH264Picture *, i);
       if (pic->field == field) {
-        pic = gst_h264_picture_ref (pic);
         g_array_append_val (ref_pic_list_x, pic);
         i++;
         break;
@@ -2308,7 +2325,6 @@ init_picture_refs_fields_1 (GstH264Decoder * self, GstH264PictureField field,
     for (; j < ref_frame_list->len; j++) {
       GstH264Picture *pic = g_array_index (ref_frame_list, GstH264Picture *, j);
       if (pic->field != field) {
-        pic = gst_h264_picture_ref (pic);
         g_array_append_val (ref_pic_list_x, pic);
         j++;
         break;
@@ -2331,8 +2347,7 @@ construct_ref_field_pic_lists_p (GstH264Decoder * self,
   /* 8.2.4.2.2, 8.2.4.2.5 refFrameList0ShortTerm:
    * short-term ref pictures sorted by descending frame_num_wrap.
    */
-  gst_h264_dpb_get_pictures_short_term_ref (priv->dpb,
-      TRUE, TRUE, priv->ref_frame_list_0_short_term);
+  append_short_term_refs (self, TRUE, TRUE, priv->ref_frame_list_0_short_term);
   g_array_sort (priv->ref_frame_list_0_short_term,
       (GCompareFunc) frame_num_wrap_desc_compare);
 
@@ -2354,8 +2369,7 @@ construct_ref_field_pic_lists_p (GstH264Decoder * self,
   /* 8.2.4.2.2 refFrameList0LongTerm,:
    * long-term ref pictures sorted by ascending long_term_frame_idx.
    */
-  gst_h264_dpb_get_pictures_long_term_ref (priv->dpb,
-      TRUE, priv->ref_frame_list_long_term);
+  append_long_term_refs (self, TRUE, priv->ref_frame_list_long_term);
   g_array_sort (priv->ref_frame_list_long_term,
       (GCompareFunc) long_term_frame_idx_asc_compare);
 
@@ -2401,7 +2415,7 @@ construct_ref_field_pic_lists_p (GstH264Decoder * self,
   }
 #endif
 
-  /* Clear temporary lists, now pictures are owned by ref_pic_list_p0 */
+  /* Clear temporary lists */
   g_array_set_size (priv->ref_frame_list_0_short_term, 0);
   g_array_set_size (priv->ref_frame_list_long_term, 0);
 }
@@ -2483,8 +2497,8 @@ construct_ref_pic_lists_b (GstH264Decoder * self,
    * as "non-existing" as specified in clause 8.2.5.2 are not included in either
    * RefPicList0 or RefPicList1
    */
-  gst_h264_dpb_get_pictures_short_term_ref (priv->dpb,
-      current_picture->pic_order_cnt_type != 0, FALSE, priv->ref_pic_list_b0);
+  append_short_term_refs (self, current_picture->pic_order_cnt_type != 0, FALSE,
+      priv->ref_pic_list_b0);
 
   /* First sort ascending, this will put [1] in right place and finish
    * [2]. */
@@ -2505,8 +2519,7 @@ construct_ref_pic_lists_b (GstH264Decoder * self,
 
   /* Now add [3] and sort by ascending long_term_pic_num. */
   pos = priv->ref_pic_list_b0->len;
-  gst_h264_dpb_get_pictures_long_term_ref (priv->dpb,
-      FALSE, priv->ref_pic_list_b0);
+  append_long_term_refs (self, FALSE, priv->ref_pic_list_b0);
   g_qsort_with_data (&g_array_index (priv->ref_pic_list_b0, gpointer, pos),
       priv->ref_pic_list_b0->len - pos, sizeof (gpointer),
       (GCompareDataFunc) long_term_pic_num_asc_compare, NULL);
@@ -2516,8 +2529,8 @@ construct_ref_pic_lists_b (GstH264Decoder * self,
    * [2] shortterm ref pics with POC < curr_pic's POC by descending POC,
    * [3] longterm ref pics by ascending long_term_pic_num.
    */
-  gst_h264_dpb_get_pictures_short_term_ref (priv->dpb,
-      current_picture->pic_order_cnt_type != 0, FALSE, priv->ref_pic_list_b1);
+  append_short_term_refs (self, current_picture->pic_order_cnt_type != 0, FALSE,
+      priv->ref_pic_list_b1);
 
   /* First sort by descending POC. */
   g_array_sort (priv->ref_pic_list_b1, (GCompareFunc) poc_desc_compare);
@@ -2533,8 +2546,7 @@ construct_ref_pic_lists_b (GstH264Decoder * self,
 
   /* Now add [3] and sort by ascending long_term_pic_num */
   pos = priv->ref_pic_list_b1->len;
-  gst_h264_dpb_get_pictures_long_term_ref (priv->dpb,
-      FALSE, priv->ref_pic_list_b1);
+  append_long_term_refs (self, FALSE, priv->ref_pic_list_b1);
   g_qsort_with_data (&g_array_index (priv->ref_pic_list_b1, gpointer, pos),
       priv->ref_pic_list_b1->len - pos, sizeof (gpointer),
       (GCompareDataFunc) long_term_pic_num_asc_compare, NULL);
@@ -2576,8 +2588,7 @@ construct_ref_field_pic_lists_b (GstH264Decoder * self,
    * as "non-existing" as specified in clause 8.2.5.2 are not included in either
    * RefPicList0 or RefPicList1
    */
-  gst_h264_dpb_get_pictures_short_term_ref (priv->dpb,
-      current_picture->pic_order_cnt_type != 0, TRUE,
+  append_short_term_refs (self, current_picture->pic_order_cnt_type != 0, TRUE,
       priv->ref_frame_list_0_short_term);
 
   /* First sort ascending, this will put [1] in right place and finish
@@ -2601,8 +2612,7 @@ construct_ref_field_pic_lists_b (GstH264Decoder * self,
    * [1] shortterm ref pics with POC > curr_pic's POC sorted by ascending POC,
    * [2] shortterm ref pics with POC < curr_pic's POC by descending POC,
    */
-  gst_h264_dpb_get_pictures_short_term_ref (priv->dpb,
-      current_picture->pic_order_cnt_type != 0, TRUE,
+  append_short_term_refs (self, current_picture->pic_order_cnt_type != 0, TRUE,
       priv->ref_frame_list_1_short_term);
 
   /* First sort by descending POC. */
@@ -2621,8 +2631,7 @@ construct_ref_field_pic_lists_b (GstH264Decoder * self,
   /* 8.2.4.2.2 refFrameList0LongTerm,:
    * long-term ref pictures sorted by ascending long_term_frame_idx.
    */
-  gst_h264_dpb_get_pictures_long_term_ref (priv->dpb,
-      TRUE, priv->ref_frame_list_long_term);
+  append_long_term_refs (self, TRUE, priv->ref_frame_list_long_term);
   g_array_sort (priv->ref_frame_list_long_term,
       (GCompareFunc) long_term_frame_idx_asc_compare);
 
@@ -2652,8 +2661,7 @@ construct_ref_field_pic_lists_b (GstH264Decoder * self,
   print_ref_pic_list_b (self, priv->ref_pic_list_b0, 0);
   print_ref_pic_list_b (self, priv->ref_pic_list_b1, 1);
 
-  /* Clear temporary lists, now pictures are owned by ref_pic_list_b0
-   * and ref_pic_list_b1 */
+  /* Clear temporary lists */
   g_array_set_size (priv->ref_frame_list_0_short_term, 0);
   g_array_set_size (priv->ref_frame_list_1_short_term, 0);
   g_array_set_size (priv->ref_frame_list_long_term, 0);
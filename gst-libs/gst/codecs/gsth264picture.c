@@ -110,6 +110,16 @@ struct _GstH264Dpb
   gint num_output_needed;
   gint32 last_output_poc;
 
+  /* Short-term and long-term reference pictures in pic_list order, rebuilt
+   * on the next lookup after any reference marking change */
+  GPtrArray *short_ref_list;
+  GPtrArray *long_ref_list;
+  gboolean ref_lists_dirty;
+
+  /* Frames and first fields of complete field pairs which are needed for
+   * output, sorted by ascending POC */
+  GPtrArray *output_list;
+
   gboolean interlaced;
 };
 
@@ -120,6 +130,64 @@ gst_h264_dpb_init (GstH264Dpb * dpb)
   dpb->last_output_poc = G_MININT32;
 }
 
+static void
+gst_h264_dpb_update_ref_lists (GstH264Dpb * dpb)
+{
+  gint i;
+
+  if (!dpb->ref_lists_dirty)
+    return;
+
+  g_ptr_array_set_size (dpb->short_ref_list, 0);
+  g_ptr_array_set_size (dpb->long_ref_list, 0);
+
+  for (i = 0; i < dpb->pic_list->len; i++) {
+    GstH264Picture *picture =
+        g_array_index (dpb->pic_list, GstH264Picture *, i);
+
+    if (GST_H264_PICTURE_IS_SHORT_TERM_REF (picture))
+      g_ptr_array_add (dpb->short_ref_list, picture);
+    else if (GST_H264_PICTURE_IS_LONG_TERM_REF (picture))
+      g_ptr_array_add (dpb->long_ref_list, picture);
+  }
+
+  dpb->ref_lists_dirty = FALSE;
+}
+
+static void
+gst_h264_dpb_queue_output (GstH264Dpb * dpb, GstH264Picture * picture)
+{
+  guint i;
+
+  /* Pictures with identical POC stay in storage order */
+  for (i = dpb->output_list->len; i > 0; i--) {
+    GstH264Picture *other = g_ptr_array_index (dpb->output_list, i - 1);
+
+    if (other->pic_order_cnt <= picture->pic_order_cnt)
+      break;
+  }
+
+  g_ptr_array_insert (dpb->output_list, i, picture);
+}
+
+static void
+gst_h264_dpb_remove_picture (GstH264Dpb * dpb, GstH264Picture * picture)
+{
+  gint i;
+
+  for (i = 0; i < dpb->pic_list->len; i++) {
+    if (g_array_index (dpb->pic_list, GstH264Picture *, i) == picture) {
+      if (GST_H264_PICTURE_IS_REF (picture))
+        dpb->ref_lists_dirty = TRUE;
+
+      /* NOTE: don't use g_array_remove_index_fast here since the last picture
+       * need to be referenced for bumping decision */
+      g_array_remove_index (dpb->pic_list, i);
+      return;
+    }
+  }
+}
+
 /**
  * gst_h264_dpb_new: (skip)
  *
@@ -141,6 +209,10 @@ gst_h264_dpb_new (void)
   g_array_set_clear_func (dpb->pic_list,
       (GDestroyNotify) gst_h264_picture_clear);
 
+  dpb->short_ref_list = g_ptr_array_sized_new (GST_H264_DPB_MAX_SIZE);
+  dpb->long_ref_list = g_ptr_array_sized_new (GST_H264_DPB_MAX_SIZE);
+  dpb->output_list = g_ptr_array_sized_new (GST_H264_DPB_MAX_SIZE);
+
   return dpb;
 }
 
@@ -221,6 +293,9 @@ gst_h264_dpb_free (GstH264Dpb * dpb)
 
   gst_h264_dpb_clear (dpb);
   g_array_unref (dpb->pic_list);
+  g_ptr_array_unref (dpb->short_ref_list);
+  g_ptr_array_unref (dpb->long_ref_list);
+  g_ptr_array_unref (dpb->output_list);
   g_free (dpb);
 }
 
@@ -236,6 +311,10 @@ gst_h264_dpb_clear (GstH264Dpb * dpb)
   g_return_if_fail (dpb != NULL);
 
   g_array_set_size (dpb->pic_list, 0);
+  g_ptr_array_set_size (dpb->short_ref_list, 0);
+  g_ptr_array_set_size (dpb->long_ref_list, 0);
+  g_ptr_array_set_size (dpb->output_list, 0);
+  dpb->ref_lists_dirty = FALSE;
   gst_h264_dpb_init (dpb);
 }
 
@@ -261,6 +340,7 @@ gst_h264_dpb_add (GstH264Dpb * dpb, GstH264Picture * picture)
 
     if (GST_H264_PICTURE_IS_FRAME (picture)) {
       dpb->num_output_needed++;
+      gst_h264_dpb_queue_output (dpb, picture);
     } else {
       /* We can do output only when field pair are complete */
       if (picture->second_field) {
@@ -274,8 +354,15 @@ gst_h264_dpb_add (GstH264Dpb * dpb, GstH264Picture * picture)
   /* Link each field */
   if (picture->second_field && picture->other_field) {
     picture->other_field->other_field = picture;
+
+    /* The first field can be output once the pair is complete */
+    if (picture->other_field->needed_for_output)
+      gst_h264_dpb_queue_output (dpb, picture->other_field);
   }
 
+  if (GST_H264_PICTURE_IS_REF (picture))
+    dpb->ref_lists_dirty = TRUE;
+
   g_array_append_val (dpb->pic_list, picture);
 }
 
@@ -324,15 +411,20 @@ gst_h264_dpb_num_ref_frames (GstH264Dpb * dpb)
 
   g_return_val_if_fail (dpb != NULL, -1);
 
-  for (i = 0; i < dpb->pic_list->len; i++) {
-    GstH264Picture *picture =
-        g_array_index (dpb->pic_list, GstH264Picture *, i);
+  gst_h264_dpb_update_ref_lists (dpb);
 
-    /* Count frame, not field picture */
-    if (picture->second_field)
-      continue;
+  /* Count frame, not field picture */
+  for (i = 0; i < dpb->short_ref_list->len; i++) {
+    GstH264Picture *picture = g_ptr_array_index (dpb->short_ref_list, i);
 
-    if (GST_H264_PICTURE_IS_REF (picture))
+    if (!picture->second_field)
+      ret++;
+  }
+
+  for (i = 0; i < dpb->long_ref_list->len; i++) {
+    GstH264Picture *picture = g_ptr_array_index (dpb->long_ref_list, i);
+
+    if (!picture->second_field)
       ret++;
   }
 
@@ -358,6 +450,10 @@ gst_h264_dpb_mark_all_non_ref (GstH264Dpb * dpb)
 
     gst_h264_picture_set_reference (picture, GST_H264_PICTURE_REF_NONE, FALSE);
   }
+
+  g_ptr_array_set_size (dpb->short_ref_list, 0);
+  g_ptr_array_set_size (dpb->long_ref_list, 0);
+  dpb->ref_lists_dirty = FALSE;
 }
 
 /**
@@ -376,12 +472,12 @@ gst_h264_dpb_get_short_ref_by_pic_num (GstH264Dpb * dpb, gint pic_num)
 
   g_return_val_if_fail (dpb != NULL, NULL);
 
-  for (i = 0; i < dpb->pic_list->len; i++) {
-    GstH264Picture *picture =
-        g_array_index (dpb->pic_list, GstH264Picture *, i);
+  gst_h264_dpb_update_ref_lists (dpb);
 
-    if (GST_H264_PICTURE_IS_SHORT_TERM_REF (picture)
-        && picture->pic_num == pic_num)
+  for (i = 0; i < dpb->short_ref_list->len; i++) {
+    GstH264Picture *picture = g_ptr_array_index (dpb->short_ref_list, i);
+
+    if (picture->pic_num == pic_num)
       return picture;
   }
 
@@ -409,12 +505,12 @@ gst_h264_dpb_get_long_ref_by_long_term_pic_num (GstH264Dpb * dpb,
 
   g_return_val_if_fail (dpb != NULL, NULL);
 
-  for (i = 0; i < dpb->pic_list->len; i++) {
-    GstH264Picture *picture =
-        g_array_index (dpb->pic_list, GstH264Picture *, i);
+  gst_h264_dpb_update_ref_lists (dpb);
 
-    if (GST_H264_PICTURE_IS_LONG_TERM_REF (picture) &&
-        picture->long_term_pic_num == long_term_pic_num)
+  for (i = 0; i < dpb->long_ref_list->len; i++) {
+    GstH264Picture *picture = g_ptr_array_index (dpb->long_ref_list, i);
+
+    if (picture->long_term_pic_num == long_term_pic_num)
       return picture;
   }
 
@@ -439,12 +535,12 @@ gst_h264_dpb_get_lowest_frame_num_short_ref (GstH264Dpb * dpb)
 
   g_return_val_if_fail (dpb != NULL, NULL);
 
-  for (i = 0; i < dpb->pic_list->len; i++) {
-    GstH264Picture *picture =
-        g_array_index (dpb->pic_list, GstH264Picture *, i);
+  gst_h264_dpb_update_ref_lists (dpb);
+
+  for (i = 0; i < dpb->short_ref_list->len; i++) {
+    GstH264Picture *picture = g_ptr_array_index (dpb->short_ref_list, i);
 
-    if (GST_H264_PICTURE_IS_SHORT_TERM_REF (picture) &&
-        (!ret || picture->frame_num_wrap < ret->frame_num_wrap))
+    if (!ret || picture->frame_num_wrap < ret->frame_num_wrap)
       ret = picture;
   }
 
@@ -476,16 +572,15 @@ gst_h264_dpb_get_pictures_short_term_ref (GstH264Dpb * dpb,
   g_return_if_fail (dpb != NULL);
   g_return_if_fail (out != NULL);
 
-  for (i = 0; i < dpb->pic_list->len; i++) {
-    GstH264Picture *picture =
-        g_array_index (dpb->pic_list, GstH264Picture *, i);
+  gst_h264_dpb_update_ref_lists (dpb);
+
+  for (i = 0; i < dpb->short_ref_list->len; i++) {
+    GstH264Picture *picture = g_ptr_array_index (dpb->short_ref_list, i);
 
     if (!include_second_field && picture->second_field)
       continue;
 
-    if (GST_H264_PICTURE_IS_SHORT_TERM_REF (picture) &&
-        (include_non_existing || (!include_non_existing &&
-                !picture->nonexisting))) {
+    if (include_non_existing || !picture->nonexisting) {
       gst_h264_picture_ref (picture);
       g_array_append_val (out, picture);
     }
@@ -513,20 +608,102 @@ gst_h264_dpb_get_pictures_long_term_ref (GstH264Dpb * dpb,
   g_return_if_fail (dpb != NULL);
   g_return_if_fail (out != NULL);
 
-  for (i = 0; i < dpb->pic_list->len; i++) {
-    GstH264Picture *picture =
-        g_array_index (dpb->pic_list, GstH264Picture *, i);
+  gst_h264_dpb_update_ref_lists (dpb);
+
+  for (i = 0; i < dpb->long_ref_list->len; i++) {
+    GstH264Picture *picture = g_ptr_array_index (dpb->long_ref_list, i);
 
     if (!include_second_field && picture->second_field)
       continue;
 
-    if (GST_H264_PICTURE_IS_LONG_TERM_REF (picture)) {
-      gst_h264_picture_ref (picture);
-      g_array_append_val (out, picture);
-    }
+    gst_h264_picture_ref (picture);
+    g_array_append_val (out, picture);
   }
 }
 
+/**
+ * gst_h264_dpb_get_short_term_refs:
+ * @dpb: a #GstH264Dpb
+ * @include_non_existing: %TRUE if non-existing pictures need to be included
+ * @include_second_field: %TRUE if the second field pictures need to be included
+ * @refs: (out caller-allocates) (array length=n_refs) (transfer none):
+ *   storage for #GstH264Picture pointers
+ * @n_refs: the number of pointers @refs can hold
+ *
+ * Store up to @n_refs short-term reference pictures of @dpb into @refs.
+ * Unlike gst_h264_dpb_get_pictures_short_term_ref(), no reference is taken
+ * on the pictures, which stay valid until @dpb is modified.
+ *
+ * Returns: the number of pictures stored in @refs
+ *
+ * Since: 1.20
+ */
+guint
+gst_h264_dpb_get_short_term_refs (GstH264Dpb * dpb,
+    gboolean include_non_existing, gboolean include_second_field,
+    GstH264Picture ** refs, guint n_refs)
+{
+  guint i;
+  guint n = 0;
+
+  g_return_val_if_fail (dpb != NULL, 0);
+  g_return_val_if_fail (refs != NULL || n_refs == 0, 0);
+
+  gst_h264_dpb_update_ref_lists (dpb);
+
+  for (i = 0; i < dpb->short_ref_list->len && n < n_refs; i++) {
+    GstH264Picture *picture = g_ptr_array_index (dpb->short_ref_list, i);
+
+    if (!include_second_field && picture->second_field)
+      continue;
+
+    if (include_non_existing || !picture->nonexisting)
+      refs[n++] = picture;
+  }
+
+  return n;
+}
+
+/**
+ * gst_h264_dpb_get_long_term_refs:
+ * @dpb: a #GstH264Dpb
+ * @include_second_field: %TRUE if the second field pictures need to be included
+ * @refs: (out caller-allocates) (array length=n_refs) (transfer none):
+ *   storage for #GstH264Picture pointers
+ * @n_refs: the number of pointers @refs can hold
+ *
+ * Store up to @n_refs long-term reference pictures of @dpb into @refs.
+ * Unlike gst_h264_dpb_get_pictures_long_term_ref(), no reference is taken
+ * on the pictures, which stay valid until @dpb is modified.
+ *
+ * Returns: the number of pictures stored in @refs
+ *
+ * Since: 1.20
+ */
+guint
+gst_h264_dpb_get_long_term_refs (GstH264Dpb * dpb,
+    gboolean include_second_field, GstH264Picture ** refs, guint n_refs)
+{
+  guint i;
+  guint n = 0;
+
+  g_return_val_if_fail (dpb != NULL, 0);
+  g_return_val_if_fail (refs != NULL || n_refs == 0, 0);
+
+  gst_h264_dpb_update_ref_lists (dpb);
+
+  for (i = 0; i < dpb->long_ref_list->len && n < n_refs; i++) {
+    GstH264Picture *picture = g_ptr_array_index (dpb->long_ref_list, i);
+
+    if (!include_second_field && picture->second_field)
+      continue;
+
+    refs[n++] = picture;
+  }
+
+  return n;
+}
+
 /**
  * gst_h264_dpb_get_pictures_all:
  * @dpb: a #GstH264Dpb
@@ -615,43 +792,13 @@ gst_h264_dpb_has_empty_frame_buffer (GstH264Dpb * dpb)
   return FALSE;
 }
 
-static gint
-gst_h264_dpb_get_lowest_output_needed_picture (GstH264Dpb * dpb,
-    GstH264Picture ** picture)
+static GstH264Picture *
+gst_h264_dpb_get_lowest_output_needed_picture (GstH264Dpb * dpb)
 {
-  gint i;
-  GstH264Picture *lowest = NULL;
-  gint index = -1;
-
-  *picture = NULL;
-
-  for (i = 0; i < dpb->pic_list->len; i++) {
-    GstH264Picture *picture =
-        g_array_index (dpb->pic_list, GstH264Picture *, i);
-
-    if (!picture->needed_for_output)
-      continue;
-
-    if (!GST_H264_PICTURE_IS_FRAME (picture) &&
-        (!picture->other_field || picture->second_field))
-      continue;
-
-    if (!lowest) {
-      lowest = picture;
-      index = i;
-      continue;
-    }
-
-    if (picture->pic_order_cnt < lowest->pic_order_cnt) {
-      lowest = picture;
-      index = i;
-    }
-  }
-
-  if (lowest)
-    *picture = gst_h264_picture_ref (lowest);
+  if (dpb->output_list->len == 0)
+    return NULL;
 
-  return index;
+  return g_ptr_array_index (dpb->output_list, 0);
 }
 
 /**
@@ -719,14 +866,12 @@ gst_h264_dpb_needs_bump (GstH264Dpb * dpb, guint32 max_num_reorder_frames,
   /* HACK: Not all streams have PicOrderCnt increment by 2, but in practice this
    * condition can be used */
   if (low_latency && dpb->last_output_poc != G_MININT32) {
-    GstH264Picture *picture = NULL;
+    GstH264Picture *picture;
     gint32 lowest_poc = G_MININT32;
 
-    gst_h264_dpb_get_lowest_output_needed_picture (dpb, &picture);
-    if (picture) {
+    picture = gst_h264_dpb_get_lowest_output_needed_picture (dpb);
+    if (picture)
       lowest_poc = picture->pic_order_cnt;
-      gst_h264_picture_unref (picture);
-    }
 
     if (lowest_poc != G_MININT32 && lowest_poc > dpb->last_output_poc
         && abs (lowest_poc - dpb->last_output_poc) <= 2) {
@@ -758,25 +903,24 @@ gst_h264_dpb_bump (GstH264Dpb * dpb, gboolean drain)
 {
   GstH264Picture *picture;
   GstH264Picture *other_picture;
-  gint i;
-  gint index;
 
   g_return_val_if_fail (dpb != NULL, NULL);
 
-  index = gst_h264_dpb_get_lowest_output_needed_picture (dpb, &picture);
+  picture = gst_h264_dpb_get_lowest_output_needed_picture (dpb);
 
-  if (!picture || index < 0)
+  if (!picture)
     return NULL;
 
+  gst_h264_picture_ref (picture);
+  g_ptr_array_remove_index (dpb->output_list, 0);
+
   picture->needed_for_output = FALSE;
 
   dpb->num_output_needed--;
   g_assert (dpb->num_output_needed >= 0);
 
-  /* NOTE: don't use g_array_remove_index_fast here since the last picture
-   * need to be referenced for bumping decision */
   if (!GST_H264_PICTURE_IS_REF (picture) || drain)
-    g_array_remove_index (dpb->pic_list, index);
+    gst_h264_dpb_remove_picture (dpb, picture);
 
   other_picture = picture->other_field;
   if (other_picture) {
@@ -790,17 +934,8 @@ gst_h264_dpb_bump (GstH264Dpb * dpb, gboolean drain)
     if (picture->pic_order_cnt < other_picture->pic_order_cnt)
       picture->buffer_flags |= GST_VIDEO_BUFFER_FLAG_TFF;
 
-    if (!other_picture->ref) {
-      for (i = 0; i < dpb->pic_list->len; i++) {
-        GstH264Picture *tmp =
-            g_array_index (dpb->pic_list, GstH264Picture *, i);
-
-        if (tmp == other_picture) {
-          g_array_remove_index (dpb->pic_list, i);
-          break;
-        }
-      }
-    }
+    if (!other_picture->ref)
+      gst_h264_dpb_remove_picture (dpb, other_picture);
     /* Now other field may or may not exist */
   }
 
@@ -854,7 +989,7 @@ gst_h264_dpb_perform_memory_management_control_operation (GstH264Dpb * dpb,
       pic_num_x = get_picNumX (picture, ref_pic_marking);
       other = gst_h264_dpb_get_short_ref_by_pic_num (dpb, pic_num_x);
       if (other) {
-        gst_h264_picture_set_reference (other,
+        gst_h264_dpb_set_reference (dpb, other,
             GST_H264_PICTURE_REF_NONE, GST_H264_PICTURE_IS_FRAME (picture));
         GST_TRACE ("MMCO-1: unmark short-term ref picture %p, (poc %d)",
             other, other->pic_order_cnt);
@@ -869,7 +1004,7 @@ gst_h264_dpb_perform_memory_management_control_operation (GstH264Dpb * dpb,
       other = gst_h264_dpb_get_long_ref_by_long_term_pic_num (dpb,
           ref_pic_marking->long_term_pic_num);
       if (other) {
-        gst_h264_picture_set_reference (other,
+        gst_h264_dpb_set_reference (dpb, other,
             GST_H264_PICTURE_REF_NONE, FALSE);
         GST_TRACE ("MMCO-2: unmark long-term ref picture %p, (poc %d)",
             other, other->pic_order_cnt);
@@ -902,7 +1037,7 @@ gst_h264_dpb_perform_memory_management_control_operation (GstH264Dpb * dpb,
             /* When long_term_frame_idx is already assigned to a long-term
              * reference frame, that frame is marked as "unused for reference"
              */
-            gst_h264_picture_set_reference (tmp,
+            gst_h264_dpb_set_reference (dpb, tmp,
                 GST_H264_PICTURE_REF_NONE, TRUE);
             GST_TRACE ("MMCO-3: unmark old long-term frame %p (poc %d)",
                 tmp, tmp->pic_order_cnt);
@@ -914,7 +1049,7 @@ gst_h264_dpb_perform_memory_management_control_operation (GstH264Dpb * dpb,
              * reference field pair, that complementary field pair and both of
              * its fields are marked as "unused for reference"
              */
-            gst_h264_picture_set_reference (tmp,
+            gst_h264_dpb_set_reference (dpb, tmp,
                 GST_H264_PICTURE_REF_NONE, TRUE);
             GST_TRACE ("MMCO-3: unmark old long-term field-pair %p (poc %d)",
                 tmp, tmp->pic_order_cnt);
@@ -932,13 +1067,13 @@ gst_h264_dpb_perform_memory_management_control_operation (GstH264Dpb * dpb,
             /* NOTE: "other" here is short-ref, so "other" and "tmp" must not be
              * identical picture */
             if (!tmp->other_field) {
-              gst_h264_picture_set_reference (tmp,
+              gst_h264_dpb_set_reference (dpb, tmp,
                   GST_H264_PICTURE_REF_NONE, FALSE);
               GST_TRACE ("MMCO-3: unmark old long-term field %p (poc %d)",
                   tmp, tmp->pic_order_cnt);
             } else if (tmp->other_field != other &&
                 (!other->other_field || other->other_field != tmp)) {
-              gst_h264_picture_set_reference (tmp,
+              gst_h264_dpb_set_reference (dpb, tmp,
                   GST_H264_PICTURE_REF_NONE, FALSE);
               GST_TRACE ("MMCO-3: unmark old long-term field %p (poc %d)",
                   tmp, tmp->pic_order_cnt);
@@ -948,7 +1083,7 @@ gst_h264_dpb_perform_memory_management_control_operation (GstH264Dpb * dpb,
         }
       }
 
-      gst_h264_picture_set_reference (other,
+      gst_h264_dpb_set_reference (dpb, other,
           GST_H264_PICTURE_REF_LONG_TERM, GST_H264_PICTURE_IS_FRAME (picture));
       other->long_term_frame_idx = ref_pic_marking->long_term_frame_idx;
 
@@ -975,7 +1110,7 @@ gst_h264_dpb_perform_memory_management_control_operation (GstH264Dpb * dpb,
 
         if (GST_H264_PICTURE_IS_LONG_TERM_REF (other) &&
             other->long_term_frame_idx > max_long_term_frame_idx) {
-          gst_h264_picture_set_reference (other,
+          gst_h264_dpb_set_reference (dpb, other,
               GST_H264_PICTURE_REF_NONE, FALSE);
           GST_TRACE ("MMCO-4: unmark long-term ref pic %p, index %d, (poc %d)",
               other, other->long_term_frame_idx, other->pic_order_cnt);
@@ -986,7 +1121,7 @@ gst_h264_dpb_perform_memory_management_control_operation (GstH264Dpb * dpb,
       /* 8.2.5.4.5 Unmark all reference pictures */
       for (i = 0; i < dpb->pic_list->len; i++) {
         other = g_array_index (dpb->pic_list, GstH264Picture *, i);
-        gst_h264_picture_set_reference (other,
+        gst_h264_dpb_set_reference (dpb, other,
             GST_H264_PICTURE_REF_NONE, FALSE);
       }
       picture->mem_mgmt_5 = TRUE;
@@ -1006,13 +1141,13 @@ gst_h264_dpb_perform_memory_management_control_operation (GstH264Dpb * dpb,
             ref_pic_marking->long_term_frame_idx) {
           GST_TRACE ("MMCO-6: unmark old long-term ref pic %p (poc %d)",
               other, other->pic_order_cnt);
-          gst_h264_picture_set_reference (other,
+          gst_h264_dpb_set_reference (dpb, other,
               GST_H264_PICTURE_REF_NONE, TRUE);
           break;
         }
       }
 
-      gst_h264_picture_set_reference (picture,
+      gst_h264_dpb_set_reference (dpb, picture,
           GST_H264_PICTURE_REF_LONG_TERM, picture->second_field);
       picture->long_term_frame_idx = ref_pic_marking->long_term_frame_idx;
       if (picture->other_field &&
@@ -1051,3 +1186,15 @@ gst_h264_picture_set_reference (GstH264Picture * picture,
   if (other_field && picture->other_field)
     picture->other_field->ref = reference;
 }
+
+/* Same as gst_h264_picture_set_reference() for a picture stored in @dpb,
+ * but also invalidates the cached reference lists of @dpb */
+void
+gst_h264_dpb_set_reference (GstH264Dpb * dpb, GstH264Picture * picture,
+    GstH264PictureReference reference, gboolean other_field)
+{
+  g_return_if_fail (dpb != NULL);
+
+  gst_h264_picture_set_reference (picture, reference, other_field);
+  dpb->ref_lists_dirty = TRUE;
+}
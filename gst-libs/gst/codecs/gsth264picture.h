@@ -268,6 +268,19 @@ void  gst_h264_dpb_get_pictures_long_term_ref  (GstH264Dpb * dpb,
                                                 gboolean include_second_field,
                                                 GArray * out);
 
+GST_CODECS_API
+guint gst_h264_dpb_get_short_term_refs (GstH264Dpb * dpb,
+                                        gboolean include_non_existing,
+                                        gboolean include_second_field,
+                                        GstH264Picture ** refs,
+                                        guint n_refs);
+
+GST_CODECS_API
+guint gst_h264_dpb_get_long_term_refs  (GstH264Dpb * dpb,
+                                        gboolean include_second_field,
+                                        GstH264Picture ** refs,
+                                        guint n_refs);
+
 GST_CODECS_API
 GArray * gst_h264_dpb_get_pictures_all         (GstH264Dpb * dpb);
 
@@ -297,6 +310,12 @@ void  gst_h264_picture_set_reference (GstH264Picture * picture,
                                       GstH264PictureReference reference,
                                       gboolean other_field);
 
+G_GNUC_INTERNAL
+void  gst_h264_dpb_set_reference (GstH264Dpb * dpb,
+                                  GstH264Picture * picture,
+                                  GstH264PictureReference reference,
+                                  gboolean other_field);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstH264Picture, gst_h264_picture_unref)
 
 G_END_DECLS
@@ -54,6 +54,8 @@ enum
   SIGNAL_SEND_DATA,
   SIGNAL_SEND_STRING,
   SIGNAL_CLOSE,
+  SIGNAL_ON_MESSAGE_BUFFER,
+  SIGNAL_SEND_BUFFER_LIST,
   LAST_SIGNAL,
 };
 
@@ -319,6 +321,24 @@ gst_webrtc_data_channel_class_init (GstWebRTCDataChannelClass * klass)
       g_signal_new ("on-message-string", G_TYPE_FROM_CLASS (klass),
       G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_STRING);
 
+  /**
+   * GstWebRTCDataChannel::on-message-buffer:
+   * @object: the #GstWebRTCDataChannel
+   * @buffer: a #GstBuffer with the message received, empty for empty
+   *     messages
+   * @is_string: whether the message is a string or binary message
+   *
+   * Emitted for each data or string message, without copying the received
+   * data. String messages are not NUL terminated. Messages received in a
+   * row are emitted one after the other from the same dispatch.
+   *
+   * Since: 1.20
+   */
+  gst_webrtc_data_channel_signals[SIGNAL_ON_MESSAGE_BUFFER] =
+      g_signal_new ("on-message-buffer", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 2,
+      GST_TYPE_BUFFER | G_SIGNAL_TYPE_STATIC_SCOPE, G_TYPE_BOOLEAN);
+
   /**
    * GstWebRTCDataChannel::on-buffered-amount-low:
    * @object: the #GstWebRTCDataChannel
@@ -349,6 +369,24 @@ gst_webrtc_data_channel_class_init (GstWebRTCDataChannelClass * klass)
       G_CALLBACK (gst_webrtc_data_channel_send_string), NULL, NULL, NULL,
       G_TYPE_NONE, 1, G_TYPE_STRING);
 
+  /**
+   * GstWebRTCDataChannel::send-buffer-list:
+   * @object: the #GstWebRTCDataChannel
+   * @list: a #GstBufferList with one message per buffer
+   * @is_string: whether to send the messages as strings or binary data
+   *
+   * Sends a batch of messages. The buffers are sent without copying their
+   * memory and the buffered amount is only updated once for the whole
+   * list.
+   *
+   * Since: 1.20
+   */
+  gst_webrtc_data_channel_signals[SIGNAL_SEND_BUFFER_LIST] =
+      g_signal_new_class_handler ("send-buffer-list",
+      G_TYPE_FROM_CLASS (klass), G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_CALLBACK (gst_webrtc_data_channel_send_buffer_list), NULL, NULL, NULL,
+      G_TYPE_NONE, 2, GST_TYPE_BUFFER_LIST, G_TYPE_BOOLEAN);
+
   /**
    * GstWebRTCDataChannel::close:
    * @object: the #GstWebRTCDataChannel
@@ -487,6 +525,30 @@ gst_webrtc_data_channel_on_message_string (GstWebRTCDataChannel * channel,
       gst_webrtc_data_channel_signals[SIGNAL_ON_MESSAGE_STRING], 0, str);
 }
 
+/**
+ * gst_webrtc_data_channel_on_message_buffer:
+ * @channel: a #GstWebRTCDataChannel
+ * @buffer: a #GstBuffer
+ * @is_string: whether the message is a string message
+ *
+ * Signal that the data channel received a message, without copying it.
+ * Should only be used by subclasses.
+ *
+ * Since: 1.20
+ */
+void
+gst_webrtc_data_channel_on_message_buffer (GstWebRTCDataChannel * channel,
+    GstBuffer * buffer, gboolean is_string)
+{
+  g_return_if_fail (GST_IS_WEBRTC_DATA_CHANNEL (channel));
+  g_return_if_fail (GST_IS_BUFFER (buffer));
+
+  GST_LOG_OBJECT (channel, "Have buffer %" GST_PTR_FORMAT, buffer);
+  g_signal_emit (channel,
+      gst_webrtc_data_channel_signals[SIGNAL_ON_MESSAGE_BUFFER], 0, buffer,
+      is_string);
+}
+
 /**
  * gst_webrtc_data_channel_on_buffered_amount_low:
  * @channel: a #GstWebRTCDataChannel
@@ -541,6 +603,32 @@ gst_webrtc_data_channel_send_string (GstWebRTCDataChannel * channel,
   klass->send_string (channel, str);
 }
 
+/**
+ * gst_webrtc_data_channel_send_buffer_list:
+ * @channel: a #GstWebRTCDataChannel
+ * @list: a #GstBufferList
+ * @is_string: whether to send the messages as strings
+ *
+ * Send each buffer of @list as a separate message over @channel, as string
+ * messages if @is_string is %TRUE and as data messages otherwise.
+ *
+ * Since: 1.20
+ */
+void
+gst_webrtc_data_channel_send_buffer_list (GstWebRTCDataChannel * channel,
+    GstBufferList * list, gboolean is_string)
+{
+  GstWebRTCDataChannelClass *klass;
+
+  g_return_if_fail (GST_IS_WEBRTC_DATA_CHANNEL (channel));
+  g_return_if_fail (GST_IS_BUFFER_LIST (list));
+
+  klass = GST_WEBRTC_DATA_CHANNEL_GET_CLASS (channel);
+  g_return_if_fail (klass->send_buffer_list != NULL);
+
+  klass->send_buffer_list (channel, list, is_string);
+}
+
 /**
  * gst_webrtc_data_channel_close:
  * @channel: a #GstWebRTCDataChannel
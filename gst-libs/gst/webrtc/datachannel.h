@@ -78,7 +78,14 @@ struct _GstWebRTCDataChannelClass
   void              (*send_string) (GstWebRTCDataChannel * channel, const gchar *str);
   void              (*close)       (GstWebRTCDataChannel * channel);
 
-  gpointer           _padding[GST_PADDING];
+  /**
+   * GstWebRTCDataChannelClass::send_buffer_list:
+   *
+   * Since: 1.20
+   */
+  void              (*send_buffer_list) (GstWebRTCDataChannel * channel, GstBufferList * list, gboolean is_string);
+
+  gpointer           _padding[GST_PADDING - 1];
 };
 
 GST_WEBRTC_API
@@ -96,6 +103,9 @@ void gst_webrtc_data_channel_on_message_data (GstWebRTCDataChannel * channel, GB
 GST_WEBRTC_API
 void gst_webrtc_data_channel_on_message_string (GstWebRTCDataChannel * channel, const gchar * str);
 
+GST_WEBRTC_API
+void gst_webrtc_data_channel_on_message_buffer (GstWebRTCDataChannel * channel, GstBuffer * buffer, gboolean is_string);
+
 GST_WEBRTC_API
 void gst_webrtc_data_channel_on_buffered_amount_low (GstWebRTCDataChannel * channel);
 
@@ -105,6 +115,9 @@ void gst_webrtc_data_channel_send_data (GstWebRTCDataChannel * channel, GBytes *
 GST_WEBRTC_API
 void gst_webrtc_data_channel_send_string (GstWebRTCDataChannel * channel, const gchar * str);
 
+GST_WEBRTC_API
+void gst_webrtc_data_channel_send_buffer_list (GstWebRTCDataChannel * channel, GstBufferList * list, gboolean is_string);
+
 GST_WEBRTC_API
 void gst_webrtc_data_channel_close (GstWebRTCDataChannel * channel);
 
@@ -24,6 +24,7 @@
 #include "gstgeometrictransform.h"
 #include "geometricmath.h"
 #include <string.h>
+#include <math.h>
 
 GST_DEBUG_CATEGORY_STATIC (geometric_transform_debug);
 #define GST_CAT_DEFAULT geometric_transform_debug
@@ -49,7 +50,9 @@ static GstVideoFilterClass *parent_class = NULL;
 enum
 {
   PROP_0,
-  PROP_OFF_EDGE_PIXELS
+  PROP_OFF_EDGE_PIXELS,
+  PROP_INTERPOLATION,
+  PROP_N_THREADS
 };
 
 #define GST_GT_OFF_EDGES_PIXELS_METHOD_TYPE ( \
@@ -74,7 +77,128 @@ gst_geometric_transform_off_edges_pixels_method_get_type (void)
   return method_type;
 }
 
+#define GST_GT_INTERPOLATION_METHOD_TYPE ( \
+    gst_geometric_transform_interpolation_method_get_type())
+static GType
+gst_geometric_transform_interpolation_method_get_type (void)
+{
+  static GType method_type = 0;
+
+  static const GEnumValue method_types[] = {
+    {GST_GT_INTERPOLATION_NEAREST, "Nearest Neighbour", "nearest"},
+    {GST_GT_INTERPOLATION_BILINEAR, "Bilinear", "bilinear"},
+    {0, NULL, NULL}
+  };
+
+  if (!method_type) {
+    method_type =
+        g_enum_register_static ("GstGeometricTransformInterpolationMethod",
+        method_types);
+  }
+  return method_type;
+}
+
 #define DEFAULT_OFF_EDGE_PIXELS GST_GT_OFF_EDGES_PIXELS_IGNORE
+#define DEFAULT_INTERPOLATION GST_GT_INTERPOLATION_NEAREST
+#define DEFAULT_N_THREADS 0
+
+/* x0 of the output pixels that have no source pixel and are left black */
+#define PIXEL_OFF_EDGE G_MAXUINT16
+
+struct _GstGeometricTransformPixel
+{
+  /* top left source pixel */
+  guint16 x0, y0;
+  /* the pixels on its right and below, used when interpolating */
+  guint16 x1, y1;
+  /* weights of x1 and y1 in 1/256 units, always 0 for nearest neighbour */
+  guint8 wx, wy;
+};
+
+/* A band of rows of the output frame */
+typedef struct
+{
+  GstGeometricTransform *gt;
+  const guint8 *in_data;
+  guint8 *out_data;
+  gint in_stride;
+  gint out_stride;
+  gint y_start;
+  gint y_end;
+  /* handle of the pool task filling the slice, NULL when it is filled by
+   * the streaming thread */
+  gpointer task;
+} GstGeometricTransformSlice;
+
+/* must be called with the object lock */
+static void
+gst_geometric_transform_map_pixel (GstGeometricTransform * gt,
+    GstGeometricTransformPixel * pixel, gdouble in_x, gdouble in_y)
+{
+  gint x0, y0;
+
+  /* operate on out of edge pixels */
+  switch (gt->off_edge_pixels) {
+    case GST_GT_OFF_EDGES_PIXELS_CLAMP:
+      in_x = CLAMP (in_x, 0, gt->width - 1);
+      in_y = CLAMP (in_y, 0, gt->height - 1);
+      break;
+
+    case GST_GT_OFF_EDGES_PIXELS_WRAP:
+      in_x = gst_gm_mod_float (in_x, gt->width);
+      in_y = gst_gm_mod_float (in_y, gt->height);
+      if (in_x < 0)
+        in_x += gt->width;
+      if (in_y < 0)
+        in_y += gt->height;
+      break;
+
+    default:
+      break;
+  }
+
+  /* only map to valid pixels, the checks are done on the doubles so that
+   * huge or NaN coordinates never get converted */
+  if (gt->interpolation == GST_GT_INTERPOLATION_BILINEAR) {
+    gdouble floor_x, floor_y;
+
+    if (!(in_x >= 0 && in_x < gt->width && in_y >= 0 && in_y < gt->height))
+      goto off_edge;
+
+    floor_x = floor (in_x);
+    floor_y = floor (in_y);
+    x0 = (gint) floor_x;
+    y0 = (gint) floor_y;
+    pixel->wx = (guint8) ((in_x - floor_x) * 256);
+    pixel->wy = (guint8) ((in_y - floor_y) * 256);
+  } else {
+    if (!(in_x > -1 && in_x < gt->width && in_y > -1 && in_y < gt->height))
+      goto off_edge;
+
+    x0 = (gint) in_x;
+    y0 = (gint) in_y;
+    pixel->wx = 0;
+    pixel->wy = 0;
+  }
+
+  pixel->x0 = x0;
+  pixel->y0 = y0;
+
+  /* the neighbours of the last column and row are off edge, only wrapping
+   * brings them back */
+  if (x0 + 1 < gt->width)
+    pixel->x1 = x0 + 1;
+  else
+    pixel->x1 = gt->off_edge_pixels == GST_GT_OFF_EDGES_PIXELS_WRAP ? 0 : x0;
+  if (y0 + 1 < gt->height)
+    pixel->y1 = y0 + 1;
+  else
+    pixel->y1 = gt->off_edge_pixels == GST_GT_OFF_EDGES_PIXELS_WRAP ? 0 : y0;
+  return;
+
+off_edge:
+  pixel->x0 = PIXEL_OFF_EDGE;
+}
 
 /* must be called with the object lock */
 static gboolean
@@ -84,13 +208,10 @@ gst_geometric_transform_generate_map (GstGeometricTransform * gt)
   gdouble in_x, in_y;
   gboolean ret = TRUE;
   GstGeometricTransformClass *klass;
-  gdouble *ptr;
+  GstGeometricTransformPixel *ptr;
 
-  GST_INFO_OBJECT (gt, "Generating new transform map");
-
-  /* cleanup old map */
-  g_free (gt->map);
-  gt->map = NULL;
+  if (gt->precalc_map)
+    GST_INFO_OBJECT (gt, "Generating new transform map");
 
   klass = GST_GEOMETRIC_TRANSFORM_GET_CLASS (gt);
 
@@ -98,9 +219,11 @@ gst_geometric_transform_generate_map (GstGeometricTransform * gt)
   g_return_val_if_fail (klass->map_func, FALSE);
 
   /*
-   * (x,y) pairs of the inverse mapping
+   * source pixel of the inverse mapping of each output pixel, the memory
+   * of the old map is reused
    */
-  gt->map = g_malloc0 (sizeof (gdouble) * gt->width * gt->height * 2);
+  gt->map = g_renew (GstGeometricTransformPixel, gt->map,
+      gt->width * gt->height);
   ptr = gt->map;
 
   for (y = 0; y < gt->height; y++) {
@@ -111,9 +234,8 @@ gst_geometric_transform_generate_map (GstGeometricTransform * gt)
         goto end;
       }
 
-      ptr[0] = in_x;
-      ptr[1] = in_y;
-      ptr += 2;
+      gst_geometric_transform_map_pixel (gt, ptr, in_x, in_y);
+      ptr++;
     }
   }
 
@@ -140,11 +262,19 @@ gst_geometric_transform_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
   gt = GST_GEOMETRIC_TRANSFORM_CAST (vfilter);
   klass = GST_GEOMETRIC_TRANSFORM_GET_CLASS (gt);
 
+  /* source pixels are stored as 16 bits coordinates in the map */
+  if (in_info->width >= PIXEL_OFF_EDGE || in_info->height >= PIXEL_OFF_EDGE) {
+    GST_ERROR_OBJECT (gt, "Unsupported size %dx%d", in_info->width,
+        in_info->height);
+    return FALSE;
+  }
+
   old_width = gt->width;
   old_height = gt->height;
 
   gt->width = in_info->width;
   gt->height = in_info->height;
+  gt->format = GST_VIDEO_INFO_FORMAT (in_info);
   gt->row_stride = in_info->stride[0];
   gt->pixel_stride = GST_VIDEO_INFO_COMP_PSTRIDE (in_info, 0);
 
@@ -164,46 +294,158 @@ gst_geometric_transform_set_info (GstVideoFilter * vfilter, GstCaps * incaps,
   return ret;
 }
 
+static inline void
+gst_geometric_transform_copy_pixel (guint8 * dest, const guint8 * src,
+    gint pixel_stride)
+{
+  /* constant sizes so that the copies get inlined */
+  switch (pixel_stride) {
+    case 1:
+      dest[0] = src[0];
+      break;
+    case 2:
+      memcpy (dest, src, 2);
+      break;
+    case 3:
+      memcpy (dest, src, 3);
+      break;
+    case 4:
+      memcpy (dest, src, 4);
+      break;
+    default:
+      memcpy (dest, src, pixel_stride);
+      break;
+  }
+}
+
+/* Bilinear interpolation with 8 bits weights, the intermediate values fit
+ * in 32 bits for samples of up to 16 bits */
+static inline guint
+gst_geometric_transform_lerp (guint p00, guint p01, guint p10, guint p11,
+    guint wx, guint wy)
+{
+  guint top = p00 * (256 - wx) + p01 * wx;
+  guint bottom = p10 * (256 - wx) + p11 * wx;
+
+  return (top * (256 - wy) + bottom * wy + 32768) >> 16;
+}
+
 static void
-gst_geometric_transform_do_map (GstGeometricTransform * gt, guint8 * in_data,
-    guint8 * out_data, gint x, gint y, gdouble in_x, gdouble in_y)
+gst_geometric_transform_slice_run (GstGeometricTransformSlice * slice)
 {
-  gint in_offset;
-  gint out_offset;
+  GstGeometricTransform *gt = slice->gt;
+  const GstGeometricTransformPixel *pixel;
+  gint pixel_stride = gt->pixel_stride;
+  guint8 black[4] = { 0, };
+  gint x, y, c;
 
-  out_offset = y * gt->row_stride + x * gt->pixel_stride;
+  if (gt->format == GST_VIDEO_FORMAT_AYUV) {
+    /* in AYUV black is not just all zeros:
+     * 0x10 is black for Y,
+     * 0x80 is black for Cr and Cb */
+    GST_WRITE_UINT32_BE (black, 0xff108080);
+  }
 
-  /* operate on out of edge pixels */
-  switch (gt->off_edge_pixels) {
-    case GST_GT_OFF_EDGES_PIXELS_CLAMP:
-      in_x = CLAMP (in_x, 0, gt->width - 1);
-      in_y = CLAMP (in_y, 0, gt->height - 1);
-      break;
+  for (y = slice->y_start; y < slice->y_end; y++) {
+    guint8 *dest = slice->out_data + y * slice->out_stride;
 
-    case GST_GT_OFF_EDGES_PIXELS_WRAP:
-      in_x = gst_gm_mod_float (in_x, gt->width);
-      in_y = gst_gm_mod_float (in_y, gt->height);
-      if (in_x < 0)
-        in_x += gt->width;
-      if (in_y < 0)
-        in_y += gt->height;
-      break;
+    pixel = gt->map + y * gt->width;
+    for (x = 0; x < gt->width; x++, pixel++, dest += pixel_stride) {
+      const guint8 *row0, *row1;
+      const guint8 *s00, *s01, *s10, *s11;
 
-    default:
-      break;
+      if (pixel->x0 == PIXEL_OFF_EDGE) {
+        gst_geometric_transform_copy_pixel (dest, black, pixel_stride);
+        continue;
+      }
+
+      row0 = slice->in_data + pixel->y0 * slice->in_stride;
+      s00 = row0 + pixel->x0 * pixel_stride;
+
+      /* nearest neighbour, or a source pixel that is hit exactly */
+      if (pixel->wx == 0 && pixel->wy == 0) {
+        gst_geometric_transform_copy_pixel (dest, s00, pixel_stride);
+        continue;
+      }
+
+      row1 = slice->in_data + pixel->y1 * slice->in_stride;
+      s01 = row0 + pixel->x1 * pixel_stride;
+      s10 = row1 + pixel->x0 * pixel_stride;
+      s11 = row1 + pixel->x1 * pixel_stride;
+
+      switch (gt->format) {
+        case GST_VIDEO_FORMAT_GRAY16_LE:
+          GST_WRITE_UINT16_LE (dest,
+              gst_geometric_transform_lerp (GST_READ_UINT16_LE (s00),
+                  GST_READ_UINT16_LE (s01), GST_READ_UINT16_LE (s10),
+                  GST_READ_UINT16_LE (s11), pixel->wx, pixel->wy));
+          break;
+        case GST_VIDEO_FORMAT_GRAY16_BE:
+          GST_WRITE_UINT16_BE (dest,
+              gst_geometric_transform_lerp (GST_READ_UINT16_BE (s00),
+                  GST_READ_UINT16_BE (s01), GST_READ_UINT16_BE (s10),
+                  GST_READ_UINT16_BE (s11), pixel->wx, pixel->wy));
+          break;
+        default:
+          /* all other formats have 8 bits components */
+          for (c = 0; c < pixel_stride; c++)
+            dest[c] = gst_geometric_transform_lerp (s00[c], s01[c], s10[c],
+                s11[c], pixel->wx, pixel->wy);
+          break;
+      }
+    }
   }
+}
 
-  {
-    gint trunc_x = (gint) in_x;
-    gint trunc_y = (gint) in_y;
-    /* only set the values if the values are valid */
-    if (trunc_x >= 0 && trunc_x < gt->width && trunc_y >= 0 &&
-        trunc_y < gt->height) {
-      in_offset = trunc_y * gt->row_stride + trunc_x * gt->pixel_stride;
+/* must be called with the object lock */
+static void
+gst_geometric_transform_run_slices (GstGeometricTransform * gt,
+    GstVideoFrame * in_frame, GstVideoFrame * out_frame)
+{
+  GstGeometricTransformSlice *slice;
+  guint n_threads, n_slices, i;
+
+  n_threads = gt->n_threads ? gt->n_threads : g_get_num_processors ();
+  /* not worth waking up a thread for less than 16 rows */
+  n_slices = CLAMP (gt->height / 16, 1, n_threads);
+
+  g_array_set_size (gt->slices, n_slices);
+  for (i = 0; i < n_slices; i++) {
+    slice = &g_array_index (gt->slices, GstGeometricTransformSlice, i);
+    slice->gt = gt;
+    slice->in_data = GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0);
+    slice->out_data = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0);
+    slice->in_stride = GST_VIDEO_FRAME_PLANE_STRIDE (in_frame, 0);
+    slice->out_stride = GST_VIDEO_FRAME_PLANE_STRIDE (out_frame, 0);
+    slice->y_start = gt->height * i / n_slices;
+    slice->y_end = gt->height * (i + 1) / n_slices;
+    slice->task = NULL;
+  }
 
-      memcpy (out_data + out_offset, in_data + in_offset, gt->pixel_stride);
+  if (n_slices > 1) {
+    if (!gt->pool) {
+      gt->pool = gst_shared_task_pool_new ();
+      gst_task_pool_prepare (gt->pool, NULL);
+    }
+    /* the streaming thread fills the first slice itself */
+    gst_shared_task_pool_set_max_threads (GST_SHARED_TASK_POOL (gt->pool),
+        n_slices - 1);
+
+    for (i = 1; i < n_slices; i++) {
+      slice = &g_array_index (gt->slices, GstGeometricTransformSlice, i);
+      slice->task = gst_task_pool_push (gt->pool,
+          (GstTaskPoolFunction) gst_geometric_transform_slice_run, slice,
+          NULL);
     }
   }
+
+  for (i = 0; i < n_slices; i++) {
+    slice = &g_array_index (gt->slices, GstGeometricTransformSlice, i);
+    if (slice->task)
+      gst_task_pool_join (gt->pool, slice->task);
+    else
+      gst_geometric_transform_slice_run (slice);
+  }
 }
 
 static void
@@ -229,64 +471,37 @@ gst_geometric_transform_transform_frame (GstVideoFilter * vfilter,
 {
   GstGeometricTransform *gt;
   GstGeometricTransformClass *klass;
-  gint x, y, i;
   GstFlowReturn ret = GST_FLOW_OK;
-  gdouble *ptr;
-  guint8 *in_data;
-  guint8 *out_data;
 
   gt = GST_GEOMETRIC_TRANSFORM_CAST (vfilter);
   klass = GST_GEOMETRIC_TRANSFORM_GET_CLASS (gt);
 
-  in_data = GST_VIDEO_FRAME_PLANE_DATA (in_frame, 0);
-  out_data = GST_VIDEO_FRAME_PLANE_DATA (out_frame, 0);
-
-  if (GST_VIDEO_FRAME_FORMAT (out_frame) == GST_VIDEO_FORMAT_AYUV) {
-    /* in AYUV black is not just all zeros:
-     * 0x10 is black for Y,
-     * 0x80 is black for Cr and Cb */
-    for (i = 0; i < out_frame->map[0].size; i += 4)
-      GST_WRITE_UINT32_BE (out_data + i, 0xff108080);
-  } else {
-    memset (out_data, 0, out_frame->map[0].size);
-  }
-
   GST_OBJECT_LOCK (gt);
   if (gt->precalc_map) {
     if (gt->needs_remap) {
       if (klass->prepare_func)
         if (!klass->prepare_func (gt)) {
-          ret = FALSE;
+          ret = GST_FLOW_ERROR;
           goto end;
         }
       gst_geometric_transform_generate_map (gt);
     }
-    g_return_val_if_fail (gt->map, GST_FLOW_ERROR);
-    ptr = gt->map;
-    for (y = 0; y < gt->height; y++) {
-      for (x = 0; x < gt->width; x++) {
-        /* do the mapping */
-        gst_geometric_transform_do_map (gt, in_data, out_data, x, y, ptr[0],
-            ptr[1]);
-        ptr += 2;
-      }
-    }
   } else {
-    for (y = 0; y < gt->height; y++) {
-      for (x = 0; x < gt->width; x++) {
-        gdouble in_x, in_y;
-
-        if (klass->map_func (gt, x, y, &in_x, &in_y)) {
-          gst_geometric_transform_do_map (gt, in_data, out_data, x, y, in_x,
-              in_y);
-        } else {
-          GST_WARNING_OBJECT (gt, "Failed to do mapping for %d %d", x, y);
-          ret = GST_FLOW_ERROR;
-          goto end;
-        }
-      }
+    /* the mapping changes with each frame, the per pixel work is still
+     * shared with the precalculated case */
+    if (!gst_geometric_transform_generate_map (gt)) {
+      ret = GST_FLOW_ERROR;
+      goto end;
     }
   }
+
+  if (gt->map == NULL) {
+    ret = GST_FLOW_ERROR;
+    goto end;
+  }
+
+  gst_geometric_transform_run_slices (gt, in_frame, out_frame);
+
 end:
   GST_OBJECT_UNLOCK (gt);
   return ret;
@@ -301,9 +516,34 @@ gst_geometric_transform_set_property (GObject * object, guint prop_id,
   gt = GST_GEOMETRIC_TRANSFORM_CAST (object);
 
   switch (prop_id) {
-    case PROP_OFF_EDGE_PIXELS:
+    case PROP_OFF_EDGE_PIXELS:{
+      gint off_edge_pixels;
+
+      off_edge_pixels = g_value_get_enum (value);
+      GST_OBJECT_LOCK (gt);
+      /* the method is applied when generating the map */
+      if (off_edge_pixels != gt->off_edge_pixels) {
+        gt->off_edge_pixels = off_edge_pixels;
+        gst_geometric_transform_set_need_remap (gt);
+      }
+      GST_OBJECT_UNLOCK (gt);
+      break;
+    }
+    case PROP_INTERPOLATION:{
+      gint interpolation;
+
+      interpolation = g_value_get_enum (value);
       GST_OBJECT_LOCK (gt);
-      gt->off_edge_pixels = g_value_get_enum (value);
+      if (interpolation != gt->interpolation) {
+        gt->interpolation = interpolation;
+        gst_geometric_transform_set_need_remap (gt);
+      }
+      GST_OBJECT_UNLOCK (gt);
+      break;
+    }
+    case PROP_N_THREADS:
+      GST_OBJECT_LOCK (gt);
+      gt->n_threads = g_value_get_uint (value);
       GST_OBJECT_UNLOCK (gt);
       break;
     default:
@@ -324,6 +564,12 @@ gst_geometric_transform_get_property (GObject * object, guint prop_id,
     case PROP_OFF_EDGE_PIXELS:
       g_value_set_enum (value, gt->off_edge_pixels);
       break;
+    case PROP_INTERPOLATION:
+      g_value_set_enum (value, gt->interpolation);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, gt->n_threads);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -347,6 +593,22 @@ gst_geometric_transform_stop (GstBaseTransform * trans)
   return TRUE;
 }
 
+static void
+gst_geometric_transform_finalize (GObject * object)
+{
+  GstGeometricTransform *gt = GST_GEOMETRIC_TRANSFORM_CAST (object);
+
+  if (gt->pool) {
+    gst_task_pool_cleanup (gt->pool);
+    gst_object_unref (gt->pool);
+  }
+  g_array_free (gt->slices, TRUE);
+
+  g_free (gt->map);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gst_geometric_transform_base_init (gpointer g_class)
 {
@@ -373,6 +635,7 @@ gst_geometric_transform_class_init (gpointer klass, gpointer class_data)
 
   obj_class->set_property = gst_geometric_transform_set_property;
   obj_class->get_property = gst_geometric_transform_get_property;
+  obj_class->finalize = gst_geometric_transform_finalize;
 
   trans_class->stop = GST_DEBUG_FUNCPTR (gst_geometric_transform_stop);
   trans_class->before_transform =
@@ -389,7 +652,37 @@ gst_geometric_transform_class_init (gpointer klass, gpointer class_data)
           GST_GT_OFF_EDGES_PIXELS_METHOD_TYPE, DEFAULT_OFF_EDGE_PIXELS,
           GST_PARAM_CONTROLLABLE | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstGeometricTransform:interpolation:
+   *
+   * How output pixels are computed from the source position given by the
+   * transform. Bilinear interpolation blends the 4 closest source pixels
+   * and avoids the jagged edges of nearest neighbour.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (obj_class, PROP_INTERPOLATION,
+      g_param_spec_enum ("interpolation", "Interpolation",
+          "Interpolation method of the source pixels",
+          GST_GT_INTERPOLATION_METHOD_TYPE, DEFAULT_INTERPOLATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstGeometricTransform:n-threads:
+   *
+   * Maximum number of threads used to fill the output frames, each one
+   * handling a band of rows. 0 uses one per processor.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (obj_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Maximum number of threads filling a frame (0 = auto)",
+          0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_type_mark_as_plugin_api (GST_GT_OFF_EDGES_PIXELS_METHOD_TYPE, 0);
+  gst_type_mark_as_plugin_api (GST_GT_INTERPOLATION_METHOD_TYPE, 0);
   gst_type_mark_as_plugin_api (GST_TYPE_GEOMETRIC_TRANSFORM, 0);
 }
 
@@ -399,8 +692,12 @@ gst_geometric_transform_init (GTypeInstance * instance, gpointer g_class)
   GstGeometricTransform *gt = GST_GEOMETRIC_TRANSFORM_CAST (instance);
 
   gt->off_edge_pixels = DEFAULT_OFF_EDGE_PIXELS;
+  gt->interpolation = DEFAULT_INTERPOLATION;
+  gt->n_threads = DEFAULT_N_THREADS;
   gt->precalc_map = TRUE;
   gt->needs_remap = TRUE;
+
+  gt->slices = g_array_new (FALSE, FALSE, sizeof (GstGeometricTransformSlice));
 }
 
 GType
@@ -46,8 +46,15 @@ enum
   GST_GT_OFF_EDGES_PIXELS_WRAP
 };
 
+enum
+{
+  GST_GT_INTERPOLATION_NEAREST = 0,
+  GST_GT_INTERPOLATION_BILINEAR
+};
+
 typedef struct _GstGeometricTransform GstGeometricTransform;
 typedef struct _GstGeometricTransformClass GstGeometricTransformClass;
+typedef struct _GstGeometricTransformPixel GstGeometricTransformPixel;
 
 /**
  * GstGeometricTransformMapFunc:
@@ -99,8 +106,15 @@ struct _GstGeometricTransform {
 
   /* properties */
   gint off_edge_pixels;
+  gint interpolation;
+  guint n_threads;
+
+  /* source pixel of each output pixel, with the off edge pixels method
+   * already applied */
+  GstGeometricTransformPixel *map;
 
-  gdouble *map;
+  GstTaskPool *pool;
+  GArray *slices;
 };
 
 struct _GstGeometricTransformClass {
@@ -178,6 +178,31 @@ gst_inter_audio_sink_finalize (GObject * object)
   G_OBJECT_CLASS (gst_inter_audio_sink_parent_class)->finalize (object);
 }
 
+/* Must be called with the surface mutex held */
+static void
+gst_inter_audio_sink_flush_input (GstInterAudioSink * interaudiosink)
+{
+  GList *buffers, *l;
+  guint n, bpf;
+
+  n = gst_adapter_available (interaudiosink->input_adapter);
+  if (n == 0)
+    return;
+
+  /* Hand over the buffers themselves instead of merging them into one */
+  bpf = interaudiosink->info.bpf;
+  buffers = gst_adapter_take_list (interaudiosink->input_adapter, n);
+  for (l = buffers; l; l = l->next) {
+    GstBuffer *tmp = l->data;
+
+    if (bpf > 0)
+      gst_inter_surface_push_audio (interaudiosink->surface, tmp,
+          gst_buffer_get_size (tmp) / bpf);
+    gst_buffer_unref (tmp);
+  }
+  g_list_free (buffers);
+}
+
 static void
 gst_inter_audio_sink_get_times (GstBaseSink * sink, GstBuffer * buffer,
     GstClockTime * start, GstClockTime * end)
@@ -226,7 +251,7 @@ gst_inter_audio_sink_stop (GstBaseSink * sink)
   GST_DEBUG_OBJECT (interaudiosink, "stop");
 
   g_mutex_lock (&interaudiosink->surface->mutex);
-  gst_adapter_clear (interaudiosink->surface->audio_adapter);
+  gst_inter_surface_clear_audio (interaudiosink->surface);
   memset (&interaudiosink->surface->audio_info, 0, sizeof (GstAudioInfo));
   g_mutex_unlock (&interaudiosink->surface->mutex);
 
@@ -253,7 +278,7 @@ gst_inter_audio_sink_set_caps (GstBaseSink * sink, GstCaps * caps)
   interaudiosink->surface->audio_info = info;
   interaudiosink->info = info;
   /* TODO: Ideally we would drain the source here */
-  gst_adapter_clear (interaudiosink->surface->audio_adapter);
+  gst_inter_surface_clear_audio (interaudiosink->surface);
   g_mutex_unlock (&interaudiosink->surface->mutex);
 
   return TRUE;
@@ -266,15 +291,9 @@ gst_inter_audio_sink_event (GstBaseSink * sink, GstEvent * event)
 
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_EOS:{
-      GstBuffer *tmp;
-      guint n;
-
-      if ((n = gst_adapter_available (interaudiosink->input_adapter)) > 0) {
-        g_mutex_lock (&interaudiosink->surface->mutex);
-        tmp = gst_adapter_take_buffer (interaudiosink->input_adapter, n);
-        gst_adapter_push (interaudiosink->surface->audio_adapter, tmp);
-        g_mutex_unlock (&interaudiosink->surface->mutex);
-      }
+      g_mutex_lock (&interaudiosink->surface->mutex);
+      gst_inter_audio_sink_flush_input (interaudiosink);
+      g_mutex_unlock (&interaudiosink->surface->mutex);
       break;
     }
     default:
@@ -317,27 +336,18 @@ gst_inter_audio_sink_render (GstBaseSink * sink, GstBuffer * buffer)
       gst_util_uint64_scale (period_time, interaudiosink->info.rate,
       GST_SECOND);
 
-  n = gst_adapter_available (interaudiosink->surface->audio_adapter) / bpf;
-  while (n > buffer_samples) {
-    GST_DEBUG_OBJECT (interaudiosink, "flushing %" GST_TIME_FORMAT,
-        GST_TIME_ARGS (period_time));
-    gst_adapter_flush (interaudiosink->surface->audio_adapter,
-        period_samples * bpf);
-    n -= period_samples;
-  }
+  /* Forget about the samples that even the slowest source will not get
+   * to anymore */
+  gst_inter_surface_trim_audio (interaudiosink->surface, buffer_samples,
+      period_samples);
 
   n = gst_adapter_available (interaudiosink->input_adapter);
   if (period_samples * bpf > gst_buffer_get_size (buffer) + n) {
     gst_adapter_push (interaudiosink->input_adapter, gst_buffer_ref (buffer));
   } else {
-    GstBuffer *tmp;
-
-    if (n > 0) {
-      tmp = gst_adapter_take_buffer (interaudiosink->input_adapter, n);
-      gst_adapter_push (interaudiosink->surface->audio_adapter, tmp);
-    }
-    gst_adapter_push (interaudiosink->surface->audio_adapter,
-        gst_buffer_ref (buffer));
+    gst_inter_audio_sink_flush_input (interaudiosink);
+    gst_inter_surface_push_audio (interaudiosink->surface, buffer,
+        gst_buffer_get_size (buffer) / bpf);
   }
   g_mutex_unlock (&interaudiosink->surface->mutex);
 
@@ -21,6 +21,7 @@
 #define _GST_INTER_AUDIO_SINK_H_
 
 #include <gst/base/gstbasesink.h>
+#include <gst/base/gstadapter.h>
 #include "gstintersurface.h"
 
 G_BEGIN_DECLS
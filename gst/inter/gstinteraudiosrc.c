@@ -282,6 +282,7 @@ gst_inter_audio_src_start (GstBaseSrc * src)
   interaudiosrc->surface = gst_inter_surface_get (interaudiosrc->channel);
   interaudiosrc->timestamp_offset = 0;
   interaudiosrc->n_samples = 0;
+  interaudiosrc->audio_cursor = 0;
 
   g_mutex_lock (&interaudiosrc->surface->mutex);
   interaudiosrc->surface->audio_buffer_time = interaudiosrc->buffer_time;
@@ -363,17 +364,13 @@ gst_inter_audio_src_create (GstBaseSrc * src, guint64 offset, guint size,
   period_samples =
       gst_util_uint64_scale (period_time, interaudiosrc->info.rate, GST_SECOND);
 
-  if (bpf > 0)
-    n = gst_adapter_available (interaudiosrc->surface->audio_adapter) / bpf;
-  else
-    n = 0;
-
-  if (n > period_samples)
-    n = period_samples;
-  if (n > 0) {
-    buffer = gst_adapter_take_buffer (interaudiosrc->surface->audio_adapter,
-        n * bpf);
-  } else {
+  /* Every source has its own position in the samples kept by the sink,
+   * and the returned buffer shares the memory of the sink's buffers */
+  buffer = gst_inter_surface_read_audio (interaudiosrc->surface,
+      &interaudiosrc->audio_cursor, period_samples, bpf);
+  n = buffer ? gst_buffer_get_size (buffer) / bpf : 0;
+  if (n == 0) {
+    gst_buffer_replace (&buffer, NULL);
     buffer = gst_buffer_new ();
     GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_GAP);
   }
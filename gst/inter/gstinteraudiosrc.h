@@ -43,6 +43,7 @@ struct _GstInterAudioSrc
   char *channel;
 
   guint64 n_samples;
+  guint64 audio_cursor;
   GstClockTime timestamp_offset;
   GstAudioInfo info;
   guint64 buffer_time, latency_time, period_time;
@@ -28,6 +28,13 @@
 static GList *list;
 static GMutex mutex;
 
+static void
+gst_inter_audio_chunk_free (GstInterAudioChunk * chunk)
+{
+  gst_buffer_unref (chunk->buffer);
+  g_slice_free (GstInterAudioChunk, chunk);
+}
+
 GstInterSurface *
 gst_inter_surface_get (const char *name)
 {
@@ -48,7 +55,9 @@ gst_inter_surface_get (const char *name)
   surface->ref_count = 1;
   surface->name = g_strdup (name);
   g_mutex_init (&surface->mutex);
-  surface->audio_adapter = gst_adapter_new ();
+  surface->video_ring_size = DEFAULT_VIDEO_RING_SIZE;
+  surface->video_ring = g_new0 (GstBuffer *, surface->video_ring_size);
+  g_queue_init (&surface->audio_chunks);
   surface->audio_buffer_time = DEFAULT_AUDIO_BUFFER_TIME;
   surface->audio_latency_time = DEFAULT_AUDIO_LATENCY_TIME;
   surface->audio_period_time = DEFAULT_AUDIO_PERIOD_TIME;
@@ -78,11 +87,162 @@ gst_inter_surface_unref (GstInterSurface * surface)
     }
 
     g_mutex_clear (&surface->mutex);
-    gst_buffer_replace (&surface->video_buffer, NULL);
+    gst_inter_surface_clear_video (surface);
+    g_free (surface->video_ring);
     gst_buffer_replace (&surface->sub_buffer, NULL);
-    gst_object_unref (surface->audio_adapter);
+    gst_inter_surface_clear_audio (surface);
     g_free (surface->name);
     g_free (surface);
   }
   g_mutex_unlock (&mutex);
 }
+
+/* Only the sink resizes the ring, readers holding a sequence number
+ * that is not in the new ring anymore simply see a missing buffer */
+void
+gst_inter_surface_set_video_ring_size (GstInterSurface * surface, guint size)
+{
+  g_return_if_fail (size > 0);
+
+  if (size == surface->video_ring_size)
+    return;
+
+  gst_inter_surface_clear_video (surface);
+  g_free (surface->video_ring);
+  surface->video_ring = g_new0 (GstBuffer *, size);
+  surface->video_ring_size = size;
+}
+
+void
+gst_inter_surface_push_video (GstInterSurface * surface, GstBuffer * buffer)
+{
+  guint idx = surface->video_seq % surface->video_ring_size;
+
+  gst_buffer_replace (&surface->video_ring[idx], buffer);
+  surface->video_seq++;
+}
+
+/* Drops all buffers but keeps counting, so that readers never mistake a
+ * buffer pushed later for one they have already seen */
+void
+gst_inter_surface_clear_video (GstInterSurface * surface)
+{
+  guint i;
+
+  for (i = 0; i < surface->video_ring_size; i++)
+    gst_buffer_replace (&surface->video_ring[i], NULL);
+}
+
+/* Returns a new reference to the buffer with sequence number @seq, or NULL
+ * if it was not pushed yet, was overwritten or was cleared */
+GstBuffer *
+gst_inter_surface_peek_video (GstInterSurface * surface, guint64 seq)
+{
+  GstBuffer *buffer;
+
+  if (seq >= surface->video_seq ||
+      surface->video_seq - seq > surface->video_ring_size)
+    return NULL;
+
+  buffer = surface->video_ring[seq % surface->video_ring_size];
+
+  return buffer ? gst_buffer_ref (buffer) : NULL;
+}
+
+void
+gst_inter_surface_push_audio (GstInterSurface * surface, GstBuffer * buffer,
+    guint64 n_samples)
+{
+  GstInterAudioChunk *chunk;
+
+  if (n_samples == 0)
+    return;
+
+  chunk = g_slice_new (GstInterAudioChunk);
+  chunk->buffer = gst_buffer_ref (buffer);
+  chunk->offset = surface->audio_end;
+  chunk->n_samples = n_samples;
+  g_queue_push_tail (&surface->audio_chunks, chunk);
+
+  surface->audio_end += n_samples;
+}
+
+/* Forgets the oldest samples @step at a time until at most @max_samples
+ * are left, then drops the chunks nobody can read anymore */
+void
+gst_inter_surface_trim_audio (GstInterSurface * surface, guint64 max_samples,
+    guint64 step)
+{
+  GstInterAudioChunk *chunk;
+
+  if (step == 0)
+    step = 1;
+
+  while (surface->audio_end - surface->audio_start > max_samples)
+    surface->audio_start = MIN (surface->audio_start + step,
+        surface->audio_end);
+
+  while ((chunk = g_queue_peek_head (&surface->audio_chunks)) &&
+      chunk->offset + chunk->n_samples <= surface->audio_start) {
+    g_queue_pop_head (&surface->audio_chunks);
+    gst_inter_audio_chunk_free (chunk);
+  }
+}
+
+void
+gst_inter_surface_clear_audio (GstInterSurface * surface)
+{
+  GstInterAudioChunk *chunk;
+
+  while ((chunk = g_queue_pop_head (&surface->audio_chunks)))
+    gst_inter_audio_chunk_free (chunk);
+  surface->audio_start = surface->audio_end;
+}
+
+/* Returns up to @max_samples samples starting at *@cursor without copying
+ * any sample data: the returned buffer only references the memories of
+ * the pushed buffers. A cursor that fell behind the oldest available
+ * sample is moved forward. Returns NULL if there is nothing to read. */
+GstBuffer *
+gst_inter_surface_read_audio (GstInterSurface * surface, guint64 * cursor,
+    guint64 max_samples, guint bpf)
+{
+  GstBuffer *buffer = NULL;
+  GList *l;
+  guint64 pos, end;
+
+  if (*cursor < surface->audio_start)
+    *cursor = surface->audio_start;
+  else if (*cursor > surface->audio_end)
+    *cursor = surface->audio_end;
+
+  pos = *cursor;
+  end = MIN (pos + max_samples, surface->audio_end);
+  if (bpf == 0 || pos >= end)
+    return NULL;
+
+  for (l = surface->audio_chunks.head; l && pos < end; l = l->next) {
+    GstInterAudioChunk *chunk = l->data;
+    guint64 skip, n;
+    GstBuffer *region;
+
+    if (chunk->offset + chunk->n_samples <= pos)
+      continue;
+
+    skip = pos - chunk->offset;
+    n = MIN (chunk->n_samples - skip, end - pos);
+
+    region = gst_buffer_copy_region (chunk->buffer, GST_BUFFER_COPY_MEMORY,
+        skip * bpf, n * bpf);
+    if (buffer)
+      buffer = gst_buffer_append (buffer, region);
+    else
+      buffer = region;
+
+    pos += n;
+  }
+
+  *cursor = pos;
+
+  return buffer;
+}
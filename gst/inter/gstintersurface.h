@@ -20,7 +20,6 @@
 #ifndef _GST_INTER_SURFACE_H_
 #define _GST_INTER_SURFACE_H_
 
-#include <gst/base/gstadapter.h>
 #include <gst/audio/audio.h>
 #include <gst/video/video.h>
 
@@ -35,29 +34,61 @@ struct _GstInterSurface
 
   char *name;
 
-  /* video */
+  /* video: ring of the last video_ring_size buffers, the buffer with
+   * sequence number seq lives at video_ring[seq % video_ring_size] and
+   * video_seq is the sequence number the next buffer will get */
   GstVideoInfo video_info;
-  int video_buffer_count;
+  GstBuffer **video_ring;
+  guint video_ring_size;
+  guint64 video_seq;
 
   /* audio */
   GstAudioInfo audio_info;
   guint64 audio_buffer_time;
   guint64 audio_latency_time;
   guint64 audio_period_time;
+  /* GstInterAudioChunk, oldest first. Samples are numbered from the
+   * start of the surface, [audio_start, audio_end) are available */
+  GQueue audio_chunks;
+  guint64 audio_start;
+  guint64 audio_end;
 
-  GstBuffer *video_buffer;
   GstBuffer *sub_buffer;
-  GstAdapter *audio_adapter;
 };
 
+typedef struct
+{
+  GstBuffer *buffer;
+  guint64 offset;
+  guint64 n_samples;
+} GstInterAudioChunk;
+
 #define DEFAULT_AUDIO_BUFFER_TIME  (GST_SECOND)
 #define DEFAULT_AUDIO_LATENCY_TIME (100 * GST_MSECOND)
 #define DEFAULT_AUDIO_PERIOD_TIME  (25 * GST_MSECOND)
-
+#define DEFAULT_VIDEO_RING_SIZE    1
+#define MAX_VIDEO_RING_SIZE        256
 
 GstInterSurface * gst_inter_surface_get (const char *name);
 void gst_inter_surface_unref (GstInterSurface *surface);
 
+/* All of the following must be called with the surface mutex held */
+void gst_inter_surface_set_video_ring_size (GstInterSurface *surface,
+    guint size);
+void gst_inter_surface_push_video (GstInterSurface *surface,
+    GstBuffer *buffer);
+void gst_inter_surface_clear_video (GstInterSurface *surface);
+GstBuffer * gst_inter_surface_peek_video (GstInterSurface *surface,
+    guint64 seq);
+
+void gst_inter_surface_push_audio (GstInterSurface *surface,
+    GstBuffer *buffer, guint64 n_samples);
+void gst_inter_surface_trim_audio (GstInterSurface *surface,
+    guint64 max_samples, guint64 step);
+void gst_inter_surface_clear_audio (GstInterSurface *surface);
+GstBuffer * gst_inter_surface_read_audio (GstInterSurface *surface,
+    guint64 *cursor, guint64 max_samples, guint bpf);
+
 
 G_END_DECLS
 
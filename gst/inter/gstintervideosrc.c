@@ -71,11 +71,33 @@ enum
 {
   PROP_0,
   PROP_CHANNEL,
-  PROP_TIMEOUT
+  PROP_TIMEOUT,
+  PROP_MODE
 };
 
 #define DEFAULT_CHANNEL ("default")
 #define DEFAULT_TIMEOUT (GST_SECOND)
+#define DEFAULT_MODE GST_INTER_VIDEO_SRC_MODE_LATEST
+
+GType
+gst_inter_video_src_mode_get_type (void)
+{
+  static GType gst_inter_video_src_mode_type = 0;
+  static const GEnumValue gst_inter_video_src_mode[] = {
+    {GST_INTER_VIDEO_SRC_MODE_LATEST,
+        "Output the most recent frame, dropping the ones in between", "latest"},
+    {GST_INTER_VIDEO_SRC_MODE_ALL,
+        "Output all frames kept by the sink in order", "all"},
+    {0, NULL, NULL}
+  };
+
+  if (!gst_inter_video_src_mode_type) {
+    gst_inter_video_src_mode_type =
+        g_enum_register_static ("GstInterVideoSrcMode",
+        gst_inter_video_src_mode);
+  }
+  return gst_inter_video_src_mode_type;
+}
 
 /* pad templates */
 static GstStaticPadTemplate gst_inter_video_src_src_template =
@@ -130,6 +152,27 @@ gst_inter_video_src_class_init (GstInterVideoSrcClass * klass)
           "Timeout after which to start outputting black frames",
           0, G_MAXUINT64, DEFAULT_TIMEOUT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstInterVideoSrc:mode:
+   *
+   * How to pick the next frame when the sink pushed more than one since
+   * the last one was output. Every source of a channel has its own
+   * position, so sources running at different framerates do not affect
+   * each other. In "all" mode the source can lag behind the sink by up
+   * to #GstInterVideoSink:ring-size frames, older frames are dropped.
+   * In both modes the last frame is repeated until a new one is
+   * available or the timeout expires.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_MODE,
+      g_param_spec_enum ("mode", "Mode",
+          "How to pick the next frame from the ones kept by the sink",
+          GST_TYPE_INTER_VIDEO_SRC_MODE, DEFAULT_MODE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_type_mark_as_plugin_api (GST_TYPE_INTER_VIDEO_SRC_MODE, 0);
 }
 
 static void
@@ -140,6 +183,7 @@ gst_inter_video_src_init (GstInterVideoSrc * intervideosrc)
 
   intervideosrc->channel = g_strdup (DEFAULT_CHANNEL);
   intervideosrc->timeout = DEFAULT_TIMEOUT;
+  intervideosrc->mode = DEFAULT_MODE;
 }
 
 void
@@ -156,6 +200,9 @@ gst_inter_video_src_set_property (GObject * object, guint property_id,
     case PROP_TIMEOUT:
       intervideosrc->timeout = g_value_get_uint64 (value);
       break;
+    case PROP_MODE:
+      intervideosrc->mode = g_value_get_enum (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -175,6 +222,9 @@ gst_inter_video_src_get_property (GObject * object, guint property_id,
     case PROP_TIMEOUT:
       g_value_set_uint64 (value, intervideosrc->timeout);
       break;
+    case PROP_MODE:
+      g_value_set_enum (value, intervideosrc->mode);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -276,6 +326,9 @@ gst_inter_video_src_start (GstBaseSrc * src)
   intervideosrc->surface = gst_inter_surface_get (intervideosrc->channel);
   intervideosrc->timestamp_offset = 0;
   intervideosrc->n_frames = 0;
+  intervideosrc->video_cursor = 0;
+  intervideosrc->video_seq = G_MAXUINT64;
+  intervideosrc->video_count = 0;
 
   return TRUE;
 }
@@ -327,6 +380,7 @@ gst_inter_video_src_create (GstBaseSrc * src, guint64 offset, guint size,
   GstCaps *caps;
   GstBuffer *buffer;
   guint64 frames;
+  guint64 surface_seq, seq;
   gboolean is_gap = FALSE;
 
   GST_DEBUG_OBJECT (intervideosrc, "create");
@@ -360,24 +414,40 @@ gst_inter_video_src_create (GstBaseSrc * src, guint64 offset, guint size,
     }
   }
 
-  if (intervideosrc->surface->video_buffer) {
-    /* We have a buffer to push */
-    buffer = gst_buffer_ref (intervideosrc->surface->video_buffer);
+  surface_seq = intervideosrc->surface->video_seq;
+  if (intervideosrc->video_cursor < surface_seq) {
+    /* The sink pushed something new since we last looked */
+    if (intervideosrc->mode == GST_INTER_VIDEO_SRC_MODE_ALL) {
+      seq = intervideosrc->video_cursor;
+      if (surface_seq - seq > intervideosrc->surface->video_ring_size)
+        seq = surface_seq - intervideosrc->surface->video_ring_size;
+    } else {
+      seq = surface_seq - 1;
+    }
 
-    /* Can only be true if timeout > 0 */
-    if (intervideosrc->surface->video_buffer_count == frames) {
-      gst_buffer_unref (intervideosrc->surface->video_buffer);
-      intervideosrc->surface->video_buffer = NULL;
+    if (seq > intervideosrc->video_cursor) {
+      GST_LOG_OBJECT (intervideosrc, "dropping %" G_GUINT64_FORMAT " frames",
+          seq - intervideosrc->video_cursor);
     }
+
+    intervideosrc->video_cursor = seq + 1;
+    intervideosrc->video_seq = seq;
+    intervideosrc->video_count = 0;
   }
 
-  if (intervideosrc->surface->video_buffer_count != 0 &&
-      intervideosrc->surface->video_buffer_count != (frames + 1)) {
+  /* Repeat the current buffer until the timeout, which can only expire
+   * if timeout > 0 */
+  if (intervideosrc->video_count <= frames)
+    buffer = gst_inter_surface_peek_video (intervideosrc->surface,
+        intervideosrc->video_seq);
+
+  if (intervideosrc->video_count != 0 &&
+      intervideosrc->video_count != (frames + 1)) {
     /* This is a repeat of the stored buffer or of a black frame */
     is_gap = TRUE;
   }
 
-  intervideosrc->surface->video_buffer_count++;
+  intervideosrc->video_count++;
   g_mutex_unlock (&intervideosrc->surface->mutex);
 
   if (caps) {
@@ -32,6 +32,14 @@ G_BEGIN_DECLS
 #define GST_IS_INTER_VIDEO_SRC(obj)   (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_INTER_VIDEO_SRC))
 #define GST_IS_INTER_VIDEO_SRC_CLASS(obj)   (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_INTER_VIDEO_SRC))
 
+#define GST_TYPE_INTER_VIDEO_SRC_MODE (gst_inter_video_src_mode_get_type ())
+
+typedef enum
+{
+  GST_INTER_VIDEO_SRC_MODE_LATEST,
+  GST_INTER_VIDEO_SRC_MODE_ALL
+} GstInterVideoSrcMode;
+
 typedef struct _GstInterVideoSrc GstInterVideoSrc;
 typedef struct _GstInterVideoSrcClass GstInterVideoSrcClass;
 
@@ -43,6 +51,14 @@ struct _GstInterVideoSrc
 
   char *channel;
   guint64 timeout;
+  GstInterVideoSrcMode mode;
+
+  /* our cursor in the surface video ring: the next sequence number we
+   * have not looked at yet, the one we are currently outputting and how
+   * many times we have output it (or black after the timeout) */
+  guint64 video_cursor;
+  guint64 video_seq;
+  guint64 video_count;
 
   GstVideoInfo info;
   GstBuffer *black_frame;
@@ -56,6 +72,7 @@ struct _GstInterVideoSrcClass
 };
 
 GType gst_inter_video_src_get_type (void);
+GType gst_inter_video_src_mode_get_type (void);
 
 G_END_DECLS
 
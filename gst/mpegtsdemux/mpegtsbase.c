@@ -1470,6 +1470,13 @@ mpegts_base_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   mpegts_packetizer_push (base->packetizer, buf);
 
   while (res == GST_FLOW_OK) {
+    /* Packets of PIDs that are neither pushed nor parsed, typically the
+     * other programs of a multiplex, would only be logged below. Go over
+     * them in one go when nothing else needs to see every packet. */
+    if (!base->push_unknown && !klass->inspect_packet)
+      mpegts_packetizer_skip_packets (packetizer, base->is_pes,
+          base->known_psi);
+
     pret = mpegts_packetizer_next_packet (base->packetizer, &packet);
 
     /* If we don't have enough data, return */
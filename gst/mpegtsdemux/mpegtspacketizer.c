@@ -260,6 +260,9 @@ mpegts_packetizer_init (MpegTSPacketizer2 * packetizer)
   packetizer->map_data = NULL;
   packetizer->map_size = 0;
   packetizer->map_offset = 0;
+  packetizer->index_pos = 0;
+  packetizer->index_len = 0;
+  packetizer->index_offset = 0;
   packetizer->need_sync = FALSE;
 
   memset (packetizer->pcrtablelut, 0xff, 0x2000);
@@ -457,6 +460,28 @@ mpegts_packetizer_parse_adaptation_field_control (MpegTSPacketizer2 *
   return TRUE;
 }
 
+/* Parses the adaptation field (if any) and sets the payload, packet->data
+ * must point right after the 4 bytes header */
+static inline MpegTSPacketizerPacketReturn
+mpegts_packetizer_parse_packet_data (MpegTSPacketizer2 * packetizer,
+    MpegTSPacketizerPacket * packet)
+{
+  packet->afc_flags = 0;
+  packet->pcr = G_MAXUINT64;
+
+  if (FLAGS_HAS_AFC (packet->scram_afc_cc)) {
+    if (!mpegts_packetizer_parse_adaptation_field_control (packetizer, packet))
+      return FALSE;
+  }
+
+  if (FLAGS_HAS_PAYLOAD (packet->scram_afc_cc))
+    packet->payload = packet->data;
+  else
+    packet->payload = NULL;
+
+  return PACKET_OK;
+}
+
 static MpegTSPacketizerPacketReturn
 mpegts_packetizer_parse_packet (MpegTSPacketizer2 * packetizer,
     MpegTSPacketizerPacket * packet)
@@ -487,20 +512,29 @@ mpegts_packetizer_parse_packet (MpegTSPacketizer2 * packetizer,
 
   packet->data = data;
 
-  packet->afc_flags = 0;
-  packet->pcr = G_MAXUINT64;
+  return mpegts_packetizer_parse_packet_data (packetizer, packet);
+}
 
-  if (FLAGS_HAS_AFC (tmp)) {
-    if (!mpegts_packetizer_parse_adaptation_field_control (packetizer, packet))
-      return FALSE;
-  }
+/* Same as mpegts_packetizer_parse_packet() but takes the header values
+ * from the packet index built by mpegts_packetizer_index_packets() */
+static inline MpegTSPacketizerPacketReturn
+mpegts_packetizer_parse_indexed_packet (MpegTSPacketizer2 * packetizer,
+    MpegTSPacketizerPacket * packet, const MpegTSPacketizerIndexEntry * entry)
+{
+  /* transport_error_indicator 1 */
+  if (G_UNLIKELY (entry->flags & 0x80))
+    return PACKET_BAD;
 
-  if (FLAGS_HAS_PAYLOAD (packet->scram_afc_cc))
-    packet->payload = packet->data;
-  else
-    packet->payload = NULL;
+  packet->payload_unit_start_indicator = entry->flags & 0x40;
+  packet->pid = entry->pid;
+  packet->scram_afc_cc = entry->scram_afc_cc;
+  /* transport_scrambling_control 2 */
+  if (G_UNLIKELY (entry->scram_afc_cc & 0xc0))
+    return PACKET_BAD;
 
-  return PACKET_OK;
+  packet->data = packet->data_start + 4;
+
+  return mpegts_packetizer_parse_packet_data (packetizer, packet);
 }
 
 static GstMpegtsSection *
@@ -591,6 +625,8 @@ mpegts_packetizer_clear (MpegTSPacketizer2 * packetizer)
   packetizer->map_data = NULL;
   packetizer->map_size = 0;
   packetizer->map_offset = 0;
+  packetizer->index_pos = 0;
+  packetizer->index_len = 0;
   packetizer->last_in_time = GST_CLOCK_TIME_NONE;
   packetizer->last_pts = GST_CLOCK_TIME_NONE;
   packetizer->last_dts = GST_CLOCK_TIME_NONE;
@@ -633,6 +669,8 @@ mpegts_packetizer_flush (MpegTSPacketizer2 * packetizer, gboolean hard)
   packetizer->map_data = NULL;
   packetizer->map_size = 0;
   packetizer->map_offset = 0;
+  packetizer->index_pos = 0;
+  packetizer->index_len = 0;
   packetizer->last_in_time = GST_CLOCK_TIME_NONE;
   packetizer->last_pts = GST_CLOCK_TIME_NONE;
   packetizer->last_dts = GST_CLOCK_TIME_NONE;
@@ -712,6 +750,8 @@ mpegts_packetizer_flush_bytes (MpegTSPacketizer2 * packetizer, gsize size)
   packetizer->map_data = NULL;
   packetizer->map_size = 0;
   packetizer->map_offset = 0;
+  packetizer->index_pos = 0;
+  packetizer->index_len = 0;
 }
 
 static gboolean
@@ -728,6 +768,18 @@ mpegts_packetizer_map (MpegTSPacketizer2 * packetizer, gsize size)
   if (available < size)
     return FALSE;
 
+  /* When going through the packets one by one, only map what the first
+   * buffer of the adapter holds, which doesn't copy anything. Mapping all
+   * of the adapter would merge the buffers (and so copy the whole stream)
+   * every time upstream buffers aren't a multiple of the packet size, now
+   * only the packet straddling two buffers is. The sync code still maps
+   * everything to be able to scan as far as possible. */
+  if (size == packetizer->packet_size) {
+    gsize contiguous = gst_adapter_available_fast (packetizer->adapter);
+
+    available = MAX (contiguous, size);
+  }
+
   packetizer->map_data =
       (guint8 *) gst_adapter_map (packetizer->adapter, available);
   if (!packetizer->map_data)
@@ -835,6 +887,51 @@ mpegts_packetizer_sync (MpegTSPacketizer2 * packetizer)
   return found;
 }
 
+/* Validates the sync bytes of all the packets available in the current map
+ * (up to MPEGTS_PACKETIZER_INDEX_SIZE) in one go and stores their headers,
+ * so that the following calls to mpegts_packetizer_next_packet() don't have
+ * to check them one by one. The index stops at the first packet without a
+ * sync byte, which is then handled by the regular resync code.
+ *
+ * The sync bytes are 188/192/204 bytes apart, which SIMD loads can't gather
+ * any faster than one 32bit load per packet, so this is kept as a tight
+ * scalar loop. */
+static gboolean
+mpegts_packetizer_index_packets (MpegTSPacketizer2 * packetizer,
+    gsize sync_offset)
+{
+  MpegTSPacketizerIndexEntry *entries = packetizer->index;
+  const guint8 *data;
+  guint packet_size = packetizer->packet_size;
+  gsize size;
+  guint i, max;
+
+  size = packetizer->map_size - packetizer->map_offset;
+  data = packetizer->map_data + packetizer->map_offset + sync_offset;
+
+  max = MIN (size / packet_size, MPEGTS_PACKETIZER_INDEX_SIZE);
+
+  for (i = 0; i < max; i++) {
+    guint32 header = GST_READ_UINT32_BE (data);
+
+    if (G_UNLIKELY ((header >> 24) != PACKET_SYNC_BYTE))
+      break;
+
+    entries[i].flags = (header >> 16) & 0xc0;
+    entries[i].pid = (header >> 8) & 0x1fff;
+    entries[i].scram_afc_cc = header & 0xff;
+    data += packet_size;
+  }
+
+  GST_LOG ("indexed %u packets out of %u", i, max);
+
+  packetizer->index_pos = 0;
+  packetizer->index_len = i;
+  packetizer->index_offset = packetizer->map_offset;
+
+  return i > 0;
+}
+
 MpegTSPacketizerPacketReturn
 mpegts_packetizer_next_packet (MpegTSPacketizer2 * packetizer,
     MpegTSPacketizerPacket * packet)
@@ -863,11 +960,29 @@ mpegts_packetizer_next_packet (MpegTSPacketizer2 * packetizer,
       packetizer->need_sync = FALSE;
     }
 
-    if (!mpegts_packetizer_map (packetizer, packet_size))
-      return PACKET_NEED_MORE;
+    /* Fast path: the packet was already validated by the last batch */
+    if (packetizer->index_pos >= packetizer->index_len
+        || packetizer->index_offset != packetizer->map_offset) {
+      if (!mpegts_packetizer_map (packetizer, packet_size))
+        return PACKET_NEED_MORE;
+      mpegts_packetizer_index_packets (packetizer, sync_offset);
+    }
 
     packet_data = &packetizer->map_data[packetizer->map_offset + sync_offset];
 
+    if (G_LIKELY (packetizer->index_pos < packetizer->index_len)) {
+      const MpegTSPacketizerIndexEntry *entry =
+          &packetizer->index[packetizer->index_pos++];
+
+      packetizer->index_offset += packet_size;
+      packet->data_start = packet_data;
+      packet->data_end = packet->data_start + 188;
+      packet->offset = packetizer->offset;
+      packetizer->offset += packet_size;
+
+      return mpegts_packetizer_parse_indexed_packet (packetizer, packet, entry);
+    }
+
     /* Check sync byte */
     if (G_UNLIKELY (*packet_data != PACKET_SYNC_BYTE)) {
       GST_DEBUG ("lost sync");
@@ -914,6 +1029,50 @@ mpegts_packetizer_clear_packet (MpegTSPacketizer2 * packetizer,
   }
 }
 
+/* Goes over the packets of the current batch for which
+ * mpegts_packetizer_next_packet() would return something the caller ignores:
+ * packets whose PID is set in neither @pids nor @other_pids, and without
+ * adaptation field (which could hold a PCR or a discontinuity). This avoids
+ * going through the whole packet parsing and dispatching for each packet of
+ * the other programs of a multiplex. Returns the number of skipped packets */
+guint
+mpegts_packetizer_skip_packets (MpegTSPacketizer2 * packetizer,
+    const guint8 * pids, const guint8 * other_pids)
+{
+  const MpegTSPacketizerIndexEntry *entry;
+  guint packet_size = packetizer->packet_size;
+  guint skipped = 0;
+
+  if (packetizer->map_data == NULL
+      || packetizer->index_offset != packetizer->map_offset)
+    return 0;
+
+  while (packetizer->index_pos < packetizer->index_len) {
+    entry = &packetizer->index[packetizer->index_pos];
+
+    if (FLAGS_HAS_AFC (entry->scram_afc_cc)
+        || MPEGTS_BIT_IS_SET (pids, entry->pid)
+        || MPEGTS_BIT_IS_SET (other_pids, entry->pid))
+      break;
+
+    packetizer->index_pos++;
+    skipped++;
+  }
+
+  if (skipped == 0)
+    return 0;
+
+  GST_LOG ("skipped %u packets", skipped);
+
+  packetizer->index_offset += skipped * packet_size;
+  packetizer->map_offset += skipped * packet_size;
+  packetizer->offset += skipped * packet_size;
+  if (packetizer->map_size - packetizer->map_offset < packet_size)
+    mpegts_packetizer_flush_bytes (packetizer, packetizer->map_offset);
+
+  return skipped;
+}
+
 gboolean
 mpegts_packetizer_has_packets (MpegTSPacketizer2 * packetizer)
 {
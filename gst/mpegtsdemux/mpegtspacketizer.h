@@ -241,6 +241,18 @@ typedef struct _MpegTSPCR
   PCROffsetCurrent *current;
 } MpegTSPCR;
 
+/* Maximum number of packets validated in one batch */
+#define MPEGTS_PACKETIZER_INDEX_SIZE 256
+
+/* Header of a packet whose sync byte was already checked.
+ * flags contains the transport_error and payload_unit_start bits */
+typedef struct
+{
+  guint16 pid;
+  guint8  flags;
+  guint8  scram_afc_cc;
+} MpegTSPacketizerIndexEntry;
+
 struct _MpegTSPacketizer2 {
   GObject     parent;
 
@@ -269,6 +281,13 @@ struct _MpegTSPacketizer2 {
   gsize map_size;
   gboolean need_sync;
 
+  /* Pre-validated headers of the packets following index_offset in the
+   * current map. Only valid while index_offset == map_offset */
+  MpegTSPacketizerIndexEntry index[MPEGTS_PACKETIZER_INDEX_SIZE];
+  guint index_pos;
+  guint index_len;
+  gsize index_offset;
+
   /* Reference offset */
   guint64 refoffset;
 
@@ -352,6 +371,8 @@ G_GNUC_INTERNAL MpegTSPacketizerPacketReturn
 mpegts_packetizer_process_next_packet(MpegTSPacketizer2 * packetizer);
 G_GNUC_INTERNAL void mpegts_packetizer_clear_packet (MpegTSPacketizer2 *packetizer,
 				     MpegTSPacketizerPacket *packet);
+G_GNUC_INTERNAL guint mpegts_packetizer_skip_packets (MpegTSPacketizer2 *packetizer,
+  const guint8 *pids, const guint8 *other_pids);
 G_GNUC_INTERNAL void mpegts_packetizer_remove_stream(MpegTSPacketizer2 *packetizer,
   gint16 pid);
 
@@ -82,6 +82,30 @@
  * up to this size */
 #define MAX_PES_PAYLOAD (32 * 1024 * 1024)
 
+/* Largest allocation made upfront for a PES without PES_packet_length */
+#define MAX_PES_SIZE_HINT (4 * 1024 * 1024)
+/* Unused space allowed at the end of an output buffer. Beyond that the
+ * allocation is shrunk, so that downstream doesn't keep the headroom of a
+ * small PES sized after a big one alive. */
+#define MAX_PES_SLACK (64 * 1024)
+
+/* Seek index sidecar file: magic, version, PID, PMT PID, program number,
+ * reserved, indexed size and number of entries, followed by the entries.
+ * All little endian. */
+#define INDEX_MAGIC "GSTTSIDX"
+#define INDEX_VERSION 2
+#define INDEX_HEADER_SIZE (8 + 4 + 2 + 2 + 2 + 2 + 8 + 4)
+#define INDEX_ENTRY_SIZE (8 + 8)
+#define INDEX_PID_NONE 0x1fff
+
+typedef struct
+{
+  /* Time of the random access point, as output by tsdemux */
+  GstClockTime ts;
+  /* Offset of the packet starting its PES */
+  guint64 offset;
+} TSDemuxIndexEntry;
+
 GST_DEBUG_CATEGORY_STATIC (ts_demux_debug);
 #define GST_CAT_DEFAULT ts_demux_debug
 
@@ -182,6 +206,8 @@ struct _TSDemuxStream
   guint current_size;
   /* Size of ->data */
   guint allocated_size;
+  /* Size to allocate for the next PES without a PES_packet_length */
+  guint size_hint;
 
   /* Current PTS/DTS for this stream (in running time) */
   GstClockTime pts;
@@ -297,6 +323,7 @@ enum
   PROP_PROGRAM_NUMBER,
   PROP_EMIT_STATS,
   PROP_LATENCY,
+  PROP_INDEX_LOCATION,
   /* FILL ME */
 };
 
@@ -325,6 +352,8 @@ gst_ts_demux_stream_added (MpegTSBase * base, MpegTSBaseStream * stream,
 static void
 gst_ts_demux_stream_removed (MpegTSBase * base, MpegTSBaseStream * stream);
 static GstFlowReturn gst_ts_demux_do_seek (MpegTSBase * base, GstEvent * event);
+static GstStateChangeReturn gst_ts_demux_change_state (GstElement * element,
+    GstStateChange transition);
 static void gst_ts_demux_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec);
 static void gst_ts_demux_get_property (GObject * object, guint prop_id,
@@ -367,6 +396,17 @@ gst_ts_demux_dispose (GObject * object)
   GST_CALL_PARENT (G_OBJECT_CLASS, dispose, (object));
 }
 
+static void
+gst_ts_demux_finalize (GObject * object)
+{
+  GstTSDemux *demux = GST_TS_DEMUX_CAST (object);
+
+  g_free (demux->index_location);
+  g_array_free (demux->index, TRUE);
+
+  GST_CALL_PARENT (G_OBJECT_CLASS, finalize, (object));
+}
+
 static void
 gst_ts_demux_class_init (GstTSDemuxClass * klass)
 {
@@ -378,6 +418,7 @@ gst_ts_demux_class_init (GstTSDemuxClass * klass)
   gobject_class->set_property = gst_ts_demux_set_property;
   gobject_class->get_property = gst_ts_demux_get_property;
   gobject_class->dispose = gst_ts_demux_dispose;
+  gobject_class->finalize = gst_ts_demux_finalize;
 
   g_object_class_install_property (gobject_class, PROP_PROGRAM_NUMBER,
       g_param_spec_int ("program-number", "Program number",
@@ -395,7 +436,26 @@ gst_ts_demux_class_init (GstTSDemuxClass * klass)
           G_MAXINT, DEFAULT_LATENCY,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstTSDemux:index-location:
+   *
+   * File to load the seek index from when starting and to save it to when
+   * stopping. The index maps the random access points of a video stream,
+   * as signalled in the adaptation field of its packets, to their offset.
+   * It is built while playing and is used for seeking to one of them in a
+   * single jump instead of scanning for the PCR and the keyframe.
+   * A loaded index is only used once one of its entries is found again in
+   * the stream, and only for the program it was built for.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_INDEX_LOCATION,
+      g_param_spec_string ("index-location", "Index location",
+          "File to load the seek index from and save it to", NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   element_class = GST_ELEMENT_CLASS (klass);
+  element_class->change_state = GST_DEBUG_FUNCPTR (gst_ts_demux_change_state);
   gst_element_class_add_pad_template (element_class,
       gst_static_pad_template_get (&video_template));
   gst_element_class_add_pad_template (element_class,
@@ -470,6 +530,11 @@ gst_ts_demux_init (GstTSDemux * demux)
   demux->requested_program_number = -1;
   demux->program_number = -1;
   demux->latency = DEFAULT_LATENCY;
+  demux->index = g_array_new (FALSE, FALSE, sizeof (TSDemuxIndexEntry));
+  demux->index_pid = INDEX_PID_NONE;
+  demux->index_program_number = -1;
+  demux->index_pmt_pid = INDEX_PID_NONE;
+  demux->index_verified = TRUE;
   gst_ts_demux_reset (base);
 }
 
@@ -492,6 +557,12 @@ gst_ts_demux_set_property (GObject * object, guint prop_id,
     case PROP_LATENCY:
       demux->latency = g_value_get_int (value);
       break;
+    case PROP_INDEX_LOCATION:
+      GST_OBJECT_LOCK (demux);
+      g_free (demux->index_location);
+      demux->index_location = g_value_dup_string (value);
+      GST_OBJECT_UNLOCK (demux);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
   }
@@ -513,6 +584,11 @@ gst_ts_demux_get_property (GObject * object, guint prop_id,
     case PROP_LATENCY:
       g_value_set_int (value, demux->latency);
       break;
+    case PROP_INDEX_LOCATION:
+      GST_OBJECT_LOCK (demux);
+      g_value_set_string (value, demux->index_location);
+      GST_OBJECT_UNLOCK (demux);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
   }
@@ -836,6 +912,294 @@ typedef struct
   gint merged_offset;           /* offset of merged data in buffer */
 } OffsetInfo;
 
+static void
+gst_ts_demux_index_clear (GstTSDemux * demux)
+{
+  g_array_set_size (demux->index, 0);
+  demux->index_pid = INDEX_PID_NONE;
+  demux->index_program_number = -1;
+  demux->index_pmt_pid = INDEX_PID_NONE;
+  demux->index_size = 0;
+  demux->index_dirty = FALSE;
+  demux->index_verified = TRUE;
+}
+
+static void
+gst_ts_demux_index_load (GstTSDemux * demux, const gchar * location)
+{
+  GstByteReader br;
+  const guint8 *magic;
+  gchar *contents;
+  gsize length;
+  guint32 version, n, i;
+  guint16 pid, pmt_pid, program_number;
+  guint64 size;
+  GError *err = NULL;
+
+  gst_ts_demux_index_clear (demux);
+
+  if (!g_file_get_contents (location, &contents, &length, &err)) {
+    GST_DEBUG_OBJECT (demux, "No index loaded: %s", err->message);
+    g_clear_error (&err);
+    return;
+  }
+
+  gst_byte_reader_init (&br, (const guint8 *) contents, length);
+  if (!gst_byte_reader_get_data (&br, 8, &magic)
+      || memcmp (magic, INDEX_MAGIC, 8) != 0
+      || !gst_byte_reader_get_uint32_le (&br, &version)
+      || version != INDEX_VERSION
+      || !gst_byte_reader_get_uint16_le (&br, &pid)
+      || pid >= INDEX_PID_NONE
+      || !gst_byte_reader_get_uint16_le (&br, &pmt_pid)
+      || pmt_pid >= INDEX_PID_NONE
+      || !gst_byte_reader_get_uint16_le (&br, &program_number)
+      || !gst_byte_reader_skip (&br, 2)
+      || !gst_byte_reader_get_uint64_le (&br, &size)
+      || !gst_byte_reader_get_uint32_le (&br, &n)
+      || gst_byte_reader_get_remaining (&br) / INDEX_ENTRY_SIZE < n)
+    goto invalid;
+
+  g_array_set_size (demux->index, n);
+  for (i = 0; i < n; i++) {
+    TSDemuxIndexEntry *entry =
+        &g_array_index (demux->index, TSDemuxIndexEntry, i);
+
+    entry->ts = gst_byte_reader_get_uint64_le_unchecked (&br);
+    entry->offset = gst_byte_reader_get_uint64_le_unchecked (&br);
+
+    /* lookups rely on the entries being sorted on both */
+    if (i > 0 && (entry->ts <= entry[-1].ts
+            || entry->offset <= entry[-1].offset))
+      goto invalid;
+  }
+
+  demux->index_pid = pid;
+  demux->index_pmt_pid = pmt_pid;
+  demux->index_program_number = program_number;
+  demux->index_size = size;
+  /* not used for seeking before it is known to match the stream */
+  demux->index_verified = FALSE;
+
+  GST_INFO_OBJECT (demux, "Loaded %u index entries for PID 0x%04x from %s",
+      n, pid, location);
+  g_free (contents);
+  return;
+
+invalid:
+  GST_WARNING_OBJECT (demux, "Ignoring invalid index file %s", location);
+  gst_ts_demux_index_clear (demux);
+  g_free (contents);
+}
+
+static void
+gst_ts_demux_index_save (GstTSDemux * demux, const gchar * location)
+{
+  GstByteWriter bw;
+  guint8 *data;
+  gsize size;
+  guint i;
+  GError *err = NULL;
+
+  size = INDEX_HEADER_SIZE + demux->index->len * INDEX_ENTRY_SIZE;
+  gst_byte_writer_init_with_size (&bw, size, TRUE);
+
+  gst_byte_writer_put_data_unchecked (&bw, (const guint8 *) INDEX_MAGIC, 8);
+  gst_byte_writer_put_uint32_le_unchecked (&bw, INDEX_VERSION);
+  gst_byte_writer_put_uint16_le_unchecked (&bw, demux->index_pid);
+  gst_byte_writer_put_uint16_le_unchecked (&bw, demux->index_pmt_pid);
+  gst_byte_writer_put_uint16_le_unchecked (&bw, demux->index_program_number);
+  gst_byte_writer_put_uint16_le_unchecked (&bw, 0);
+  gst_byte_writer_put_uint64_le_unchecked (&bw, demux->index_size);
+  gst_byte_writer_put_uint32_le_unchecked (&bw, demux->index->len);
+  for (i = 0; i < demux->index->len; i++) {
+    TSDemuxIndexEntry *entry =
+        &g_array_index (demux->index, TSDemuxIndexEntry, i);
+
+    gst_byte_writer_put_uint64_le_unchecked (&bw, entry->ts);
+    gst_byte_writer_put_uint64_le_unchecked (&bw, entry->offset);
+  }
+
+  data = gst_byte_writer_reset_and_get_data (&bw);
+  if (g_file_set_contents (location, (const gchar *) data, size, &err)) {
+    GST_INFO_OBJECT (demux, "Saved %u index entries to %s", demux->index->len,
+        location);
+    demux->index_dirty = FALSE;
+  } else {
+    GST_WARNING_OBJECT (demux, "Couldn't save index: %s", err->message);
+    g_clear_error (&err);
+  }
+  g_free (data);
+}
+
+/* Record that the PES of @stream starting in the packet at @offset is a
+ * random access point. The index only covers the first video stream seen
+ * with such PES. */
+static void
+gst_ts_demux_index_add (GstTSDemux * demux, TSDemuxStream * stream,
+    guint64 offset)
+{
+  MpegTSBase *base = (MpegTSBase *) demux;
+  MpegTSBaseStream *bs = (MpegTSBaseStream *) stream;
+  TSDemuxIndexEntry entry, *entries;
+  guint pos, len;
+
+  if (demux->index_pid == INDEX_PID_NONE) {
+    if (!(gst_stream_get_stream_type (bs->stream_object) &
+            GST_STREAM_TYPE_VIDEO))
+      return;
+    GST_DEBUG_OBJECT (demux, "Indexing PID 0x%04x", bs->pid);
+    demux->index_pid = bs->pid;
+    demux->index_program_number = demux->program->program_number;
+    demux->index_pmt_pid = demux->program->pmt_pid;
+  } else if (demux->index_pid != bs->pid) {
+    return;
+  }
+
+  entry.ts = stream->pts;
+  entry.offset = offset;
+
+  entries = (TSDemuxIndexEntry *) demux->index->data;
+  len = demux->index->len;
+
+  /* Appending is the common case, after a seek the entries might have to be
+   * inserted before existing ones */
+  pos = len;
+  if (len > 0 && entries[len - 1].ts >= entry.ts) {
+    guint lo = 0, hi = len;
+
+    while (lo < hi) {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (entries[mid].ts < entry.ts)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    pos = lo;
+  }
+
+  /* A loaded index is trusted once one of its entries is found again, and
+   * dropped if an entry turns out to be for something else */
+  if (pos < len && entries[pos].ts == entry.ts
+      && entries[pos].offset == entry.offset) {
+    if (!demux->index_verified)
+      GST_DEBUG_OBJECT (demux, "Index matches the stream");
+    demux->index_verified = TRUE;
+    return;
+  }
+  if ((pos < len && (entries[pos].ts == entry.ts
+              || entries[pos].offset == entry.offset))
+      || (pos > 0 && entries[pos - 1].offset == entry.offset)) {
+    if (!demux->index_verified) {
+      GST_WARNING_OBJECT (demux, "Loaded index doesn't match the stream, "
+          "discarding it");
+      g_array_set_size (demux->index, 0);
+      demux->index_program_number = demux->program->program_number;
+      demux->index_pmt_pid = demux->program->pmt_pid;
+      demux->index_size = 0;
+      demux->index_verified = TRUE;
+      pos = len = 0;
+    }
+  }
+
+  /* Already known, or not in the same order as the offsets (timestamp
+   * discontinuity) */
+  if (pos < len && (entries[pos].ts == entry.ts
+          || entries[pos].offset <= entry.offset))
+    return;
+  if (pos > 0 && entries[pos - 1].offset >= entry.offset)
+    return;
+
+  GST_LOG_OBJECT (demux, "Random access point %" GST_TIME_FORMAT
+      " at offset %" G_GUINT64_FORMAT, GST_TIME_ARGS (entry.ts), offset);
+
+  g_array_insert_val (demux->index, pos, entry);
+  demux->index_size = MAX (demux->index_size, offset + base->packetsize);
+  demux->index_dirty = TRUE;
+}
+
+/* Returns the last indexed random access point at or before @ts */
+static const TSDemuxIndexEntry *
+gst_ts_demux_index_lookup (GstTSDemux * demux, GstClockTime ts)
+{
+  MpegTSBase *base = (MpegTSBase *) demux;
+  const TSDemuxIndexEntry *entries;
+  guint lo = 0, hi = demux->index->len;
+  gint64 upstream_size;
+
+  if (hi == 0 || !demux->index_verified || demux->program == NULL
+      || demux->program->streams[demux->index_pid] == NULL)
+    return NULL;
+
+  if (demux->program->program_number != demux->index_program_number
+      || demux->program->pmt_pid != demux->index_pmt_pid) {
+    GST_WARNING_OBJECT (demux, "Index is for program %d (PMT PID 0x%04x), "
+        "discarding it", demux->index_program_number, demux->index_pmt_pid);
+    gst_ts_demux_index_clear (demux);
+    return NULL;
+  }
+
+  /* An index loaded from a file might be for a different one */
+  if (gst_pad_peer_query_duration (base->sinkpad, GST_FORMAT_BYTES,
+          &upstream_size) && demux->index_size > upstream_size) {
+    GST_WARNING_OBJECT (demux, "Index covers %" G_GUINT64_FORMAT " bytes, "
+        "more than the %" G_GINT64_FORMAT " of the stream, discarding it",
+        demux->index_size, upstream_size);
+    gst_ts_demux_index_clear (demux);
+    return NULL;
+  }
+
+  entries = (const TSDemuxIndexEntry *) demux->index->data;
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (entries[mid].ts <= ts)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo > 0 ? &entries[lo - 1] : NULL;
+}
+
+static GstStateChangeReturn
+gst_ts_demux_change_state (GstElement * element, GstStateChange transition)
+{
+  GstTSDemux *demux = GST_TS_DEMUX_CAST (element);
+  GstStateChangeReturn ret;
+  gchar *location;
+
+  GST_OBJECT_LOCK (demux);
+  location = g_strdup (demux->index_location);
+  GST_OBJECT_UNLOCK (demux);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      if (location)
+        gst_ts_demux_index_load (demux, location);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      if (location && demux->index_dirty)
+        gst_ts_demux_index_save (demux, location);
+      gst_ts_demux_index_clear (demux);
+      break;
+    default:
+      break;
+  }
+
+  g_free (location);
+
+  return ret;
+}
+
 static gboolean
 gst_ts_demux_adjust_seek_offset_for_keyframe (TSDemuxStream * stream,
     guint8 * data, guint64 size)
@@ -869,6 +1233,7 @@ gst_ts_demux_do_seek (MpegTSBase * base, GstEvent * event)
   guint64 start_offset;
   gboolean update = FALSE;
   GstSegment seeksegment;
+  const TSDemuxIndexEntry *entry = NULL;
 
   GST_DEBUG ("seek event, %" GST_PTR_FORMAT, event);
 
@@ -910,12 +1275,20 @@ gst_ts_demux_do_seek (MpegTSBase * base, GstEvent * event)
     else
       target = 0;
 
-    start_offset =
-        mpegts_packetizer_ts_to_offset (base->packetizer, target,
-        demux->program->pcr_pid);
-    if (G_UNLIKELY (start_offset == -1)) {
-      GST_WARNING ("Couldn't convert start position to an offset");
-      goto done;
+    entry = gst_ts_demux_index_lookup (demux, seeksegment.start);
+    if (entry) {
+      GST_DEBUG_OBJECT (demux, "Seeking to indexed random access point %"
+          GST_TIME_FORMAT " at offset %" G_GUINT64_FORMAT,
+          GST_TIME_ARGS (entry->ts), entry->offset);
+      start_offset = entry->offset;
+    } else {
+      start_offset =
+          mpegts_packetizer_ts_to_offset (base->packetizer, target,
+          demux->program->pcr_pid);
+      if (G_UNLIKELY (start_offset == -1)) {
+        GST_WARNING ("Couldn't convert start position to an offset");
+        goto done;
+      }
     }
 
     base->seek_offset = start_offset;
@@ -929,7 +1302,10 @@ gst_ts_demux_do_seek (MpegTSBase * base, GstEvent * event)
     for (tmp = demux->program->stream_list; tmp; tmp = tmp->next) {
       TSDemuxStream *stream = tmp->data;
 
-      if (flags & GST_SEEK_FLAG_ACCURATE)
+      /* No need to look for the keyframe of the indexed stream, we start
+       * from one */
+      if ((flags & GST_SEEK_FLAG_ACCURATE) && (entry == NULL
+              || ((MpegTSBaseStream *) stream)->pid != demux->index_pid))
         stream->needs_keyframe = TRUE;
 
       stream->seeked_pts = GST_CLOCK_TIME_NONE;
@@ -2442,11 +2818,13 @@ gst_ts_demux_parse_pes_header (GstTSDemux * demux, TSDemuxStream * stream,
   data += header.header_size;
   length -= header.header_size;
 
-  /* Create the output buffer */
+  /* Create the output buffer. Video PES usually don't signal their length,
+   * so size them like the previous ones instead of growing (and copying)
+   * the buffer from 8kB every time. */
   if (stream->expected_size)
     stream->allocated_size = MAX (stream->expected_size, length);
   else
-    stream->allocated_size = MAX (8192, length);
+    stream->allocated_size = MAX (MAX (8192, stream->size_hint), length);
 
   g_assert (stream->data == NULL);
   stream->data = g_malloc (stream->allocated_size);
@@ -2520,6 +2898,11 @@ gst_ts_demux_queue_data (GstTSDemux * demux, TSDemuxStream * stream,
 
       /* parse the header */
       gst_ts_demux_parse_pes_header (demux, stream, data, size, packet->offset);
+
+      if ((packet->afc_flags & MPEGTS_AFC_RANDOM_ACCESS_FLAG)
+          && stream->state == PENDING_PACKET_BUFFER
+          && GST_CLOCK_TIME_IS_VALID (stream->pts))
+        gst_ts_demux_index_add (demux, stream, packet->offset);
       break;
     }
     case PENDING_PACKET_BUFFER:
@@ -3081,6 +3464,14 @@ gst_ts_demux_push_pending_data (GstTSDemux * demux, TSDemuxStream * stream,
     goto beach;
   }
 
+  if (G_UNLIKELY (stream->current_size > 0
+          && stream->allocated_size - stream->current_size > MAX_PES_SLACK)) {
+    GST_LOG_OBJECT (stream->pad, "Shrinking PES allocation from %u to %u",
+        stream->allocated_size, stream->current_size);
+    stream->data = g_realloc (stream->data, stream->current_size);
+    stream->allocated_size = stream->current_size;
+  }
+
   if (stream->needs_keyframe) {
     MpegTSBase *base = (MpegTSBase *) demux;
 
@@ -3305,6 +3696,11 @@ beach:
   /* Reset the PES payload collection, but don't clear the state,
    * we might want to keep collecting this PES */
   GST_LOG ("Cleared PES data. returning %s", gst_flow_get_name (res));
+  /* with some headroom, so that a slightly bigger PES doesn't have to be
+   * reallocated */
+  if (stream->current_size)
+    stream->size_hint = MIN (stream->current_size + stream->current_size / 4,
+        MAX_PES_SIZE_HINT);
   if (stream->expected_size) {
     if (stream->current_size > stream->expected_size)
       stream->expected_size = 0;
@@ -101,6 +101,20 @@ struct _GstTSDemux
 
   /* Used when seeking for a keyframe to go backward in the stream */
   guint64 last_seek_offset;
+
+  /* Seek index of the random access points of one video stream, built while
+   * playing and cached in index_location (protected by the OBJECT_LOCK) */
+  gchar *index_location;
+  GArray *index;
+  guint16 index_pid;
+  /* program the index belongs to, to recognize the stream */
+  gint index_program_number;
+  guint16 index_pmt_pid;
+  /* amount of bytes of the stream the index was built from */
+  guint64 index_size;
+  gboolean index_dirty;
+  /* FALSE for a loaded index until one of its entries was found again */
+  gboolean index_verified;
 };
 
 struct _GstTSDemuxClass
@@ -308,6 +308,31 @@ steal_si_section (GstMpegtsSectionType * type, TsMuxSection * section,
   return TRUE;
 }
 
+static void
+gst_base_ts_mux_clear_out_pool (GstBaseTsMux * mux)
+{
+  if (mux->out_buffer) {
+    gst_buffer_unmap (mux->out_buffer, &mux->out_map);
+    gst_buffer_unref (mux->out_buffer);
+    mux->out_buffer = NULL;
+  }
+  mux->out_offset = 0;
+
+  if (mux->out_list) {
+    gst_buffer_list_unref (mux->out_list);
+    mux->out_list = NULL;
+  }
+
+  if (mux->out_pool) {
+    gst_buffer_pool_set_active (mux->out_pool, FALSE);
+    gst_object_unref (mux->out_pool);
+    mux->out_pool = NULL;
+  }
+  mux->out_pool_size = 0;
+
+  gst_buffer_replace (&mux->free_packet, NULL);
+}
+
 static void
 gst_base_ts_mux_reset (GstBaseTsMux * mux, gboolean alloc)
 {
@@ -346,7 +371,7 @@ gst_base_ts_mux_reset (GstBaseTsMux * mux, gboolean alloc)
     gst_buffer_unref (buf);
 
   gst_event_replace (&mux->force_key_unit_event, NULL);
-  gst_buffer_replace (&mux->out_buffer, NULL);
+  gst_base_ts_mux_clear_out_pool (mux);
 
   GST_OBJECT_LOCK (mux);
 
@@ -857,7 +882,8 @@ new_packet_common_init (GstBaseTsMux * mux, GstBuffer * buf, guint8 * data,
         hbuf = gst_buffer_new_and_alloc (len);
         gst_buffer_fill (hbuf, 0, data, len);
       } else {
-        hbuf = gst_buffer_copy (buf);
+        /* packet buffers may get reused, don't share their memory */
+        hbuf = gst_buffer_copy_deep (buf);
       }
       GST_LOG_OBJECT (mux,
           "Collecting packet with pid 0x%04x into streamheaders", pid);
@@ -884,105 +910,222 @@ new_packet_common_init (GstBaseTsMux * mux, GstBuffer * buf, guint8 * data,
   }
 }
 
+/* Writes @n null packets at @data. @header is the 4 bytes header of the
+ * previous packet, only used when packets are bigger than 188 bytes */
+static void
+gst_base_ts_mux_write_null_packets (GstBaseTsMux * mux, guint8 * data,
+    gint n, guint32 header)
+{
+  gsize packet_size = mux->packet_size;
+
+  for (; n > 0; n--) {
+    gint offset;
+
+    if (packet_size > GST_BASE_TS_MUX_NORMAL_PACKET_LENGTH) {
+      GST_WRITE_UINT32_BE (data, header);
+      /* simply increase header a bit and never mind too much */
+      header++;
+      offset = 4;
+    } else {
+      offset = 0;
+    }
+    GST_WRITE_UINT8 (data + offset, TSMUX_SYNC_BYTE);
+    /* null packet PID */
+    GST_WRITE_UINT16_BE (data + offset + 1, 0x1FFF);
+    /* no adaptation field exists | continuity counter undefined */
+    GST_WRITE_UINT8 (data + offset + 3, 0x10);
+    /* payload */
+    memset (data + offset + 4, 0, GST_BASE_TS_MUX_NORMAL_PACKET_LENGTH - 4);
+    data += packet_size;
+  }
+}
+
+/* Takes a new output buffer of @size bytes from the pool and maps it */
+static gboolean
+gst_base_ts_mux_acquire_out_buffer (GstBaseTsMux * mux, gsize size)
+{
+  GstBuffer *buf = NULL;
+
+  if (mux->out_pool && mux->out_pool_size != size) {
+    gst_buffer_pool_set_active (mux->out_pool, FALSE);
+    gst_object_unref (mux->out_pool);
+    mux->out_pool = NULL;
+  }
+
+  if (!mux->out_pool) {
+    GstStructure *config;
+
+    mux->out_pool = gst_buffer_pool_new ();
+    config = gst_buffer_pool_get_config (mux->out_pool);
+    gst_buffer_pool_config_set_params (config, NULL, size, 0, 0);
+
+    if (!gst_buffer_pool_set_config (mux->out_pool, config) ||
+        !gst_buffer_pool_set_active (mux->out_pool, TRUE)) {
+      GST_ERROR_OBJECT (mux, "Failed to configure output buffer pool");
+      gst_object_unref (mux->out_pool);
+      mux->out_pool = NULL;
+      return FALSE;
+    }
+    mux->out_pool_size = size;
+  }
+
+  if (gst_buffer_pool_acquire_buffer (mux->out_pool, &buf,
+          NULL) != GST_FLOW_OK) {
+    GST_ERROR_OBJECT (mux, "Failed to acquire output buffer");
+    return FALSE;
+  }
+
+  if (!gst_buffer_map (buf, &mux->out_map, GST_MAP_WRITE)) {
+    GST_ERROR_OBJECT (mux, "Failed to map output buffer");
+    gst_buffer_unref (buf);
+    return FALSE;
+  }
+
+  mux->out_buffer = buf;
+  mux->out_offset = 0;
+
+  return TRUE;
+}
+
+/* Queues the current output buffer for pushing, padding it with null
+ * packets if it is not full yet */
+static void
+gst_base_ts_mux_finish_out_buffer (GstBaseTsMux * mux)
+{
+  GstBuffer *buf = mux->out_buffer;
+
+  if (!buf)
+    return;
+
+  if (mux->out_offset < mux->out_map.size) {
+    guint8 *data = mux->out_map.data + mux->out_offset;
+    guint32 header = GST_READ_UINT32_BE (data - mux->packet_size);
+    gint dummy = (mux->out_map.size - mux->out_offset) / mux->packet_size;
+
+    GST_LOG_OBJECT (mux, "adding %d null packets", dummy);
+    gst_base_ts_mux_write_null_packets (mux, data, dummy, header);
+  }
+
+  gst_buffer_unmap (buf, &mux->out_map);
+  mux->out_buffer = NULL;
+  mux->out_offset = 0;
+
+  if (!mux->out_list)
+    mux->out_list = gst_buffer_list_new ();
+  gst_buffer_list_add (mux->out_list, buf);
+}
+
 static GstFlowReturn
 gst_base_ts_mux_push_packets (GstBaseTsMux * mux, gboolean force)
 {
   GstBufferList *buffer_list;
-  gint align = mux->alignment;
-  gint av, packet_size;
-
-  packet_size = mux->packet_size;
+  gint av;
 
-  if (align < 0)
-    align = mux->automatic_alignment;
+  /* aligned output, a partially filled buffer only goes out when forced */
+  if (force && mux->out_buffer)
+    gst_base_ts_mux_finish_out_buffer (mux);
 
-  av = gst_adapter_available (mux->out_adapter);
-  GST_LOG_OBJECT (mux, "align %d, av %d", align, av);
+  if (mux->out_list) {
+    GstFlowReturn ret;
 
-  if (av == 0)
-    return GST_FLOW_OK;
+    buffer_list = mux->out_list;
+    mux->out_list = NULL;
 
-  /* no alignment, just push all available data */
-  if (align == 0) {
-    buffer_list = gst_adapter_take_buffer_list (mux->out_adapter, av);
-    return gst_aggregator_finish_buffer_list (GST_AGGREGATOR (mux),
+    GST_LOG_OBJECT (mux, "pushing %u aligned buffers",
+        gst_buffer_list_length (buffer_list));
+    ret = gst_aggregator_finish_buffer_list (GST_AGGREGATOR (mux),
         buffer_list);
+    if (ret != GST_FLOW_OK)
+      return ret;
   }
 
-  align *= packet_size;
+  av = gst_adapter_available (mux->out_adapter);
+  GST_LOG_OBJECT (mux, "av %d", av);
 
-  if (!force && align > av)
+  if (av == 0)
     return GST_FLOW_OK;
 
-  buffer_list = gst_buffer_list_new_sized ((av / align) + 1);
-
-  GST_LOG_OBJECT (mux, "aligning to %d bytes", align);
-  while (align <= av) {
-    GstBuffer *buf;
-    GstClockTime pts;
+  /* no alignment, just push all available data */
+  buffer_list = gst_adapter_take_buffer_list (mux->out_adapter, av);
+  return gst_aggregator_finish_buffer_list (GST_AGGREGATOR (mux), buffer_list);
+}
 
-    pts = gst_adapter_prev_pts (mux->out_adapter, NULL);
-    buf = gst_adapter_take_buffer (mux->out_adapter, align);
+/* Keeps @buf around for the next packet allocation if nothing else
+ * references it */
+static void
+gst_base_ts_mux_recycle_packet (GstBaseTsMux * mux, GstBuffer * buf)
+{
+  if (mux->free_packet || !gst_buffer_is_writable (buf)
+      || gst_buffer_n_memory (buf) != 1
+      || !gst_buffer_is_all_memory_writable (buf)) {
+    gst_buffer_unref (buf);
+    return;
+  }
 
-    GST_BUFFER_PTS (buf) = pts;
+  GST_BUFFER_FLAGS (buf) = 0;
+  GST_BUFFER_PTS (buf) = GST_CLOCK_TIME_NONE;
+  GST_BUFFER_DTS (buf) = GST_CLOCK_TIME_NONE;
+  GST_BUFFER_OFFSET (buf) = GST_BUFFER_OFFSET_NONE;
+  mux->free_packet = buf;
+}
 
-    gst_buffer_list_add (buffer_list, buf);
-    av -= align;
-  }
+/* Copies the packet into the current output buffer, which holds @align
+ * packets */
+static gboolean
+gst_base_ts_mux_collect_packet_aligned (GstBaseTsMux * mux, GstBuffer * buf,
+    gint align)
+{
+  gsize size = align * mux->packet_size;
 
-  if (av > 0 && force) {
-    GstBuffer *buf;
-    GstClockTime pts;
-    guint8 *data;
-    guint32 header;
-    gint dummy;
-    GstMapInfo map;
+  if (mux->out_buffer && mux->out_map.size != size)
+    gst_base_ts_mux_finish_out_buffer (mux);
 
-    GST_LOG_OBJECT (mux, "handling %d leftover bytes", av);
+  if (!mux->out_buffer) {
+    if (!gst_base_ts_mux_acquire_out_buffer (mux, size)) {
+      gst_buffer_unref (buf);
+      return FALSE;
+    }
+    /* the output buffer gets the flags and timestamps of its first packet */
+    gst_buffer_copy_into (mux->out_buffer, buf,
+        GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+  }
 
-    pts = gst_adapter_prev_pts (mux->out_adapter, NULL);
-    buf = gst_buffer_new_and_alloc (align);
+  GST_LOG_OBJECT (mux, "collecting packet at offset %" G_GSIZE_FORMAT
+      " of aligned buffer", mux->out_offset);
 
-    GST_BUFFER_PTS (buf) = pts;
+  gst_buffer_extract (buf, 0, mux->out_map.data + mux->out_offset,
+      mux->packet_size);
+  mux->out_offset += mux->packet_size;
 
-    gst_buffer_map (buf, &map, GST_MAP_READ);
-    data = map.data;
+  gst_base_ts_mux_recycle_packet (mux, buf);
 
-    gst_adapter_copy (mux->out_adapter, data, 0, av);
-    gst_adapter_clear (mux->out_adapter);
+  if (mux->out_offset >= mux->out_map.size)
+    gst_base_ts_mux_finish_out_buffer (mux);
 
-    data += av;
-    header = GST_READ_UINT32_BE (data - packet_size);
+  return TRUE;
+}
 
-    dummy = (map.size - av) / packet_size;
-    GST_LOG_OBJECT (mux, "adding %d null packets", dummy);
+/* Queues the packets collected in the output adapter after the aligned
+ * output buffers, for when the alignment changed since */
+static void
+gst_base_ts_mux_queue_unaligned_packets (GstBaseTsMux * mux)
+{
+  GstBufferList *buffer_list;
+  gint av = gst_adapter_available (mux->out_adapter);
+  guint i;
 
-    for (; dummy > 0; dummy--) {
-      gint offset;
+  if (av == 0)
+    return;
 
-      if (packet_size > GST_BASE_TS_MUX_NORMAL_PACKET_LENGTH) {
-        GST_WRITE_UINT32_BE (data, header);
-        /* simply increase header a bit and never mind too much */
-        header++;
-        offset = 4;
-      } else {
-        offset = 0;
-      }
-      GST_WRITE_UINT8 (data + offset, TSMUX_SYNC_BYTE);
-      /* null packet PID */
-      GST_WRITE_UINT16_BE (data + offset + 1, 0x1FFF);
-      /* no adaptation field exists | continuity counter undefined */
-      GST_WRITE_UINT8 (data + offset + 3, 0x10);
-      /* payload */
-      memset (data + offset + 4, 0, GST_BASE_TS_MUX_NORMAL_PACKET_LENGTH - 4);
-      data += packet_size;
-    }
+  if (!mux->out_list)
+    mux->out_list = gst_buffer_list_new ();
 
-    gst_buffer_unmap (buf, &map);
-    gst_buffer_list_add (buffer_list, buf);
+  buffer_list = gst_adapter_take_buffer_list (mux->out_adapter, av);
+  for (i = 0; i < gst_buffer_list_length (buffer_list); i++) {
+    gst_buffer_list_add (mux->out_list,
+        gst_buffer_ref (gst_buffer_list_get (buffer_list, i)));
   }
-
-  return gst_aggregator_finish_buffer_list (GST_AGGREGATOR (mux), buffer_list);
+  gst_buffer_list_unref (buffer_list);
 }
 
 static GstFlowReturn
@@ -1918,6 +2061,21 @@ gst_base_ts_mux_default_allocate_packet (GstBaseTsMux * mux,
 {
   GstBuffer *buf;
 
+  if (mux->free_packet) {
+    gsize offset, maxsize;
+
+    buf = mux->free_packet;
+    mux->free_packet = NULL;
+
+    gst_buffer_get_sizes (buf, &offset, &maxsize);
+    if (offset + mux->packet_size <= maxsize) {
+      gst_buffer_set_size (buf, mux->packet_size);
+      *buffer = buf;
+      return;
+    }
+    gst_buffer_unref (buf);
+  }
+
   buf = gst_buffer_new_and_alloc (mux->packet_size);
 
   *buffer = buf;
@@ -1927,6 +2085,22 @@ static gboolean
 gst_base_ts_mux_default_output_packet (GstBaseTsMux * mux, GstBuffer * buffer,
     gint64 new_pcr)
 {
+  gint align = mux->alignment;
+
+  if (align < 0)
+    align = mux->automatic_alignment;
+
+  /* aligned output is written into pooled buffers of align packets. When
+   * the alignment changed, the packets collected the other way go out first
+   * so that the output stays in order */
+  if (align > 0) {
+    gst_base_ts_mux_queue_unaligned_packets (mux);
+    return gst_base_ts_mux_collect_packet_aligned (mux, buffer, align);
+  }
+
+  if (mux->out_buffer)
+    gst_base_ts_mux_finish_out_buffer (mux);
+
   gst_base_ts_mux_collect_packet (mux, buffer);
 
   return TRUE;
@@ -197,6 +197,16 @@ struct GstBaseTsMux {
   /* output buffer aggregation */
   GstAdapter *out_adapter;
   GstBuffer *out_buffer;
+
+  /* aligned output: packets are written into out_buffer (mapped in out_map),
+   * taken from out_pool, and queued in out_list once full */
+  GstBufferPool *out_pool;
+  gsize out_pool_size;
+  GstMapInfo out_map;
+  gsize out_offset;
+  GstBufferList *out_list;
+  /* packet buffer handed back by the output path, reused for the next packet */
+  GstBuffer *free_packet;
 };
 
 /**
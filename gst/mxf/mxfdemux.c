@@ -173,6 +173,8 @@ gst_mxf_demux_reset_mxf_state (GstMXFDemux * demux)
 
     if (t->offsets)
       g_array_free (t->offsets, TRUE);
+    if (t->keyframes)
+      g_array_free (t->keyframes, TRUE);
 
     g_free (t->mapping_data);
 
@@ -239,6 +241,8 @@ gst_mxf_demux_reset_metadata (GstMXFDemux * demux)
 static void
 gst_mxf_demux_reset (GstMXFDemux * demux)
 {
+  guint i;
+
   GST_DEBUG_OBJECT (demux, "cleaning up MXF demuxer");
 
   demux->flushing = FALSE;
@@ -280,17 +284,14 @@ gst_mxf_demux_reset (GstMXFDemux * demux)
     demux->pending_index_table_segments = NULL;
   }
 
-  if (demux->index_tables) {
-    GList *l;
+  for (i = 0; i < demux->index_tables->len; i++) {
+    GstMXFDemuxIndexTable *t =
+        &g_array_index (demux->index_tables, GstMXFDemuxIndexTable, i);
 
-    for (l = demux->index_tables; l; l = l->next) {
-      GstMXFDemuxIndexTable *t = l->data;
-      g_array_free (t->offsets, TRUE);
-      g_free (t);
-    }
-    g_list_free (demux->index_tables);
-    demux->index_tables = NULL;
+    g_array_free (t->offsets, TRUE);
+    g_array_free (t->keyframes, TRUE);
   }
+  g_array_set_size (demux->index_tables, 0);
 
   demux->index_table_segments_collected = FALSE;
 
@@ -1683,6 +1684,70 @@ gst_mxf_demux_pad_set_component (GstMXFDemux * demux, GstMXFDemuxPad * pad,
   return ret;
 }
 
+/* Returns the index of the first keyframe at or after @position */
+static guint
+keyframes_lower_bound (GArray * keyframes, guint64 position)
+{
+  guint lo = 0, hi = keyframes->len;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (g_array_index (keyframes, guint64, mid) < position)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+static void
+keyframes_update (GArray * keyframes, guint64 position, gboolean keyframe)
+{
+  guint i = keyframes_lower_bound (keyframes, position);
+  gboolean found = i < keyframes->len
+      && g_array_index (keyframes, guint64, i) == position;
+
+  if (keyframe && !found)
+    g_array_insert_val (keyframes, i, position);
+  else if (!keyframe && found)
+    g_array_remove_index (keyframes, i);
+}
+
+/* Binary search in the index tables, which are sorted by BodySID and then
+ * IndexSID. @pos receives the index of the table, or where it would have to
+ * be inserted if there is none yet */
+static GstMXFDemuxIndexTable *
+gst_mxf_demux_find_index_table (GstMXFDemux * demux, guint32 body_sid,
+    guint32 index_sid, guint * pos)
+{
+  guint lo = 0, hi = demux->index_tables->len;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+    GstMXFDemuxIndexTable *t =
+        &g_array_index (demux->index_tables, GstMXFDemuxIndexTable, mid);
+
+    if (t->body_sid == body_sid && t->index_sid == index_sid) {
+      if (pos)
+        *pos = mid;
+      return t;
+    }
+
+    if (t->body_sid < body_sid || (t->body_sid == body_sid
+            && t->index_sid < index_sid))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (pos)
+    *pos = lo;
+
+  return NULL;
+}
+
 static GstFlowReturn
 gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
     const MXFUL * key, GstBuffer * buffer, gboolean peek)
@@ -1812,19 +1877,11 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
     keyframe = !GST_BUFFER_FLAG_IS_SET (outbuf, GST_BUFFER_FLAG_DELTA_UNIT);
 
   /* Prefer keyframe information from index tables over everything else */
-  if (demux->index_tables) {
-    GList *l;
-    GstMXFDemuxIndexTable *index_table = NULL;
+  if (demux->index_tables->len > 0) {
+    GstMXFDemuxIndexTable *index_table;
 
-    for (l = demux->index_tables; l; l = l->next) {
-      GstMXFDemuxIndexTable *tmp = l->data;
-
-      if (tmp->body_sid == etrack->body_sid
-          && tmp->index_sid == etrack->index_sid) {
-        index_table = tmp;
-        break;
-      }
-    }
+    index_table = gst_mxf_demux_find_index_table (demux, etrack->body_sid,
+        etrack->index_sid, NULL);
 
     if (index_table && index_table->offsets->len > etrack->position) {
       GstMXFDemuxIndex *index =
@@ -1848,8 +1905,10 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
     }
   }
 
-  if (!etrack->offsets)
+  if (!etrack->offsets) {
     etrack->offsets = g_array_new (FALSE, TRUE, sizeof (GstMXFDemuxIndex));
+    etrack->keyframes = g_array_new (FALSE, FALSE, sizeof (guint64));
+  }
 
   {
     if (etrack->offsets->len > etrack->position) {
@@ -1861,6 +1920,8 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
       index->pts = pts;
       index->dts = dts;
       index->keyframe = keyframe;
+      keyframes_update (etrack->keyframes, etrack->position,
+          keyframe && index->offset != 0);
     } else if (etrack->position < G_MAXINT) {
       GstMXFDemuxIndex index;
 
@@ -1872,6 +1933,8 @@ gst_mxf_demux_handle_generic_container_essence_element (GstMXFDemux * demux,
       if (etrack->offsets->len < etrack->position)
         g_array_set_size (etrack->offsets, etrack->position + 1);
       g_array_insert_val (etrack->offsets, etrack->position, index);
+      keyframes_update (etrack->keyframes, etrack->position,
+          keyframe && index.offset != 0);
     }
   }
 
@@ -2785,7 +2848,8 @@ find_offset (GArray * offsets, gint64 * position, gboolean keyframe)
 }
 
 static guint64
-find_closest_offset (GArray * offsets, gint64 * position, gboolean keyframe)
+find_closest_offset (GArray * offsets, GArray * keyframes, gint64 * position,
+    gboolean keyframe)
 {
   GstMXFDemuxIndex *idx;
   gint64 current_position = *position;
@@ -2795,6 +2859,18 @@ find_closest_offset (GArray * offsets, gint64 * position, gboolean keyframe)
 
   current_position = MIN (current_position, offsets->len - 1);
 
+  /* keyframes holds exactly the entries the loop below would stop at */
+  if (keyframe && keyframes) {
+    guint i = keyframes_lower_bound (keyframes, current_position + 1);
+
+    if (i == 0)
+      return -1;
+
+    *position = g_array_index (keyframes, guint64, i - 1);
+    idx = &g_array_index (offsets, GstMXFDemuxIndex, *position);
+    return idx->offset;
+  }
+
   idx = &g_array_index (offsets, GstMXFDemuxIndex, current_position);
   while (idx->offset == 0 || (keyframe && !idx->keyframe)) {
     current_position--;
@@ -2827,22 +2903,12 @@ gst_mxf_demux_find_essence_element (GstMXFDemux * demux,
       " of track %u with body_sid %u (keyframe %d)", *position,
       etrack->track_number, etrack->body_sid, keyframe);
 
-  if (demux->index_tables) {
-    GList *l;
-
-    for (l = demux->index_tables; l; l = l->next) {
-      GstMXFDemuxIndexTable *tmp = l->data;
-
-      if (tmp->body_sid == etrack->body_sid
-          && tmp->index_sid == etrack->index_sid) {
-        index_table = tmp;
-        break;
-      }
-    }
-  }
-
 from_index:
 
+  /* looked up again after scanning, which might have collected the tables */
+  index_table = gst_mxf_demux_find_index_table (demux, etrack->body_sid,
+      etrack->index_sid, NULL);
+
   if (etrack->duration > 0 && *position >= etrack->duration) {
     GST_WARNING_OBJECT (demux, "Position after end of essence track");
     return -1;
@@ -2860,7 +2926,8 @@ from_index:
 
   GST_DEBUG_OBJECT (demux, "Not found in index");
   if (!demux->random_access) {
-    offset = find_closest_offset (etrack->offsets, position, keyframe);
+    offset = find_closest_offset (etrack->offsets, etrack->keyframes, position,
+        keyframe);
     if (offset != -1) {
       GST_DEBUG_OBJECT (demux,
           "Starting with edit unit %" G_GINT64_FORMAT " for %" G_GINT64_FORMAT
@@ -2870,7 +2937,8 @@ from_index:
     }
 
     if (index_table) {
-      offset = find_closest_offset (index_table->offsets, position, keyframe);
+      offset = find_closest_offset (index_table->offsets,
+          index_table->keyframes, position, keyframe);
       if (offset != -1) {
         GST_DEBUG_OBJECT (demux,
             "Starting with edit unit %" G_GINT64_FORMAT " for %" G_GINT64_FORMAT
@@ -2885,7 +2953,8 @@ from_index:
     demux->offset = demux->run_in;
 
     offset =
-        find_closest_offset (etrack->offsets, &index_start_position, FALSE);
+        find_closest_offset (etrack->offsets, etrack->keyframes,
+        &index_start_position, FALSE);
     if (offset != -1) {
       demux->offset = offset + demux->run_in;
       GST_DEBUG_OBJECT (demux,
@@ -2899,7 +2968,8 @@ from_index:
     if (index_table) {
       gint64 tmp_position = *position;
 
-      offset = find_closest_offset (index_table->offsets, &tmp_position, TRUE);
+      offset = find_closest_offset (index_table->offsets,
+          index_table->keyframes, &tmp_position, TRUE);
       if (offset != -1 && tmp_position > index_start_position) {
         demux->offset = offset + demux->run_in;
         index_start_position = tmp_position;
@@ -3665,11 +3735,35 @@ no_new_offset:
   }
 }
 
+/* Returns the link of the last partition in @links, which are the
+ * partitions of one BodySID in file order, whose essence starts at or
+ * before @offset in the essence stream */
+static GList *
+find_partition_link_for_body_offset (GPtrArray * links, guint64 offset)
+{
+  guint lo = 0, hi = links->len;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+    GList *m = g_ptr_array_index (links, mid);
+    GstMXFDemuxPartition *partition = m->data;
+
+    if (partition->partition.body_offset <= offset)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo > 0 ? g_ptr_array_index (links, lo - 1) : NULL;
+}
+
 static void
 collect_index_table_segments (GstMXFDemux * demux)
 {
   GList *l;
   guint i;
+  GPtrArray *links = NULL;
+  guint32 links_body_sid = 0;
   guint64 old_offset = demux->offset;
   GstMXFDemuxPartition *old_partition = demux->current_partition;
 
@@ -3694,59 +3788,65 @@ collect_index_table_segments (GstMXFDemux * demux)
 
   for (l = demux->pending_index_table_segments; l; l = l->next) {
     MXFIndexTableSegment *segment = l->data;
-    GstMXFDemuxIndexTable *t = NULL;
-    GList *k;
+    GstMXFDemuxIndexTable *t;
     guint64 start, end;
+    guint pos;
 
-    for (k = demux->index_tables; k; k = k->next) {
-      GstMXFDemuxIndexTable *tmp = k->data;
-
-      if (tmp->body_sid == segment->body_sid
-          && tmp->index_sid == segment->index_sid) {
-        t = tmp;
-        break;
-      }
-    }
-
+    t = gst_mxf_demux_find_index_table (demux, segment->body_sid,
+        segment->index_sid, &pos);
     if (!t) {
-      t = g_new0 (GstMXFDemuxIndexTable, 1);
-      t->body_sid = segment->body_sid;
-      t->index_sid = segment->index_sid;
-      t->offsets = g_array_new (FALSE, TRUE, sizeof (GstMXFDemuxIndex));
-      demux->index_tables = g_list_prepend (demux->index_tables, t);
+      GstMXFDemuxIndexTable tmp;
+
+      tmp.body_sid = segment->body_sid;
+      tmp.index_sid = segment->index_sid;
+      tmp.offsets = g_array_new (FALSE, TRUE, sizeof (GstMXFDemuxIndex));
+      tmp.keyframes = g_array_new (FALSE, FALSE, sizeof (guint64));
+      g_array_insert_val (demux->index_tables, pos, tmp);
+      t = &g_array_index (demux->index_tables, GstMXFDemuxIndexTable, pos);
     }
 
     start = segment->index_start_position;
     end = start + segment->index_duration;
     if (end > G_MAXINT / sizeof (GstMXFDemuxIndex)) {
-      demux->index_tables = g_list_remove (demux->index_tables, t);
       g_array_free (t->offsets, TRUE);
-      g_free (t);
+      g_array_free (t->keyframes, TRUE);
+      g_array_remove_index (demux->index_tables, pos);
       continue;
     }
 
     if (t->offsets->len < end)
       g_array_set_size (t->offsets, end);
 
-    for (i = 0; i < segment->n_index_entries && start + i < t->offsets->len;
-        i++) {
-      guint64 offset = segment->index_entries[i].stream_offset;
+    /* The partitions of this BodySID, to look up the one containing each
+     * entry without walking all of them every time */
+    if (!links || links_body_sid != t->body_sid) {
       GList *m;
-      GstMXFDemuxPartition *offset_partition = NULL, *next_partition = NULL;
+
+      if (links)
+        g_ptr_array_set_size (links, 0);
+      else
+        links = g_ptr_array_new ();
+      links_body_sid = t->body_sid;
 
       for (m = demux->partitions; m; m = m->next) {
         GstMXFDemuxPartition *partition = m->data;
 
-        if (!next_partition && offset_partition)
-          next_partition = partition;
+        if (partition->partition.body_sid == links_body_sid)
+          g_ptr_array_add (links, m);
+      }
+    }
 
-        if (partition->partition.body_sid != t->body_sid)
-          continue;
-        if (partition->partition.body_offset > offset)
-          break;
+    for (i = 0; i < segment->n_index_entries && start + i < t->offsets->len;
+        i++) {
+      guint64 offset = segment->index_entries[i].stream_offset;
+      GList *m;
+      GstMXFDemuxPartition *offset_partition = NULL, *next_partition = NULL;
 
-        offset_partition = partition;
-        next_partition = NULL;
+      m = find_partition_link_for_body_offset (links, offset);
+      if (m) {
+        offset_partition = m->data;
+        if (m->next)
+          next_partition = m->next->data;
       }
 
       if (offset_partition && offset >= offset_partition->partition.body_offset) {
@@ -3801,6 +3901,25 @@ collect_index_table_segments (GstMXFDemux * demux)
     }
   }
 
+  if (links)
+    g_ptr_array_free (links, TRUE);
+
+  /* Keyframe lookups are binary searches in these */
+  for (i = 0; i < demux->index_tables->len; i++) {
+    GstMXFDemuxIndexTable *t =
+        &g_array_index (demux->index_tables, GstMXFDemuxIndexTable, i);
+    guint64 j;
+
+    g_array_set_size (t->keyframes, 0);
+    for (j = 0; j < t->offsets->len; j++) {
+      GstMXFDemuxIndex *index =
+          &g_array_index (t->offsets, GstMXFDemuxIndex, j);
+
+      if (index->offset != 0 && index->keyframe)
+        g_array_append_val (t->keyframes, j);
+    }
+  }
+
   for (l = demux->pending_index_table_segments; l; l = l->next) {
     MXFIndexTableSegment *s = l->data;
     mxf_index_table_segment_reset (s);
@@ -4626,6 +4745,8 @@ gst_mxf_demux_finalize (GObject * object)
   demux->src = NULL;
   g_array_free (demux->essence_tracks, TRUE);
   demux->essence_tracks = NULL;
+  g_array_free (demux->index_tables, TRUE);
+  demux->index_tables = NULL;
 
   g_hash_table_destroy (demux->metadata);
 
@@ -4703,6 +4824,8 @@ gst_mxf_demux_init (GstMXFDemux * demux)
   demux->src = g_ptr_array_new ();
   demux->essence_tracks =
       g_array_new (FALSE, FALSE, sizeof (GstMXFDemuxEssenceTrack));
+  demux->index_tables =
+      g_array_new (FALSE, FALSE, sizeof (GstMXFDemuxIndexTable));
 
   gst_segment_init (&demux->segment, GST_FORMAT_TIME);
 
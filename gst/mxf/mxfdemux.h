@@ -70,6 +70,8 @@ typedef struct
   gint64 duration;
 
   GArray *offsets;
+  /* sorted positions of the keyframes in offsets */
+  GArray *keyframes;
 
   MXFMetadataSourcePackage *source_package;
   MXFMetadataTimelineTrack *source_track;
@@ -106,6 +108,8 @@ typedef struct
 
   /* offsets indexed by DTS */
   GArray *offsets;
+  /* sorted DTS of the keyframes in offsets */
+  GArray *keyframes;
 } GstMXFDemuxIndexTable;
 
 struct _GstMXFDemuxPad
@@ -185,7 +189,7 @@ struct _GstMXFDemux
   GArray *essence_tracks;
 
   GList *pending_index_table_segments;
-  GList *index_tables; /* one per BodySID / IndexSID */
+  GArray *index_tables; /* one per BodySID / IndexSID, sorted by both */
   gboolean index_table_segments_collected;
 
   GArray *random_index_pack;
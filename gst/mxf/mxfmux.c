@@ -1287,10 +1287,12 @@ gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * pad)
         mxf_uuid_init (&s.instance_id, mux->metadata);
         memcpy (&s.index_edit_rate, &pad->source_track->edit_rate,
             sizeof (s.index_edit_rate));
+        /* all segments but the last one are full */
         if (mux->index_table->len > 0)
           s.index_start_position =
               g_array_index (mux->index_table, MXFIndexTableSegment,
-              mux->index_table->len - 1).index_start_position;
+              mux->index_table->len - 1).index_start_position +
+              max_segment_size;
         else
           s.index_start_position = 0;
         s.index_duration = 0;
@@ -1345,7 +1347,8 @@ gst_mxf_mux_handle_buffer (GstMXFMux * mux, GstMXFMuxPad * pad)
             if (mux->index_table->len > 0)
               s.index_start_position =
                   g_array_index (mux->index_table, MXFIndexTableSegment,
-                  mux->index_table->len - 1).index_start_position;
+                  mux->index_table->len - 1).index_start_position +
+                  max_segment_size;
             else
               s.index_start_position = 0;
             s.index_duration = 0;
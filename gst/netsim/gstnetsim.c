@@ -66,6 +66,10 @@ enum
   PROP_MAX_KBPS,
   PROP_MAX_BUCKET_SIZE,
   PROP_ALLOW_REORDERING,
+  PROP_MAX_QUEUE_DELAY,
+  PROP_BURST_ENTER_PROBABILITY,
+  PROP_BURST_EXIT_PROBABILITY,
+  PROP_BURST_DROP_PROBABILITY,
 };
 
 /* these numbers are nothing but wild guesses and don't reflect any reality */
@@ -79,6 +83,10 @@ enum
 #define DEFAULT_MAX_KBPS -1
 #define DEFAULT_MAX_BUCKET_SIZE -1
 #define DEFAULT_ALLOW_REORDERING TRUE
+#define DEFAULT_MAX_QUEUE_DELAY 0
+#define DEFAULT_BURST_ENTER_PROBABILITY 0.0
+#define DEFAULT_BURST_EXIT_PROBABILITY 1.0
+#define DEFAULT_BURST_DROP_PROBABILITY 1.0
 
 static GstStaticPadTemplate gst_net_sim_sink_template =
 GST_STATIC_PAD_TEMPLATE ("sink",
@@ -94,57 +102,141 @@ GST_STATIC_PAD_TEMPLATE ("src",
 
 G_DEFINE_TYPE (GstNetSim, gst_net_sim, GST_TYPE_ELEMENT);
 
-static gboolean
-gst_net_sim_source_dispatch (GSource * source,
-    GSourceFunc callback, gpointer user_data)
+typedef struct
 {
-  callback (user_data);
-  return FALSE;
+  GList link;
+  GstBuffer *buf;
+  gint64 ready_time;
+} GstNetSimTimer;
+
+static void
+gst_net_sim_timer_free (GstNetSimTimer * timer)
+{
+  gst_buffer_unref (timer->buf);
+  g_slice_free (GstNetSimTimer, timer);
 }
 
-GSourceFuncs gst_net_sim_source_funcs = {
-  NULL,                         /* prepare */
-  NULL,                         /* check */
-  gst_net_sim_source_dispatch,
-  NULL                          /* finalize */
-};
+/* Must be called with the loop_mutex held */
+static void
+gst_net_sim_wheel_insert (GstNetSim * netsim, GstBuffer * buf,
+    gint64 ready_time)
+{
+  GstNetSimTimer *timer = g_slice_new (GstNetSimTimer);
+  gint64 tick = ready_time / NETSIM_WHEEL_TICK;
+
+  timer->link.data = timer;
+  timer->link.prev = timer->link.next = NULL;
+  timer->buf = gst_buffer_ref (buf);
+  timer->ready_time = ready_time;
+
+  /* Never put anything behind the wheel, it would only be found one full
+   * turn later */
+  if (tick <= netsim->wheel_tick)
+    tick = netsim->wheel_tick + 1;
+
+  g_queue_push_tail_link (&netsim->wheel[tick % NETSIM_WHEEL_SIZE],
+      &timer->link);
+  if (netsim->wheel_pending++ == 0)
+    g_cond_signal (&netsim->wheel_cond);
+}
+
+/* Takes all buffers that are due at @now out of the wheel, in the order of
+ * their ticks. Sets @next_wakeup to when this should be called again.
+ * Must be called with the loop_mutex held */
+static GstBufferList *
+gst_net_sim_wheel_collect (GstNetSim * netsim, gint64 now,
+    gint64 * next_wakeup)
+{
+  GstBufferList *list = NULL;
+  gint64 now_tick = now / NETSIM_WHEEL_TICK;
+  gint64 tick;
+
+  *next_wakeup = (now_tick + 1) * NETSIM_WHEEL_TICK;
+
+  /* Each slot needs to be looked at only once, even if we fell behind by
+   * more than a full turn */
+  tick = MAX (netsim->wheel_tick + 1, now_tick - NETSIM_WHEEL_SIZE + 1);
+  for (; tick <= now_tick; tick++) {
+    GQueue *slot = &netsim->wheel[tick % NETSIM_WHEEL_SIZE];
+    GList *l, *next;
+
+    for (l = slot->head; l; l = next) {
+      GstNetSimTimer *timer = l->data;
+
+      next = l->next;
+      if (timer->ready_time > now) {
+        /* Either later in the current tick or on a later turn */
+        if (tick == now_tick)
+          *next_wakeup = MIN (*next_wakeup, timer->ready_time);
+        continue;
+      }
+
+      g_queue_unlink (slot, l);
+      if (list == NULL)
+        list = gst_buffer_list_new ();
+      gst_buffer_list_add (list, timer->buf);
+      g_slice_free (GstNetSimTimer, timer);
+      netsim->wheel_pending--;
+    }
+  }
 
+  /* The current tick can still get buffers that are due before its end,
+   * so look at it again next time */
+  netsim->wheel_tick = now_tick - 1;
+
+  return list;
+}
+
+/* Must be called with the loop_mutex held */
 static void
-gst_net_sim_loop (GstNetSim * netsim)
+gst_net_sim_wheel_clear (GstNetSim * netsim)
 {
-  GMainLoop *loop;
+  guint i;
 
-  GST_TRACE_OBJECT (netsim, "TASK: begin");
+  for (i = 0; i < NETSIM_WHEEL_SIZE; i++) {
+    GList *link;
 
-  g_mutex_lock (&netsim->loop_mutex);
-  loop = g_main_loop_ref (netsim->main_loop);
-  netsim->running = TRUE;
-  GST_TRACE_OBJECT (netsim, "TASK: signal start");
-  g_cond_signal (&netsim->start_cond);
-  g_mutex_unlock (&netsim->loop_mutex);
+    while ((link = g_queue_pop_head_link (&netsim->wheel[i])))
+      gst_net_sim_timer_free (link->data);
+  }
+  netsim->wheel_pending = 0;
+}
 
-  GST_TRACE_OBJECT (netsim, "TASK: run");
-  g_main_loop_run (loop);
-  g_main_loop_unref (loop);
+static void
+gst_net_sim_loop (GstNetSim * netsim)
+{
+  GstBufferList *list = NULL;
+  gint64 now, next_wakeup;
 
   g_mutex_lock (&netsim->loop_mutex);
-  GST_TRACE_OBJECT (netsim, "TASK: pause");
-  gst_pad_pause_task (netsim->srcpad);
-  netsim->running = FALSE;
-  GST_TRACE_OBJECT (netsim, "TASK: signal end");
-  g_cond_signal (&netsim->start_cond);
+  while (netsim->running) {
+    now = g_get_monotonic_time ();
+
+    if (netsim->wheel_pending == 0) {
+      GST_TRACE_OBJECT (netsim, "TASK: idle");
+      netsim->wheel_tick = now / NETSIM_WHEEL_TICK - 1;
+      g_cond_wait (&netsim->wheel_cond, &netsim->loop_mutex);
+      continue;
+    }
+
+    list = gst_net_sim_wheel_collect (netsim, now, &next_wakeup);
+    if (list)
+      break;
+
+    g_cond_wait_until (&netsim->wheel_cond, &netsim->loop_mutex,
+        next_wakeup);
+  }
   g_mutex_unlock (&netsim->loop_mutex);
-  GST_TRACE_OBJECT (netsim, "TASK: end");
-}
 
-static gboolean
-_main_loop_quit_and_remove_source (gpointer user_data)
-{
-  GMainLoop *main_loop = user_data;
-  GST_DEBUG ("MAINLOOP: Quit %p", main_loop);
-  g_main_loop_quit (main_loop);
-  g_assert (!g_main_loop_is_running (main_loop));
-  return FALSE;                 /* Remove source */
+  if (list) {
+    GstFlowReturn ret;
+
+    GST_DEBUG_OBJECT (netsim, "Pushing %u delayed buffers now",
+        gst_buffer_list_length (list));
+    ret = gst_pad_push_list (netsim->srcpad, list);
+    if (ret != GST_FLOW_OK)
+      GST_DEBUG_OBJECT (netsim, "Pushing returned %s", gst_flow_get_name (ret));
+  }
 }
 
 static gboolean
@@ -152,92 +244,39 @@ gst_net_sim_src_activatemode (GstPad * pad, GstObject * parent,
     GstPadMode mode, gboolean active)
 {
   GstNetSim *netsim = GST_NET_SIM (parent);
-  gboolean result = FALSE;
+  gboolean result = TRUE;
 
   g_mutex_lock (&netsim->loop_mutex);
   if (active) {
-    if (netsim->main_loop == NULL) {
-      GMainContext *main_context = g_main_context_new ();
-      netsim->main_loop = g_main_loop_new (main_context, FALSE);
-      g_main_context_unref (main_context);
-
+    if (!netsim->running) {
+      netsim->running = TRUE;
+      netsim->wheel_tick = g_get_monotonic_time () / NETSIM_WHEEL_TICK - 1;
       GST_TRACE_OBJECT (netsim, "ACT: Starting task on srcpad");
       result = gst_pad_start_task (netsim->srcpad,
           (GstTaskFunction) gst_net_sim_loop, netsim, NULL);
-
-      GST_TRACE_OBJECT (netsim, "ACT: Wait for task to start");
-      g_assert (!netsim->running);
-      while (!netsim->running)
-        g_cond_wait (&netsim->start_cond, &netsim->loop_mutex);
-      GST_TRACE_OBJECT (netsim, "ACT: Task on srcpad started");
+      if (!result)
+        netsim->running = FALSE;
     }
+    g_mutex_unlock (&netsim->loop_mutex);
   } else {
-    if (netsim->main_loop != NULL) {
-      GSource *source;
-      guint id;
-
-      /* Adds an Idle Source which quits the main loop from within.
-       * This removes the possibility for run/quit race conditions. */
-      GST_TRACE_OBJECT (netsim, "DEACT: Stopping main loop on deactivate");
-      source = g_idle_source_new ();
-      g_source_set_callback (source, _main_loop_quit_and_remove_source,
-          g_main_loop_ref (netsim->main_loop),
-          (GDestroyNotify) g_main_loop_unref);
-      id = g_source_attach (source,
-          g_main_loop_get_context (netsim->main_loop));
-      g_source_unref (source);
-      g_assert_cmpuint (id, >, 0);
-      g_main_loop_unref (netsim->main_loop);
-      netsim->main_loop = NULL;
-
-      GST_TRACE_OBJECT (netsim, "DEACT: Wait for mainloop and task to pause");
-      g_assert (netsim->running);
-      while (netsim->running)
-        g_cond_wait (&netsim->start_cond, &netsim->loop_mutex);
-
+    if (netsim->running) {
       GST_TRACE_OBJECT (netsim, "DEACT: Stopping task on srcpad");
+      netsim->running = FALSE;
+      g_cond_signal (&netsim->wheel_cond);
+      g_mutex_unlock (&netsim->loop_mutex);
+
       result = gst_pad_stop_task (netsim->srcpad);
-      GST_TRACE_OBJECT (netsim, "DEACT: Mainloop and GstTask stopped");
+
+      g_mutex_lock (&netsim->loop_mutex);
+      gst_net_sim_wheel_clear (netsim);
+      GST_TRACE_OBJECT (netsim, "DEACT: GstTask stopped");
     }
+    g_mutex_unlock (&netsim->loop_mutex);
   }
-  g_mutex_unlock (&netsim->loop_mutex);
 
   return result;
 }
 
-typedef struct
-{
-  GstPad *pad;
-  GstBuffer *buf;
-} PushBufferCtx;
-
-static inline PushBufferCtx *
-push_buffer_ctx_new (GstPad * pad, GstBuffer * buf)
-{
-  PushBufferCtx *ctx = g_slice_new (PushBufferCtx);
-  ctx->pad = gst_object_ref (pad);
-  ctx->buf = gst_buffer_ref (buf);
-  return ctx;
-}
-
-static inline void
-push_buffer_ctx_free (PushBufferCtx * ctx)
-{
-  if (G_LIKELY (ctx != NULL)) {
-    gst_buffer_unref (ctx->buf);
-    gst_object_unref (ctx->pad);
-    g_slice_free (PushBufferCtx, ctx);
-  }
-}
-
-static gboolean
-push_buffer_ctx_push (PushBufferCtx * ctx)
-{
-  GST_DEBUG_OBJECT (ctx->pad, "Pushing buffer now");
-  gst_pad_push (ctx->pad, gst_buffer_ref (ctx->buf));
-  return FALSE;
-}
-
 static gint
 get_random_value_uniform (GRand * rand_seed, gint32 min_value, gint32 max_value)
 {
@@ -326,18 +365,17 @@ get_random_value_gamma (GRand * rand_seed, gint32 low, gint32 high,
   return round (x + low);
 }
 
+/* @wait is how long in microseconds the token bucket holds the buffer
+ * back, on top of which a random delay might be added */
 static GstFlowReturn
-gst_net_sim_delay_buffer (GstNetSim * netsim, GstBuffer * buf)
+gst_net_sim_delay_buffer (GstNetSim * netsim, GstBuffer * buf, gint64 wait)
 {
   GstFlowReturn ret = GST_FLOW_OK;
 
   g_mutex_lock (&netsim->loop_mutex);
-  if (netsim->main_loop != NULL && netsim->delay_probability > 0 &&
+  if (netsim->running && netsim->delay_probability > 0 &&
       g_rand_double (netsim->rand_seed) < netsim->delay_probability) {
     gint delay;
-    PushBufferCtx *ctx;
-    GSource *source;
-    gint64 ready_time, now_time;
 
     switch (netsim->delay_distribution) {
       case DISTRIBUTION_UNIFORM:
@@ -360,11 +398,14 @@ gst_net_sim_delay_buffer (GstNetSim * netsim, GstBuffer * buf)
     if (delay < 0)
       delay = 0;
 
-    ctx = push_buffer_ctx_new (netsim->srcpad, buf);
+    wait += (gint64) delay * 1000;
+  }
+
+  if (netsim->running && wait > 0) {
+    gint64 ready_time, now_time;
 
-    source = g_source_new (&gst_net_sim_source_funcs, sizeof (GSource));
     now_time = g_get_monotonic_time ();
-    ready_time = now_time + delay * 1000;
+    ready_time = now_time + wait;
     if (!netsim->allow_reordering && ready_time < netsim->last_ready_time)
       ready_time = netsim->last_ready_time + 1;
 
@@ -372,15 +413,12 @@ gst_net_sim_delay_buffer (GstNetSim * netsim, GstBuffer * buf)
     GST_DEBUG_OBJECT (netsim, "Delaying packet by %" G_GINT64_FORMAT "ms",
         (ready_time - now_time) / 1000);
 
-    g_source_set_ready_time (source, ready_time);
-    g_source_set_callback (source, (GSourceFunc) push_buffer_ctx_push,
-        ctx, (GDestroyNotify) push_buffer_ctx_free);
-    g_source_attach (source, g_main_loop_get_context (netsim->main_loop));
-    g_source_unref (source);
+    gst_net_sim_wheel_insert (netsim, buf, ready_time);
+    g_mutex_unlock (&netsim->loop_mutex);
   } else {
+    g_mutex_unlock (&netsim->loop_mutex);
     ret = gst_pad_push (netsim->srcpad, gst_buffer_ref (buf));
   }
-  g_mutex_unlock (&netsim->loop_mutex);
 
   return ret;
 }
@@ -431,12 +469,17 @@ gst_net_sim_get_tokens (GstNetSim * netsim)
   return tokens;
 }
 
+/* Returns FALSE if @buf has to be dropped. When shaping, a buffer that
+ * does not fit in the bucket borrows its tokens and @wait is set to the
+ * time in microseconds it takes to pay them back */
 static gboolean
-gst_net_sim_token_bucket (GstNetSim * netsim, GstBuffer * buf)
+gst_net_sim_token_bucket (GstNetSim * netsim, GstBuffer * buf, gint64 * wait)
 {
-  gsize buffer_size;
+  gint64 buffer_size;
   gint tokens;
 
+  *wait = 0;
+
   /* with an unlimited bucket-size, we have nothing to do */
   if (netsim->max_bucket_size == -1)
     return TRUE;
@@ -447,7 +490,7 @@ gst_net_sim_token_bucket (GstNetSim * netsim, GstBuffer * buf)
 
   netsim->bucket_size = MIN (G_MAXINT, netsim->bucket_size + tokens);
   GST_LOG_OBJECT (netsim,
-      "Adding %d tokens to bucket (contains %" G_GSIZE_FORMAT " tokens)",
+      "Adding %d tokens to bucket (contains %" G_GINT64_FORMAT " tokens)",
       tokens, netsim->bucket_size);
 
   if (netsim->max_bucket_size != -1 && netsim->bucket_size >
@@ -455,33 +498,75 @@ gst_net_sim_token_bucket (GstNetSim * netsim, GstBuffer * buf)
     netsim->bucket_size = netsim->max_bucket_size * 1000;
 
   if (buffer_size > netsim->bucket_size) {
+    if (netsim->max_queue_delay > 0 && netsim->max_kbps > 0) {
+      gint64 debt = buffer_size - netsim->bucket_size;
+
+      *wait = gst_util_uint64_scale_int (debt, G_USEC_PER_SEC,
+          netsim->max_kbps * 1000);
+      if (*wait <= (gint64) netsim->max_queue_delay * 1000) {
+        netsim->bucket_size -= buffer_size;
+        GST_LOG_OBJECT (netsim,
+            "Queueing buffer for %" G_GINT64_FORMAT "us (%" G_GINT64_FORMAT
+            " tokens left)", *wait, netsim->bucket_size);
+        return TRUE;
+      }
+      *wait = 0;
+    }
+
     GST_DEBUG_OBJECT (netsim,
-        "Buffer size (%" G_GSIZE_FORMAT ") exeedes bucket size (%"
-        G_GSIZE_FORMAT ")", buffer_size, netsim->bucket_size);
+        "Buffer size (%" G_GINT64_FORMAT ") exeedes bucket size (%"
+        G_GINT64_FORMAT ")", buffer_size, netsim->bucket_size);
     return FALSE;
   }
 
   netsim->bucket_size -= buffer_size;
   GST_LOG_OBJECT (netsim,
-      "Buffer taking %" G_GSIZE_FORMAT " tokens (%" G_GSIZE_FORMAT " left)",
+      "Buffer taking %" G_GINT64_FORMAT " tokens (%" G_GINT64_FORMAT " left)",
       buffer_size, netsim->bucket_size);
   return TRUE;
 }
 
+/* Gilbert-Elliott model: a two state Markov chain switching between a good
+ * state, where drop-probability applies, and a bad (burst) state with its
+ * own, usually much higher, drop probability */
+static gboolean
+gst_net_sim_burst_loss (GstNetSim * netsim)
+{
+  if (netsim->in_burst) {
+    if (g_rand_double (netsim->rand_seed) <
+        (gdouble) netsim->burst_exit_probability) {
+      GST_DEBUG_OBJECT (netsim, "Leaving loss burst");
+      netsim->in_burst = FALSE;
+    }
+  } else if (netsim->burst_enter_probability > 0 &&
+      g_rand_double (netsim->rand_seed) <
+      (gdouble) netsim->burst_enter_probability) {
+    GST_DEBUG_OBJECT (netsim, "Entering loss burst");
+    netsim->in_burst = TRUE;
+  }
+
+  return netsim->in_burst && netsim->burst_drop_probability > 0 &&
+      g_rand_double (netsim->rand_seed) <
+      (gdouble) netsim->burst_drop_probability;
+}
+
 static GstFlowReturn
 gst_net_sim_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
 {
   GstNetSim *netsim = GST_NET_SIM (parent);
   GstFlowReturn ret = GST_FLOW_OK;
+  gint64 wait;
 
-  if (!gst_net_sim_token_bucket (netsim, buf))
+  if (!gst_net_sim_token_bucket (netsim, buf, &wait))
     goto done;
 
   if (netsim->drop_packets > 0) {
     netsim->drop_packets--;
     GST_DEBUG_OBJECT (netsim, "Dropping packet (%d left)",
         netsim->drop_packets);
-  } else if (netsim->drop_probability > 0
+  } else if (gst_net_sim_burst_loss (netsim)) {
+    GST_DEBUG_OBJECT (netsim, "Dropping packet in burst");
+  } else if (!netsim->in_burst && netsim->drop_probability > 0
       && g_rand_double (netsim->rand_seed) <
       (gdouble) netsim->drop_probability) {
     GST_DEBUG_OBJECT (netsim, "Dropping packet");
@@ -489,10 +574,10 @@ gst_net_sim_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
       g_rand_double (netsim->rand_seed) <
       (gdouble) netsim->duplicate_probability) {
     GST_DEBUG_OBJECT (netsim, "Duplicating packet");
-    gst_net_sim_delay_buffer (netsim, buf);
-    ret = gst_net_sim_delay_buffer (netsim, buf);
+    gst_net_sim_delay_buffer (netsim, buf, wait);
+    ret = gst_net_sim_delay_buffer (netsim, buf, wait);
   } else {
-    ret = gst_net_sim_delay_buffer (netsim, buf);
+    ret = gst_net_sim_delay_buffer (netsim, buf, wait);
   }
 
 done:
@@ -540,6 +625,18 @@ gst_net_sim_set_property (GObject * object,
     case PROP_ALLOW_REORDERING:
       netsim->allow_reordering = g_value_get_boolean (value);
       break;
+    case PROP_MAX_QUEUE_DELAY:
+      netsim->max_queue_delay = g_value_get_int (value);
+      break;
+    case PROP_BURST_ENTER_PROBABILITY:
+      netsim->burst_enter_probability = g_value_get_float (value);
+      break;
+    case PROP_BURST_EXIT_PROBABILITY:
+      netsim->burst_exit_probability = g_value_get_float (value);
+      break;
+    case PROP_BURST_DROP_PROBABILITY:
+      netsim->burst_drop_probability = g_value_get_float (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -583,6 +680,18 @@ gst_net_sim_get_property (GObject * object,
     case PROP_ALLOW_REORDERING:
       g_value_set_boolean (value, netsim->allow_reordering);
       break;
+    case PROP_MAX_QUEUE_DELAY:
+      g_value_set_int (value, netsim->max_queue_delay);
+      break;
+    case PROP_BURST_ENTER_PROBABILITY:
+      g_value_set_float (value, netsim->burst_enter_probability);
+      break;
+    case PROP_BURST_EXIT_PROBABILITY:
+      g_value_set_float (value, netsim->burst_exit_probability);
+      break;
+    case PROP_BURST_DROP_PROBABILITY:
+      g_value_set_float (value, netsim->burst_drop_probability);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -593,6 +702,8 @@ gst_net_sim_get_property (GObject * object,
 static void
 gst_net_sim_init (GstNetSim * netsim)
 {
+  guint i;
+
   netsim->srcpad =
       gst_pad_new_from_static_template (&gst_net_sim_src_template, "src");
   netsim->sinkpad =
@@ -602,9 +713,11 @@ gst_net_sim_init (GstNetSim * netsim)
   gst_element_add_pad (GST_ELEMENT (netsim), netsim->sinkpad);
 
   g_mutex_init (&netsim->loop_mutex);
-  g_cond_init (&netsim->start_cond);
+  g_cond_init (&netsim->wheel_cond);
+  for (i = 0; i < NETSIM_WHEEL_SIZE; i++)
+    g_queue_init (&netsim->wheel[i]);
   netsim->rand_seed = g_rand_new ();
-  netsim->main_loop = NULL;
+  netsim->running = FALSE;
   netsim->prev_time = GST_CLOCK_TIME_NONE;
 
   GST_OBJECT_FLAG_SET (netsim->sinkpad,
@@ -623,7 +736,7 @@ gst_net_sim_finalize (GObject * object)
 
   g_rand_free (netsim->rand_seed);
   g_mutex_clear (&netsim->loop_mutex);
-  g_cond_clear (&netsim->start_cond);
+  g_cond_clear (&netsim->wheel_cond);
 
   G_OBJECT_CLASS (gst_net_sim_parent_class)->finalize (object);
 }
@@ -633,7 +746,7 @@ gst_net_sim_dispose (GObject * object)
 {
   GstNetSim *netsim = GST_NET_SIM (object);
 
-  g_assert (netsim->main_loop == NULL);
+  g_assert (!netsim->running);
 
   G_OBJECT_CLASS (gst_net_sim_parent_class)->dispose (object);
 }
@@ -755,6 +868,69 @@ gst_net_sim_class_init (GstNetSimClass * klass)
           DEFAULT_ALLOW_REORDERING,
           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstNetSim:max-queue-delay:
+   *
+   * Turns the token bucket from policing into shaping: a buffer that does
+   * not fit in the bucket is held back until enough tokens arrived, like
+   * in the queue of a router, instead of being dropped right away. Only
+   * buffers that would have to wait longer than this are dropped. Needs
+   * "max-kbps" and "max-bucket-size" to be set.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_MAX_QUEUE_DELAY,
+      g_param_spec_int ("max-queue-delay", "Maximum queue delay (ms)",
+          "The maximum time in ms a buffer waits for tokens before being "
+          "dropped (0 = drop right away)", 0, G_MAXINT,
+          DEFAULT_MAX_QUEUE_DELAY,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetSim:burst-enter-probability:
+   *
+   * Probability for each buffer to switch from the good to the bad state
+   * of a Gilbert-Elliott loss model. In the good state buffers are dropped
+   * with "drop-probability", in the bad state with
+   * "burst-drop-probability". Setting this to 0 disables burst loss.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class,
+      PROP_BURST_ENTER_PROBABILITY,
+      g_param_spec_float ("burst-enter-probability",
+          "Burst Enter Probability",
+          "The Probability to go from the good to the bad (burst loss) state",
+          0.0, 1.0, DEFAULT_BURST_ENTER_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetSim:burst-exit-probability:
+   *
+   * Probability for each buffer to switch from the bad back to the good
+   * state, the mean burst length is the inverse of it.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_BURST_EXIT_PROBABILITY,
+      g_param_spec_float ("burst-exit-probability", "Burst Exit Probability",
+          "The Probability to go from the bad (burst loss) to the good state",
+          0.0, 1.0, DEFAULT_BURST_EXIT_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstNetSim:burst-drop-probability:
+   *
+   * Probability a buffer is dropped while in the bad state.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_BURST_DROP_PROBABILITY,
+      g_param_spec_float ("burst-drop-probability", "Burst Drop Probability",
+          "The Probability a buffer is dropped in the bad (burst loss) state",
+          0.0, 1.0, DEFAULT_BURST_DROP_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+
   GST_DEBUG_CATEGORY_INIT (netsim_debug, "netsim", 0, "Network simulator");
 
   gst_type_mark_as_plugin_api (distribution_get_type (), 0);
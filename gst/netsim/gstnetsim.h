@@ -53,6 +53,11 @@ typedef enum
   DISTRIBUTION_GAMMA
 } GstNetSimDistribution;
 
+/* 1 ms ticks, a full turn of the wheel covers about a second. Buffers
+ * delayed longer simply stay in their slot for more turns */
+#define NETSIM_WHEEL_TICK (1000)
+#define NETSIM_WHEEL_SIZE (1024)
+
 typedef struct
 {
   gboolean generate;
@@ -68,14 +73,20 @@ struct _GstNetSim
   GstPad *srcpad;
 
   GMutex loop_mutex;
-  GCond start_cond;
-  GMainLoop *main_loop;
+  GCond wheel_cond;
   gboolean running;
   GRand *rand_seed;
-  gsize bucket_size;
+  gint64 bucket_size;
   GstClockTime prev_time;
   NormalDistributionState delay_state;
   gint64 last_ready_time;
+  gboolean in_burst;
+
+  /* hashed timer wheel of delayed buffers, the slot of a buffer is its
+   * ready time in ticks modulo NETSIM_WHEEL_SIZE */
+  GQueue wheel[NETSIM_WHEEL_SIZE];
+  gint64 wheel_tick;
+  guint wheel_pending;
 
   /* properties */
   gint min_delay;
@@ -87,7 +98,11 @@ struct _GstNetSim
   guint drop_packets;
   gint max_kbps;
   gint max_bucket_size;
+  gint max_queue_delay;
   gboolean allow_reordering;
+  gfloat burst_enter_probability;
+  gfloat burst_exit_probability;
+  gfloat burst_drop_probability;
 };
 
 struct _GstNetSimClass
@@ -26,8 +26,19 @@
  * #GstPcapParse:src-port and #GstPcapParse:dst-port to restrict which packets
  * should be included.
  *
- * The supported data format is the classical
+ * The supported data formats are the classical
  * [libpcap file format](https://wiki.wireshark.org/Development/LibpcapFileFormat)
+ * and [pcapng](https://wiki.wireshark.org/Development/PcapNg), of which the
+ * Enhanced and Simple Packet Blocks are used.
+ *
+ * With #GstPcapParse:demux, each flow (addresses, ports, protocol and, for
+ * RTP, the SSRC) gets its own `src_%u` pad, so all streams of a capture can
+ * be extracted in a single pass.
+ *
+ * When upstream supports it (e.g. filesrc), the capture is read in pull mode
+ * and the element can seek in time. A sparse index of capture time to file
+ * offset is built while reading, so seeking back is cheap and seeking
+ * forward only scans packet headers past the indexed part.
  *
  * ## Example pipelines
  * |[
@@ -35,6 +46,11 @@
  * ! ffdec_h264 ! fakesink
  * ]| Read from a pcap dump file using filesrc, extract the raw UDP packets,
  * depayload and decode them.
+ * |[
+ * gst-launch-1.0 filesrc location=calls.pcapng ! pcapparse demux=true \
+ *     caps="application/x-rtp" name=p \
+ *   p.src_0 ! queue ! fakesink  p.src_1 ! queue ! fakesink
+ * ]| Split the first two flows found in a pcapng capture.
  *
  */
 
@@ -64,6 +80,63 @@ const guint GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN = 0xa1b23c4d;
 const guint GST_PCAPPARSE_MAGIC_MILLISECOND_SWAP_ENDIAN = 0xd4c3b2a1;
 const guint GST_PCAPPARSE_MAGIC_NANOSECOND_SWAP_ENDIAN = 0x4d3cb2a1;
 
+#define PCAPNG_BLOCK_SHB 0x0a0d0d0a
+#define PCAPNG_BLOCK_IDB 0x00000001
+#define PCAPNG_BLOCK_SPB 0x00000003
+#define PCAPNG_BLOCK_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1a2b3c4d
+#define PCAPNG_OPT_IF_TSRESOL 9
+
+/* bytes pulled at a time in pull mode; payloads are sub-buffers of these
+ * unless a packet straddles two of them */
+#define PCAP_PARSE_PULL_SIZE (1024 * 1024)
+/* minimum capture time between two index entries */
+#define PCAP_PARSE_INDEX_INTERVAL GST_SECOND
+
+typedef struct
+{
+  guint16 linktype;
+  guint64 ts_units;             /* timestamp units per second */
+} GstPcapParseInterface;
+
+typedef struct
+{
+  GstClockTime ts;
+  guint64 offset;
+  /* pcapng section state at @offset, since a seek doesn't go back to the
+   * section header. @interfaces is shared by consecutive entries as long as
+   * it doesn't change, NULL for pcap files */
+  gboolean swap_endian;
+  GArray *interfaces;
+} GstPcapParseIndexEntry;
+
+static void
+gst_pcap_parse_index_entry_clear (GstPcapParseIndexEntry * entry)
+{
+  if (entry->interfaces)
+    g_array_unref (entry->interfaces);
+}
+
+typedef struct
+{
+  guint32 src_ip;
+  guint32 dst_ip;
+  guint16 src_port;
+  guint16 dst_port;
+  guint8 proto;
+  gboolean has_ssrc;
+  guint32 ssrc;
+} GstPcapParseFlowKey;
+
+typedef struct
+{
+  GstPcapParseFlowKey key;
+  GstPad *pad;
+  GstBufferList *pending;
+  gboolean newsegment_sent;
+  gboolean first_packet;
+} GstPcapParseStream;
+
 
 enum
 {
@@ -73,7 +146,8 @@ enum
   PROP_SRC_PORT,
   PROP_DST_PORT,
   PROP_CAPS,
-  PROP_TS_OFFSET
+  PROP_TS_OFFSET,
+  PROP_DEMUX
 };
 
 GST_DEBUG_CATEGORY_STATIC (gst_pcap_parse_debug);
@@ -89,6 +163,11 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
     GST_PAD_ALWAYS,
     GST_STATIC_CAPS_ANY);
 
+static GstStaticPadTemplate stream_template = GST_STATIC_PAD_TEMPLATE ("src_%u",
+    GST_PAD_SRC,
+    GST_PAD_SOMETIMES,
+    GST_STATIC_CAPS_ANY);
+
 static void gst_pcap_parse_finalize (GObject * object);
 static void gst_pcap_parse_get_property (GObject * object, guint prop_id,
     GValue * value, GParamSpec * pspec);
@@ -98,11 +177,20 @@ static GstStateChangeReturn
 gst_pcap_parse_change_state (GstElement * element, GstStateChange transition);
 
 static void gst_pcap_parse_reset (GstPcapParse * self);
+static void gst_pcap_parse_remove_streams (GstPcapParse * self);
 
 static GstFlowReturn gst_pcap_parse_chain (GstPad * pad,
     GstObject * parent, GstBuffer * buffer);
 static gboolean gst_pcap_sink_event (GstPad * pad,
     GstObject * parent, GstEvent * event);
+static gboolean gst_pcap_parse_sink_activate (GstPad * sinkpad,
+    GstObject * parent);
+static gboolean gst_pcap_parse_sink_activate_mode (GstPad * sinkpad,
+    GstObject * parent, GstPadMode mode, gboolean active);
+static gboolean gst_pcap_parse_src_event (GstPad * pad,
+    GstObject * parent, GstEvent * event);
+static gboolean gst_pcap_parse_src_query (GstPad * pad,
+    GstObject * parent, GstQuery * query);
 
 
 #define parent_class gst_pcap_parse_parent_class
@@ -148,8 +236,27 @@ gst_pcap_parse_class_init (GstPcapParseClass * klass)
           "Relative timestamp offset (ns) to apply (-1 = use absolute packet time)",
           -1, G_MAXINT64, -1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstPcapParse:demux:
+   *
+   * Output each flow on its own `src_%u` pad instead of all matching packets
+   * on the `src` pad. A flow is identified by source and destination
+   * address and port, the IP protocol and, for UDP packets that look like
+   * RTP, the SSRC. The address and port properties still filter which
+   * packets are considered, #GstPcapParse:caps is used for every pad, with
+   * the SSRC added if known.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_DEMUX,
+      g_param_spec_boolean ("demux", "Demux",
+          "Output each flow on its own pad", FALSE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS |
+          GST_PARAM_MUTABLE_READY));
+
   gst_element_class_add_static_pad_template (element_class, &sink_template);
   gst_element_class_add_static_pad_template (element_class, &src_template);
+  gst_element_class_add_static_pad_template (element_class, &stream_template);
 
   element_class->change_state = gst_pcap_parse_change_state;
 
@@ -161,6 +268,27 @@ gst_pcap_parse_class_init (GstPcapParseClass * klass)
   GST_DEBUG_CATEGORY_INIT (gst_pcap_parse_debug, "pcapparse", 0, "pcap parser");
 }
 
+static guint
+gst_pcap_parse_flow_key_hash (gconstpointer v)
+{
+  const GstPcapParseFlowKey *key = v;
+
+  return key->src_ip ^ (key->dst_ip * 31) ^
+      ((key->src_port << 16) | key->dst_port) ^ key->proto ^ key->ssrc;
+}
+
+static gboolean
+gst_pcap_parse_flow_key_equal (gconstpointer v1, gconstpointer v2)
+{
+  const GstPcapParseFlowKey *a = v1;
+  const GstPcapParseFlowKey *b = v2;
+
+  return a->src_ip == b->src_ip && a->dst_ip == b->dst_ip &&
+      a->src_port == b->src_port && a->dst_port == b->dst_port &&
+      a->proto == b->proto && a->has_ssrc == b->has_ssrc &&
+      (!a->has_ssrc || a->ssrc == b->ssrc);
+}
+
 static void
 gst_pcap_parse_init (GstPcapParse * self)
 {
@@ -170,10 +298,18 @@ gst_pcap_parse_init (GstPcapParse * self)
   gst_pad_use_fixed_caps (self->sink_pad);
   gst_pad_set_event_function (self->sink_pad,
       GST_DEBUG_FUNCPTR (gst_pcap_sink_event));
+  gst_pad_set_activate_function (self->sink_pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_sink_activate));
+  gst_pad_set_activatemode_function (self->sink_pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_sink_activate_mode));
   gst_element_add_pad (GST_ELEMENT (self), self->sink_pad);
 
   self->src_pad = gst_pad_new_from_static_template (&src_template, "src");
   gst_pad_use_fixed_caps (self->src_pad);
+  gst_pad_set_event_function (self->src_pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_src_event));
+  gst_pad_set_query_function (self->src_pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_src_query));
   gst_element_add_pad (GST_ELEMENT (self), self->src_pad);
 
   self->src_ip = -1;
@@ -181,8 +317,17 @@ gst_pcap_parse_init (GstPcapParse * self)
   self->src_port = -1;
   self->dst_port = -1;
   self->offset = -1;
+  self->seek_seqnum = GST_SEQNUM_INVALID;
 
   self->adapter = gst_adapter_new ();
+  self->interfaces = g_array_new (FALSE, FALSE,
+      sizeof (GstPcapParseInterface));
+  self->index = g_array_new (FALSE, FALSE, sizeof (GstPcapParseIndexEntry));
+  g_array_set_clear_func (self->index,
+      (GDestroyNotify) gst_pcap_parse_index_entry_clear);
+  self->streams = g_hash_table_new (gst_pcap_parse_flow_key_hash,
+      gst_pcap_parse_flow_key_equal);
+  self->flowcombiner = gst_flow_combiner_new ();
 
   gst_pcap_parse_reset (self);
 }
@@ -195,6 +340,10 @@ gst_pcap_parse_finalize (GObject * object)
   g_object_unref (self->adapter);
   if (self->caps)
     gst_caps_unref (self->caps);
+  g_array_free (self->interfaces, TRUE);
+  g_array_free (self->index, TRUE);
+  g_hash_table_unref (self->streams);
+  gst_flow_combiner_free (self->flowcombiner);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -254,6 +403,10 @@ gst_pcap_parse_get_property (GObject * object, guint prop_id,
       g_value_set_int64 (value, self->offset);
       break;
 
+    case PROP_DEMUX:
+      g_value_set_boolean (value, self->demux);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -308,16 +461,35 @@ gst_pcap_parse_set_property (GObject * object, guint prop_id,
       self->offset = g_value_get_int64 (value);
       break;
 
+    case PROP_DEMUX:
+      self->demux = g_value_get_boolean (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
   }
 }
 
+static void
+gst_pcap_parse_reset_streams (GstPcapParse * self)
+{
+  GHashTableIter iter;
+  GstPcapParseStream *stream;
+
+  g_hash_table_iter_init (&iter, self->streams);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & stream)) {
+    g_clear_pointer (&stream->pending, gst_buffer_list_unref);
+    stream->newsegment_sent = FALSE;
+    stream->first_packet = TRUE;
+  }
+}
+
 static void
 gst_pcap_parse_reset (GstPcapParse * self)
 {
   self->initialized = FALSE;
+  self->pcapng = FALSE;
   self->swap_endian = FALSE;
   self->nanosecond_timestamp = FALSE;
   self->cur_packet_size = -1;
@@ -325,8 +497,34 @@ gst_pcap_parse_reset (GstPcapParse * self)
   self->base_ts = GST_CLOCK_TIME_NONE;
   self->newsegment_sent = FALSE;
   self->first_packet = TRUE;
+  self->skip_until = GST_CLOCK_TIME_NONE;
+  gst_segment_init (&self->segment, GST_FORMAT_UNDEFINED);
 
+  g_array_set_size (self->interfaces, 0);
+  g_clear_pointer (&self->pending, gst_buffer_list_unref);
   gst_adapter_clear (self->adapter);
+
+  gst_pcap_parse_reset_streams (self);
+}
+
+static void
+gst_pcap_parse_remove_streams (GstPcapParse * self)
+{
+  GHashTableIter iter;
+  GstPcapParseStream *stream;
+
+  g_hash_table_iter_init (&iter, self->streams);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & stream)) {
+    gst_flow_combiner_remove_pad (self->flowcombiner, stream->pad);
+    gst_element_remove_pad (GST_ELEMENT (self), stream->pad);
+    if (stream->pending)
+      gst_buffer_list_unref (stream->pending);
+    g_slice_free (GstPcapParseStream, stream);
+  }
+  g_hash_table_remove_all (self->streams);
+  self->n_streams = 0;
+
+  g_array_set_size (self->index, 0);
 }
 
 static guint32
@@ -345,6 +543,22 @@ gst_pcap_parse_read_uint32 (GstPcapParse * self, const guint8 * p)
   }
 }
 
+static guint16
+gst_pcap_parse_read_uint16 (GstPcapParse * self, const guint8 * p)
+{
+  guint16 val = *((guint16 *) p);
+
+  if (self->swap_endian) {
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+    return GUINT16_FROM_BE (val);
+#else
+    return GUINT16_FROM_LE (val);
+#endif
+  } else {
+    return val;
+  }
+}
+
 #define ETH_MAC_ADDRESSES_LEN    12
 #define ETH_HEADER_LEN    14
 #define ETH_VLAN_HEADER_LEN    4
@@ -359,7 +573,8 @@ gst_pcap_parse_read_uint32 (GstPcapParse * self, const guint8 * p)
 static gboolean
 gst_pcap_parse_scan_frame (GstPcapParse * self,
     const guint8 * buf,
-    gint buf_size, const guint8 ** payload, gint * payload_size)
+    gint buf_size, const guint8 ** payload, gint * payload_size,
+    GstPcapParseFlowKey * key)
 {
   const guint8 *buf_ip = 0;
   const guint8 *buf_proto;
@@ -488,15 +703,479 @@ gst_pcap_parse_scan_frame (GstPcapParse * self,
   if (self->dst_port >= 0 && dst_port != self->dst_port)
     return FALSE;
 
+  key->src_ip = ip_src_addr;
+  key->dst_ip = ip_dst_addr;
+  key->src_port = src_port;
+  key->dst_port = dst_port;
+  key->proto = ip_protocol;
+  key->has_ssrc = FALSE;
+  key->ssrc = 0;
+
+  return TRUE;
+}
+
+static void
+gst_pcap_parse_push_segment (GstPcapParse * self, GstPad * pad)
+{
+  if (self->segment.format == GST_FORMAT_UNDEFINED) {
+    gst_segment_init (&self->segment, GST_FORMAT_TIME);
+    if (GST_CLOCK_TIME_IS_VALID (self->base_ts))
+      self->segment.start = self->base_ts;
+  }
+
+  gst_pad_push_event (pad, gst_event_new_segment (&self->segment));
+}
+
+static gboolean
+gst_pcap_parse_rtp_ssrc (const guint8 * payload, gint payload_size,
+    guint32 * ssrc)
+{
+  guint8 pt;
+
+  if (payload_size < 12 || (payload[0] >> 6) != 2)
+    return FALSE;
+
+  /* RTCP (SR, RR, SDES, BYE, APP) multiplexed on the same port */
+  pt = payload[1] & 0x7f;
+  if (pt >= 72 && pt <= 76)
+    return FALSE;
+
+  *ssrc = GST_READ_UINT32_BE (payload + 8);
+  return TRUE;
+}
+
+static GstPcapParseStream *
+gst_pcap_parse_get_stream (GstPcapParse * self,
+    const GstPcapParseFlowKey * key)
+{
+  GstPcapParseStream *stream;
+  gchar *name, *stream_id;
+
+  stream = g_hash_table_lookup (self->streams, key);
+  if (stream)
+    return stream;
+
+  stream = g_slice_new0 (GstPcapParseStream);
+  stream->key = *key;
+  stream->first_packet = TRUE;
+
+  name = g_strdup_printf ("src_%u", self->n_streams++);
+  stream->pad = gst_pad_new_from_static_template (&stream_template, name);
+  g_free (name);
+
+  gst_pad_use_fixed_caps (stream->pad);
+  gst_pad_set_event_function (stream->pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_src_event));
+  gst_pad_set_query_function (stream->pad,
+      GST_DEBUG_FUNCPTR (gst_pcap_parse_src_query));
+  gst_pad_set_active (stream->pad, TRUE);
+
+  stream_id = gst_pad_create_stream_id_printf (stream->pad,
+      GST_ELEMENT (self), "%08x:%u-%08x:%u/%u/%08x", key->src_ip,
+      key->src_port, key->dst_ip, key->dst_port, key->proto, key->ssrc);
+  gst_pad_push_event (stream->pad, gst_event_new_stream_start (stream_id));
+  g_free (stream_id);
+
+  if (self->caps) {
+    GstCaps *caps = gst_caps_copy (self->caps);
+
+    if (key->has_ssrc && gst_caps_is_fixed (caps))
+      gst_caps_set_simple (caps, "ssrc", G_TYPE_UINT, key->ssrc, NULL);
+    gst_pad_set_caps (stream->pad, caps);
+    gst_caps_unref (caps);
+  }
+
+  GST_DEBUG_OBJECT (self, "new stream %s: proto %u, ports %u -> %u, "
+      "ssrc %08x", GST_PAD_NAME (stream->pad), key->proto, key->src_port,
+      key->dst_port, key->ssrc);
+
+  g_hash_table_insert (self->streams, &stream->key, stream);
+  gst_flow_combiner_add_pad (self->flowcombiner, stream->pad);
+  gst_element_add_pad (GST_ELEMENT (self), stream->pad);
+
+  return stream;
+}
+
+static gboolean
+gst_pcap_parse_interfaces_equal (GArray * a, GArray * b)
+{
+  guint i;
+
+  if (!a || !b || a->len != b->len)
+    return FALSE;
+
+  for (i = 0; i < a->len; i++) {
+    GstPcapParseInterface *ia = &g_array_index (a, GstPcapParseInterface, i);
+    GstPcapParseInterface *ib = &g_array_index (b, GstPcapParseInterface, i);
+
+    if (ia->linktype != ib->linktype || ia->ts_units != ib->ts_units)
+      return FALSE;
+  }
+
   return TRUE;
 }
 
+/* Remembers the file offset of the record at the head of the adapter as
+ * the place to start from when seeking to @ts. Only done in pull mode, and
+ * sparsely, since seeking then scans forward to the exact position. */
+static void
+gst_pcap_parse_index_add (GstPcapParse * self, GstClockTime ts)
+{
+  GstPcapParseIndexEntry entry = { 0, };
+  GstPcapParseIndexEntry *last = NULL;
+
+  if (!self->pull || !GST_CLOCK_TIME_IS_VALID (ts))
+    return;
+
+  entry.ts = ts;
+  entry.offset = self->read_offset - gst_adapter_available (self->adapter);
+
+  if (self->index->len > 0) {
+    last = &g_array_index (self->index, GstPcapParseIndexEntry,
+        self->index->len - 1);
+
+    /* entries stay sorted by both offset and time */
+    if (entry.offset <= last->offset ||
+        entry.ts < last->ts + PCAP_PARSE_INDEX_INTERVAL)
+      return;
+  }
+
+  if (self->pcapng) {
+    guint n = self->interfaces->len;
+
+    entry.swap_endian = self->swap_endian;
+    if (last && gst_pcap_parse_interfaces_equal (last->interfaces,
+            self->interfaces)) {
+      entry.interfaces = g_array_ref (last->interfaces);
+    } else {
+      entry.interfaces = g_array_sized_new (FALSE, FALSE,
+          sizeof (GstPcapParseInterface), n);
+      g_array_append_vals (entry.interfaces, self->interfaces->data, n);
+    }
+  }
+
+  GST_LOG_OBJECT (self, "indexing %" GST_TIME_FORMAT " at offset %"
+      G_GUINT64_FORMAT, GST_TIME_ARGS (entry.ts), entry.offset);
+  g_array_append_val (self->index, entry);
+}
+
+/* last index entry not after @ts, if any */
+static const GstPcapParseIndexEntry *
+gst_pcap_parse_index_lookup (GstPcapParse * self, GstClockTime ts)
+{
+  guint lo = 0, hi = self->index->len;
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (g_array_index (self->index, GstPcapParseIndexEntry, mid).ts <= ts)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  if (lo == 0)
+    return NULL;
+
+  return &g_array_index (self->index, GstPcapParseIndexEntry, lo - 1);
+}
+
+/* Handles the packet found at @packet_offset in @data, which is mapped from
+ * the adapter. Consumes @total bytes from the adapter and unmaps it. */
+static void
+gst_pcap_parse_handle_packet (GstPcapParse * self, const guint8 * data,
+    gsize packet_offset, gint packet_size, gsize total)
+{
+  const guint8 *payload_data;
+  gint payload_size;
+  GstPcapParseFlowKey key;
+  GstPcapParseStream *stream = NULL;
+  GstBufferList **list;
+  gboolean *first_packet;
+  GstBuffer *out_buf;
+  GstClockTime ts = self->cur_ts;
+  guintptr offset;
+
+  GST_LOG_OBJECT (self, "examining packet size %d", packet_size);
+
+  if (GST_CLOCK_TIME_IS_VALID (self->skip_until)) {
+    if (GST_CLOCK_TIME_IS_VALID (ts) && ts < self->skip_until)
+      goto skip;
+
+    GST_DEBUG_OBJECT (self, "reached seek target at %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (ts));
+    self->skip_until = GST_CLOCK_TIME_NONE;
+  }
+
+  if (!gst_pcap_parse_scan_frame (self, data + packet_offset, packet_size,
+          &payload_data, &payload_size, &key))
+    goto skip;
+
+  if (self->demux) {
+    if (key.proto == IP_PROTO_UDP)
+      key.has_ssrc = gst_pcap_parse_rtp_ssrc (payload_data, payload_size,
+          &key.ssrc);
+    stream = gst_pcap_parse_get_stream (self, &key);
+  }
+
+  offset = payload_data - data;
+
+  gst_adapter_unmap (self->adapter);
+  gst_adapter_flush (self->adapter, offset);
+  /* we don't use _take_buffer_fast() on purpose here, we need a
+   * buffer with a single memory, since the RTP depayloaders expect
+   * the complete RTP header to be in the first memory if there are
+   * multiple ones and we can't guarantee that with _fast() */
+  if (payload_size > 0) {
+    out_buf = gst_adapter_take_buffer (self->adapter, payload_size);
+  } else {
+    out_buf = gst_buffer_new ();
+  }
+  gst_adapter_flush (self->adapter, total - offset - payload_size);
+
+  /* only first packet should have DISCONT flag */
+  first_packet = stream ? &stream->first_packet : &self->first_packet;
+  if (G_LIKELY (!*first_packet)) {
+    GST_BUFFER_FLAG_UNSET (out_buf, GST_BUFFER_FLAG_DISCONT);
+  } else {
+    GST_BUFFER_FLAG_SET (out_buf, GST_BUFFER_FLAG_DISCONT);
+    *first_packet = FALSE;
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (ts)) {
+    if (!GST_CLOCK_TIME_IS_VALID (self->base_ts))
+      self->base_ts = ts;
+    if (self->offset >= 0) {
+      ts -= self->base_ts;
+      ts += self->offset;
+    }
+  }
+  GST_BUFFER_TIMESTAMP (out_buf) = ts;
+
+  list = stream ? &stream->pending : &self->pending;
+  if (*list == NULL)
+    *list = gst_buffer_list_new ();
+  gst_buffer_list_add (*list, out_buf);
+  return;
+
+skip:
+  gst_adapter_unmap (self->adapter);
+  gst_adapter_flush (self->adapter, total);
+}
+
 static GstFlowReturn
-gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+gst_pcap_parse_push_pending (GstPcapParse * self)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  GHashTableIter iter;
+  GstPcapParseStream *stream;
+
+  if (self->pending) {
+    if (!self->newsegment_sent) {
+      if (self->caps)
+        gst_pad_set_caps (self->src_pad, self->caps);
+      gst_pcap_parse_push_segment (self, self->src_pad);
+      self->newsegment_sent = TRUE;
+    }
+
+    ret = gst_pad_push_list (self->src_pad, self->pending);
+    self->pending = NULL;
+  }
+
+  /* packets were collected per stream for the whole input buffer, so each
+   * pad gets one list */
+  g_hash_table_iter_init (&iter, self->streams);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & stream)) {
+    GstFlowReturn stream_ret;
+
+    if (!stream->pending)
+      continue;
+
+    if (!stream->newsegment_sent) {
+      gst_pcap_parse_push_segment (self, stream->pad);
+      stream->newsegment_sent = TRUE;
+    }
+
+    stream_ret = gst_pad_push_list (stream->pad, stream->pending);
+    stream->pending = NULL;
+    ret = gst_flow_combiner_update_pad_flow (self->flowcombiner, stream->pad,
+        stream_ret);
+  }
+
+  return ret;
+}
+
+static void
+gst_pcap_parse_ng_interface (GstPcapParse * self, const guint8 * data,
+    guint32 block_len)
+{
+  GstPcapParseInterface iface;
+  guint32 pos = 16;
+
+  iface.linktype = gst_pcap_parse_read_uint16 (self, data + 8);
+  iface.ts_units = G_GUINT64_CONSTANT (1000000);
+
+  /* options, up to the trailing block length */
+  while (pos + 4 <= block_len - 4) {
+    guint16 code = gst_pcap_parse_read_uint16 (self, data + pos);
+    guint16 len = gst_pcap_parse_read_uint16 (self, data + pos + 2);
+
+    if (code == 0 || pos + 4 + len > block_len - 4)
+      break;
+
+    if (code == PCAPNG_OPT_IF_TSRESOL && len >= 1) {
+      guint8 tsresol = data[pos + 4];
+      guint exp = tsresol & 0x7f;
+
+      if (tsresol & 0x80) {
+        if (exp < 64)
+          iface.ts_units = G_GUINT64_CONSTANT (1) << exp;
+      } else if (exp <= 19) {
+        iface.ts_units = 1;
+        while (exp--)
+          iface.ts_units *= 10;
+      }
+    }
+
+    pos += 4 + GST_ROUND_UP_4 (len);
+  }
+
+  if (iface.linktype != LINKTYPE_ETHER && iface.linktype != LINKTYPE_SLL &&
+      iface.linktype != LINKTYPE_RAW) {
+    GST_WARNING_OBJECT (self, "interface %u has link type %u, its packets "
+        "will be ignored", self->interfaces->len, iface.linktype);
+  }
+
+  GST_DEBUG_OBJECT (self, "interface %u: linktype %u, %" G_GUINT64_FORMAT
+      " timestamp units per second", self->interfaces->len, iface.linktype,
+      iface.ts_units);
+  g_array_append_val (self->interfaces, iface);
+}
+
+/* Handles one pcapng block, returns FALSE if more data is needed or on
+ * error, in which case @ret is set */
+static gboolean
+gst_pcap_parse_ng_block (GstPcapParse * self, gint avail, GstFlowReturn * ret)
+{
+  const guint8 *data;
+  guint32 block_type, block_len;
+
+  /* block type, block length and the byte-order magic of a SHB */
+  if (avail < 12)
+    return FALSE;
+
+  data = gst_adapter_map (self->adapter, 12);
+
+  block_type = gst_pcap_parse_read_uint32 (self, data);
+  if (block_type == PCAPNG_BLOCK_SHB) {
+    /* every section has its own byte order */
+    guint32 magic = *((guint32 *) (data + 8));
+
+    if (magic == PCAPNG_BYTE_ORDER_MAGIC) {
+      self->swap_endian = FALSE;
+    } else if (magic == GUINT32_SWAP_LE_BE (PCAPNG_BYTE_ORDER_MAGIC)) {
+      self->swap_endian = TRUE;
+    } else {
+      gst_adapter_unmap (self->adapter);
+      GST_ELEMENT_ERROR (self, STREAM, WRONG_TYPE, (NULL),
+          ("Invalid pcapng byte-order magic %X", magic));
+      *ret = GST_FLOW_ERROR;
+      return FALSE;
+    }
+  }
+  block_len = gst_pcap_parse_read_uint32 (self, data + 4);
+  gst_adapter_unmap (self->adapter);
+
+  if (block_len < 12 || block_len % 4) {
+    GST_ELEMENT_ERROR (self, STREAM, DEMUX, (NULL),
+        ("Invalid pcapng block length %u", block_len));
+    *ret = GST_FLOW_ERROR;
+    return FALSE;
+  }
+
+  if (avail < block_len)
+    return FALSE;
+
+  data = gst_adapter_map (self->adapter, block_len);
+
+  switch (block_type) {
+    case PCAPNG_BLOCK_SHB:
+      GST_DEBUG_OBJECT (self, "section header, swap endian %d",
+          self->swap_endian);
+      g_array_set_size (self->interfaces, 0);
+      break;
+
+    case PCAPNG_BLOCK_IDB:
+      if (block_len >= 20)
+        gst_pcap_parse_ng_interface (self, data, block_len);
+      break;
+
+    case PCAPNG_BLOCK_EPB:{
+      const GstPcapParseInterface *iface;
+      guint32 if_id, caplen;
+      guint64 ts;
+
+      if (block_len < 32)
+        break;
+
+      if_id = gst_pcap_parse_read_uint32 (self, data + 8);
+      caplen = gst_pcap_parse_read_uint32 (self, data + 20);
+      if (if_id >= self->interfaces->len || caplen > block_len - 32) {
+        GST_WARNING_OBJECT (self, "skipping invalid enhanced packet block");
+        break;
+      }
+
+      iface = &g_array_index (self->interfaces, GstPcapParseInterface, if_id);
+      ts = ((guint64) gst_pcap_parse_read_uint32 (self, data + 12) << 32) |
+          gst_pcap_parse_read_uint32 (self, data + 16);
+
+      self->linktype = iface->linktype;
+      self->cur_ts = gst_util_uint64_scale (ts, GST_SECOND, iface->ts_units);
+      gst_pcap_parse_index_add (self, self->cur_ts);
+
+      if (caplen == 0)
+        break;
+
+      gst_pcap_parse_handle_packet (self, data, 28, caplen, block_len);
+      return TRUE;
+    }
+
+    case PCAPNG_BLOCK_SPB:{
+      guint32 caplen;
+
+      if (block_len < 16 || self->interfaces->len == 0)
+        break;
+
+      /* no timestamp, and only the original length is stored */
+      caplen = MIN (gst_pcap_parse_read_uint32 (self, data + 8),
+          block_len - 16);
+
+      self->linktype =
+          g_array_index (self->interfaces, GstPcapParseInterface, 0).linktype;
+      self->cur_ts = GST_CLOCK_TIME_NONE;
+
+      if (caplen == 0)
+        break;
+
+      gst_pcap_parse_handle_packet (self, data, 12, caplen, block_len);
+      return TRUE;
+    }
+
+    default:
+      GST_LOG_OBJECT (self, "skipping block type 0x%08x", block_type);
+      break;
+  }
+
+  gst_adapter_unmap (self->adapter);
+  gst_adapter_flush (self->adapter, block_len);
+
+  return TRUE;
+}
+
+static GstFlowReturn
+gst_pcap_parse_process (GstPcapParse * self, GstBuffer * buffer)
 {
-  GstPcapParse *self = GST_PCAP_PARSE (parent);
   GstFlowReturn ret = GST_FLOW_OK;
-  GstBufferList *list = NULL;
 
   gst_adapter_push (self->adapter, buffer);
 
@@ -506,67 +1185,19 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
 
     avail = gst_adapter_available (self->adapter);
 
-    if (self->initialized) {
+    if (self->initialized && self->pcapng) {
+      if (!gst_pcap_parse_ng_block (self, avail, &ret))
+        break;
+    } else if (self->initialized) {
       if (self->cur_packet_size >= 0) {
         /* Parse the Packet Data */
         if (avail < self->cur_packet_size)
           break;
 
         if (self->cur_packet_size > 0) {
-          const guint8 *payload_data;
-          gint payload_size;
-
           data = gst_adapter_map (self->adapter, self->cur_packet_size);
-
-          GST_LOG_OBJECT (self, "examining packet size %" G_GINT64_FORMAT,
+          gst_pcap_parse_handle_packet (self, data, 0, self->cur_packet_size,
               self->cur_packet_size);
-
-          if (gst_pcap_parse_scan_frame (self, data, self->cur_packet_size,
-                  &payload_data, &payload_size)) {
-            GstBuffer *out_buf;
-            guintptr offset = payload_data - data;
-
-            gst_adapter_unmap (self->adapter);
-            gst_adapter_flush (self->adapter, offset);
-            /* we don't use _take_buffer_fast() on purpose here, we need a
-             * buffer with a single memory, since the RTP depayloaders expect
-             * the complete RTP header to be in the first memory if there are
-             * multiple ones and we can't guarantee that with _fast() */
-            if (payload_size > 0) {
-              out_buf = gst_adapter_take_buffer (self->adapter, payload_size);
-            } else {
-              out_buf = gst_buffer_new ();
-            }
-
-            /* only first packet should have DISCONT flag */
-            if (G_LIKELY (!self->first_packet)) {
-              GST_BUFFER_FLAG_UNSET (out_buf, GST_BUFFER_FLAG_DISCONT);
-            } else {
-              GST_BUFFER_FLAG_SET (out_buf, GST_BUFFER_FLAG_DISCONT);
-              self->first_packet = FALSE;
-            }
-
-            gst_adapter_flush (self->adapter,
-                self->cur_packet_size - offset - payload_size);
-
-            if (GST_CLOCK_TIME_IS_VALID (self->cur_ts)) {
-              if (!GST_CLOCK_TIME_IS_VALID (self->base_ts))
-                self->base_ts = self->cur_ts;
-              if (self->offset >= 0) {
-                self->cur_ts -= self->base_ts;
-                self->cur_ts += self->offset;
-              }
-            }
-            GST_BUFFER_TIMESTAMP (out_buf) = self->cur_ts;
-
-
-            if (list == NULL)
-              list = gst_buffer_list_new ();
-            gst_buffer_list_add (list, out_buf);
-          } else {
-            gst_adapter_unmap (self->adapter);
-            gst_adapter_flush (self->adapter, self->cur_packet_size);
-          }
         }
 
         self->cur_packet_size = -1;
@@ -588,12 +1219,14 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
         /* orig_len = gst_pcap_parse_read_uint32 (self, data + 12); */
 
         gst_adapter_unmap (self->adapter);
-        gst_adapter_flush (self->adapter, 16);
 
         self->cur_ts =
             ts_sec * GST_SECOND +
             ts_usec * (self->nanosecond_timestamp ? 1 : GST_USECOND);
         self->cur_packet_size = incl_len;
+
+        gst_pcap_parse_index_add (self, self->cur_ts);
+        gst_adapter_flush (self->adapter, 16);
       }
     } else {
       /* Parse the Global Header */
@@ -612,6 +1245,14 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
       linktype = *((guint32 *) (data + 20));
       gst_adapter_unmap (self->adapter);
 
+      if (magic == PCAPNG_BLOCK_SHB) {
+        /* the section header block is parsed like any other block */
+        GST_DEBUG_OBJECT (self, "pcapng file");
+        self->pcapng = TRUE;
+        self->initialized = TRUE;
+        continue;
+      }
+
       if (magic == GST_PCAPPARSE_MAGIC_MILLISECOND_NO_SWAP_ENDIAN ||
           magic == GST_PCAPPARSE_MAGIC_NANOSECOND_NO_SWAP_ENDIAN) {
         self->swap_endian = FALSE;
@@ -655,30 +1296,294 @@ gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
     }
   }
 
-  if (list) {
-    if (!self->newsegment_sent && GST_CLOCK_TIME_IS_VALID (self->cur_ts)) {
-      GstSegment segment;
+  if (ret == GST_FLOW_OK)
+    ret = gst_pcap_parse_push_pending (self);
 
-      if (self->caps)
-        gst_pad_set_caps (self->src_pad, self->caps);
-      gst_segment_init (&segment, GST_FORMAT_TIME);
-      segment.start = self->base_ts;
-      gst_pad_push_event (self->src_pad, gst_event_new_segment (&segment));
-      self->newsegment_sent = TRUE;
+out:
+  return ret;
+}
+
+static GstFlowReturn
+gst_pcap_parse_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  return gst_pcap_parse_process (GST_PCAP_PARSE (parent), buffer);
+}
+
+static gboolean
+push_event_func (GstElement * element, GstPad * pad, gpointer user_data)
+{
+  gst_pad_push_event (pad, gst_event_ref (GST_EVENT (user_data)));
+
+  return TRUE;
+}
+
+/* pushes @event on the src pad, and on all stream pads in demux mode */
+static gboolean
+gst_pcap_parse_push_event (GstPcapParse * self, GstEvent * event)
+{
+  if (!self->demux)
+    return gst_pad_push_event (self->src_pad, event);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS)
+    gst_element_no_more_pads (GST_ELEMENT (self));
+
+  gst_element_foreach_src_pad (GST_ELEMENT (self), push_event_func, event);
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+static void
+gst_pcap_parse_loop (GstPad * sinkpad)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (GST_PAD_PARENT (sinkpad));
+  GstBuffer *buffer = NULL;
+  GstEvent *event;
+  GstFlowReturn ret;
+
+  /* there is no upstream stream-start in pull mode */
+  event = gst_pad_get_sticky_event (self->src_pad, GST_EVENT_STREAM_START, 0);
+  if (event) {
+    gst_event_unref (event);
+  } else {
+    gchar *stream_id;
+
+    stream_id = gst_pad_create_stream_id (self->src_pad, GST_ELEMENT (self),
+        NULL);
+    gst_pad_push_event (self->src_pad, gst_event_new_stream_start (stream_id));
+    g_free (stream_id);
+  }
+
+  ret = gst_pad_pull_range (sinkpad, self->read_offset, PCAP_PARSE_PULL_SIZE,
+      &buffer);
+  if (ret != GST_FLOW_OK)
+    goto pause;
+
+  self->read_offset += gst_buffer_get_size (buffer);
+
+  ret = gst_pcap_parse_process (self, buffer);
+  if (ret != GST_FLOW_OK)
+    goto pause;
+
+  return;
+
+pause:
+  {
+    GST_DEBUG_OBJECT (self, "pausing task, reason %s",
+        gst_flow_get_name (ret));
+    gst_pad_pause_task (sinkpad);
+
+    if (ret == GST_FLOW_EOS) {
+      gst_pcap_parse_push_event (self, gst_event_new_eos ());
+    } else if (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS) {
+      GST_ELEMENT_FLOW_ERROR (self, ret);
+      gst_pcap_parse_push_event (self, gst_event_new_eos ());
     }
+  }
+}
+
+static gboolean
+gst_pcap_parse_sink_activate (GstPad * sinkpad, GstObject * parent)
+{
+  GstQuery *query;
+  gboolean pull_mode;
+
+  query = gst_query_new_scheduling ();
 
-    ret = gst_pad_push_list (self->src_pad, list);
-    list = NULL;
+  if (!gst_pad_peer_query (sinkpad, query)) {
+    gst_query_unref (query);
+    goto activate_push;
   }
 
-out:
+  pull_mode = gst_query_has_scheduling_mode_with_flags (query,
+      GST_PAD_MODE_PULL, GST_SCHEDULING_FLAG_SEEKABLE);
+  gst_query_unref (query);
 
-  if (list)
-    gst_buffer_list_unref (list);
+  if (!pull_mode)
+    goto activate_push;
+
+  GST_DEBUG_OBJECT (sinkpad, "activating pull");
+  return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PULL, TRUE);
+
+activate_push:
+  {
+    GST_DEBUG_OBJECT (sinkpad, "activating push");
+    return gst_pad_activate_mode (sinkpad, GST_PAD_MODE_PUSH, TRUE);
+  }
+}
+
+static gboolean
+gst_pcap_parse_sink_activate_mode (GstPad * sinkpad, GstObject * parent,
+    GstPadMode mode, gboolean active)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (parent);
+
+  switch (mode) {
+    case GST_PAD_MODE_PUSH:
+      self->pull = FALSE;
+      return TRUE;
+
+    case GST_PAD_MODE_PULL:
+      if (active) {
+        self->pull = TRUE;
+        self->read_offset = 0;
+        return gst_pad_start_task (sinkpad,
+            (GstTaskFunction) gst_pcap_parse_loop, sinkpad, NULL);
+      } else {
+        return gst_pad_stop_task (sinkpad);
+      }
+
+    default:
+      return FALSE;
+  }
+}
+
+static gboolean
+gst_pcap_parse_do_seek (GstPcapParse * self, GstEvent * event)
+{
+  gdouble rate;
+  GstFormat format;
+  GstSeekFlags flags;
+  GstSeekType start_type, stop_type;
+  gint64 start, stop;
+  const GstPcapParseIndexEntry *entry;
+  GstClockTime target;
+  guint32 seqnum;
+  gboolean flush;
+
+  gst_event_parse_seek (event, &rate, &format, &flags, &start_type, &start,
+      &stop_type, &stop);
+  seqnum = gst_event_get_seqnum (event);
+
+  if (format != GST_FORMAT_TIME || rate <= 0.0) {
+    GST_DEBUG_OBJECT (self, "only forward seeks in time are supported");
+    return FALSE;
+  }
+
+  /* the same seek arrives on every stream pad */
+  if (seqnum == self->seek_seqnum) {
+    GST_DEBUG_OBJECT (self, "already handled seek %u", seqnum);
+    return TRUE;
+  }
+  self->seek_seqnum = seqnum;
+
+  flush = ! !(flags & GST_SEEK_FLAG_FLUSH);
+
+  if (flush) {
+    GstEvent *flush_event = gst_event_new_flush_start ();
+
+    gst_event_set_seqnum (flush_event, seqnum);
+    gst_pcap_parse_push_event (self, flush_event);
+  } else {
+    gst_pad_pause_task (self->sink_pad);
+  }
+
+  GST_PAD_STREAM_LOCK (self->sink_pad);
+
+  if (flush) {
+    GstEvent *flush_event = gst_event_new_flush_stop (TRUE);
+
+    gst_event_set_seqnum (flush_event, seqnum);
+    gst_pcap_parse_push_event (self, flush_event);
+  }
+
+  if (self->segment.format == GST_FORMAT_UNDEFINED)
+    gst_segment_init (&self->segment, GST_FORMAT_TIME);
+  gst_segment_do_seek (&self->segment, rate, format, flags, start_type, start,
+      stop_type, stop, NULL);
+
+  /* back from output timestamps to capture time */
+  target = self->segment.start;
+  if (self->offset >= 0 && GST_CLOCK_TIME_IS_VALID (self->base_ts)) {
+    if (target > self->offset)
+      target = target - self->offset + self->base_ts;
+    else
+      target = self->base_ts;
+  }
+
+  entry = gst_pcap_parse_index_lookup (self, target);
+  if (entry) {
+    GST_DEBUG_OBJECT (self, "seeking to %" GST_TIME_FORMAT ", starting at "
+        "offset %" G_GUINT64_FORMAT " (%" GST_TIME_FORMAT ")",
+        GST_TIME_ARGS (target), entry->offset, GST_TIME_ARGS (entry->ts));
+    self->read_offset = entry->offset;
+    if (entry->interfaces) {
+      self->swap_endian = entry->swap_endian;
+      g_array_set_size (self->interfaces, 0);
+      g_array_append_vals (self->interfaces, entry->interfaces->data,
+          entry->interfaces->len);
+    }
+  } else {
+    /* from the very start, file header included */
+    GST_DEBUG_OBJECT (self, "seeking to %" GST_TIME_FORMAT ", starting over",
+        GST_TIME_ARGS (target));
+    self->read_offset = 0;
+    self->initialized = FALSE;
+    self->pcapng = FALSE;
+  }
+
+  gst_adapter_clear (self->adapter);
+  g_clear_pointer (&self->pending, gst_buffer_list_unref);
+  gst_pcap_parse_reset_streams (self);
+  gst_flow_combiner_reset (self->flowcombiner);
+  self->cur_packet_size = -1;
+  self->newsegment_sent = FALSE;
+  self->first_packet = TRUE;
+  self->skip_until = target;
+
+  gst_pad_start_task (self->sink_pad, (GstTaskFunction) gst_pcap_parse_loop,
+      self->sink_pad, NULL);
+
+  GST_PAD_STREAM_UNLOCK (self->sink_pad);
+
+  return TRUE;
+}
+
+static gboolean
+gst_pcap_parse_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (parent);
+  gboolean ret;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_SEEK:
+      if (self->pull) {
+        ret = gst_pcap_parse_do_seek (self, event);
+        gst_event_unref (event);
+        break;
+      }
+      /* fall through */
+    default:
+      ret = gst_pad_event_default (pad, parent, event);
+      break;
+  }
 
   return ret;
 }
 
+static gboolean
+gst_pcap_parse_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  GstPcapParse *self = GST_PCAP_PARSE (parent);
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_SEEKING:{
+      GstFormat format;
+
+      gst_query_parse_seeking (query, &format, NULL, NULL, NULL);
+      if (format != GST_FORMAT_TIME || !self->pull)
+        break;
+
+      gst_query_set_seeking (query, GST_FORMAT_TIME, TRUE, 0, -1);
+      return TRUE;
+    }
+    default:
+      break;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
 static gboolean
 gst_pcap_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -690,12 +1595,18 @@ gst_pcap_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       /* Drop it, we'll replace it with our own */
       gst_event_unref (event);
       break;
+    case GST_EVENT_STREAM_START:
+    case GST_EVENT_CAPS:
+      /* streams in demux mode have their own */
+      ret = gst_pad_push_event (self->src_pad, event);
+      break;
     case GST_EVENT_FLUSH_STOP:
       gst_pcap_parse_reset (self);
+      gst_flow_combiner_reset (self->flowcombiner);
       /* Push event down the pipeline so that other elements stop flushing */
       /* fall through */
     default:
-      ret = gst_pad_push_event (self->src_pad, event);
+      ret = gst_pcap_parse_push_event (self, event);
       break;
   }
 
@@ -713,6 +1624,9 @@ gst_pcap_parse_change_state (GstElement * element, GstStateChange transition)
   switch (transition) {
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       gst_pcap_parse_reset (self);
+      gst_pcap_parse_remove_streams (self);
+      gst_flow_combiner_reset (self->flowcombiner);
+      self->seek_seqnum = GST_SEQNUM_INVALID;
       break;
     default:
       break;
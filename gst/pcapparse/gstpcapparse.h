@@ -22,6 +22,7 @@
 
 #include <gst/gst.h>
 #include <gst/base/gstadapter.h>
+#include <gst/base/gstflowcombiner.h>
 
 G_BEGIN_DECLS
 
@@ -73,19 +74,38 @@ struct _GstPcapParse
   gint32 dst_port;
   GstCaps *caps;
   gint64 offset;
+  gboolean demux;
 
   /* state */
   GstAdapter * adapter;
   gboolean initialized;
+  gboolean pcapng;
   gboolean swap_endian;
   gboolean nanosecond_timestamp;
   gint64 cur_packet_size;
   GstClockTime cur_ts;
   GstClockTime base_ts;
   GstPcapParseLinktype linktype;
+  /* interfaces of the current pcapng section */
+  GArray *interfaces;
 
   gboolean newsegment_sent;
   gboolean first_packet;
+  GstBufferList *pending;
+  GstSegment segment;
+
+  /* demux mode, one stream per flow */
+  GHashTable *streams;
+  guint n_streams;
+  GstFlowCombiner *flowcombiner;
+
+  /* pull mode */
+  gboolean pull;
+  guint64 read_offset;
+  /* capture time to file offset, see gst_pcap_parse_index_add() */
+  GArray *index;
+  GstClockTime skip_until;
+  guint32 seek_seqnum;
 };
 
 struct _GstPcapParseClass
@@ -105,7 +105,7 @@ static void gst_rtmp_connection_emit_error (GstRtmpConnection * self);
 static gboolean gst_rtmp_connection_input_ready (GInputStream * is,
     gpointer user_data);
 static void gst_rtmp_connection_start_write (GstRtmpConnection * self);
-static void gst_rtmp_connection_write_buffer_done (GObject * obj,
+static void gst_rtmp_connection_write_buffers_done (GObject * obj,
     GAsyncResult * result, gpointer user_data);
 static void gst_rtmp_connection_start_read (GstRtmpConnection * sc,
     guint needed_bytes);
@@ -491,34 +491,27 @@ gst_rtmp_connection_input_ready (GInputStream * is, gpointer user_data)
   return G_SOURCE_CONTINUE;
 }
 
-static void
-gst_rtmp_connection_start_write (GstRtmpConnection * self)
+/* Serializes @message into chunks appended to @chunks. Every chunk is
+ * a header memory followed by memory shared with the message payload. */
+static gboolean
+gst_rtmp_connection_serialize_message (GstRtmpConnection * self,
+    GstBuffer * message, GPtrArray * chunks)
 {
-  GOutputStream *os;
-  GstBuffer *message, *chunks;
   GstRtmpMeta *meta;
   GstRtmpChunkStream *cstream;
-
-  if (self->writing) {
-    return;
-  }
-
-  message = g_async_queue_try_pop (self->output_queue);
-  if (!message) {
-    return;
-  }
+  GstBuffer *chunk;
 
   meta = gst_buffer_get_rtmp_meta (message);
   if (!meta) {
     GST_ERROR_OBJECT (self, "No RTMP meta on %" GST_PTR_FORMAT, message);
-    goto out;
+    return FALSE;
   }
 
   if (gst_rtmp_message_is_protocol_control (message)) {
     if (!gst_rtmp_connection_prepare_protocol_control (self, message)) {
       GST_ERROR_OBJECT (self,
           "Failed to prepare protocol control %" GST_PTR_FORMAT, message);
-      goto out;
+      return FALSE;
     }
   }
 
@@ -526,30 +519,74 @@ gst_rtmp_connection_start_write (GstRtmpConnection * self)
   if (!cstream) {
     GST_ERROR_OBJECT (self, "Failed to get chunk stream for %" GST_PTR_FORMAT,
         message);
-    goto out;
+    return FALSE;
   }
 
-  chunks = gst_rtmp_chunk_stream_serialize_all (cstream, message,
+  chunk = gst_rtmp_chunk_stream_serialize_start (cstream, message,
       self->out_chunk_size);
-  if (!chunks) {
+  if (!chunk) {
     GST_ERROR_OBJECT (self, "Failed to serialize %" GST_PTR_FORMAT, message);
-    goto out;
+    return FALSE;
+  }
+
+  do {
+    g_ptr_array_add (chunks, chunk);
+    chunk = gst_rtmp_chunk_stream_serialize_next (cstream,
+        self->out_chunk_size);
+  } while (chunk);
+
+  return TRUE;
+}
+
+static void
+gst_rtmp_connection_start_write (GstRtmpConnection * self)
+{
+  GOutputStream *os;
+  GstBuffer *message;
+  GPtrArray *chunks;
+  guint n_messages = 0;
+
+  if (self->writing) {
+    return;
+  }
+
+  /* Coalesce everything queued so far into a single vectored write */
+  chunks = g_ptr_array_new_with_free_func ((GDestroyNotify) gst_buffer_unref);
+
+  while ((message = g_async_queue_try_pop (self->output_queue))) {
+    gboolean protocol_control = gst_rtmp_message_is_protocol_control (message);
+
+    if (gst_rtmp_connection_serialize_message (self, message, chunks)) {
+      n_messages++;
+    }
+    gst_buffer_unref (message);
+
+    /* a new chunk size only applies once the protocol control message
+     * has been written, so don't serialize anything after it yet */
+    if (protocol_control) {
+      break;
+    }
   }
 
+  if (chunks->len == 0) {
+    g_ptr_array_unref (chunks);
+    return;
+  }
+
+  GST_LOG_OBJECT (self, "writing %u messages in %u chunks", n_messages,
+      chunks->len);
+
   self->writing = TRUE;
   if (self->output_handler) {
     self->output_handler (self, self->output_handler_user_data);
   }
 
   os = g_io_stream_get_output_stream (G_IO_STREAM (self->connection));
-  gst_rtmp_output_stream_write_all_buffer_async (os, chunks, G_PRIORITY_DEFAULT,
-      self->cancellable, gst_rtmp_connection_write_buffer_done,
-      g_object_ref (self));
-
-  gst_buffer_unref (chunks);
+  gst_rtmp_output_stream_write_all_buffers_async (os, chunks,
+      G_PRIORITY_DEFAULT, self->cancellable,
+      gst_rtmp_connection_write_buffers_done, g_object_ref (self));
 
-out:
-  gst_buffer_unref (message);
+  g_ptr_array_unref (chunks);
 }
 
 static void
@@ -568,7 +605,7 @@ gst_rtmp_connection_emit_error (GstRtmpConnection * self)
 }
 
 static void
-gst_rtmp_connection_write_buffer_done (GObject * obj,
+gst_rtmp_connection_write_buffers_done (GObject * obj,
     GAsyncResult * result, gpointer user_data)
 {
   GOutputStream *os = G_OUTPUT_STREAM (obj);
@@ -579,7 +616,7 @@ gst_rtmp_connection_write_buffer_done (GObject * obj,
 
   self->writing = FALSE;
 
-  res = gst_rtmp_output_stream_write_all_buffer_finish (os, result,
+  res = gst_rtmp_output_stream_write_all_buffers_finish (os, result,
       &bytes_written, &error);
 
   g_mutex_lock (&self->stats_lock);
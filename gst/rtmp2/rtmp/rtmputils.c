@@ -30,7 +30,7 @@ static void read_all_bytes_done (GObject * source, GAsyncResult * result,
     gpointer user_data);
 static void write_all_bytes_done (GObject * source, GAsyncResult * result,
     gpointer user_data);
-static void write_all_buffer_done (GObject * source, GAsyncResult * result,
+static void write_all_buffers_done (GObject * source, GAsyncResult * result,
     gpointer user_data);
 
 void
@@ -156,77 +156,218 @@ gst_rtmp_output_stream_write_all_bytes_finish (GOutputStream * stream,
   return g_task_propagate_boolean (G_TASK (result), error);
 }
 
+/* Memories smaller than this are copied together with their neighbours
+ * when the stream has no vectored write of its own. Its default one writes
+ * each vector separately, which for TLS means a record per chunk header */
+#define WRITE_COALESCE_THRESHOLD 1024
+
 typedef struct
 {
-  GstBuffer *buffer;
-  GstMapInfo map;
-  gboolean mapped;
+  GPtrArray *buffers;
+  GArray *maps;                 /* GstMapInfo, one per mapped memory */
+  GArray *vectors;              /* GOutputVector */
+  guint8 *coalesced;            /* copies of the small memories */
   gsize bytes_written;
-} WriteAllBufferData;
+} WriteAllBuffersData;
 
-static WriteAllBufferData *
-write_all_buffer_data_new (GstBuffer * buffer)
+static WriteAllBuffersData *
+write_all_buffers_data_new (GPtrArray * buffers)
 {
-  WriteAllBufferData *data = g_slice_new0 (WriteAllBufferData);
-  data->buffer = gst_buffer_ref (buffer);
+  WriteAllBuffersData *data = g_slice_new0 (WriteAllBuffersData);
+  data->buffers = g_ptr_array_ref (buffers);
+  data->maps = g_array_new (FALSE, FALSE, sizeof (GstMapInfo));
+  data->vectors = g_array_new (FALSE, FALSE, sizeof (GOutputVector));
   return data;
 }
 
 static void
-write_all_buffer_data_free (gpointer ptr)
+write_all_buffers_data_unmap (WriteAllBuffersData * data)
+{
+  guint i;
+
+  for (i = 0; i < data->maps->len; i++) {
+    GstMapInfo *map = &g_array_index (data->maps, GstMapInfo, i);
+    gst_memory_unmap (map->memory, map);
+    gst_memory_unref (map->memory);
+  }
+  g_array_set_size (data->maps, 0);
+}
+
+static void
+write_all_buffers_data_free (gpointer ptr)
+{
+  WriteAllBuffersData *data = ptr;
+  write_all_buffers_data_unmap (data);
+  g_array_free (data->maps, TRUE);
+  g_array_free (data->vectors, TRUE);
+  g_free (data->coalesced);
+  g_clear_pointer (&data->buffers, g_ptr_array_unref);
+  g_slice_free (WriteAllBuffersData, data);
+}
+
+static gboolean
+write_all_buffers_data_map_memory (WriteAllBuffersData * data,
+    GstMemory * memory)
 {
-  WriteAllBufferData *data = ptr;
-  if (data->mapped) {
-    gst_buffer_unmap (data->buffer, &data->map);
+  GstMapInfo map;
+
+  if (!gst_memory_map (memory, &map, GST_MAP_READ)) {
+    gst_memory_unref (memory);
+    return FALSE;
   }
-  g_clear_pointer (&data->buffer, gst_buffer_unref);
-  g_slice_free (WriteAllBufferData, data);
+
+  g_array_append_val (data->maps, map);
+  return TRUE;
+}
+
+#if GLIB_CHECK_VERSION (2, 60, 0)
+static gboolean
+output_stream_has_writev (GOutputStream * stream)
+{
+  GOutputStreamClass *klass = G_OUTPUT_STREAM_GET_CLASS (stream);
+  GOutputStreamClass *base_class = g_type_class_peek (G_TYPE_OUTPUT_STREAM);
+
+  return klass->writev_fn != base_class->writev_fn;
 }
+#endif
 
+/* One vector per mapped memory, except that with @coalesce consecutive
+ * small memories are copied into a single one */
+static void
+write_all_buffers_data_build_vectors (WriteAllBuffersData * data,
+    gboolean coalesce)
+{
+  GOutputVector vector = { NULL, 0 };
+  gsize coalesced_size = 0;
+  guint8 *dest = NULL;
+  guint i;
+
+  if (coalesce) {
+    for (i = 0; i < data->maps->len; i++) {
+      GstMapInfo *map = &g_array_index (data->maps, GstMapInfo, i);
+      if (map->size < WRITE_COALESCE_THRESHOLD)
+        coalesced_size += map->size;
+    }
+    dest = data->coalesced = g_malloc (coalesced_size);
+  }
+
+  for (i = 0; i < data->maps->len; i++) {
+    GstMapInfo *map = &g_array_index (data->maps, GstMapInfo, i);
+
+    if (coalesce && map->size < WRITE_COALESCE_THRESHOLD) {
+      if (vector.buffer == NULL)
+        vector.buffer = dest;
+      memcpy (dest, map->data, map->size);
+      dest += map->size;
+      vector.size += map->size;
+      continue;
+    }
+
+    /* end of a run of small memories */
+    if (vector.buffer != NULL)
+      g_array_append_val (data->vectors, vector);
+
+    vector.buffer = map->data;
+    vector.size = map->size;
+    g_array_append_val (data->vectors, vector);
+    vector.buffer = NULL;
+    vector.size = 0;
+  }
+
+  if (vector.buffer != NULL)
+    g_array_append_val (data->vectors, vector);
+}
+
+/* Writes all of @buffers, in order. Each memory of each buffer is mapped
+ * separately and handed to a single vectored write, so neither multi-memory
+ * buffers nor the array as a whole get merged. Streams without a vectored
+ * write of their own, like TLS ones, get the small memories copied
+ * together instead. */
 void
-gst_rtmp_output_stream_write_all_buffer_async (GOutputStream * stream,
-    GstBuffer * buffer, int io_priority, GCancellable * cancellable,
+gst_rtmp_output_stream_write_all_buffers_async (GOutputStream * stream,
+    GPtrArray * buffers, int io_priority, GCancellable * cancellable,
     GAsyncReadyCallback callback, gpointer user_data)
 {
   GTask *task;
-  WriteAllBufferData *data;
+  WriteAllBuffersData *data;
+  gboolean mapped = TRUE;
+  guint i;
 
   g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
-  g_return_if_fail (GST_IS_BUFFER (buffer));
+  g_return_if_fail (buffers && buffers->len > 0);
 
   task = g_task_new (stream, cancellable, callback, user_data);
 
-  data = write_all_buffer_data_new (buffer);
-  g_task_set_task_data (task, data, write_all_buffer_data_free);
+  data = write_all_buffers_data_new (buffers);
+  g_task_set_task_data (task, data, write_all_buffers_data_free);
+
+#if GLIB_CHECK_VERSION (2, 60, 0)
+  for (i = 0; mapped && i < buffers->len; i++) {
+    GstBuffer *buffer = g_ptr_array_index (buffers, i);
+    guint j, n = gst_buffer_n_memory (buffer);
 
-  if (!gst_buffer_map (buffer, &data->map, GST_MAP_READ)) {
+    for (j = 0; mapped && j < n; j++) {
+      mapped = write_all_buffers_data_map_memory (data,
+          gst_buffer_get_memory (buffer, j));
+    }
+  }
+#else
+  {
+    /* no vectored writes available, fall back to a single merged write */
+    GstBuffer *merged = gst_buffer_new ();
+
+    for (i = 0; i < buffers->len; i++) {
+      merged = gst_buffer_append (merged,
+          gst_buffer_ref (g_ptr_array_index (buffers, i)));
+    }
+
+    mapped = write_all_buffers_data_map_memory (data,
+        gst_buffer_get_all_memory (merged));
+    gst_buffer_unref (merged);
+  }
+#endif
+
+  if (!mapped) {
     g_task_return_new_error (task, GST_RESOURCE_ERROR, GST_RESOURCE_ERROR_READ,
         "Failed to map buffer for reading");
     g_object_unref (task);
     return;
   }
 
-  data->mapped = TRUE;
-
-  g_output_stream_write_all_async (stream, data->map.data, data->map.size,
-      io_priority, cancellable, write_all_buffer_done, task);
+#if GLIB_CHECK_VERSION (2, 60, 0)
+  write_all_buffers_data_build_vectors (data,
+      !output_stream_has_writev (stream));
+  g_output_stream_writev_all_async (stream,
+      (GOutputVector *) data->vectors->data, data->vectors->len, io_priority,
+      cancellable, write_all_buffers_done, task);
+#else
+  write_all_buffers_data_build_vectors (data, FALSE);
+  g_output_stream_write_all_async (stream,
+      g_array_index (data->vectors, GOutputVector, 0).buffer,
+      g_array_index (data->vectors, GOutputVector, 0).size, io_priority,
+      cancellable, write_all_buffers_done, task);
+#endif
 }
 
 static void
-write_all_buffer_done (GObject * source, GAsyncResult * result,
+write_all_buffers_done (GObject * source, GAsyncResult * result,
     gpointer user_data)
 {
   GOutputStream *os = G_OUTPUT_STREAM (source);
   GTask *task = user_data;
-  WriteAllBufferData *data = g_task_get_task_data (task);
+  WriteAllBuffersData *data = g_task_get_task_data (task);
   GError *error = NULL;
   gboolean res;
 
+#if GLIB_CHECK_VERSION (2, 60, 0)
+  res = g_output_stream_writev_all_finish (os, result, &data->bytes_written,
+      &error);
+#else
   res = g_output_stream_write_all_finish (os, result, &data->bytes_written,
       &error);
+#endif
 
-  gst_buffer_unmap (data->buffer, &data->map);
-  data->mapped = FALSE;
+  write_all_buffers_data_unmap (data);
 
   if (!res) {
     g_task_return_error (task, error);
@@ -238,12 +379,11 @@ write_all_buffer_done (GObject * source, GAsyncResult * result,
   g_object_unref (task);
 }
 
-
 gboolean
-gst_rtmp_output_stream_write_all_buffer_finish (GOutputStream * stream,
+gst_rtmp_output_stream_write_all_buffers_finish (GOutputStream * stream,
     GAsyncResult * result, gsize * bytes_written, GError ** error)
 {
-  WriteAllBufferData *data;
+  WriteAllBuffersData *data;
   GTask *task;
 
   g_return_val_if_fail (g_task_is_valid (result, stream), FALSE);
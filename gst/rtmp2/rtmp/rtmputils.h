@@ -40,11 +40,12 @@ void gst_rtmp_output_stream_write_all_bytes_async (GOutputStream * stream,
 gboolean gst_rtmp_output_stream_write_all_bytes_finish (GOutputStream * stream,
     GAsyncResult * result, GError ** error);
 
-void gst_rtmp_output_stream_write_all_buffer_async (GOutputStream * stream,
-    GstBuffer * buffer, int io_priority, GCancellable * cancellable,
+void gst_rtmp_output_stream_write_all_buffers_async (GOutputStream * stream,
+    GPtrArray * buffers, int io_priority, GCancellable * cancellable,
     GAsyncReadyCallback callback, gpointer user_data);
-gboolean gst_rtmp_output_stream_write_all_buffer_finish (GOutputStream * stream,
-    GAsyncResult * result, gsize * bytes_written, GError ** error);
+gboolean gst_rtmp_output_stream_write_all_buffers_finish (
+    GOutputStream * stream, GAsyncResult * result, gsize * bytes_written,
+    GError ** error);
 
 void gst_rtmp_string_print_escaped (GString * string, const gchar * data,
     gssize size);
@@ -21,11 +21,13 @@
  * @title: gstscenechange
  *
  * The scenechange element detects scene changes (also known as shot
- * changes) in a video stream, and sends a signal when this occurs.
- * Applications can listen to this signal and make changes to the
- * pipeline such as cutting the stream.  In addition, whenever a
- * scene change is detected, a custom downstream "GstForceKeyUnit"
- * event is sent to downstream elements.  Most video encoder elements
+ * changes) in a video stream, and posts a "scene-change" element message
+ * when this occurs, with the "timestamp", "running-time", "stream-time",
+ * "score" and "threshold" of the cut.  Applications can listen to this
+ * message and make changes to the pipeline such as cutting the stream.
+ * In addition, whenever a scene change is detected, a custom downstream
+ * "GstForceKeyUnit" event is sent to downstream elements, carrying the
+ * score in its "scene-change-score" field.  Most video encoder elements
  * will insert synchronization points into the stream when this event
  * is received.  When used with a tee element, the scenechange element
  * can be used to align the synchronization points among multiple
@@ -90,6 +92,15 @@ GST_DEBUG_CATEGORY_STATIC (gst_scene_change_debug_category);
 /* prototypes */
 
 
+static void gst_scene_change_set_property (GObject * object,
+    guint property_id, const GValue * value, GParamSpec * pspec);
+static void gst_scene_change_get_property (GObject * object,
+    guint property_id, GValue * value, GParamSpec * pspec);
+static void gst_scene_change_finalize (GObject * object);
+static gboolean gst_scene_change_stop (GstBaseTransform * trans);
+static gboolean gst_scene_change_set_info (GstVideoFilter * filter,
+    GstCaps * incaps, GstVideoInfo * in_info, GstCaps * outcaps,
+    GstVideoInfo * out_info);
 static GstFlowReturn gst_scene_change_transform_frame_ip (GstVideoFilter *
     filter, GstVideoFrame * frame);
 
@@ -100,12 +111,67 @@ static gboolean is_shot_change (int frame_number);
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_DECIMATION,
+  PROP_METRICS,
+  PROP_N_THREADS
 };
 
+#define DEFAULT_DECIMATION 0
+#define DEFAULT_METRICS GST_SCENE_CHANGE_METRIC_SAD
+#define DEFAULT_N_THREADS 0
+
+/* automatic decimation brings the analysed width down to this */
+#define SC_ANALYSIS_WIDTH 480
+/* sum of the horizontal and vertical gradients above which a pixel is part
+ * of an edge */
+#define SC_EDGE_THRESHOLD 32
+
 #define VIDEO_CAPS \
     GST_VIDEO_CAPS_MAKE("{ I420, Y42B, Y41B, Y444 }")
 
+#define GST_TYPE_SCENE_CHANGE_METRICS (gst_scene_change_metrics_get_type ())
+static GType
+gst_scene_change_metrics_get_type (void)
+{
+  static GType metrics_type = 0;
+  static const GFlagsValue metrics[] = {
+    {GST_SCENE_CHANGE_METRIC_SAD, "Sum of absolute differences of the luma",
+        "sad"},
+    {GST_SCENE_CHANGE_METRIC_HISTOGRAM, "Difference of the luma histograms",
+        "histogram"},
+    {GST_SCENE_CHANGE_METRIC_EDGES, "Ratio of edge pixels that changed",
+        "edges"},
+    {0, NULL, NULL}
+  };
+
+  if (!metrics_type)
+    metrics_type = g_flags_register_static ("GstSceneChangeMetrics", metrics);
+
+  return metrics_type;
+}
+
+/* A band of rows of the decimated luma */
+typedef struct _GstSceneChangeSlice GstSceneChangeSlice;
+struct _GstSceneChangeSlice
+{
+  GstSceneChange *scenechange;
+  void (*func) (GstSceneChangeSlice * slice);
+  GstVideoFrame *frame;
+  gint y_start;
+  gint y_end;
+  guint metrics;
+  guint compare;
+  /* handle of the pool task running func, NULL when it runs in the
+   * streaming thread */
+  gpointer task;
+
+  guint32 sad;
+  guint32 histogram[SC_HISTOGRAM_BINS];
+  guint edges_changed;
+  guint edges_total;
+};
+
 /* class initialization */
 
 G_DEFINE_TYPE_WITH_CODE (GstSceneChange, gst_scene_change,
@@ -116,6 +182,9 @@ G_DEFINE_TYPE_WITH_CODE (GstSceneChange, gst_scene_change,
 static void
 gst_scene_change_class_init (GstSceneChangeClass * klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstBaseTransformClass *base_transform_class =
+      GST_BASE_TRANSFORM_CLASS (klass);
   GstVideoFilterClass *video_filter_class = GST_VIDEO_FILTER_CLASS (klass);
 
   gst_element_class_add_pad_template (GST_ELEMENT_CLASS (klass),
@@ -130,30 +199,424 @@ gst_scene_change_class_init (GstSceneChangeClass * klass)
       "Video/Filter", "Detects scene changes in video",
       "David Schleef <ds@entropywave.com>");
 
+  gobject_class->set_property = gst_scene_change_set_property;
+  gobject_class->get_property = gst_scene_change_get_property;
+  gobject_class->finalize = gst_scene_change_finalize;
+  base_transform_class->stop = GST_DEBUG_FUNCPTR (gst_scene_change_stop);
+  video_filter_class->set_info = GST_DEBUG_FUNCPTR (gst_scene_change_set_info);
   video_filter_class->transform_frame_ip =
       GST_DEBUG_FUNCPTR (gst_scene_change_transform_frame_ip);
 
+  /**
+   * GstSceneChange:decimation:
+   *
+   * Only one luma sample out of this number is analysed, horizontally and
+   * vertically. As the samples are picked rather than averaged, the
+   * per-pixel difference stays an estimate of the full resolution one and
+   * the detection thresholds still apply. 0 picks a factor that brings the
+   * analysed width down to 480 pixels or less.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_DECIMATION,
+      g_param_spec_uint ("decimation", "Decimation",
+          "Decimation factor of the analysed luma, 0 for automatic",
+          0, 64, DEFAULT_DECIMATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSceneChange:metrics:
+   *
+   * Metrics of the difference between consecutive frames. The score of a
+   * frame is the average of the enabled metrics, each scaled to the 0-255
+   * range of the sum of absolute differences per pixel.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_METRICS,
+      g_param_spec_flags ("metrics", "Metrics",
+          "Metrics used to score the difference between frames",
+          GST_TYPE_SCENE_CHANGE_METRICS, DEFAULT_METRICS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstSceneChange:n-threads:
+   *
+   * Maximum number of threads used to analyse a frame, each one handling a
+   * band of rows. 0 uses one per processor.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_N_THREADS,
+      g_param_spec_uint ("n-threads", "Threads",
+          "Maximum number of threads analysing a frame (0 = auto)",
+          0, G_MAXINT, DEFAULT_N_THREADS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_type_mark_as_plugin_api (GST_TYPE_SCENE_CHANGE_METRICS, 0);
 }
 
 static void
 gst_scene_change_init (GstSceneChange * scenechange)
 {
+  scenechange->decimation = DEFAULT_DECIMATION;
+  scenechange->metrics = DEFAULT_METRICS;
+  scenechange->n_threads = DEFAULT_N_THREADS;
+
+  scenechange->slices = g_array_new (FALSE, FALSE,
+      sizeof (GstSceneChangeSlice));
+}
+
+static void
+gst_scene_change_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (object);
+
+  GST_DEBUG_OBJECT (scenechange, "set_property");
+
+  GST_OBJECT_LOCK (scenechange);
+  switch (property_id) {
+    case PROP_DECIMATION:
+      scenechange->decimation = g_value_get_uint (value);
+      break;
+    case PROP_METRICS:
+      scenechange->metrics = g_value_get_flags (value);
+      break;
+    case PROP_N_THREADS:
+      scenechange->n_threads = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (scenechange);
 }
 
+static void
+gst_scene_change_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (object);
+
+  GST_DEBUG_OBJECT (scenechange, "get_property");
+
+  GST_OBJECT_LOCK (scenechange);
+  switch (property_id) {
+    case PROP_DECIMATION:
+      g_value_set_uint (value, scenechange->decimation);
+      break;
+    case PROP_METRICS:
+      g_value_set_flags (value, scenechange->metrics);
+      break;
+    case PROP_N_THREADS:
+      g_value_set_uint (value, scenechange->n_threads);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (scenechange);
+}
+
+static void
+gst_scene_change_reset (GstSceneChange * scenechange)
+{
+  gint i;
+
+  for (i = 0; i < 2; i++) {
+    g_free (scenechange->planes[i]);
+    scenechange->planes[i] = NULL;
+    g_free (scenechange->edges[i]);
+    scenechange->edges[i] = NULL;
+  }
+  scenechange->step = 0;
+  scenechange->width = 0;
+  scenechange->height = 0;
+  scenechange->prev_metrics = 0;
+  scenechange->n_diffs = 0;
+  memset (scenechange->diffs, 0, sizeof (double) * SC_N_DIFFS);
+}
+
+static void
+gst_scene_change_finalize (GObject * object)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (object);
 
+  gst_scene_change_reset (scenechange);
+
+  if (scenechange->pool) {
+    gst_task_pool_cleanup (scenechange->pool);
+    gst_object_unref (scenechange->pool);
+  }
+  g_array_free (scenechange->slices, TRUE);
+
+  G_OBJECT_CLASS (gst_scene_change_parent_class)->finalize (object);
+}
+
+static gboolean
+gst_scene_change_stop (GstBaseTransform * trans)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (trans);
+
+  GST_DEBUG_OBJECT (scenechange, "stop");
+
+  gst_scene_change_reset (scenechange);
+
+  return TRUE;
+}
+
+static gboolean
+gst_scene_change_set_info (GstVideoFilter * filter, GstCaps * incaps,
+    GstVideoInfo * in_info, GstCaps * outcaps, GstVideoInfo * out_info)
+{
+  GstSceneChange *scenechange = GST_SCENE_CHANGE (filter);
+
+  /* frames of different sizes can't be compared, start over */
+  gst_scene_change_reset (scenechange);
+
+  return TRUE;
+}
+
+/* (Re)allocates the decimated planes if the decimation or the frame size
+ * changed, which also drops the history */
+static void
+gst_scene_change_configure (GstSceneChange * scenechange,
+    GstVideoFrame * frame, guint decimation)
+{
+  gint frame_width = GST_VIDEO_FRAME_WIDTH (frame);
+  gint frame_height = GST_VIDEO_FRAME_HEIGHT (frame);
+  gint step, width, height, i;
+
+  if (decimation == 0)
+    step = MAX (1, (frame_width + SC_ANALYSIS_WIDTH - 1) / SC_ANALYSIS_WIDTH);
+  else
+    step = decimation;
+  width = (frame_width + step - 1) / step;
+  height = (frame_height + step - 1) / step;
+
+  if (step == scenechange->step && width == scenechange->width
+      && height == scenechange->height)
+    return;
+
+  gst_scene_change_reset (scenechange);
+
+  GST_DEBUG_OBJECT (scenechange, "analysing %dx%d luma, decimation %d",
+      width, height, step);
+
+  scenechange->step = step;
+  scenechange->width = width;
+  scenechange->height = height;
+  for (i = 0; i < 2; i++) {
+    scenechange->planes[i] = g_malloc (width * height);
+    scenechange->edges[i] = g_malloc (width * height);
+  }
+  scenechange->cur = 0;
+}
+
+static void
+gst_scene_change_slice_decimate (GstSceneChangeSlice * slice)
+{
+  GstSceneChange *scenechange = slice->scenechange;
+  const guint8 *data = GST_VIDEO_FRAME_PLANE_DATA (slice->frame, 0);
+  gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (slice->frame, 0);
+  gint step = scenechange->step;
+  gint width = scenechange->width;
+  guint8 *dest;
+  gint x, y;
+
+  dest = scenechange->planes[scenechange->cur] + slice->y_start * width;
+  for (y = slice->y_start; y < slice->y_end; y++, dest += width) {
+    const guint8 *src = data + y * step * stride;
+
+    if (step == 1) {
+      memcpy (dest, src, width);
+    } else {
+      for (x = 0; x < width; x++)
+        dest[x] = src[x * step];
+    }
+  }
+}
+
+static void
+gst_scene_change_slice_analyse (GstSceneChangeSlice * slice)
+{
+  GstSceneChange *scenechange = slice->scenechange;
+  gint width = scenechange->width;
+  gint height = scenechange->height;
+  const guint8 *cur = scenechange->planes[scenechange->cur];
+  const guint8 *prev = scenechange->planes[!scenechange->cur];
+  guint8 *edges = scenechange->edges[scenechange->cur];
+  const guint8 *prev_edges = scenechange->edges[!scenechange->cur];
+  gint x, y, i;
+
+  slice->sad = 0;
+  memset (slice->histogram, 0, sizeof (slice->histogram));
+  slice->edges_changed = 0;
+  slice->edges_total = 0;
+
+  if (slice->compare & GST_SCENE_CHANGE_METRIC_SAD) {
+    orc_sad_nxm_u8 (&slice->sad, cur + slice->y_start * width, width,
+        prev + slice->y_start * width, width, width,
+        slice->y_end - slice->y_start);
+  }
+
+  if (slice->metrics & GST_SCENE_CHANGE_METRIC_HISTOGRAM) {
+    for (i = slice->y_start * width; i < slice->y_end * width; i++)
+      slice->histogram[cur[i] >> 2]++;
+  }
+
+  if (slice->metrics & GST_SCENE_CHANGE_METRIC_EDGES) {
+    for (y = slice->y_start; y < slice->y_end; y++) {
+      for (x = 0; x < width; x++) {
+        gint g = 0;
+
+        i = y * width + x;
+        /* the next row always belongs to a fully decimated plane */
+        if (x + 1 < width && y + 1 < height)
+          g = ABS (cur[i + 1] - cur[i]) + ABS (cur[i + width] - cur[i]);
+        edges[i] = g > SC_EDGE_THRESHOLD;
+
+        if (slice->compare & GST_SCENE_CHANGE_METRIC_EDGES) {
+          if (edges[i] != prev_edges[i])
+            slice->edges_changed++;
+          if (edges[i] || prev_edges[i])
+            slice->edges_total++;
+        }
+      }
+    }
+  }
+}
+
+static void
+gst_scene_change_slice_func (gpointer data)
+{
+  GstSceneChangeSlice *slice = data;
+
+  slice->func (slice);
+}
+
+static void
+gst_scene_change_run_slices (GstSceneChange * scenechange,
+    void (*func) (GstSceneChangeSlice * slice))
+{
+  GstSceneChangeSlice *slice;
+  guint n_slices = scenechange->slices->len;
+  guint i;
+
+  for (i = 0; i < n_slices; i++) {
+    slice = &g_array_index (scenechange->slices, GstSceneChangeSlice, i);
+    slice->func = func;
+    slice->task = NULL;
+  }
+
+  if (n_slices > 1) {
+    if (!scenechange->pool) {
+      scenechange->pool = gst_shared_task_pool_new ();
+      gst_task_pool_prepare (scenechange->pool, NULL);
+    }
+    /* the streaming thread handles the first slice itself */
+    gst_shared_task_pool_set_max_threads (GST_SHARED_TASK_POOL
+        (scenechange->pool), n_slices - 1);
+
+    for (i = 1; i < n_slices; i++) {
+      slice = &g_array_index (scenechange->slices, GstSceneChangeSlice, i);
+      slice->task = gst_task_pool_push (scenechange->pool,
+          gst_scene_change_slice_func, slice, NULL);
+    }
+  }
+
+  for (i = 0; i < n_slices; i++) {
+    slice = &g_array_index (scenechange->slices, GstSceneChangeSlice, i);
+    if (slice->task)
+      gst_task_pool_join (scenechange->pool, slice->task);
+    else
+      func (slice);
+  }
+}
+
+/* Analyses @frame and returns its difference with the previous frame, or a
+ * negative value if there is nothing to compare it with yet */
 static double
-get_frame_score (GstVideoFrame * f1, GstVideoFrame * f2)
+get_frame_score (GstSceneChange * scenechange, GstVideoFrame * frame,
+    guint metrics, guint n_threads)
 {
-  guint32 score = 0;
-  int width, height;
+  GstSceneChangeSlice *slice;
+  guint32 *histogram, *prev_histogram;
+  guint64 sad = 0;
+  guint64 edges_changed = 0;
+  guint64 edges_total = 0;
+  guint64 n_pixels;
+  guint analysed, scored, n_slices, n_metrics = 0;
+  double score = 0;
+  guint i, j;
+
+  /* the decimated luma is always kept, it is what SAD needs */
+  analysed = metrics | GST_SCENE_CHANGE_METRIC_SAD;
+  /* only compare with what was also measured on the previous frame */
+  scored = metrics & scenechange->prev_metrics;
+
+  histogram = scenechange->histograms[scenechange->cur];
+  prev_histogram = scenechange->histograms[!scenechange->cur];
+  memset (histogram, 0, sizeof (guint32) * SC_HISTOGRAM_BINS);
+
+  /* not worth waking up a thread for less than 32 rows */
+  n_slices = CLAMP (scenechange->height / 32, 1, n_threads);
+  g_array_set_size (scenechange->slices, n_slices);
+  for (i = 0; i < n_slices; i++) {
+    slice = &g_array_index (scenechange->slices, GstSceneChangeSlice, i);
+    slice->scenechange = scenechange;
+    slice->frame = frame;
+    slice->y_start = scenechange->height * i / n_slices;
+    slice->y_end = scenechange->height * (i + 1) / n_slices;
+    slice->metrics = analysed;
+    slice->compare = scored;
+  }
+
+  /* edges look at the next row, so the whole plane has to be decimated
+   * before analysing any band */
+  gst_scene_change_run_slices (scenechange, gst_scene_change_slice_decimate);
+  gst_scene_change_run_slices (scenechange, gst_scene_change_slice_analyse);
+
+  for (i = 0; i < n_slices; i++) {
+    slice = &g_array_index (scenechange->slices, GstSceneChangeSlice, i);
+    sad += slice->sad;
+    for (j = 0; j < SC_HISTOGRAM_BINS; j++)
+      histogram[j] += slice->histogram[j];
+    edges_changed += slice->edges_changed;
+    edges_total += slice->edges_total;
+  }
+
+  scenechange->prev_metrics = analysed;
+  scenechange->cur = !scenechange->cur;
+
+  if (!scored)
+    return -1;
+
+  n_pixels = (guint64) scenechange->width * scenechange->height;
+
+  if (scored & GST_SCENE_CHANGE_METRIC_SAD) {
+    score += ((double) sad) / n_pixels;
+    n_metrics++;
+  }
 
-  width = f1->info.width;
-  height = f1->info.height;
+  if (scored & GST_SCENE_CHANGE_METRIC_HISTOGRAM) {
+    guint64 diff = 0;
 
-  orc_sad_nxm_u8 (&score, f1->data[0], f1->info.stride[0],
-      f2->data[0], f2->info.stride[0], width, height);
+    /* the L1 distance of two histograms is at most twice the pixel count */
+    for (j = 0; j < SC_HISTOGRAM_BINS; j++)
+      diff += ABS ((gint64) histogram[j] - (gint64) prev_histogram[j]);
+    score += 255.0 * diff / (2 * n_pixels);
+    n_metrics++;
+  }
+
+  if (scored & GST_SCENE_CHANGE_METRIC_EDGES) {
+    if (edges_total > 0)
+      score += 255.0 * edges_changed / edges_total;
+    n_metrics++;
+  }
 
-  return ((double) score) / (width * height);
+  return score / n_metrics;
 }
 
 static GstFlowReturn
@@ -161,41 +624,36 @@ gst_scene_change_transform_frame_ip (GstVideoFilter * filter,
     GstVideoFrame * frame)
 {
   GstSceneChange *scenechange = GST_SCENE_CHANGE (filter);
-  GstVideoFrame oldframe;
   double score_min;
   double score_max;
   double threshold;
   double score;
   gboolean change;
-  gboolean ret;
+  guint decimation, metrics, n_threads;
   int i;
 
   GST_DEBUG_OBJECT (scenechange, "transform_frame_ip");
 
-  if (!scenechange->oldbuf) {
+  GST_OBJECT_LOCK (scenechange);
+  decimation = scenechange->decimation;
+  metrics = scenechange->metrics;
+  n_threads = scenechange->n_threads;
+  GST_OBJECT_UNLOCK (scenechange);
+
+  if (metrics == 0)
+    metrics = DEFAULT_METRICS;
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  gst_scene_change_configure (scenechange, frame, decimation);
+
+  score = get_frame_score (scenechange, frame, metrics, n_threads);
+  if (score < 0) {
     scenechange->n_diffs = 0;
     memset (scenechange->diffs, 0, sizeof (double) * SC_N_DIFFS);
-    scenechange->oldbuf = gst_buffer_ref (frame->buffer);
-    memcpy (&scenechange->oldinfo, &frame->info, sizeof (GstVideoInfo));
     return GST_FLOW_OK;
   }
 
-  ret =
-      gst_video_frame_map (&oldframe, &scenechange->oldinfo,
-      scenechange->oldbuf, GST_MAP_READ);
-  if (!ret) {
-    GST_ERROR_OBJECT (scenechange, "failed to map old video frame");
-    return GST_FLOW_ERROR;
-  }
-
-  score = get_frame_score (&oldframe, frame);
-
-  gst_video_frame_unmap (&oldframe);
-
-  gst_buffer_unref (scenechange->oldbuf);
-  scenechange->oldbuf = gst_buffer_ref (frame->buffer);
-  memcpy (&scenechange->oldinfo, &frame->info, sizeof (GstVideoInfo));
-
   memmove (scenechange->diffs, scenechange->diffs + 1,
       sizeof (double) * (SC_N_DIFFS - 1));
   scenechange->diffs[SC_N_DIFFS - 1] = score;
@@ -241,15 +699,35 @@ gst_scene_change_transform_frame_ip (GstVideoFilter * filter,
 #endif
 
   if (change) {
+    GstBaseTransform *trans = GST_BASE_TRANSFORM (scenechange);
+    GstClockTime timestamp = GST_BUFFER_PTS (frame->buffer);
+    GstClockTime running_time, stream_time;
+    GstStructure *s;
     GstEvent *event;
 
     GST_INFO_OBJECT (scenechange, "%d %g %g %g %d",
         scenechange->n_diffs, score / threshold, score, threshold, change);
 
+    running_time = gst_segment_to_running_time (&trans->segment,
+        GST_FORMAT_TIME, timestamp);
+    stream_time = gst_segment_to_stream_time (&trans->segment,
+        GST_FORMAT_TIME, timestamp);
+
+    s = gst_structure_new ("scene-change",
+        "timestamp", G_TYPE_UINT64, timestamp,
+        "running-time", G_TYPE_UINT64, running_time,
+        "stream-time", G_TYPE_UINT64, stream_time,
+        "score", G_TYPE_DOUBLE, score,
+        "threshold", G_TYPE_DOUBLE, threshold, NULL);
+    gst_element_post_message (GST_ELEMENT (scenechange),
+        gst_message_new_element (GST_OBJECT (scenechange), s));
+
     event =
-        gst_video_event_new_downstream_force_key_unit (GST_BUFFER_PTS
-        (frame->buffer), GST_CLOCK_TIME_NONE, GST_CLOCK_TIME_NONE, FALSE,
-        scenechange->count++);
+        gst_video_event_new_downstream_force_key_unit (timestamp,
+        stream_time, running_time, FALSE, scenechange->count++);
+    /* lets downstream tell cuts from other key unit requests */
+    gst_structure_set (gst_event_writable_structure (event),
+        "scene-change-score", G_TYPE_DOUBLE, score, NULL);
 
     gst_pad_push_event (GST_BASE_TRANSFORM_SRC_PAD (scenechange), event);
   }
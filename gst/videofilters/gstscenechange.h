@@ -34,7 +34,14 @@ G_BEGIN_DECLS
 typedef struct _GstSceneChange GstSceneChange;
 typedef struct _GstSceneChangeClass GstSceneChangeClass;
 
+typedef enum {
+  GST_SCENE_CHANGE_METRIC_SAD = (1 << 0),
+  GST_SCENE_CHANGE_METRIC_HISTOGRAM = (1 << 1),
+  GST_SCENE_CHANGE_METRIC_EDGES = (1 << 2)
+} GstSceneChangeMetrics;
+
 #define SC_N_DIFFS 5
+#define SC_HISTOGRAM_BINS 64
 
 struct _GstSceneChange
 {
@@ -42,9 +49,26 @@ struct _GstSceneChange
 
   int n_diffs;
   double diffs[SC_N_DIFFS];
-  GstBuffer *oldbuf;
-  GstVideoInfo oldinfo;
   int count;
+
+  /* properties */
+  guint decimation;
+  guint metrics;
+  guint n_threads;
+
+  /* decimated luma of the current and the previous frames, and what was
+   * measured on them */
+  gint step;
+  gint width;
+  gint height;
+  guint8 *planes[2];
+  guint8 *edges[2];
+  guint32 histograms[2][SC_HISTOGRAM_BINS];
+  guint prev_metrics;
+  gint cur;
+
+  GstTaskPool *pool;
+  GArray *slices;
 };
 
 struct _GstSceneChangeClass
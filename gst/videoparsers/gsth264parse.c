@@ -498,6 +498,40 @@ gst_h264_parse_wrap_nal (GstH264Parse * h264parse, guint format, guint8 * data,
   return buf;
 }
 
+static const guint8 nal_start_code[4] = { 0x00, 0x00, 0x00, 0x01 };
+
+/* as gst_h264_parse_wrap_nal(), but the payload is a region of @src that
+ * shares its memory, so only the prefix is newly allocated (if at all) */
+static GstBuffer *
+gst_h264_parse_wrap_nal_shared (GstH264Parse * h264parse, guint format,
+    GstBuffer * src, gsize offset, guint size)
+{
+  GstBuffer *buf;
+  GstBuffer *payload;
+  guint nl = h264parse->nal_length_size;
+  guint32 tmp;
+
+  GST_DEBUG_OBJECT (h264parse, "nal length %d (shared)", size);
+
+  if (format == GST_H264_PARSE_FORMAT_AVC
+      || format == GST_H264_PARSE_FORMAT_AVC3) {
+    tmp = GUINT32_TO_BE (size << (32 - 8 * nl));
+    buf = gst_buffer_new_allocate (NULL, nl, NULL);
+    gst_buffer_fill (buf, 0, &tmp, nl);
+  } else {
+    /* start code is constant, wrap it rather than allocating */
+    buf = gst_buffer_new ();
+    gst_buffer_append_memory (buf,
+        gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+            (guint8 *) nal_start_code, sizeof (nal_start_code), 0,
+            sizeof (nal_start_code), NULL, NULL));
+  }
+
+  payload = gst_buffer_copy_region (src, GST_BUFFER_COPY_MEMORY, offset, size);
+
+  return gst_buffer_append (buf, payload);
+}
+
 static void
 gst_h264_parser_store_nal (GstH264Parse * h264parse, guint id,
     GstH264NalUnitType naltype, GstH264NalUnit * nalu)
@@ -1144,8 +1178,14 @@ gst_h264_parse_process_nal (GstH264Parse * h264parse, GstH264NalUnit * nalu)
     GstBuffer *buf;
 
     GST_LOG_OBJECT (h264parse, "collecting NAL in AVC frame");
-    buf = gst_h264_parse_wrap_nal (h264parse, h264parse->format,
-        nalu->data + nalu->offset, nalu->size);
+    if (h264parse->nal_src) {
+      buf = gst_h264_parse_wrap_nal_shared (h264parse, h264parse->format,
+          h264parse->nal_src,
+          nalu->data - h264parse->nal_src_data + nalu->offset, nalu->size);
+    } else {
+      buf = gst_h264_parse_wrap_nal (h264parse, h264parse->format,
+          nalu->data + nalu->offset, nalu->size);
+    }
     gst_adapter_push (h264parse->frame_out, buf);
   }
   return TRUE;
@@ -1235,7 +1275,10 @@ gst_h264_parse_handle_frame_packetized (GstBaseParse * parse,
     GST_DEBUG_OBJECT (h264parse, "AVC nal offset %d", nalu.offset + nalu.size);
 
     /* either way, have a look at it */
+    h264parse->nal_src = buffer;
+    h264parse->nal_src_data = map.data;
     gst_h264_parse_process_nal (h264parse, &nalu);
+    h264parse->nal_src = NULL;
 
     /* dispatch per NALU if needed */
     if (h264parse->split_packetized) {
@@ -1310,7 +1353,7 @@ gst_h264_parse_handle_frame (GstBaseParse * parse,
   guint8 *data;
   gsize size;
   gint current_off = 0;
-  gboolean drain, nonext;
+  gboolean drain, nonext, processed;
   GstH264NalParser *nalparser = h264parse->nalparser;
   GstH264NalUnit nalu;
   GstH264ParserResult pres;
@@ -1486,7 +1529,13 @@ gst_h264_parse_handle_frame (GstBaseParse * parse,
       }
     }
 
-    if (!gst_h264_parse_process_nal (h264parse, &nalu)) {
+    /* the frame_out adapter may share memory with the input buffer */
+    h264parse->nal_src = buffer;
+    h264parse->nal_src_data = map.data;
+    processed = gst_h264_parse_process_nal (h264parse, &nalu);
+    h264parse->nal_src = NULL;
+
+    if (!processed) {
       GST_WARNING_OBJECT (h264parse,
           "broken/invalid nal Type: %d %s, Size: %u will be dropped",
           nalu.type, _nal_name (nalu.type), nalu.size);
@@ -2679,7 +2728,9 @@ gst_h264_parse_parse_frame (GstBaseParse * parse, GstBaseParseFrame * frame)
   if (av) {
     GstBuffer *buf;
 
-    buf = gst_adapter_take_buffer (h264parse->frame_out, av);
+    /* keep the collected prefix and payload memories as they are, they
+     * only get merged if there are more than a buffer can hold */
+    buf = gst_adapter_take_buffer_fast (h264parse->frame_out, av);
     gst_buffer_copy_into (buf, buffer, GST_BUFFER_COPY_METADATA, 0, -1);
     gst_buffer_replace (&frame->out_buffer, buf);
     gst_buffer_unref (buf);
@@ -2701,13 +2752,10 @@ static GstFlowReturn
 gst_h264_parse_push_codec_buffer (GstH264Parse * h264parse,
     GstBuffer * nal, GstBuffer * buffer)
 {
-  GstMapInfo map;
   GstBuffer *wrapped_nal;
 
-  gst_buffer_map (nal, &map, GST_MAP_READ);
-  wrapped_nal = gst_h264_parse_wrap_nal (h264parse, h264parse->format,
-      map.data, map.size);
-  gst_buffer_unmap (nal, &map);
+  wrapped_nal = gst_h264_parse_wrap_nal_shared (h264parse, h264parse->format,
+      nal, 0, gst_buffer_get_size (nal));
 
   GST_BUFFER_PTS (wrapped_nal) = GST_BUFFER_PTS (buffer);
   GST_BUFFER_DTS (wrapped_nal) = GST_BUFFER_DTS (buffer);
@@ -2842,60 +2890,44 @@ gst_h264_parse_handle_sps_pps_nals (GstH264Parse * h264parse,
       }
     }
   } else {
-    /* insert config NALs into AU */
-    GstByteWriter bw;
+    /* insert config NALs into AU, sharing the memory of the AU around the
+     * insertion point rather than copying it */
     GstBuffer *new_buf;
-    const gboolean bs = h264parse->format == GST_H264_PARSE_FORMAT_BYTE;
-    const gint nls = 4 - h264parse->nal_length_size;
-    gboolean ok;
 
-    gst_byte_writer_init_with_size (&bw, gst_buffer_get_size (buffer), FALSE);
-    ok = gst_byte_writer_put_buffer (&bw, buffer, 0, h264parse->idr_pos);
+    new_buf = gst_buffer_new ();
+    gst_buffer_copy_into (new_buf, buffer, GST_BUFFER_COPY_METADATA, 0, -1);
+    if (h264parse->idr_pos > 0) {
+      gst_buffer_copy_into (new_buf, buffer, GST_BUFFER_COPY_MEMORY, 0,
+          h264parse->idr_pos);
+    }
     GST_DEBUG_OBJECT (h264parse, "- inserting SPS/PPS");
     for (i = 0; i < GST_H264_MAX_SPS_COUNT; i++) {
       if ((codec_nal = h264parse->sps_nals[i])) {
-        gsize nal_size = gst_buffer_get_size (codec_nal);
         GST_DEBUG_OBJECT (h264parse, "inserting SPS nal");
-        if (bs) {
-          ok &= gst_byte_writer_put_uint32_be (&bw, 1);
-        } else {
-          ok &= gst_byte_writer_put_uint32_be (&bw, (nal_size << (nls * 8)));
-          ok &= gst_byte_writer_set_pos (&bw,
-              gst_byte_writer_get_pos (&bw) - nls);
-        }
-
-        ok &= gst_byte_writer_put_buffer (&bw, codec_nal, 0, nal_size);
+        new_buf = gst_buffer_append (new_buf,
+            gst_h264_parse_wrap_nal_shared (h264parse, h264parse->format,
+                codec_nal, 0, gst_buffer_get_size (codec_nal)));
         send_done = TRUE;
       }
     }
     for (i = 0; i < GST_H264_MAX_PPS_COUNT; i++) {
       if ((codec_nal = h264parse->pps_nals[i])) {
-        gsize nal_size = gst_buffer_get_size (codec_nal);
         GST_DEBUG_OBJECT (h264parse, "inserting PPS nal");
-        if (bs) {
-          ok &= gst_byte_writer_put_uint32_be (&bw, 1);
-        } else {
-          ok &= gst_byte_writer_put_uint32_be (&bw, (nal_size << (nls * 8)));
-          ok &= gst_byte_writer_set_pos (&bw,
-              gst_byte_writer_get_pos (&bw) - nls);
-        }
-        ok &= gst_byte_writer_put_buffer (&bw, codec_nal, 0, nal_size);
+        new_buf = gst_buffer_append (new_buf,
+            gst_h264_parse_wrap_nal_shared (h264parse, h264parse->format,
+                codec_nal, 0, gst_buffer_get_size (codec_nal)));
         send_done = TRUE;
       }
     }
-    ok &= gst_byte_writer_put_buffer (&bw, buffer, h264parse->idr_pos, -1);
-    /* collect result and push */
-    new_buf = gst_byte_writer_reset_and_get_buffer (&bw);
-    gst_buffer_copy_into (new_buf, buffer, GST_BUFFER_COPY_METADATA, 0, -1);
+    if (gst_buffer_get_size (buffer) > h264parse->idr_pos) {
+      gst_buffer_copy_into (new_buf, buffer, GST_BUFFER_COPY_MEMORY,
+          h264parse->idr_pos, -1);
+    }
     /* should already be keyframe/IDR, but it may not have been,
      * so mark it as such to avoid being discarded by picky decoder */
     GST_BUFFER_FLAG_UNSET (new_buf, GST_BUFFER_FLAG_DELTA_UNIT);
     gst_buffer_replace (&frame->out_buffer, new_buf);
     gst_buffer_unref (new_buf);
-    /* some result checking seems to make some compilers happy */
-    if (G_UNLIKELY (!ok)) {
-      GST_ERROR_OBJECT (h264parse, "failed to insert SPS/PPS");
-    }
   }
 
   return send_done;
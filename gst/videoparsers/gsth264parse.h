@@ -126,6 +126,10 @@ struct _GstH264Parse
   gint pic_timing_sei_size;
   gboolean update_caps;
   GstAdapter *frame_out;
+  /* buffer (and its mapping) the NALs being processed come from, if any,
+   * so frame_out can share its memory rather than copy the payload */
+  GstBuffer *nal_src;
+  const guint8 *nal_src_data;
   gboolean keyframe;
   gboolean predicted;
   gboolean bidirectional;
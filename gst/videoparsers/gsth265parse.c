@@ -446,6 +446,40 @@ gst_h265_parse_wrap_nal (GstH265Parse * h265parse, guint format, guint8 * data,
   return buf;
 }
 
+static const guint8 nal_start_code[4] = { 0x00, 0x00, 0x00, 0x01 };
+
+/* as gst_h265_parse_wrap_nal(), but the payload is a region of @src that
+ * shares its memory, so only the prefix is newly allocated (if at all) */
+static GstBuffer *
+gst_h265_parse_wrap_nal_shared (GstH265Parse * h265parse, guint format,
+    GstBuffer * src, gsize offset, guint size)
+{
+  GstBuffer *buf;
+  GstBuffer *payload;
+  guint nl = h265parse->nal_length_size;
+  guint32 tmp;
+
+  GST_DEBUG_OBJECT (h265parse, "nal length %d (shared)", size);
+
+  if (format == GST_H265_PARSE_FORMAT_HVC1
+      || format == GST_H265_PARSE_FORMAT_HEV1) {
+    tmp = GUINT32_TO_BE (size << (32 - 8 * nl));
+    buf = gst_buffer_new_allocate (NULL, nl, NULL);
+    gst_buffer_fill (buf, 0, &tmp, nl);
+  } else {
+    /* start code is constant, wrap it rather than allocating */
+    buf = gst_buffer_new ();
+    gst_buffer_append_memory (buf,
+        gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+            (guint8 *) nal_start_code, sizeof (nal_start_code), 0,
+            sizeof (nal_start_code), NULL, NULL));
+  }
+
+  payload = gst_buffer_copy_region (src, GST_BUFFER_COPY_MEMORY, offset, size);
+
+  return gst_buffer_append (buf, payload);
+}
+
 static void
 gst_h265_parser_store_nal (GstH265Parse * h265parse, guint id,
     GstH265NalUnitType naltype, GstH265NalUnit * nalu)
@@ -978,8 +1012,14 @@ gst_h265_parse_process_nal (GstH265Parse * h265parse, GstH265NalUnit * nalu)
     GstBuffer *buf;
 
     GST_LOG_OBJECT (h265parse, "collecting NAL in HEVC frame");
-    buf = gst_h265_parse_wrap_nal (h265parse, h265parse->format,
-        nalu->data + nalu->offset, nalu->size);
+    if (h265parse->nal_src) {
+      buf = gst_h265_parse_wrap_nal_shared (h265parse, h265parse->format,
+          h265parse->nal_src,
+          nalu->data - h265parse->nal_src_data + nalu->offset, nalu->size);
+    } else {
+      buf = gst_h265_parse_wrap_nal (h265parse, h265parse->format,
+          nalu->data + nalu->offset, nalu->size);
+    }
     gst_adapter_push (h265parse->frame_out, buf);
   }
 
@@ -1059,7 +1099,10 @@ gst_h265_parse_handle_frame_packetized (GstBaseParse * parse,
     GST_DEBUG_OBJECT (h265parse, "HEVC nal offset %d", nalu.offset + nalu.size);
 
     /* either way, have a look at it */
+    h265parse->nal_src = buffer;
+    h265parse->nal_src_data = map.data;
     gst_h265_parse_process_nal (h265parse, &nalu);
+    h265parse->nal_src = NULL;
 
     /* dispatch per NALU if needed */
     if (h265parse->split_packetized) {
@@ -1134,7 +1177,7 @@ gst_h265_parse_handle_frame (GstBaseParse * parse,
   guint8 *data;
   gsize size;
   gint current_off = 0;
-  gboolean drain, nonext;
+  gboolean drain, nonext, processed;
   GstH265Parser *nalparser = h265parse->nalparser;
   GstH265NalUnit nalu;
   GstH265ParserResult pres;
@@ -1307,7 +1350,13 @@ gst_h265_parse_handle_frame (GstBaseParse * parse,
       }
     }
 
-    if (!gst_h265_parse_process_nal (h265parse, &nalu)) {
+    /* the frame_out adapter may share memory with the input buffer */
+    h265parse->nal_src = buffer;
+    h265parse->nal_src_data = map.data;
+    processed = gst_h265_parse_process_nal (h265parse, &nalu);
+    h265parse->nal_src = NULL;
+
+    if (!processed) {
       GST_WARNING_OBJECT (h265parse,
           "broken/invalid nal Type: %d %s, Size: %u will be dropped",
           nalu.type, _nal_name (nalu.type), nalu.size);
@@ -2414,7 +2463,9 @@ gst_h265_parse_parse_frame (GstBaseParse * parse, GstBaseParseFrame * frame)
   if (av) {
     GstBuffer *buf;
 
-    buf = gst_adapter_take_buffer (h265parse->frame_out, av);
+    /* keep the collected prefix and payload memories as they are, they
+     * only get merged if there are more than a buffer can hold */
+    buf = gst_adapter_take_buffer_fast (h265parse->frame_out, av);
     gst_buffer_copy_into (buf, buffer, GST_BUFFER_COPY_METADATA, 0, -1);
     gst_buffer_replace (&frame->out_buffer, buf);
     gst_buffer_unref (buf);
@@ -2437,12 +2488,8 @@ static GstFlowReturn
 gst_h265_parse_push_codec_buffer (GstH265Parse * h265parse, GstBuffer * nal,
     GstBuffer * buffer)
 {
-  GstMapInfo map;
-
-  gst_buffer_map (nal, &map, GST_MAP_READ);
-  nal = gst_h265_parse_wrap_nal (h265parse, h265parse->format,
-      map.data, map.size);
-  gst_buffer_unmap (nal, &map);
+  nal = gst_h265_parse_wrap_nal_shared (h265parse, h265parse->format,
+      nal, 0, gst_buffer_get_size (nal));
 
   if (h265parse->discont) {
     GST_BUFFER_FLAG_SET (nal, GST_BUFFER_FLAG_DISCONT);
@@ -2596,76 +2643,53 @@ gst_h265_parse_handle_vps_sps_pps_nals (GstH265Parse * h265parse,
       }
     }
   } else {
-    /* insert config NALs into AU */
-    GstByteWriter bw;
+    /* insert config NALs into AU, sharing the memory of the AU around the
+     * insertion point rather than copying it */
     GstBuffer *new_buf;
-    const gboolean bs = h265parse->format == GST_H265_PARSE_FORMAT_BYTE;
-    const gint nls = 4 - h265parse->nal_length_size;
-    gboolean ok;
 
-    gst_byte_writer_init_with_size (&bw, gst_buffer_get_size (buffer), FALSE);
-    ok = gst_byte_writer_put_buffer (&bw, buffer, 0, h265parse->idr_pos);
+    new_buf = gst_buffer_new ();
+    gst_buffer_copy_into (new_buf, buffer, GST_BUFFER_COPY_METADATA, 0, -1);
+    if (h265parse->idr_pos > 0) {
+      gst_buffer_copy_into (new_buf, buffer, GST_BUFFER_COPY_MEMORY, 0,
+          h265parse->idr_pos);
+    }
     GST_DEBUG_OBJECT (h265parse, "- inserting VPS/SPS/PPS");
     for (i = 0; i < GST_H265_MAX_VPS_COUNT; i++) {
       if ((codec_nal = h265parse->vps_nals[i])) {
-        gsize nal_size = gst_buffer_get_size (codec_nal);
         GST_DEBUG_OBJECT (h265parse, "inserting VPS nal");
-        if (bs) {
-          ok &= gst_byte_writer_put_uint32_be (&bw, 1);
-        } else {
-          ok &= gst_byte_writer_put_uint32_be (&bw, (nal_size << (nls * 8)));
-          ok &= gst_byte_writer_set_pos (&bw,
-              gst_byte_writer_get_pos (&bw) - nls);
-        }
-
-        ok &= gst_byte_writer_put_buffer (&bw, codec_nal, 0, nal_size);
+        new_buf = gst_buffer_append (new_buf,
+            gst_h265_parse_wrap_nal_shared (h265parse, h265parse->format,
+                codec_nal, 0, gst_buffer_get_size (codec_nal)));
         send_done = TRUE;
       }
     }
     for (i = 0; i < GST_H265_MAX_SPS_COUNT; i++) {
       if ((codec_nal = h265parse->sps_nals[i])) {
-        gsize nal_size = gst_buffer_get_size (codec_nal);
         GST_DEBUG_OBJECT (h265parse, "inserting SPS nal");
-        if (bs) {
-          ok &= gst_byte_writer_put_uint32_be (&bw, 1);
-        } else {
-          ok &= gst_byte_writer_put_uint32_be (&bw, (nal_size << (nls * 8)));
-          ok &= gst_byte_writer_set_pos (&bw,
-              gst_byte_writer_get_pos (&bw) - nls);
-        }
-
-        ok &= gst_byte_writer_put_buffer (&bw, codec_nal, 0, nal_size);
+        new_buf = gst_buffer_append (new_buf,
+            gst_h265_parse_wrap_nal_shared (h265parse, h265parse->format,
+                codec_nal, 0, gst_buffer_get_size (codec_nal)));
         send_done = TRUE;
       }
     }
     for (i = 0; i < GST_H265_MAX_PPS_COUNT; i++) {
       if ((codec_nal = h265parse->pps_nals[i])) {
-        gsize nal_size = gst_buffer_get_size (codec_nal);
         GST_DEBUG_OBJECT (h265parse, "inserting PPS nal");
-        if (bs) {
-          ok &= gst_byte_writer_put_uint32_be (&bw, 1);
-        } else {
-          ok &= gst_byte_writer_put_uint32_be (&bw, (nal_size << (nls * 8)));
-          ok &= gst_byte_writer_set_pos (&bw,
-              gst_byte_writer_get_pos (&bw) - nls);
-        }
-        ok &= gst_byte_writer_put_buffer (&bw, codec_nal, 0, nal_size);
+        new_buf = gst_buffer_append (new_buf,
+            gst_h265_parse_wrap_nal_shared (h265parse, h265parse->format,
+                codec_nal, 0, gst_buffer_get_size (codec_nal)));
         send_done = TRUE;
       }
     }
-    ok &= gst_byte_writer_put_buffer (&bw, buffer, h265parse->idr_pos, -1);
-    /* collect result and push */
-    new_buf = gst_byte_writer_reset_and_get_buffer (&bw);
-    gst_buffer_copy_into (new_buf, buffer, GST_BUFFER_COPY_METADATA, 0, -1);
+    if (gst_buffer_get_size (buffer) > h265parse->idr_pos) {
+      gst_buffer_copy_into (new_buf, buffer, GST_BUFFER_COPY_MEMORY,
+          h265parse->idr_pos, -1);
+    }
     /* should already be keyframe/IDR, but it may not have been,
      * so mark it as such to avoid being discarded by picky decoder */
     GST_BUFFER_FLAG_UNSET (new_buf, GST_BUFFER_FLAG_DELTA_UNIT);
     gst_buffer_replace (&frame->out_buffer, new_buf);
     gst_buffer_unref (new_buf);
-    /* some result checking seems to make some compilers happy */
-    if (G_UNLIKELY (!ok)) {
-      GST_ERROR_OBJECT (h265parse, "failed to insert SPS/PPS");
-    }
   }
 
   return send_done;
@@ -106,6 +106,10 @@ struct _GstH265Parse
   gint idr_pos, sei_pos;
   gboolean update_caps;
   GstAdapter *frame_out;
+  /* buffer (and its mapping) the NALs being processed come from, if any,
+   * so frame_out can share its memory rather than copy the payload */
+  GstBuffer *nal_src;
+  const guint8 *nal_src_data;
   gboolean keyframe;
   gboolean predicted;
   gboolean bidirectional;
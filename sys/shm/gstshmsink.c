@@ -31,6 +31,12 @@
  * ! shmsink socket-path=/tmp/blah shm-size=2000000
  * ]| Send video to shm buffers.
  *
+ * With #GstShmSink:ring-size set, the buffers are handed to the clients
+ * through a lock-free ring in shared memory instead of a message per buffer
+ * on the control socket. With #GstShmSink:pass-fds, memfd and DMABuf backed
+ * buffers are passed to the clients as file descriptors instead of being
+ * copied into the shared memory area.
+ *
  */
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -39,6 +45,7 @@
 #include "gstshmsink.h"
 
 #include <gst/gst.h>
+#include <gst/allocators/allocators.h>
 
 #include <string.h>
 
@@ -58,7 +65,9 @@ enum
   PROP_PERMS,
   PROP_SHM_SIZE,
   PROP_WAIT_FOR_CONNECTION,
-  PROP_BUFFER_TIME
+  PROP_BUFFER_TIME,
+  PROP_RING_SIZE,
+  PROP_PASS_FDS
 };
 
 struct GstShmClient
@@ -69,6 +78,8 @@ struct GstShmClient
 
 #define DEFAULT_SIZE ( 64 * 1024 * 1024 )
 #define DEFAULT_WAIT_FOR_CONNECTION (TRUE)
+#define DEFAULT_RING_SIZE (0)
+#define DEFAULT_PASS_FDS (FALSE)
 /* Default is user read/write, group read */
 #define DEFAULT_PERMS ( S_IRUSR | S_IWUSR | S_IRGRP )
 
@@ -355,6 +366,8 @@ gst_shm_sink_init (GstShmSink * self)
   self->unlock = FALSE;
   self->wait_for_connection = DEFAULT_WAIT_FOR_CONNECTION;
   self->perms = DEFAULT_PERMS;
+  self->ring_size = DEFAULT_RING_SIZE;
+  self->pass_fds = DEFAULT_PASS_FDS;
 
   gst_allocation_params_init (&self->params);
 }
@@ -417,6 +430,40 @@ gst_shm_sink_class_init (GstShmSinkClass * klass)
           -1, G_MAXINT64, -1,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstShmSink:ring-size:
+   *
+   * Number of buffer descriptors in the lock-free ring used to hand the
+   * buffers to the clients, rounded up to a power of two. With the ring,
+   * sending a buffer does not need any syscall unless a client is waiting
+   * for it. 0 sends every buffer over the control socket, which is the only
+   * way older clients understand. Only used when the sink starts.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_RING_SIZE,
+      g_param_spec_uint ("ring-size",
+          "Size of the descriptor ring",
+          "Number of buffer descriptors in the shared memory ring "
+          "(0 = send buffers over the control socket)",
+          0, 65536, DEFAULT_RING_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstShmSink:pass-fds:
+   *
+   * Pass buffers made of a single memfd or DMABuf memory to the clients as
+   * file descriptors instead of copying them into the shared memory area.
+   * The clients must be recent enough to handle them.
+   *
+   * Since: 1.20
+   */
+  g_object_class_install_property (gobject_class, PROP_PASS_FDS,
+      g_param_spec_boolean ("pass-fds",
+          "Pass file descriptors",
+          "Pass fd backed buffers to the clients without copying them",
+          DEFAULT_PASS_FDS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   signals[SIGNAL_CLIENT_CONNECTED] = g_signal_new ("client-connected",
       GST_TYPE_SHM_SINK, G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL,
       G_TYPE_NONE, 1, G_TYPE_INT);
@@ -505,6 +552,16 @@ gst_shm_sink_set_property (GObject * object, guint prop_id,
       GST_OBJECT_UNLOCK (object);
       g_cond_broadcast (&self->cond);
       break;
+    case PROP_RING_SIZE:
+      GST_OBJECT_LOCK (object);
+      self->ring_size = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (object);
+      break;
+    case PROP_PASS_FDS:
+      GST_OBJECT_LOCK (object);
+      self->pass_fds = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (object);
+      break;
     default:
       break;
   }
@@ -534,6 +591,12 @@ gst_shm_sink_get_property (GObject * object, guint prop_id,
     case PROP_BUFFER_TIME:
       g_value_set_int64 (value, self->buffer_time);
       break;
+    case PROP_RING_SIZE:
+      g_value_set_uint (value, self->ring_size);
+      break;
+    case PROP_PASS_FDS:
+      g_value_set_boolean (value, self->pass_fds);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -569,6 +632,11 @@ gst_shm_sink_start (GstBaseSink * bsink)
     return FALSE;
   }
 
+  if (self->ring_size > 0 &&
+      sp_writer_enable_ring (self->pipe, self->ring_size) < 0)
+    GST_WARNING_OBJECT (self, "Could not create the descriptor ring, sending "
+        "buffers over the control socket");
+
   sp_set_data (self->pipe, self);
   g_free (self->socket_path);
   self->socket_path = g_strdup (sp_writer_get_path (self->pipe));
@@ -581,6 +649,13 @@ gst_shm_sink_start (GstBaseSink * bsink)
   gst_poll_add_fd (self->poll, &self->serverpollfd);
   gst_poll_fd_ctl_read (self->poll, &self->serverpollfd, TRUE);
 
+  gst_poll_fd_init (&self->ringpollfd);
+  self->ringpollfd.fd = sp_get_ring_fd (self->pipe);
+  if (self->ringpollfd.fd >= 0) {
+    gst_poll_add_fd (self->poll, &self->ringpollfd);
+    gst_poll_fd_ctl_read (self->poll, &self->ringpollfd, TRUE);
+  }
+
   self->pollthread =
       g_thread_try_new ("gst-shmsink-poll-thread", pollthread_func, self, &err);
 
@@ -700,6 +775,38 @@ gst_shm_sink_render (GstBaseSink * bsink, GstBuffer * buf)
     }
   }
 
+  if (self->pass_fds && gst_buffer_n_memory (buf) == 1 &&
+      gst_is_fd_memory (gst_buffer_peek_memory (buf, 0))) {
+    memory = gst_buffer_peek_memory (buf, 0);
+    sendbuf = gst_buffer_ref (buf);
+
+    GST_LOG_OBJECT (self, "Passing fd of buffer %p", buf);
+    rv = sp_writer_send_fd (self->pipe, gst_fd_memory_get_fd (memory),
+        memory->offset, memory->size,
+        gst_is_dmabuf_memory (memory) ? SP_FD_BUFFER_DMABUF : 0, sendbuf);
+    GST_OBJECT_UNLOCK (self);
+
+    if (rv == 0) {
+      GST_DEBUG_OBJECT (self, "No clients connected, unreffing buffer");
+      gst_buffer_unref (sendbuf);
+    }
+
+    return ret;
+  }
+
+  /* The ring has no room left until the clients release the oldest buffer */
+  while (sp_writer_ring_is_full (self->pipe)) {
+    g_cond_wait (&self->cond, GST_OBJECT_GET_LOCK (self));
+    if (self->unlock) {
+      GST_OBJECT_UNLOCK (self);
+      ret = gst_base_sink_wait_preroll (bsink);
+      if (ret == GST_FLOW_OK)
+        GST_OBJECT_LOCK (self);
+      else
+        return ret;
+    }
+  }
+
 
   if (gst_buffer_n_memory (buf) > 1) {
     GST_LOG_OBJECT (self, "Buffer %p has %d GstMemory, we only support a single"
@@ -892,6 +999,17 @@ pollthread_func (gpointer data)
       continue;
     }
 
+    if (self->ringpollfd.fd >= 0 &&
+        gst_poll_fd_can_read (self->poll, &self->ringpollfd)) {
+      GSList *list = NULL;
+
+      GST_OBJECT_LOCK (self);
+      sp_writer_ring_reclaim (self->pipe,
+          (sp_buffer_free_callback) free_buffer_locked, (void **) &list);
+      GST_OBJECT_UNLOCK (self);
+      g_slist_free_full (list, (GDestroyNotify) gst_buffer_unref);
+    }
+
   again:
     for (item = self->clients; item; item = item->next) {
       struct GstShmClient *gclient = item->data;
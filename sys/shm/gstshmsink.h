@@ -58,11 +58,14 @@ struct _GstShmSink
   GThread *pollthread;
   GstPoll *poll;
   GstPollFD serverpollfd;
+  GstPollFD ringpollfd;
 
   gboolean wait_for_connection;
   gboolean stop;
   gboolean unlock;
   GstClockTimeDiff buffer_time;
+  guint ring_size;
+  gboolean pass_fds;
 
   GCond cond;
 
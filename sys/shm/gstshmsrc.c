@@ -41,8 +41,10 @@
 #include "gstshmsrc.h"
 
 #include <gst/gst.h>
+#include <gst/allocators/allocators.h>
 
 #include <string.h>
+#include <unistd.h>
 
 /* signals */
 enum
@@ -62,9 +64,12 @@ enum
 struct GstShmBuffer
 {
   char *buf;
+  int fd;
   GstShmPipe *pipe;
 };
 
+static GQuark fd_buffer_quark;
+
 
 GST_DEBUG_CATEGORY_STATIC (shmsrc_debug);
 #define GST_CAT_DEFAULT shmsrc_debug
@@ -145,6 +150,8 @@ gst_shm_src_class_init (GstShmSrcClass * klass)
       "Olivier Crete <olivier.crete@collabora.co.uk>");
 
   GST_DEBUG_CATEGORY_INIT (shmsrc_debug, "shmsrc", 0, "Shared Memory Source");
+
+  fd_buffer_quark = g_quark_from_static_string ("GstShmSrcFdBuffer");
 }
 
 static void
@@ -152,6 +159,10 @@ gst_shm_src_init (GstShmSrc * self)
 {
   self->poll = gst_poll_new (TRUE);
   gst_poll_fd_init (&self->pollfd);
+  gst_poll_fd_init (&self->ringpollfd);
+
+  self->fd_allocator = gst_fd_allocator_new ();
+  self->dmabuf_allocator = gst_dmabuf_allocator_new ();
 }
 
 static void
@@ -161,6 +172,8 @@ gst_shm_src_finalize (GObject * object)
 
   gst_poll_free (self->poll);
   g_free (self->socket_path);
+  gst_object_unref (self->fd_allocator);
+  gst_object_unref (self->dmabuf_allocator);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -260,6 +273,8 @@ gst_shm_src_start_reading (GstShmSrc * self)
   gst_poll_add_fd (self->poll, &self->pollfd);
   gst_poll_fd_ctl_read (self->poll, &self->pollfd, TRUE);
 
+  gst_poll_fd_init (&self->ringpollfd);
+
   return TRUE;
 }
 
@@ -310,7 +325,10 @@ free_buffer (gpointer data)
   GST_LOG ("Freeing buffer %p", gsb->buf);
 
   GST_OBJECT_LOCK (gsb->pipe->src);
-  sp_client_recv_finish (gsb->pipe->pipe, gsb->buf);
+  if (gsb->buf)
+    sp_client_recv_finish (gsb->pipe->pipe, gsb->buf);
+  else
+    sp_client_recv_fd_finish (gsb->pipe->pipe, gsb->fd);
   GST_OBJECT_UNLOCK (gsb->pipe->src);
 
   gst_shm_pipe_dec (gsb->pipe);
@@ -318,12 +336,71 @@ free_buffer (gpointer data)
   g_slice_free (struct GstShmBuffer, gsb);
 }
 
+static int
+gst_shm_src_recv (GstShmSrc * self, GstShmPipe * pipe, gchar ** buf,
+    gint * fd, gulong * offset, guint * flags)
+{
+  int rv;
+
+  GST_OBJECT_LOCK (self);
+  rv = sp_client_recv_fd (pipe->pipe, buf, fd, offset, flags);
+  GST_OBJECT_UNLOCK (self);
+
+  if (self->ringpollfd.fd < 0 && sp_get_ring_fd (pipe->pipe) >= 0) {
+    GST_DEBUG_OBJECT (self, "Receiving buffers through the descriptor ring");
+    self->ringpollfd.fd = sp_get_ring_fd (pipe->pipe);
+    gst_poll_add_fd (self->poll, &self->ringpollfd);
+    gst_poll_fd_ctl_read (self->poll, &self->ringpollfd, TRUE);
+  }
+
+  return rv;
+}
+
+static GstBuffer *
+gst_shm_src_wrap_fd (GstShmSrc * self, struct GstShmBuffer *gsb,
+    gulong offset, gsize size, guint flags)
+{
+  GstMemory *mem;
+  GstBuffer *buffer;
+  off_t maxsize;
+
+  /* The whole fd gets mapped, the data doesn't have to start at 0 */
+  maxsize = lseek (gsb->fd, 0, SEEK_END);
+  if (maxsize < (off_t) (offset + size))
+    maxsize = offset + size;
+
+  if (flags & SP_FD_BUFFER_DMABUF)
+    mem = gst_dmabuf_allocator_alloc_with_flags (self->dmabuf_allocator,
+        gsb->fd, maxsize, GST_FD_MEMORY_FLAG_DONT_CLOSE);
+  else
+    mem = gst_fd_allocator_alloc (self->fd_allocator, gsb->fd, maxsize,
+        GST_FD_MEMORY_FLAG_DONT_CLOSE);
+
+  if (!mem) {
+    free_buffer (gsb);
+    return NULL;
+  }
+
+  gst_memory_resize (mem, offset, size);
+  GST_MINI_OBJECT_FLAG_SET (mem, GST_MEMORY_FLAG_READONLY);
+  gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (mem), fd_buffer_quark,
+      gsb, free_buffer);
+
+  buffer = gst_buffer_new ();
+  gst_buffer_append_memory (buffer, mem);
+
+  return buffer;
+}
+
 static GstFlowReturn
 gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
 {
   GstShmSrc *self = GST_SHM_SRC (psrc);
   GstShmPipe *pipe;
   gchar *buf = NULL;
+  gint fd = -1;
+  gulong offset = 0;
+  guint flags = 0;
   int rv = 0;
   struct GstShmBuffer *gsb;
 
@@ -340,6 +417,17 @@ gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
   GST_OBJECT_UNLOCK (self);
 
   do {
+    /* Buffers can be waiting in the ring without any fd being readable, so
+     * only go to sleep once it is empty */
+    if (self->ringpollfd.fd >= 0) {
+      GST_LOG_OBJECT (self, "Reading from ring");
+      rv = gst_shm_src_recv (self, pipe, &buf, &fd, &offset, &flags);
+      if (rv < 0)
+        goto recv_error;
+      if (buf != NULL || fd >= 0)
+        break;
+    }
+
     if (gst_poll_wait (self->poll, GST_CLOCK_TIME_NONE) < 0) {
       if (errno == EBUSY)
         goto flushing;
@@ -363,31 +451,39 @@ gst_shm_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
       goto error;
     }
 
-    if (gst_poll_fd_can_read (self->poll, &self->pollfd)) {
-      buf = NULL;
+    if (self->ringpollfd.fd < 0 &&
+        gst_poll_fd_can_read (self->poll, &self->pollfd)) {
       GST_LOG_OBJECT (self, "Reading from pipe");
-      GST_OBJECT_LOCK (self);
-      rv = sp_client_recv (pipe->pipe, &buf);
-      GST_OBJECT_UNLOCK (self);
-      if (rv < 0) {
-        GST_ELEMENT_ERROR (self, RESOURCE, READ, ("Failed to read from shmsrc"),
-            ("Error reading control data: %d", rv));
-        goto error;
-      }
+      rv = gst_shm_src_recv (self, pipe, &buf, &fd, &offset, &flags);
+      if (rv < 0)
+        goto recv_error;
     }
-  } while (buf == NULL);
+  } while (buf == NULL && fd < 0);
 
-  GST_LOG_OBJECT (self, "Got buffer %p of size %d", buf, rv);
+  GST_LOG_OBJECT (self, "Got buffer %p (fd %d) of size %d", buf, fd, rv);
 
   gsb = g_slice_new0 (struct GstShmBuffer);
   gsb->buf = buf;
+  gsb->fd = fd;
   gsb->pipe = pipe;
 
-  *outbuf = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
-      buf, rv, 0, rv, gsb, free_buffer);
+  if (buf) {
+    *outbuf = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+        buf, rv, 0, rv, gsb, free_buffer);
+  } else {
+    *outbuf = gst_shm_src_wrap_fd (self, gsb, offset, rv, flags);
+    if (!*outbuf) {
+      GST_ELEMENT_ERROR (self, RESOURCE, READ, ("Failed to read from shmsrc"),
+          ("Could not wrap fd %d", fd));
+      return GST_FLOW_ERROR;
+    }
+  }
 
   return GST_FLOW_OK;
 
+recv_error:
+  GST_ELEMENT_ERROR (self, RESOURCE, READ, ("Failed to read from shmsrc"),
+      ("Error reading control data: %d", rv));
 error:
   gst_shm_pipe_dec (pipe);
   return GST_FLOW_ERROR;
@@ -471,6 +567,10 @@ gst_shm_pipe_dec (GstShmPipe * pipe)
 
   gst_poll_remove_fd (pipe->src->poll, &pipe->src->pollfd);
   gst_poll_fd_init (&pipe->src->pollfd);
+  if (pipe->src->ringpollfd.fd >= 0) {
+    gst_poll_remove_fd (pipe->src->poll, &pipe->src->ringpollfd);
+    gst_poll_fd_init (&pipe->src->ringpollfd);
+  }
 
   GST_OBJECT_UNLOCK (pipe->src);
 
@@ -52,6 +52,10 @@ struct _GstShmSrc
   GstShmPipe *pipe;
   GstPoll *poll;
   GstPollFD pollfd;
+  GstPollFD ringpollfd;
+
+  GstAllocator *fd_allocator;
+  GstAllocator *dmabuf_allocator;
 
 
   GstFlowReturn flow_return;
@@ -23,6 +23,10 @@
  */
 
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE             /* for memfd_create() */
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
@@ -47,6 +51,11 @@
 #include <sys/mman.h>
 #include <assert.h>
 
+#if defined (HAVE_SYS_EVENTFD_H) && defined (__GNUC__)
+#include <sys/eventfd.h>
+#define SHM_PIPE_HAVE_RING 1
+#endif
+
 #include "shmalloc.h"
 
 /*
@@ -67,9 +76,33 @@
  * type 4: ack buffer
  * offset
  *
- * Type 4 goes from the client to the server
+ * type 5: new ring (the area id field carries the consumer index)
+ * Ring length
+ * Passes the ring, consumer eventfd and writer eventfd fds
+ *
+ * type 6: fd buffer, type 7: dmabuf buffer (the area id field carries the
+ * buffer id)
+ * offset
+ * bufsize
+ * Passes the fd holding the data
+ *
+ * type 8: ack fd buffer (the area id field carries the buffer id)
+ * No payload
+ *
+ * Types 4 and 8 go from the client to the server
  * The rest are from the server to the client
- * The client should never write in the SHM
+ * The client should never write in the SHM, the ring is the only shared
+ * memory it writes to
+ *
+ * When the ring is enabled, buffers in the shm areas are not sent with type 3
+ * to the clients that got a type 5 command. Instead, the writer fills the
+ * next slot of a single producer, multiple consumer ring living in its own
+ * shared memory object, with a mask of the consumers that have to release
+ * it, and then moves the ring head forward. Every consumer follows the head
+ * on its own and clears its bit from the slot when it is done with the
+ * buffer, so neither side makes a syscall per buffer. The eventfds are only
+ * written to wake up a consumer that flagged itself as waiting in the ring
+ * header, or the writer once a slot has been fully released.
  */
 
 
@@ -80,10 +113,54 @@ enum
   COMMAND_NEW_SHM_AREA = 1,
   COMMAND_CLOSE_SHM_AREA = 2,
   COMMAND_NEW_BUFFER = 3,
-  COMMAND_ACK_BUFFER = 4
+  COMMAND_ACK_BUFFER = 4,
+  COMMAND_NEW_RING = 5,
+  COMMAND_NEW_FD_BUFFER = 6,
+  COMMAND_NEW_DMABUF_BUFFER = 7,
+  COMMAND_ACK_FD_BUFFER = 8
 };
 
+/* Up to three fds are passed with a single command */
+#define MAX_COMMAND_FDS 3
+
+#define SHM_RING_MAGIC 0x53505247
+#define SHM_RING_MAX_CONSUMERS 32
+#define SHM_RING_MAX_SLOTS 65536
+
 typedef struct _ShmArea ShmArea;
+typedef struct _ShmRing ShmRing;
+typedef struct _ShmRingHeld ShmRingHeld;
+typedef struct _ShmFdRef ShmFdRef;
+
+/* The layout of the ring is shared between processes, so only fixed size
+ * types are used in it */
+typedef struct
+{
+  uint32_t waiting;
+  uint32_t padding;
+  uint64_t start;
+} ShmRingConsumer;
+
+typedef struct
+{
+  uint64_t seq;
+  uint32_t pending;
+  int32_t area_id;
+  uint64_t offset;
+  uint64_t size;
+} ShmRingSlot;
+
+typedef struct
+{
+  uint32_t magic;
+  uint32_t n_slots;
+  uint64_t head;
+  uint32_t writer_wake;
+  uint32_t padding;
+  ShmRingConsumer consumers[SHM_RING_MAX_CONSUMERS];
+  /* This must ALWAYS stay last in the struct */
+  ShmRingSlot slots[0];
+} ShmRingHeader;
 
 struct _ShmArea
 {
@@ -118,6 +195,13 @@ struct _ShmBuffer
 
   void *tag;
 
+  /* Set while the consumers of the ring hold the buffer */
+  int ring;
+  uint64_t ring_seq;
+
+  /* Buffers passed as a fd have no shm area and are acked by id */
+  int fd_id;
+
   int num_clients;
   /* This must ALWAYS stay last in the struct */
   int clients[0];
@@ -141,15 +225,62 @@ struct _ShmPipe
   ShmClient *clients;
 
   mode_t perms;
+
+  ShmRing *ring;
+
+  int next_fd_id;
+  ShmFdRef *fd_refs;
 };
 
 struct _ShmClient
 {
   int fd;
 
+  /* Index in the ring consumers and eventfd to wake it up, -1 if the
+   * buffers are sent over the socket */
+  int consumer;
+  int efd;
+
   ShmClient *next;
 };
 
+/* sp_ring_new() creates the writer side of a ring, sp_ring_open() maps the
+ * one received by a reader; efd is the eventfd the owner polls on */
+struct _ShmRing
+{
+  int fd;
+  size_t len;
+  ShmRingHeader *hdr;
+  unsigned int n_slots;
+
+  int efd;
+
+  /* writer only */
+  uint32_t consumers;
+
+  /* reader only */
+  int writer_efd;
+  int consumer;
+  uint64_t tail;
+  ShmRingHeld *held;
+};
+
+struct _ShmRingHeld
+{
+  char *buf;
+  uint64_t seq;
+
+  ShmRingHeld *next;
+};
+
+struct _ShmFdRef
+{
+  int fd;
+  int id;
+
+  ShmFdRef *next;
+};
+
 struct _ShmBlock
 {
   ShmPipe *pipe;
@@ -186,6 +317,8 @@ static ShmArea *sp_open_shm (char *path, int id, mode_t perms, size_t size);
 static void sp_close_shm (ShmArea * area);
 static int sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf,
     ShmBuffer * prev_buf, ShmClient * client, void **tag);
+static int sp_shmbuf_unref (ShmPipe * self, ShmBuffer * buf,
+    ShmBuffer * prev_buf, void **tag);
 static void sp_shm_area_dec (ShmPipe * self, ShmArea * area);
 
 
@@ -396,6 +529,209 @@ sp_shm_area_dec (ShmPipe * self, ShmArea * area)
   }
 }
 
+static void
+sp_ring_wake (int efd)
+{
+#ifdef SHM_PIPE_HAVE_RING
+  eventfd_write (efd, 1);
+#endif
+}
+
+static void
+sp_ring_drain (int efd)
+{
+#ifdef SHM_PIPE_HAVE_RING
+  eventfd_t val;
+
+  eventfd_read (efd, &val);
+#endif
+}
+
+static int
+sp_ring_create_fd (size_t len)
+{
+  int fd = -1;
+  char tmppath[40];
+  int i = 0;
+
+#ifdef HAVE_MEMFD_CREATE
+  fd = memfd_create ("shmpipe-ring", MFD_CLOEXEC);
+#endif
+
+  if (fd < 0) {
+    do {
+      snprintf (tmppath, sizeof (tmppath), "/shmpipe.%5d.ring.%5d", getpid (),
+          i++);
+      fd = shm_open (tmppath, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    } while (fd < 0 && errno == EEXIST);
+
+    if (fd < 0)
+      return -1;
+
+    /* The ring is only ever handed out as a fd */
+    shm_unlink (tmppath);
+  }
+
+  if (ftruncate (fd, len)) {
+    close (fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+static void
+sp_ring_free (ShmRing * ring)
+{
+  while (ring->held) {
+    ShmRingHeld *held = ring->held;
+
+    ring->held = held->next;
+    spalloc_free (ShmRingHeld, held);
+  }
+
+  if (ring->hdr != MAP_FAILED)
+    munmap (ring->hdr, ring->len);
+
+  if (ring->fd >= 0)
+    close (ring->fd);
+  if (ring->efd >= 0)
+    close (ring->efd);
+  if (ring->writer_efd >= 0)
+    close (ring->writer_efd);
+
+  spalloc_free (ShmRing, ring);
+}
+
+static ShmRing *
+sp_ring_alloc (void)
+{
+  ShmRing *ring = spalloc_new (ShmRing);
+
+  memset (ring, 0, sizeof (ShmRing));
+  ring->fd = -1;
+  ring->efd = -1;
+  ring->writer_efd = -1;
+  ring->consumer = -1;
+  ring->hdr = MAP_FAILED;
+
+  return ring;
+}
+
+static ShmRing *
+sp_ring_new (unsigned int n_slots)
+{
+#ifdef SHM_PIPE_HAVE_RING
+  ShmRing *ring = sp_ring_alloc ();
+
+  ring->n_slots = n_slots;
+  ring->len = sizeof (ShmRingHeader) + sizeof (ShmRingSlot) * n_slots;
+
+  ring->fd = sp_ring_create_fd (ring->len);
+  if (ring->fd < 0)
+    goto error;
+
+  ring->hdr = mmap (NULL, ring->len, PROT_READ | PROT_WRITE, MAP_SHARED,
+      ring->fd, 0);
+  if (ring->hdr == MAP_FAILED)
+    goto error;
+
+  ring->efd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (ring->efd < 0)
+    goto error;
+
+  /* The rest of the header was zeroed by ftruncate() */
+  ring->hdr->magic = SHM_RING_MAGIC;
+  ring->hdr->n_slots = n_slots;
+
+  return ring;
+
+error:
+  fprintf (stderr, "Could not create ring (%d): %s\n", errno,
+      strerror (errno));
+  sp_ring_free (ring);
+#endif
+  return NULL;
+}
+
+static ShmRing *
+sp_ring_open (int fd, size_t len, int consumer, int efd, int writer_efd)
+{
+  ShmRing *ring = sp_ring_alloc ();
+
+  ring->fd = fd;
+  ring->efd = efd;
+  ring->writer_efd = writer_efd;
+  ring->len = len;
+
+  if (len < sizeof (ShmRingHeader) || consumer < 0 ||
+      consumer >= SHM_RING_MAX_CONSUMERS)
+    goto error;
+
+  ring->hdr = mmap (NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (ring->hdr == MAP_FAILED)
+    goto error;
+
+  /* Don't trust the size from the header more than the mapping */
+  ring->n_slots = ring->hdr->n_slots;
+  if (ring->hdr->magic != SHM_RING_MAGIC || ring->n_slots == 0 ||
+      (ring->n_slots & (ring->n_slots - 1)) != 0 ||
+      ring->n_slots > (len - sizeof (ShmRingHeader)) / sizeof (ShmRingSlot))
+    goto error;
+
+  ring->consumer = consumer;
+  ring->tail = ring->hdr->consumers[consumer].start;
+
+  return ring;
+
+error:
+  sp_ring_free (ring);
+  return NULL;
+}
+
+static ShmRingSlot *
+sp_ring_get_slot (ShmRing * ring, uint64_t seq)
+{
+  return &ring->hdr->slots[seq & (ring->n_slots - 1)];
+}
+
+/* A slot is done once every consumer has cleared its bit, or when it has
+ * already been reused for a later buffer */
+static int
+sp_ring_slot_is_released (ShmRing * ring, uint64_t seq)
+{
+  ShmRingSlot *slot = sp_ring_get_slot (ring, seq);
+
+  return slot->seq != seq ||
+      __atomic_load_n (&slot->pending, __ATOMIC_ACQUIRE) == 0;
+}
+
+static void
+sp_ring_release (ShmRing * ring, uint64_t seq, uint32_t consumers)
+{
+  ShmRingSlot *slot = sp_ring_get_slot (ring, seq);
+
+  if (__atomic_load_n (&slot->seq, __ATOMIC_RELAXED) != seq)
+    return;
+
+  if (__atomic_and_fetch (&slot->pending, ~consumers, __ATOMIC_SEQ_CST) == 0
+      && ring->writer_efd >= 0 &&
+      !__atomic_exchange_n (&ring->hdr->writer_wake, 1, __ATOMIC_SEQ_CST))
+    sp_ring_wake (ring->writer_efd);
+}
+
+static void
+sp_fd_refs_free (ShmPipe * self)
+{
+  while (self->fd_refs) {
+    ShmFdRef *ref = self->fd_refs;
+
+    self->fd_refs = ref->next;
+    close (ref->fd);
+    spalloc_free (ShmFdRef, ref);
+  }
+}
+
 void *
 sp_get_data (ShmPipe * self)
 {
@@ -425,6 +761,10 @@ sp_dec (ShmPipe * self)
   while (self->shm_area)
     sp_shm_area_dec (self, self->shm_area);
 
+  if (self->ring)
+    sp_ring_free (self->ring);
+  sp_fd_refs_free (self);
+
   spalloc_free (ShmPipe, self);
 }
 
@@ -484,6 +824,45 @@ send_command (int fd, struct CommandBuffer *cb, unsigned short int type,
   return 1;
 }
 
+static int
+send_command_fds (int fd, struct CommandBuffer *cb, unsigned short int type,
+    int area_id, const int *fds, int n_fds)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  union
+  {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE (sizeof (int) * MAX_COMMAND_FDS)];
+  } control;
+
+  assert (n_fds > 0 && n_fds <= MAX_COMMAND_FDS);
+
+  cb->type = type;
+  cb->area_id = area_id;
+
+  memset (&msg, 0, sizeof (msg));
+  memset (&control, 0, sizeof (control));
+  iov.iov_base = cb;
+  iov.iov_len = sizeof (struct CommandBuffer);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = CMSG_SPACE (sizeof (int) * n_fds);
+
+  cmsg = CMSG_FIRSTHDR (&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN (sizeof (int) * n_fds);
+  memcpy (CMSG_DATA (cmsg), fds, sizeof (int) * n_fds);
+
+  if (sendmsg (fd, &msg, MSG_NOSIGNAL) != sizeof (struct CommandBuffer))
+    return 0;
+
+  return 1;
+}
+
 int
 sp_writer_resize (ShmPipe * self, size_t size)
 {
@@ -572,6 +951,41 @@ sp_writer_free_block (ShmBlock * block)
   spalloc_free (ShmBlock, block);
 }
 
+/* Returns 0 if the next slot is still held by some consumers */
+static int
+sp_writer_ring_publish (ShmPipe * self, ShmArea * area, unsigned long offset,
+    unsigned long size, uint32_t consumers, uint64_t * seq)
+{
+  ShmRing *ring = self->ring;
+  uint64_t head = ring->hdr->head;
+  ShmRingSlot *slot = sp_ring_get_slot (ring, head);
+  ShmClient *client;
+
+  if (__atomic_load_n (&slot->pending, __ATOMIC_ACQUIRE) != 0)
+    return 0;
+
+  __atomic_store_n (&slot->seq, head, __ATOMIC_RELAXED);
+  slot->area_id = area->id;
+  slot->offset = offset;
+  slot->size = size;
+  __atomic_store_n (&slot->pending, consumers, __ATOMIC_RELAXED);
+
+  /* Pairs with the consumers setting their waiting flag and then looking at
+   * the head again before going to sleep */
+  __atomic_store_n (&ring->hdr->head, head + 1, __ATOMIC_SEQ_CST);
+
+  for (client = self->clients; client; client = client->next) {
+    if (client->consumer >= 0 && (consumers & (1U << client->consumer)) &&
+        __atomic_exchange_n (&ring->hdr->consumers[client->consumer].waiting,
+            0, __ATOMIC_SEQ_CST))
+      sp_ring_wake (client->efd);
+  }
+
+  *seq = head;
+
+  return 1;
+}
+
 /* Returns the number of client this has successfully been sent to */
 
 int
@@ -583,6 +997,7 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void *tag)
   ShmBuffer *sb;
   ShmClient *client = NULL;
   ShmAllocBlock *ablock = NULL;
+  uint32_t consumers = 0;
   int i = 0;
   int c = 0;
 
@@ -614,6 +1029,12 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void *tag)
 
   for (client = self->clients; client; client = client->next) {
     struct CommandBuffer cb = { 0 };
+
+    if (client->consumer >= 0) {
+      consumers |= 1U << client->consumer;
+      continue;
+    }
+
     cb.payload.buffer.offset = offset;
     cb.payload.buffer.size = bsize;
     if (!send_command (client->fd, &cb, COMMAND_NEW_BUFFER, self->shm_area->id))
@@ -622,6 +1043,17 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void *tag)
     c++;
   }
 
+  sb->use_count = c;
+
+  /* All the consumers of the ring share a single reference */
+  if (consumers && sp_writer_ring_publish (self, area, offset, bsize,
+          consumers, &sb->ring_seq)) {
+    sb->ring = 1;
+    sb->use_count++;
+    for (; consumers; consumers &= consumers - 1)
+      c++;
+  }
+
   if (c == 0) {
     spalloc_free1 (sizeof (ShmBuffer) + sizeof (int) * sb->num_clients, sb);
     return 0;
@@ -630,8 +1062,6 @@ sp_writer_send_buf (ShmPipe * self, char *buf, size_t size, void *tag)
   sp_shm_area_inc (area);
   shm_alloc_space_block_inc (ablock);
 
-  sb->use_count = c;
-
   sb->next = self->buffers;
   self->buffers = sb;
 
@@ -651,20 +1081,185 @@ recv_command (int fd, struct CommandBuffer *cb)
   }
 }
 
+static void
+close_fds (int *fds, int n_fds)
+{
+  int i;
+
+  for (i = 0; i < n_fds; i++)
+    close (fds[i]);
+}
+
+/* Same as recv_command(), but also picks the fds passed along with the
+ * command, and returns -1 instead of 0 if there was nothing to read */
+static int
+recv_command_fds (int fd, struct CommandBuffer *cb, int *fds, int *n_fds)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  union
+  {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE (sizeof (int) * MAX_COMMAND_FDS)];
+  } control;
+  int flags = MSG_DONTWAIT;
+  ssize_t retval;
+
+  *n_fds = 0;
+
+  memset (&msg, 0, sizeof (msg));
+  iov.iov_base = cb;
+  iov.iov_len = sizeof (struct CommandBuffer);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof (control.buf);
+
+#ifdef MSG_CMSG_CLOEXEC
+  flags |= MSG_CMSG_CLOEXEC;
+#endif
+
+  retval = recvmsg (fd, &msg, flags);
+  if (retval < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    return -1;
+
+  for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      int n = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (int);
+
+      if (*n_fds + n > MAX_COMMAND_FDS) {
+        close_fds ((int *) CMSG_DATA (cmsg), n);
+        continue;
+      }
+      memcpy (fds + *n_fds, CMSG_DATA (cmsg), sizeof (int) * n);
+      *n_fds += n;
+    }
+  }
+
+  if (retval != sizeof (struct CommandBuffer) ||
+      (msg.msg_flags & MSG_CTRUNC)) {
+    close_fds (fds, *n_fds);
+    *n_fds = 0;
+    return 0;
+  }
+
+  return 1;
+}
+
+/* Reads the next buffer from the ring, the caller has checked that there is
+ * no command waiting on the socket after loading the head */
+static long int
+sp_client_ring_recv (ShmPipe * self, uint64_t head, char **buf)
+{
+  ShmRing *ring = self->ring;
+  ShmRingSlot *slot;
+  ShmRingHeld *held;
+  ShmArea *area;
+  uint64_t offset, size;
+
+  assert (buf);
+
+  while (head != ring->tail) {
+    slot = sp_ring_get_slot (ring, ring->tail);
+    if (slot->seq != ring->tail)
+      return -24;
+
+    /* The slot lives in memory shared with the writer, don't trust it to
+     * stay the same between the checks and their use */
+    offset = __atomic_load_n (&slot->offset, __ATOMIC_RELAXED);
+    size = __atomic_load_n (&slot->size, __ATOMIC_RELAXED);
+
+    for (area = self->shm_area; area; area = area->next) {
+      if (area->id == slot->area_id)
+        break;
+    }
+
+    if (area && offset <= area->shm_area_len
+        && size <= area->shm_area_len - offset) {
+      held = spalloc_new (ShmRingHeld);
+      held->buf = area->shm_area_buf + offset;
+      held->seq = ring->tail;
+      held->next = ring->held;
+      ring->held = held;
+      ring->tail++;
+
+      *buf = held->buf;
+      sp_shm_area_inc (area);
+      return size;
+    }
+
+    /* New areas are announced on the socket before being used in the ring,
+     * so this is a buffer from an area that was closed in the meantime, or
+     * one that doesn't fit in its area. Skip it and look at the next one. */
+    sp_ring_release (ring, ring->tail, 1U << ring->consumer);
+    ring->tail++;
+  }
+
+  /* Ask to be woken up, then check that the writer didn't publish anything
+   * before it could see the flag */
+  __atomic_store_n (&ring->hdr->consumers[ring->consumer].waiting, 1,
+      __ATOMIC_SEQ_CST);
+  if (__atomic_load_n (&ring->hdr->head, __ATOMIC_SEQ_CST) != ring->tail) {
+    /* It did, but that head was loaded after checking the socket, so come
+     * back for it through the eventfd */
+    sp_ring_wake (ring->efd);
+  }
+
+  return 0;
+}
+
+static int
+sp_client_open_ring (ShmPipe * self, struct CommandBuffer *cb, int *fds,
+    int n_fds)
+{
+  if (self->ring || n_fds != 3) {
+    close_fds (fds, n_fds);
+    return 0;
+  }
+
+  self->ring = sp_ring_open (fds[0], cb->payload.new_shm_area.size,
+      cb->area_id, fds[1], fds[2]);
+  if (!self->ring)
+    return 0;
+
+  return 1;
+}
+
 long int
 sp_client_recv (ShmPipe * self, char **buf)
+{
+  return sp_client_recv_fd (self, buf, NULL, NULL, NULL);
+}
+
+long int
+sp_client_recv_fd (ShmPipe * self, char **buf, int *fd, unsigned long *offset,
+    unsigned int *flags)
 {
   char *area_name = NULL;
   ShmArea *newarea;
   ShmArea *area;
+  ShmFdRef *ref;
   struct CommandBuffer cb;
+  int fds[MAX_COMMAND_FDS];
+  int n_fds;
+  uint64_t head = 0;
   int retval;
 
-  if (!recv_command (self->main_socket, &cb))
+  if (self->ring) {
+    sp_ring_drain (self->ring->efd);
+    head = __atomic_load_n (&self->ring->hdr->head, __ATOMIC_ACQUIRE);
+  }
+
+  retval = recv_command_fds (self->main_socket, &cb, fds, &n_fds);
+  if (retval < 0 && self->ring)
+    return sp_client_ring_recv (self, head, buf);
+  if (retval <= 0)
     return -1;
 
   switch (cb.type) {
     case COMMAND_NEW_SHM_AREA:
+      close_fds (fds, n_fds);
       assert (cb.payload.new_shm_area.path_size > 0);
       assert (cb.payload.new_shm_area.size > 0);
 
@@ -689,6 +1284,7 @@ sp_client_recv (ShmPipe * self, char **buf)
       break;
 
     case COMMAND_CLOSE_SHM_AREA:
+      close_fds (fds, n_fds);
       for (area = self->shm_area; area; area = area->next) {
         if (area->id == cb.area_id) {
           sp_shm_area_dec (self, area);
@@ -698,6 +1294,7 @@ sp_client_recv (ShmPipe * self, char **buf)
       break;
 
     case COMMAND_NEW_BUFFER:
+      close_fds (fds, n_fds);
       assert (buf);
       for (area = self->shm_area; area; area = area->next) {
         if (area->id == cb.area_id) {
@@ -708,10 +1305,64 @@ sp_client_recv (ShmPipe * self, char **buf)
       }
       return -23;
 
+    case COMMAND_NEW_RING:
+      if (!sp_client_open_ring (self, &cb, fds, n_fds))
+        return -5;
+      break;
+
+    case COMMAND_NEW_FD_BUFFER:
+    case COMMAND_NEW_DMABUF_BUFFER:
+      if (n_fds != 1) {
+        close_fds (fds, n_fds);
+        return -6;
+      }
+
+      /* Callers that can't handle fds just release the buffer right away */
+      if (!fd) {
+        close (fds[0]);
+        if (!send_command (self->main_socket, &cb, COMMAND_ACK_FD_BUFFER,
+                cb.area_id))
+          return -7;
+        break;
+      }
+
+      ref = spalloc_new (ShmFdRef);
+      ref->fd = fds[0];
+      ref->id = cb.area_id;
+      ref->next = self->fd_refs;
+      self->fd_refs = ref;
+
+      *buf = NULL;
+      *fd = ref->fd;
+      *offset = cb.payload.buffer.offset;
+      *flags = 0;
+      if (cb.type == COMMAND_NEW_DMABUF_BUFFER)
+        *flags |= SP_FD_BUFFER_DMABUF;
+      return cb.payload.buffer.size;
+
     default:
+      close_fds (fds, n_fds);
       return -99;
   }
 
+  /* The caller goes back to select() after an internal message, make sure
+   * it looks at the ring again */
+  if (self->ring)
+    sp_ring_wake (self->ring->efd);
+
+  return 0;
+}
+
+static int
+sp_shmbuf_has_client (ShmBuffer * buf, ShmClient * client)
+{
+  int i;
+
+  for (i = 0; i < buf->num_clients; i++) {
+    if (buf->clients[i] == client->fd)
+      return 1;
+  }
+
   return 0;
 }
 
@@ -728,8 +1379,20 @@ sp_writer_recv (ShmPipe * self, ShmClient * client, void **tag)
     case COMMAND_ACK_BUFFER:
 
       for (buf = self->buffers; buf; buf = buf->next) {
-        if (buf->shm_area->id == cb.area_id &&
-            buf->offset == cb.payload.ack_buffer.offset) {
+        if (buf->shm_area && buf->shm_area->id == cb.area_id &&
+            buf->offset == cb.payload.ack_buffer.offset &&
+            sp_shmbuf_has_client (buf, client)) {
+          return sp_shmbuf_dec (self, buf, prev_buf, client, tag);
+        }
+        prev_buf = buf;
+      }
+
+      return -2;
+    case COMMAND_ACK_FD_BUFFER:
+
+      for (buf = self->buffers; buf; buf = buf->next) {
+        if (!buf->shm_area && buf->fd_id == cb.area_id &&
+            sp_shmbuf_has_client (buf, client)) {
           return sp_shmbuf_dec (self, buf, prev_buf, client, tag);
         }
         prev_buf = buf;
@@ -762,11 +1425,56 @@ sp_client_recv_finish (ShmPipe * self, char *buf)
 
   sp_shm_area_dec (self, shm_area);
 
+  if (self->ring) {
+    ShmRingHeld *held, *prev_held = NULL;
+
+    for (held = self->ring->held; held; held = held->next) {
+      if (held->buf == buf) {
+        if (prev_held)
+          prev_held->next = held->next;
+        else
+          self->ring->held = held->next;
+
+        sp_ring_release (self->ring, held->seq, 1U << self->ring->consumer);
+        spalloc_free (ShmRingHeld, held);
+        return 1;
+      }
+      prev_held = held;
+    }
+  }
+
   cb.payload.ack_buffer.offset = offset;
   return send_command (self->main_socket, &cb, COMMAND_ACK_BUFFER,
       self->shm_area->id);
 }
 
+int
+sp_client_recv_fd_finish (ShmPipe * self, int fd)
+{
+  ShmFdRef *ref, *prev_ref = NULL;
+  struct CommandBuffer cb = { 0 };
+
+  for (ref = self->fd_refs; ref; ref = ref->next) {
+    if (ref->fd == fd)
+      break;
+    prev_ref = ref;
+  }
+
+  assert (ref);
+
+  if (prev_ref)
+    prev_ref->next = ref->next;
+  else
+    self->fd_refs = ref->next;
+
+  close (ref->fd);
+  cb.area_id = ref->id;
+  spalloc_free (ShmFdRef, ref);
+
+  return send_command (self->main_socket, &cb, COMMAND_ACK_FD_BUFFER,
+      cb.area_id);
+}
+
 ShmPipe *
 sp_client_open (const char *path)
 {
@@ -804,11 +1512,62 @@ error:
 }
 
 
+/* Returns the index of the ring consumer given to the client, -1 if its
+ * buffers have to go through the socket or -2 on error */
+static int
+sp_writer_attach_consumer (ShmPipe * self, int fd, int *efd)
+{
+#ifdef SHM_PIPE_HAVE_RING
+  ShmRing *ring = self->ring;
+  struct CommandBuffer cb = { 0 };
+  int fds[3];
+  int i;
+
+  *efd = -1;
+
+  if (!ring)
+    return -1;
+
+  for (i = 0; i < SHM_RING_MAX_CONSUMERS; i++) {
+    if (!(ring->consumers & (1U << i)))
+      break;
+  }
+  if (i == SHM_RING_MAX_CONSUMERS)
+    return -1;
+
+  *efd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (*efd < 0)
+    return -1;
+
+  ring->hdr->consumers[i].waiting = 0;
+  ring->hdr->consumers[i].start = ring->hdr->head;
+
+  fds[0] = ring->fd;
+  fds[1] = *efd;
+  fds[2] = ring->efd;
+  cb.payload.new_shm_area.size = ring->len;
+  if (!send_command_fds (fd, &cb, COMMAND_NEW_RING, i, fds, 3)) {
+    close (*efd);
+    *efd = -1;
+    return -2;
+  }
+
+  ring->consumers |= 1U << i;
+
+  return i;
+#else
+  *efd = -1;
+  return -1;
+#endif
+}
+
 ShmClient *
 sp_writer_accept_client (ShmPipe * self)
 {
   ShmClient *client = NULL;
   int fd;
+  int consumer;
+  int efd;
   struct CommandBuffer cb = { 0 };
   int pathlen = strlen (self->shm_area->shm_area_name) + 1;
 
@@ -833,8 +1592,16 @@ sp_writer_accept_client (ShmPipe * self)
     goto error;
   }
 
+  consumer = sp_writer_attach_consumer (self, fd, &efd);
+  if (consumer == -2) {
+    fprintf (stderr, "Sending ring failed: %s", strerror (errno));
+    goto error;
+  }
+
   client = spalloc_new (ShmClient);
   client->fd = fd;
+  client->consumer = consumer;
+  client->efd = efd;
 
   /* Prepend ot linked list */
   client->next = self->clients;
@@ -870,6 +1637,13 @@ sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf, ShmBuffer * prev_buf,
   }
   assert (had_client);
 
+  return sp_shmbuf_unref (self, buf, prev_buf, tag);
+}
+
+static int
+sp_shmbuf_unref (ShmPipe * self, ShmBuffer * buf, ShmBuffer * prev_buf,
+    void **tag)
+{
   buf->use_count--;
 
   if (buf->use_count == 0) {
@@ -881,14 +1655,45 @@ sp_shmbuf_dec (ShmPipe * self, ShmBuffer * buf, ShmBuffer * prev_buf,
 
     if (tag)
       *tag = buf->tag;
-    shm_alloc_space_block_dec (buf->ablock);
-    sp_shm_area_dec (self, buf->shm_area);
+    if (buf->shm_area) {
+      shm_alloc_space_block_dec (buf->ablock);
+      sp_shm_area_dec (self, buf->shm_area);
+    }
     spalloc_free1 (sizeof (ShmBuffer) + sizeof (int) * buf->num_clients, buf);
     return 0;
   }
   return 1;
 }
 
+/* Drops the reference of the ring on the buffers all its consumers are done
+ * with */
+static int
+sp_ring_reclaim (ShmPipe * self, sp_buffer_free_callback callback,
+    void *user_data)
+{
+  ShmBuffer *buf, *prev_buf = NULL, *next;
+  int c = 0;
+
+  for (buf = self->buffers; buf; buf = next) {
+    next = buf->next;
+
+    if (buf->ring && sp_ring_slot_is_released (self->ring, buf->ring_seq)) {
+      void *tag = NULL;
+
+      buf->ring = 0;
+      if (!sp_shmbuf_unref (self, buf, prev_buf, &tag)) {
+        if (callback)
+          callback (tag, user_data);
+        c++;
+        continue;
+      }
+    }
+    prev_buf = buf;
+  }
+
+  return c;
+}
+
 void
 sp_writer_close_client (ShmPipe * self, ShmClient * client,
     sp_buffer_free_callback callback, void *user_data)
@@ -899,6 +1704,20 @@ sp_writer_close_client (ShmPipe * self, ShmClient * client,
   shutdown (client->fd, SHUT_RDWR);
   close (client->fd);
 
+  if (client->consumer >= 0) {
+    uint32_t consumer = 1U << client->consumer;
+    unsigned int i;
+
+    /* Release everything the client still held in the ring */
+    for (i = 0; i < self->ring->n_slots; i++)
+      __atomic_and_fetch (&self->ring->hdr->slots[i].pending, ~consumer,
+          __ATOMIC_SEQ_CST);
+    self->ring->consumers &= ~consumer;
+    close (client->efd);
+
+    sp_ring_reclaim (self, callback, user_data);
+  }
+
 again:
   for (buffer = self->buffers; buffer; buffer = buffer->next) {
     int i;
@@ -993,3 +1812,107 @@ sp_writer_get_max_buf_size (ShmPipe * self)
 
   return self->shm_area->shm_area_len;
 }
+
+int
+sp_writer_enable_ring (ShmPipe * self, unsigned int n_slots)
+{
+  unsigned int size = 2;
+
+  if (self->ring || self->clients)
+    return -1;
+
+  while (size < n_slots && size < SHM_RING_MAX_SLOTS)
+    size <<= 1;
+
+  self->ring = sp_ring_new (size);
+  if (!self->ring)
+    return -1;
+
+  return 0;
+}
+
+int
+sp_writer_ring_is_full (ShmPipe * self)
+{
+  ShmRingSlot *slot;
+
+  if (!self->ring || !self->ring->consumers)
+    return 0;
+
+  slot = sp_ring_get_slot (self->ring, self->ring->hdr->head);
+
+  return __atomic_load_n (&slot->pending, __ATOMIC_ACQUIRE) != 0;
+}
+
+int
+sp_writer_ring_reclaim (ShmPipe * self, sp_buffer_free_callback callback,
+    void *user_data)
+{
+  if (!self->ring)
+    return 0;
+
+  /* Consumers releasing a slot from now on have to wake us up again */
+  sp_ring_drain (self->ring->efd);
+  __atomic_store_n (&self->ring->hdr->writer_wake, 0, __ATOMIC_SEQ_CST);
+
+  return sp_ring_reclaim (self, callback, user_data);
+}
+
+int
+sp_get_ring_fd (ShmPipe * self)
+{
+  if (self->ring)
+    return self->ring->efd;
+
+  return -1;
+}
+
+/* Returns the number of client this has successfully been sent to */
+
+int
+sp_writer_send_fd (ShmPipe * self, int fd, unsigned long offset,
+    unsigned long size, unsigned int flags, void *tag)
+{
+  ShmBuffer *sb;
+  ShmClient *client = NULL;
+  int type = COMMAND_NEW_FD_BUFFER;
+  int i = 0;
+  int c = 0;
+
+  if (self->num_clients == 0)
+    return 0;
+
+  if (flags & SP_FD_BUFFER_DMABUF)
+    type = COMMAND_NEW_DMABUF_BUFFER;
+
+  sb = spalloc_alloc (sizeof (ShmBuffer) + sizeof (int) * self->num_clients);
+  memset (sb, 0, sizeof (ShmBuffer));
+  memset (sb->clients, -1, sizeof (int) * self->num_clients);
+  sb->offset = offset;
+  sb->size = size;
+  sb->num_clients = self->num_clients;
+  sb->tag = tag;
+  sb->fd_id = ++self->next_fd_id;
+
+  for (client = self->clients; client; client = client->next) {
+    struct CommandBuffer cb = { 0 };
+    cb.payload.buffer.offset = offset;
+    cb.payload.buffer.size = size;
+    if (!send_command_fds (client->fd, &cb, type, sb->fd_id, &fd, 1))
+      continue;
+    sb->clients[i++] = client->fd;
+    c++;
+  }
+
+  if (c == 0) {
+    spalloc_free1 (sizeof (ShmBuffer) + sizeof (int) * sb->num_clients, sb);
+    return 0;
+  }
+
+  sb->use_count = c;
+
+  sb->next = self->buffers;
+  self->buffers = sb;
+
+  return c;
+}
@@ -56,6 +56,24 @@
  * buffers are no longer valid. If was valid buffer was received, the
  * client must release it with sp_client_recv_finish() when it is done
  * reading from it.
+ *
+ * Before any client connects, the writer can call sp_writer_enable_ring() to
+ * hand the buffers to the clients through a lock-free ring in shared memory
+ * instead of sending a message per buffer on the sockets. The writer then
+ * also select()s on the fd from sp_get_ring_fd() and calls
+ * sp_writer_ring_reclaim() when there is something to read from it, which
+ * gives back the buffers the clients are done with. It must not call
+ * sp_writer_send_buf() while sp_writer_ring_is_full() returns true. The
+ * reader learns about the ring from sp_client_recv(); from then on, it
+ * select()s on the fd from sp_get_ring_fd() as well, and calls
+ * sp_client_recv() until it stops returning buffers before going back to
+ * select().
+ *
+ * The writer can also pass the fd of a memfd or DMABuf it did not allocate
+ * with sp_writer_send_fd(), which is released just like the other buffers.
+ * Readers receive them with sp_client_recv_fd(), which returns a NULL buffer
+ * and the fd (that remains owned by the pipe) instead, and must release them
+ * with sp_client_recv_fd_finish(). sp_client_recv() releases them right away.
  */
 
 
@@ -80,6 +98,9 @@ typedef struct _ShmBuffer ShmBuffer;
 
 typedef void (*sp_buffer_free_callback) (void * tag, void * user_data);
 
+/* Flags of the buffers passed as a fd */
+#define SP_FD_BUFFER_DMABUF (1 << 0)
+
 ShmPipe *sp_writer_create (const char *path, size_t size, mode_t perms);
 const char *sp_writer_get_path (ShmPipe *pipe);
 void sp_writer_close (ShmPipe * self, sp_buffer_free_callback callback,
@@ -112,9 +133,21 @@ ShmBuffer *sp_writer_get_pending_buffers (ShmPipe * self);
 ShmBuffer *sp_writer_get_next_buffer (ShmBuffer * buffer);
 void *sp_writer_buf_get_tag (ShmBuffer * buffer);
 
+int sp_writer_enable_ring (ShmPipe * self, unsigned int n_slots);
+int sp_writer_ring_is_full (ShmPipe * self);
+int sp_writer_ring_reclaim (ShmPipe * self, sp_buffer_free_callback callback,
+    void * user_data);
+int sp_get_ring_fd (ShmPipe * self);
+
+int sp_writer_send_fd (ShmPipe * self, int fd, unsigned long offset,
+    unsigned long size, unsigned int flags, void * tag);
+
 ShmPipe *sp_client_open (const char *path);
 long int sp_client_recv (ShmPipe * self, char **buf);
 int sp_client_recv_finish (ShmPipe * self, char *buf);
+long int sp_client_recv_fd (ShmPipe * self, char **buf, int *fd,
+    unsigned long *offset, unsigned int *flags);
+int sp_client_recv_fd_finish (ShmPipe * self, int fd);
 void sp_client_close (ShmPipe * self);
 
 #ifdef __cplusplus
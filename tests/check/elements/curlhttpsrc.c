@@ -22,6 +22,7 @@
 
 #include <stdlib.h>
 
+#include <curl/curl.h>
 #include <gio/gio.h>
 #include <glib.h>
 #include <glib/gprintf.h>
@@ -38,6 +39,7 @@ typedef struct _GioHttpServer
   char *root;
   GSocketService *service;
   guint64 delay;
+  gboolean keep_alive;
 } GioHttpServer;
 
 typedef struct _HttpHeader
@@ -228,6 +230,7 @@ server_callback (GThreadedSocketService * service,
   HttpRequest *req = NULL;
   gboolean done = FALSE;
   gchar *version = NULL, *query;
+  guint n_served = 0;
 
   in = g_io_stream_get_input_stream (G_IO_STREAM (connection));
   out = g_io_stream_get_output_stream (G_IO_STREAM (connection));
@@ -236,10 +239,13 @@ server_callback (GThreadedSocketService * service,
 
   g_data_input_stream_set_newline_type (data, G_DATA_STREAM_NEWLINE_TYPE_ANY);
 
+next_request:
   line = g_data_input_stream_read_line (data, NULL, NULL, NULL);
 
   if (line == NULL) {
-    send_error (out, 400, "Invalid request");
+    /* the client closed a kept alive connection */
+    if (n_served == 0)
+      send_error (out, 400, "Invalid request");
     goto out;
   }
 
@@ -317,6 +323,16 @@ server_callback (GThreadedSocketService * service,
     g_usleep (server->delay);
   }
   do_get (server, req, out);
+  n_served++;
+
+  if (server->keep_alive) {
+    g_free (line);
+    http_request_free (req);
+    req = NULL;
+    version = NULL;
+    done = FALSE;
+    goto next_request;
+  }
 
 out:
   g_free (line);
@@ -887,6 +903,115 @@ GST_START_TEST (test_range_get)
 
 GST_END_TEST;
 
+/* Runs a curlhttpsrc against @server until EOS and returns its stats */
+static GstStructure *
+get_stats (GioHttpServer * server, const gchar * http_version)
+{
+  GstElement *pipe, *src, *sink;
+  GstStructure *stats;
+  GstMessage *msg;
+  GstQuery *query;
+  gchar *url;
+
+  pipe = gst_pipeline_new (NULL);
+  src = gst_element_factory_make ("curlhttpsrc", NULL);
+  fail_unless (src != NULL);
+  sink = gst_element_factory_make ("fakesink", NULL);
+  fail_unless (sink != NULL);
+  gst_bin_add_many (GST_BIN (pipe), src, sink, NULL);
+  fail_unless (gst_element_link (src, sink));
+
+  url = g_strdup_printf ("http://127.0.0.1:%u/",
+      get_port_from_server (server));
+  g_object_set (src, "location", url, NULL);
+  g_free (url);
+  if (http_version != NULL)
+    gst_util_set_object_arg (G_OBJECT (src), "http-version", http_version);
+
+  gst_element_set_state (pipe, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipe),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  query = gst_query_new_custom (GST_QUERY_CUSTOM,
+      gst_structure_new_empty ("curl-http-src-stats"));
+  fail_unless (gst_element_query (src, query));
+  stats = gst_structure_copy (gst_query_get_structure (query));
+  GST_DEBUG ("stats: %" GST_PTR_FORMAT, stats);
+  gst_query_unref (query);
+
+  gst_element_set_state (pipe, GST_STATE_NULL);
+  gst_object_unref (pipe);
+
+  return stats;
+}
+
+GST_START_TEST (test_stats_query)
+{
+  GioHttpServer *server;
+  GstStructure *stats;
+  guint64 requests = 0, new_connections = 0, reused_connections = 0;
+
+  server = run_server ();
+  fail_if (server == NULL, "Failed to start up HTTP server");
+
+  stats = get_stats (server, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "requests", &requests));
+  fail_unless (gst_structure_get_uint64 (stats, "new-connections",
+          &new_connections));
+  fail_unless (gst_structure_get_uint64 (stats, "reused-connections",
+          &reused_connections));
+  fail_unless_equals_uint64 (requests, 1);
+  fail_unless_equals_uint64 (new_connections + reused_connections, requests);
+  fail_unless_equals_string (gst_structure_get_string (stats, "http-version"),
+      "1.0");
+  gst_structure_free (stats);
+
+  stop_server (server);
+}
+
+GST_END_TEST;
+
+/* The sources only share connections through the share handle */
+#if LIBCURL_VERSION_NUM >= 0x073900
+GST_START_TEST (test_stats_connection_reuse)
+{
+  GioHttpServer *server;
+  GstStructure *stats;
+  guint64 requests = 0, new_connections = 0, reused_connections = 0;
+
+  server = run_server ();
+  fail_if (server == NULL, "Failed to start up HTTP server");
+  server->keep_alive = TRUE;
+
+  /* the first source has to open the connection */
+  stats = get_stats (server, "1.1");
+  fail_unless (gst_structure_get_uint64 (stats, "new-connections",
+          &new_connections));
+  fail_unless_equals_uint64 (new_connections, 1);
+  fail_unless_equals_string (gst_structure_get_string (stats, "http-version"),
+      "1.1");
+  gst_structure_free (stats);
+
+  /* the second one finds it in the connection cache shared by all sources */
+  stats = get_stats (server, "1.1");
+  fail_unless (gst_structure_get_uint64 (stats, "requests", &requests));
+  fail_unless (gst_structure_get_uint64 (stats, "new-connections",
+          &new_connections));
+  fail_unless (gst_structure_get_uint64 (stats, "reused-connections",
+          &reused_connections));
+  fail_unless_equals_uint64 (requests, 1);
+  fail_unless (reused_connections >= 1);
+  fail_unless_equals_uint64 (new_connections + reused_connections, requests);
+  gst_structure_free (stats);
+
+  stop_server (server);
+}
+
+GST_END_TEST;
+#endif
+
 static Suite *
 curlhttpsrc_suite (void)
 {
@@ -911,6 +1036,10 @@ curlhttpsrc_suite (void)
   tcase_add_test (tc_chain, test_cookies);
   tcase_add_test (tc_chain, test_multiple_http_requests);
   tcase_add_test (tc_chain, test_range_get);
+  tcase_add_test (tc_chain, test_stats_query);
+#if LIBCURL_VERSION_NUM >= 0x073900
+  tcase_add_test (tc_chain, test_stats_connection_reuse);
+#endif
 
   return s;
 }
@@ -4969,6 +4969,203 @@ GST_START_TEST (dash_mpdparser_segment_timeline)
 
 GST_END_TEST;
 
+/*
+ * Test that consecutive S nodes of a SegmentTimeline are kept as runs and
+ * that seeking finds the right repetition in them
+ *
+ */
+GST_START_TEST (dash_mpdparser_segment_timeline_runs)
+{
+  GList *adaptationSets;
+  GstMPDAdaptationSetNode *adapt_set;
+  GstActiveStream *activeStream;
+  GstMediaSegment *segment;
+  GstClockTime final_ts;
+
+  const gchar *xml =
+      "<?xml version=\"1.0\"?>"
+      "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\""
+      "     profiles=\"urn:mpeg:dash:profile:isoff-main:2011\""
+      "     mediaPresentationDuration=\"P0Y0M0DT0H0M12S\">"
+      "  <Period start=\"P0Y0M0DT0H0M0S\">"
+      "    <AdaptationSet mimeType=\"video/mp4\">"
+      "      <Representation id=\"1\" bandwidth=\"250000\">"
+      "        <SegmentTemplate media=\"TestMedia$Number$\" timescale=\"1\">"
+      "          <SegmentTimeline>"
+      "            <S d=\"2\"></S>"
+      "            <S d=\"2\"></S>"
+      "            <S d=\"2\"></S>"
+      "            <S d=\"3\" r=\"1\"></S>"
+      "          </SegmentTimeline>"
+      "        </SegmentTemplate>"
+      "      </Representation></AdaptationSet></Period></MPD>";
+
+  gboolean ret;
+  GstMPDClient *mpdclient = gst_mpd_client_new ();
+
+  ret = gst_mpd_client_parse (mpdclient, xml, (gint) strlen (xml));
+  assert_equals_int (ret, TRUE);
+
+  /* process the xml data */
+  ret =
+      gst_mpd_client_setup_media_presentation (mpdclient, GST_CLOCK_TIME_NONE,
+      -1, NULL);
+  assert_equals_int (ret, TRUE);
+
+  /* get the list of adaptation sets of the first period */
+  adaptationSets = gst_mpd_client_get_adaptation_sets (mpdclient);
+  fail_if (adaptationSets == NULL);
+
+  /* setup streaming from the first adaptation set */
+  adapt_set = (GstMPDAdaptationSetNode *) g_list_nth_data (adaptationSets, 0);
+  fail_if (adapt_set == NULL);
+  ret = gst_mpd_client_setup_streaming (mpdclient, adapt_set);
+  assert_equals_int (ret, TRUE);
+
+  activeStream = gst_mpd_client_get_active_stream_by_index (mpdclient, 0);
+  fail_if (activeStream == NULL);
+
+  /* the first three S nodes are merged into one run */
+  assert_equals_int (activeStream->segments->len, 2);
+  segment = g_ptr_array_index (activeStream->segments, 0);
+  assert_equals_int (segment->number, 1);
+  assert_equals_int (segment->repeat, 2);
+  segment = g_ptr_array_index (activeStream->segments, 1);
+  assert_equals_int (segment->number, 4);
+  assert_equals_int (segment->repeat, 1);
+  assert_equals_uint64 (segment->start, 6 * GST_SECOND);
+
+  ret = gst_mpd_client_stream_seek (mpdclient, activeStream, TRUE, 0,
+      5 * GST_SECOND, &final_ts);
+  assert_equals_int (ret, TRUE);
+  assert_equals_int (activeStream->segment_index, 0);
+  assert_equals_int (activeStream->segment_repeat_index, 2);
+  assert_equals_uint64 (final_ts, 4 * GST_SECOND);
+
+  /* snapping after moves to the last repetition of the run */
+  ret = gst_mpd_client_stream_seek (mpdclient, activeStream, TRUE,
+      GST_SEEK_FLAG_SNAP_AFTER, 3 * GST_SECOND, &final_ts);
+  assert_equals_int (ret, TRUE);
+  assert_equals_int (activeStream->segment_index, 0);
+  assert_equals_int (activeStream->segment_repeat_index, 2);
+  assert_equals_uint64 (final_ts, 4 * GST_SECOND);
+
+  ret = gst_mpd_client_stream_seek (mpdclient, activeStream, TRUE,
+      GST_SEEK_FLAG_SNAP_AFTER, 7 * GST_SECOND, &final_ts);
+  assert_equals_int (ret, TRUE);
+  assert_equals_int (activeStream->segment_index, 1);
+  assert_equals_int (activeStream->segment_repeat_index, 1);
+  assert_equals_uint64 (final_ts, 9 * GST_SECOND);
+
+  ret = gst_mpd_client_stream_seek (mpdclient, activeStream, TRUE, 0,
+      13 * GST_SECOND, NULL);
+  assert_equals_int (ret, FALSE);
+
+  gst_mpd_client_free (mpdclient);
+}
+
+GST_END_TEST;
+
+/*
+ * Test that a refresh of a dynamic MPD shares the nodes that didn't change
+ * with the previous manifest, and parses the others again
+ *
+ */
+GST_START_TEST (dash_mpdparser_update_reuse_nodes)
+{
+  GstMPDPeriodNode *old_period, *new_period;
+  GstMPDAdaptationSetNode *old_adapt_set, *new_adapt_set;
+  GstMPDRepresentationNode *old_rep, *new_rep;
+  const gchar *xml_template =
+      "<?xml version=\"1.0\"?>"
+      "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\""
+      "     profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+      "     type=\"dynamic\""
+      "     availabilityStartTime=\"2015-03-24T0:0:0\">"
+      "  <Period id=\"Period0\" start=\"P0S\" duration=\"P0DT10S\">"
+      "    <AdaptationSet id=\"1\" mimeType=\"video/mp4\">"
+      "      <Representation id=\"v0\" bandwidth=\"250000\">"
+      "      </Representation>"
+      "    </AdaptationSet>"
+      "  </Period>"
+      "  <Period id=\"Period1\">"
+      "    <AdaptationSet id=\"1\" mimeType=\"video/mp4\">"
+      "      <Representation id=\"v0\" bandwidth=\"250000\">"
+      "        <SegmentTemplate media=\"v0-$Number$.mp4\" duration=\"1\""
+      "                         startNumber=\"1\">"
+      "        </SegmentTemplate>"
+      "      </Representation>"
+      "      <Representation id=\"v1\" bandwidth=\"500000\">"
+      "        <SegmentTemplate media=\"v1-$Number$.mp4\" duration=\"1\""
+      "                         startNumber=\"%u\">"
+      "        </SegmentTemplate>"
+      "      </Representation>"
+      "    </AdaptationSet>"
+      "    <AdaptationSet id=\"2\" mimeType=\"audio/mp4\">"
+      "      <Representation id=\"a0\" bandwidth=\"64000\">"
+      "      </Representation>"
+      "    </AdaptationSet>"
+      "  </Period></MPD>";
+
+  gboolean ret;
+  gchar *xml;
+  GstMPDClient *old_client = gst_mpd_client_new ();
+  GstMPDClient *new_client = gst_mpd_client_new ();
+
+  xml = g_strdup_printf (xml_template, 1);
+  ret = gst_mpd_client_parse (old_client, xml, (gint) strlen (xml));
+  assert_equals_int (ret, TRUE);
+  g_free (xml);
+
+  xml = g_strdup_printf (xml_template, 2);
+  ret = gst_mpd_client_parse_update (new_client, old_client, xml,
+      (gint) strlen (xml));
+  assert_equals_int (ret, TRUE);
+  g_free (xml);
+
+  /* the first Period is the same in both manifests */
+  old_period = g_list_nth_data (old_client->mpd_root_node->Periods, 0);
+  new_period = g_list_nth_data (new_client->mpd_root_node->Periods, 0);
+  fail_unless (old_period == new_period);
+
+  /* the second one changed, but only in the video AdaptationSet */
+  old_period = g_list_nth_data (old_client->mpd_root_node->Periods, 1);
+  new_period = g_list_nth_data (new_client->mpd_root_node->Periods, 1);
+  fail_unless (old_period != new_period);
+  assert_equals_string (new_period->id, "Period1");
+
+  old_adapt_set = g_list_nth_data (old_period->AdaptationSets, 1);
+  new_adapt_set = g_list_nth_data (new_period->AdaptationSets, 1);
+  fail_unless (old_adapt_set == new_adapt_set);
+
+  old_adapt_set = g_list_nth_data (old_period->AdaptationSets, 0);
+  new_adapt_set = g_list_nth_data (new_period->AdaptationSets, 0);
+  fail_unless (old_adapt_set != new_adapt_set);
+
+  /* and there, only in the second Representation */
+  old_rep = g_list_nth_data (old_adapt_set->Representations, 0);
+  new_rep = g_list_nth_data (new_adapt_set->Representations, 0);
+  fail_unless (old_rep == new_rep);
+
+  old_rep = g_list_nth_data (old_adapt_set->Representations, 1);
+  new_rep = g_list_nth_data (new_adapt_set->Representations, 1);
+  fail_unless (old_rep != new_rep);
+  assert_equals_uint64 (GST_MPD_MULT_SEGMENT_BASE_NODE (new_rep->
+          SegmentTemplate)->startNumber, 2);
+
+  /* the shared nodes outlive the previous manifest */
+  gst_mpd_client_free (old_client);
+  new_period = g_list_nth_data (new_client->mpd_root_node->Periods, 0);
+  assert_equals_string (new_period->id, "Period0");
+  new_adapt_set = new_period->AdaptationSets->data;
+  new_rep = new_adapt_set->Representations->data;
+  assert_equals_string (new_rep->id, "v0");
+
+  gst_mpd_client_free (new_client);
+}
+
+GST_END_TEST;
+
 /*
  * Test SegmentList with multiple inherited segmentURLs
  *
@@ -6483,6 +6680,8 @@ dash_suite (void)
   tcase_add_test (tc_complexMPD, dash_mpdparser_segment_list);
   tcase_add_test (tc_complexMPD, dash_mpdparser_segment_template);
   tcase_add_test (tc_complexMPD, dash_mpdparser_segment_timeline);
+  tcase_add_test (tc_complexMPD, dash_mpdparser_segment_timeline_runs);
+  tcase_add_test (tc_complexMPD, dash_mpdparser_update_reuse_nodes);
   tcase_add_test (tc_complexMPD, dash_mpdparser_multiple_inherited_segmentURL);
 
   /* tests checking the parsing of missing/incomplete attributes of xml */
@@ -0,0 +1,141 @@
+/* GStreamer
+ *
+ * unit test for the geometric transform elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define WIDTH 320
+#define HEIGHT 240
+
+static GstBuffer *
+create_frame (const gchar * format)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *buf;
+  guint8 *data;
+  gint x, y, i, stride, pixel_stride;
+
+  gst_video_info_set_format (&info, gst_video_format_from_string (format),
+      WIDTH, HEIGHT);
+  buf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  fail_unless (gst_video_frame_map (&frame, &info, buf, GST_MAP_WRITE));
+
+  /* a different value for every component of every pixel around, so that
+   * interpolating between neighbours gives something else than either */
+  data = GST_VIDEO_FRAME_PLANE_DATA (&frame, 0);
+  stride = GST_VIDEO_FRAME_PLANE_STRIDE (&frame, 0);
+  pixel_stride = GST_VIDEO_FRAME_COMP_PSTRIDE (&frame, 0);
+  for (y = 0; y < HEIGHT; y++)
+    for (x = 0; x < WIDTH; x++)
+      for (i = 0; i < pixel_stride; i++)
+        data[y * stride + x * pixel_stride + i] = x * 7 + y * 13 + i * 61;
+
+  gst_video_frame_unmap (&frame);
+
+  return buf;
+}
+
+static GstBuffer *
+transform (const gchar * format, const gchar * interpolation, guint n_threads)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  gchar *caps;
+
+  h = gst_harness_new ("rotate");
+  g_object_set (h->element, "angle", 0.3, "n-threads", n_threads, NULL);
+  gst_util_set_object_arg (G_OBJECT (h->element), "interpolation",
+      interpolation);
+
+  caps = g_strdup_printf ("video/x-raw, format = (string) %s, "
+      "width = (int) %d, height = (int) %d, framerate = (fraction) 30/1",
+      format, WIDTH, HEIGHT);
+  gst_harness_set_caps_str (h, caps, caps);
+  g_free (caps);
+
+  buf = gst_harness_push_and_pull (h, create_frame (format));
+  fail_unless (buf != NULL);
+
+  gst_harness_teardown (h);
+
+  return buf;
+}
+
+/* Several threads filling bands of rows must give exactly the output of a
+ * single one */
+static void
+check_threads (const gchar * format, const gchar * interpolation)
+{
+  GstBuffer *single, *multi;
+  GstMapInfo single_map, multi_map;
+
+  single = transform (format, interpolation, 1);
+  multi = transform (format, interpolation, 4);
+
+  fail_unless (gst_buffer_map (single, &single_map, GST_MAP_READ));
+  fail_unless (gst_buffer_map (multi, &multi_map, GST_MAP_READ));
+  fail_unless_equals_int (single_map.size, multi_map.size);
+  fail_unless (memcmp (single_map.data, multi_map.data, single_map.size) == 0,
+      "%s %s output differs with several threads", format, interpolation);
+  gst_buffer_unmap (single, &single_map);
+  gst_buffer_unmap (multi, &multi_map);
+
+  gst_buffer_unref (single);
+  gst_buffer_unref (multi);
+}
+
+GST_START_TEST (test_threads_nearest)
+{
+  check_threads ("RGBx", "nearest");
+  check_threads ("GRAY8", "nearest");
+  check_threads ("GRAY16_LE", "nearest");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_threads_bilinear)
+{
+  check_threads ("RGBx", "bilinear");
+  check_threads ("GRAY8", "bilinear");
+  check_threads ("GRAY16_LE", "bilinear");
+}
+
+GST_END_TEST;
+
+static Suite *
+geometrictransform_suite (void)
+{
+  Suite *s = suite_create ("geometrictransform");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_threads_nearest);
+  tcase_add_test (tc_chain, test_threads_bilinear);
+
+  return s;
+}
+
+GST_CHECK_MAIN (geometrictransform);
@@ -1257,6 +1257,52 @@ GST_START_TEST (test_parse_skip_to_4bytes_sc)
 
 GST_END_TEST;
 
+GST_START_TEST (test_parse_bs_to_avc_shared_memory)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  GstMapInfo map;
+  const guint8 *nals[] = { h264_sps, h264_pps, h264_idrframe };
+  const gsize sizes[] = { sizeof (h264_sps), sizeof (h264_pps),
+    sizeof (h264_idrframe)
+  };
+  gsize offset = 0;
+  gint i;
+
+  h = gst_harness_new ("h264parse");
+
+  gst_harness_set_caps_str (h, "video/x-h264, stream-format=byte-stream",
+      "video/x-h264, stream-format=avc, alignment=au");
+
+  buf = composite_buffer (100, 0, 3, h264_sps, sizeof (h264_sps),
+      h264_pps, sizeof (h264_pps), h264_idrframe, sizeof (h264_idrframe));
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 1);
+
+  buf = gst_harness_pull (h);
+  /* start codes get replaced by length prefixes, the NAL payloads are
+   * shared with the input rather than copied into a single memory */
+  fail_unless (gst_buffer_n_memory (buf) > 1);
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size,
+      sizeof (h264_sps) + sizeof (h264_pps) + sizeof (h264_idrframe));
+  for (i = 0; i < G_N_ELEMENTS (nals); i++) {
+    fail_unless_equals_int (GST_READ_UINT32_BE (map.data + offset),
+        sizes[i] - 4);
+    fail_unless (gst_buffer_memcmp (buf, offset + 4, nals[i] + 4,
+            sizes[i] - 4) == 0);
+    offset += sizes[i];
+  }
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 
 /*
  * TODO:
@@ -1369,6 +1415,7 @@ main (int argc, char **argv)
     tcase_add_test (tc_chain, test_parse_sei_closedcaptions);
     tcase_add_test (tc_chain, test_parse_compatible_caps);
     tcase_add_test (tc_chain, test_parse_skip_to_4bytes_sc);
+    tcase_add_test (tc_chain, test_parse_bs_to_avc_shared_memory);
     nf += gst_check_run_suite (s, "h264parse", __FILE__);
   }
 
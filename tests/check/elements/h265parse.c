@@ -1051,6 +1051,53 @@ GST_START_TEST (test_drain)
 
 GST_END_TEST;
 
+GST_START_TEST (test_parse_bs_to_hvc1_shared_memory)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  GstMapInfo map;
+  const guint8 *nals[] = { h265_vps, h265_sps, h265_pps, h265_idr };
+  const gsize sizes[] = { sizeof (h265_vps), sizeof (h265_sps),
+    sizeof (h265_pps), sizeof (h265_idr)
+  };
+  gsize offset = 0;
+  gint i;
+
+  h = gst_harness_new ("h265parse");
+
+  gst_harness_set_caps_str (h, "video/x-h265, stream-format=byte-stream",
+      "video/x-h265, stream-format=hvc1, alignment=au");
+
+  buf = composite_buffer (100, 0, 4, h265_vps, sizeof (h265_vps),
+      h265_sps, sizeof (h265_sps), h265_pps, sizeof (h265_pps),
+      h265_idr, sizeof (h265_idr));
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 1);
+
+  buf = gst_harness_pull (h);
+  /* start codes get replaced by length prefixes, the NAL payloads are
+   * shared with the input rather than copied into a single memory */
+  fail_unless (gst_buffer_n_memory (buf) > 1);
+
+  gst_buffer_map (buf, &map, GST_MAP_READ);
+  fail_unless_equals_int (map.size, sizeof (h265_vps) + sizeof (h265_sps) +
+      sizeof (h265_pps) + sizeof (h265_idr));
+  for (i = 0; i < G_N_ELEMENTS (nals); i++) {
+    fail_unless_equals_int (GST_READ_UINT32_BE (map.data + offset),
+        sizes[i] - 4);
+    fail_unless (gst_buffer_memcmp (buf, offset + 4, nals[i] + 4,
+            sizes[i] - 4) == 0);
+    offset += sizes[i];
+  }
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 
 static Suite *
 h265parse_harnessed_suite (void)
@@ -1087,6 +1134,8 @@ h265parse_harnessed_suite (void)
 
   tcase_add_test (tc_chain, test_drain);
 
+  tcase_add_test (tc_chain, test_parse_bs_to_hvc1_shared_memory);
+
   return s;
 }
 
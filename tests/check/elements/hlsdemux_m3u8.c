@@ -714,6 +714,107 @@ GST_START_TEST (test_update_playlist)
 
 GST_END_TEST;
 
+GST_START_TEST (test_update_playlist_incremental)
+{
+  GstHLSMasterPlaylist *master;
+  GstM3U8 *pl;
+  GstM3U8MediaFile *file, *kept;
+  gboolean ret;
+
+  master = load_playlist (LIVE_PLAYLIST);
+  pl = master->default_variant->m3u8;
+  kept = g_list_nth_data (pl->files, 2);
+  assert_equals_int (kept->sequence, 2682);
+
+  /* Segments that stay in the playlist are not parsed again */
+  ret = gst_m3u8_update (pl, g_strdup ("#EXTM3U\n\
+#EXT-X-TARGETDURATION:8\n\
+#EXT-X-MEDIA-SEQUENCE:2681\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2681.ts\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2682.ts\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2683.ts\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2684.ts"));
+  assert_equals_int (ret, TRUE);
+  assert_equals_int (g_list_length (pl->files), 4);
+  file = GST_M3U8_MEDIA_FILE (g_list_first (pl->files)->data);
+  assert_equals_int (file->sequence, 2681);
+  fail_unless (g_list_nth_data (pl->files, 1) == kept);
+  file = GST_M3U8_MEDIA_FILE (g_list_last (pl->files)->data);
+  assert_equals_int (file->sequence, 2684);
+  assert_equals_string (file->uri,
+      "https://priv.example.com/fileSequence2684.ts");
+
+  /* Delta update skipping the segments we already have */
+  ret = gst_m3u8_update (pl, g_strdup ("#EXTM3U\n\
+#EXT-X-TARGETDURATION:8\n\
+#EXT-X-MEDIA-SEQUENCE:2681\n\
+#EXT-X-SKIP:SKIPPED-SEGMENTS=3\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2684.ts\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2685.ts"));
+  assert_equals_int (ret, TRUE);
+  assert_equals_int (g_list_length (pl->files), 5);
+  fail_unless (g_list_nth_data (pl->files, 1) == kept);
+  file = GST_M3U8_MEDIA_FILE (g_list_last (pl->files)->data);
+  assert_equals_int (file->sequence, 2685);
+
+  file = gst_m3u8_peek_fragment (pl, TRUE, 0);
+  fail_unless (file != NULL);
+  gst_m3u8_media_file_unref (file);
+
+  /* Delta update skipping segments we never had */
+  ret = gst_m3u8_update (pl, g_strdup ("#EXTM3U\n\
+#EXT-X-TARGETDURATION:8\n\
+#EXT-X-MEDIA-SEQUENCE:2690\n\
+#EXT-X-SKIP:SKIPPED-SEGMENTS=3\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2693.ts"));
+  assert_equals_int (ret, FALSE);
+  assert_equals_int (g_list_length (pl->files), 5);
+
+  /* A refused update neither evicts nor appends anything */
+  ret = gst_m3u8_update (pl, g_strdup ("#EXTM3U\n\
+#EXT-X-TARGETDURATION:8\n\
+#EXT-X-MEDIA-SEQUENCE:2683\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2683.ts\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2684.ts\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2685.ts\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2686.ts\n\
+#EXT-X-SKIP:SKIPPED-SEGMENTS=1\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2688.ts"));
+  assert_equals_int (ret, FALSE);
+
+  ret = gst_m3u8_update (pl, g_strdup ("#EXTM3U\n\
+#EXT-X-TARGETDURATION:8\n\
+#EXT-X-MEDIA-SEQUENCE:2683\n\
+#EXTINF:8,\n\
+https://priv.example.com/fileSequence2683.ts\n\
+#EXTINF:8,\n\
+https://priv.example.com/otherSequence2684.ts"));
+  assert_equals_int (ret, FALSE);
+
+  assert_equals_int (g_list_length (pl->files), 5);
+  fail_unless (g_list_nth_data (pl->files, 1) == kept);
+  file = GST_M3U8_MEDIA_FILE (g_list_first (pl->files)->data);
+  assert_equals_int (file->sequence, 2681);
+  file = GST_M3U8_MEDIA_FILE (g_list_last (pl->files)->data);
+  assert_equals_int (file->sequence, 2685);
+
+  gst_hls_master_playlist_unref (master);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_playlist_media_files)
 {
   GstHLSMasterPlaylist *master;
@@ -1495,6 +1596,7 @@ hlsdemux_suite (void)
   tcase_add_test (tc_m3u8, test_playlist_with_encryption);
   tcase_add_test (tc_m3u8, test_update_invalid_playlist);
   tcase_add_test (tc_m3u8, test_update_playlist);
+  tcase_add_test (tc_m3u8, test_update_playlist_incremental);
   tcase_add_test (tc_m3u8, test_playlist_media_files);
   tcase_add_test (tc_m3u8, test_playlist_byte_range_media_files);
   tcase_add_test (tc_m3u8, test_get_next_fragment);
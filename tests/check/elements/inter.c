@@ -0,0 +1,323 @@
+/* GStreamer
+ *
+ * unit test for the inter elements
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+/* The pixels of frame i all have the value FIRST_FRAME_VALUE + i, so they
+ * can't be mistaken for the black frames the sources output before the
+ * sink pushed anything */
+#define FIRST_FRAME_VALUE 100
+#define VIDEO_CAPS "video/x-raw, format = (string) GRAY8, width = (int) 4, " \
+    "height = (int) 4, framerate = (fraction) 30/1"
+
+/* Sample i has the value i + 1, silence is 0. 200 samples are one period
+ * with the default period-time of 25ms and the default buffer-time of 1s
+ * keeps 8000 samples */
+#define AUDIO_RATE 8000
+#define PERIOD_SAMPLES 200
+#define BUFFER_SAMPLES 8000
+#define AUDIO_CAPS "audio/x-raw, format = (string) S16LE, " \
+    "layout = (string) interleaved, rate = (int) 8000, channels = (int) 1"
+
+/* The sink properties have to be set before it starts */
+static GstHarness *
+setup_sink (const gchar * launchline, const gchar * caps)
+{
+  GstHarness *h = gst_harness_new_parse (launchline);
+
+  gst_harness_set_src_caps_str (h, caps);
+
+  return h;
+}
+
+static GstHarness *
+setup_src (const gchar * factory, const gchar * channel)
+{
+  GstHarness *h = gst_harness_new (factory);
+
+  g_object_set (h->element, "channel", channel, NULL);
+  if (g_str_equal (factory, "intervideosrc"))
+    gst_util_set_object_arg (G_OBJECT (h->element), "mode", "all");
+  gst_harness_use_testclock (h);
+  gst_harness_play (h);
+
+  return h;
+}
+
+static void
+push_frame (GstHarness * h, guint i)
+{
+  GstBuffer *buf = gst_harness_create_buffer (h, 16);
+
+  gst_buffer_memset (buf, 0, FIRST_FRAME_VALUE + i, 16);
+  GST_BUFFER_PTS (buf) = gst_util_uint64_scale (i, GST_SECOND, 30);
+  GST_BUFFER_DURATION (buf) = gst_util_uint64_scale (1, GST_SECOND, 30);
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+}
+
+/* Lets the source output @n_cranks frames and stores the values of the
+ * ones the sink pushed in @values. The source already created its next
+ * frame before the sink pushed the latest ones, so it needs one more
+ * iteration than there are new frames. Returns the number of values */
+static guint
+pull_frames (GstHarness * h, guint n_cranks, guint8 * values)
+{
+  guint i, n = 0;
+
+  for (i = 0; i < n_cranks; i++) {
+    GstBuffer *buf;
+    GstMapInfo map;
+
+    fail_unless (gst_harness_crank_single_clock_wait (h));
+    buf = gst_harness_pull (h);
+    fail_unless (buf != NULL);
+
+    /* repeats of the previous frame are flagged as gap */
+    if (!GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_GAP)) {
+      fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+      if (map.data[0] >= FIRST_FRAME_VALUE)
+        values[n++] = map.data[0];
+      gst_buffer_unmap (buf, &map);
+    }
+    gst_buffer_unref (buf);
+  }
+
+  return n;
+}
+
+static void
+push_audio (GstHarness * h, guint first_sample, guint n_samples)
+{
+  GstBuffer *buf = gst_harness_create_buffer (h, n_samples * 2);
+  GstMapInfo map;
+  guint i;
+
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_WRITE));
+  for (i = 0; i < n_samples; i++)
+    GST_WRITE_UINT16_LE (map.data + 2 * i, first_sample + i + 1);
+  gst_buffer_unmap (buf, &map);
+
+  GST_BUFFER_PTS (buf) = gst_util_uint64_scale (first_sample, GST_SECOND,
+      AUDIO_RATE);
+  GST_BUFFER_DURATION (buf) = gst_util_uint64_scale (n_samples, GST_SECOND,
+      AUDIO_RATE);
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+}
+
+/* Same as pull_frames() for audio, appends the samples that are not
+ * silence to @samples */
+static void
+pull_audio (GstHarness * h, guint n_cranks, GArray * samples)
+{
+  guint i, j;
+
+  for (i = 0; i < n_cranks; i++) {
+    GstBuffer *buf;
+    GstMapInfo map;
+
+    fail_unless (gst_harness_crank_single_clock_wait (h));
+    buf = gst_harness_pull (h);
+    fail_unless (buf != NULL);
+
+    fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+    for (j = 0; j + 1 < map.size; j += 2) {
+      guint16 sample = GST_READ_UINT16_LE (map.data + j);
+
+      if (sample != 0)
+        g_array_append_val (samples, sample);
+    }
+    gst_buffer_unmap (buf, &map);
+    gst_buffer_unref (buf);
+  }
+}
+
+static void
+check_samples (GArray * samples, guint first_sample, guint n_samples)
+{
+  guint i;
+
+  fail_unless_equals_int (samples->len, n_samples);
+  for (i = 0; i < n_samples; i++)
+    fail_unless_equals_int (g_array_index (samples, guint16, i),
+        first_sample + i + 1);
+}
+
+GST_START_TEST (test_video_every_frame)
+{
+  GstHarness *sink, *src1, *src2;
+  guint8 values1[16], values2[16];
+  guint i, n;
+
+  src1 = setup_src ("intervideosrc", "video-every-frame");
+  src2 = setup_src ("intervideosrc", "video-every-frame");
+  sink = setup_sink ("intervideosink channel=video-every-frame sync=false",
+      VIDEO_CAPS);
+
+  for (i = 0; i < 10; i++)
+    push_frame (sink, i);
+
+  /* both sources get all frames in order, neither takes them away from
+   * the other one */
+  n = pull_frames (src1, 12, values1);
+  fail_unless_equals_int (n, 10);
+  n = pull_frames (src2, 12, values2);
+  fail_unless_equals_int (n, 10);
+  for (i = 0; i < 10; i++) {
+    fail_unless_equals_int (values1[i], FIRST_FRAME_VALUE + i);
+    fail_unless_equals_int (values2[i], FIRST_FRAME_VALUE + i);
+  }
+
+  gst_harness_teardown (src1);
+  gst_harness_teardown (src2);
+  gst_harness_teardown (sink);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_video_slow_reader)
+{
+  GstHarness *sink, *fast, *slow;
+  guint8 values[32];
+  guint i, j, n;
+
+  fast = setup_src ("intervideosrc", "video-slow-reader");
+  slow = setup_src ("intervideosrc", "video-slow-reader");
+  sink = setup_sink ("intervideosink channel=video-slow-reader sync=false "
+      "ring-size=8", VIDEO_CAPS);
+
+  /* the fast source keeps up with the sink while the slow one does not
+   * output anything */
+  n = 0;
+  for (i = 0; i < 5; i++) {
+    for (j = 0; j < 4; j++)
+      push_frame (sink, i * 4 + j);
+    n += pull_frames (fast, 6, values + n);
+  }
+  fail_unless_equals_int (n, 20);
+  for (i = 0; i < 20; i++)
+    fail_unless_equals_int (values[i], FIRST_FRAME_VALUE + i);
+
+  /* the slow source lost the frames that fell out of the ring but still
+   * gets the ones that are in it in order */
+  n = pull_frames (slow, 10, values);
+  fail_unless_equals_int (n, 8);
+  for (i = 0; i < 8; i++)
+    fail_unless_equals_int (values[i], FIRST_FRAME_VALUE + 12 + i);
+
+  gst_harness_teardown (fast);
+  gst_harness_teardown (slow);
+  gst_harness_teardown (sink);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_audio_every_chunk)
+{
+  GstHarness *sink, *src1, *src2;
+  GArray *samples1, *samples2;
+  guint i;
+
+  samples1 = g_array_new (FALSE, FALSE, sizeof (guint16));
+  samples2 = g_array_new (FALSE, FALSE, sizeof (guint16));
+
+  src1 = setup_src ("interaudiosrc", "audio-every-chunk");
+  src2 = setup_src ("interaudiosrc", "audio-every-chunk");
+  sink = setup_sink ("interaudiosink channel=audio-every-chunk sync=false",
+      AUDIO_CAPS);
+
+  for (i = 0; i < 20; i++)
+    push_audio (sink, i * PERIOD_SAMPLES, PERIOD_SAMPLES);
+
+  pull_audio (src1, 22, samples1);
+  check_samples (samples1, 0, 20 * PERIOD_SAMPLES);
+  pull_audio (src2, 22, samples2);
+  check_samples (samples2, 0, 20 * PERIOD_SAMPLES);
+
+  gst_harness_teardown (src1);
+  gst_harness_teardown (src2);
+  gst_harness_teardown (sink);
+
+  g_array_unref (samples1);
+  g_array_unref (samples2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_audio_slow_reader)
+{
+  GstHarness *sink, *fast, *slow;
+  GArray *samples;
+  guint i, first, last;
+
+  samples = g_array_new (FALSE, FALSE, sizeof (guint16));
+
+  fast = setup_src ("interaudiosrc", "audio-slow-reader");
+  slow = setup_src ("interaudiosrc", "audio-slow-reader");
+  sink = setup_sink ("interaudiosink channel=audio-slow-reader sync=false",
+      AUDIO_CAPS);
+
+  /* push more than buffer-time while only the fast source reads */
+  for (i = 0; i < 60; i++) {
+    push_audio (sink, i * PERIOD_SAMPLES, PERIOD_SAMPLES);
+    pull_audio (fast, 2, samples);
+  }
+  pull_audio (fast, 2, samples);
+  check_samples (samples, 0, 60 * PERIOD_SAMPLES);
+
+  /* the slow source gets at least buffer-time of the most recent samples
+   * without a hole */
+  g_array_set_size (samples, 0);
+  pull_audio (slow, BUFFER_SAMPLES / PERIOD_SAMPLES + 4, samples);
+  fail_unless (samples->len >= BUFFER_SAMPLES);
+  first = g_array_index (samples, guint16, 0) - 1;
+  last = g_array_index (samples, guint16, samples->len - 1);
+  fail_unless_equals_int (last, 60 * PERIOD_SAMPLES);
+  check_samples (samples, first, last - first);
+
+  gst_harness_teardown (fast);
+  gst_harness_teardown (slow);
+  gst_harness_teardown (sink);
+
+  g_array_unref (samples);
+}
+
+GST_END_TEST;
+
+static Suite *
+inter_suite (void)
+{
+  Suite *s = suite_create ("inter");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_video_every_frame);
+  tcase_add_test (tc_chain, test_video_slow_reader);
+  tcase_add_test (tc_chain, test_audio_every_chunk);
+  tcase_add_test (tc_chain, test_audio_slow_reader);
+
+  return s;
+}
+
+GST_CHECK_MAIN (inter);
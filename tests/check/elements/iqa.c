@@ -0,0 +1,178 @@
+/* GStreamer
+ *
+ * unit test for iqa element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <math.h>
+
+#include <gst/gst.h>
+#include <gst/check/gstcheck.h>
+
+#define SOLID_SRC(color) \
+    "videotestsrc num-buffers=1 pattern=solid-color " \
+    "foreground-color=" color " ! " \
+    "video/x-raw,format=RGBA,width=320,height=240,framerate=30/1"
+
+#define C1 (.01 * .01 * 255 * 255 * 64)
+
+/* Runs @pipeline_string to EOS and returns a copy of the first structure
+ * posted by the iqa element */
+static GstStructure *
+run_iqa (const gchar * pipeline_string)
+{
+  GstElement *pipeline;
+  GstBus *bus;
+  GstMessage *msg;
+  GstStructure *result = NULL;
+  gboolean done = FALSE;
+
+  pipeline = gst_parse_launch (pipeline_string, NULL);
+  fail_unless (pipeline != NULL);
+
+  bus = gst_element_get_bus (pipeline);
+  fail_unless_equals_int (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING), GST_STATE_CHANGE_ASYNC);
+
+  while (!done) {
+    msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+        GST_MESSAGE_ELEMENT | GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+
+    switch (GST_MESSAGE_TYPE (msg)) {
+      case GST_MESSAGE_ELEMENT:
+        if (!result && gst_message_has_name (msg, "IQA"))
+          result = gst_structure_copy (gst_message_get_structure (msg));
+        break;
+      case GST_MESSAGE_EOS:
+        done = TRUE;
+        break;
+      default:
+        fail ("Unexpected message %" GST_PTR_FORMAT, msg);
+        break;
+    }
+    gst_message_unref (msg);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  fail_unless (result != NULL);
+
+  return result;
+}
+
+static gdouble
+get_score (const GstStructure * s, const gchar * metric, const gchar * pad)
+{
+  const GstStructure *scores;
+  gdouble score;
+
+  fail_unless (gst_structure_get (s, metric, GST_TYPE_STRUCTURE, &scores,
+          NULL));
+  fail_unless (gst_structure_get_double (scores, pad, &score));
+  gst_structure_free ((GstStructure *) scores);
+
+  return score;
+}
+
+GST_START_TEST (test_iqa_identical)
+{
+  GstStructure *s;
+
+  s = run_iqa (SOLID_SRC ("0xff808080") " ! iqa name=iqa do-psnr=true "
+      "do-ssim=true ! fakesink " SOLID_SRC ("0xff808080") " ! iqa.");
+
+  fail_unless (isinf (get_score (s, "psnr", "sink_1")));
+  fail_unless_equals_float (get_score (s, "ssim", "sink_1"), 1.0);
+  fail_if (gst_structure_has_field (s, "dssim"));
+
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_iqa_offset)
+{
+  GstStructure *s;
+  gdouble expected_psnr, expected_ssim;
+  guint n_threads;
+
+  /* A flat offset of 10 on every component, so with no variance SSIM
+   * reduces to its luminance term, from the sums over 8x8 windows */
+  expected_psnr = 10.0 * log10 (255.0 * 255.0 / 100.0);
+  expected_ssim = (2.0 * (64 * 128) * (64 * 138) + C1) /
+      ((64.0 * 128) * (64 * 128) + (64.0 * 138) * (64 * 138) + C1);
+
+  /* The scores must not depend on how the frame is split in bands */
+  for (n_threads = 1; n_threads <= 4; n_threads += 3) {
+    gchar *pipeline_string;
+
+    pipeline_string = g_strdup_printf (SOLID_SRC ("0xff808080")
+        " ! iqa name=iqa do-psnr=true do-ssim=true n-threads=%u ! fakesink "
+        SOLID_SRC ("0xff8a8a8a") " ! iqa. " SOLID_SRC ("0xff808080")
+        " ! iqa.", n_threads);
+    s = run_iqa (pipeline_string);
+    g_free (pipeline_string);
+
+    fail_unless (fabs (get_score (s, "psnr", "sink_1") - expected_psnr) <
+        1e-6);
+    fail_unless (fabs (get_score (s, "ssim", "sink_1") - expected_ssim) <
+        1e-6);
+    fail_unless (isinf (get_score (s, "psnr", "sink_2")));
+    fail_unless_equals_float (get_score (s, "ssim", "sink_2"), 1.0);
+
+    gst_structure_free (s);
+  }
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_iqa_psnr_only)
+{
+  GstStructure *s;
+
+  s = run_iqa (SOLID_SRC ("0xff808080") " ! iqa name=iqa do-psnr=true "
+      "! fakesink " SOLID_SRC ("0xff808080") " ! iqa.");
+
+  fail_unless (gst_structure_has_field (s, "psnr"));
+  fail_if (gst_structure_has_field (s, "ssim"));
+
+  gst_structure_free (s);
+}
+
+GST_END_TEST;
+
+static Suite *
+iqa_suite (void)
+{
+  Suite *s = suite_create ("iqa");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_iqa_identical);
+  tcase_add_test (tc_chain, test_iqa_offset);
+  tcase_add_test (tc_chain, test_iqa_psnr_only);
+
+  return s;
+}
+
+GST_CHECK_MAIN (iqa);
@@ -21,6 +21,8 @@
 #include <gst/gst.h>
 #include <gst/check/gstcheck.h>
 #include <gst/check/gstharness.h>
+#include <glib/gstdio.h>
+#include <string.h>
 
 #define PACKETSIZE 188
 
@@ -377,6 +379,345 @@ GST_START_TEST (test_tsdemux_simple)
 
 GST_END_TEST;
 
+GST_START_TEST (test_tsdemux_skip_other_pids)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("tsdemux", "sink", NULL);
+  GstBuffer *buf;
+  GstCaps *caps;
+  GstSegment segment;
+  GstMapInfo map;
+  guint8 other_pid_ts[PACKETSIZE], *data;
+  guint i, j, n_packets;
+
+  caps = gst_caps_from_string ("video/mpegts,systemstream=true");
+  gst_harness_push_event (h, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_harness_push_event (h, gst_event_new_segment (&segment));
+
+  gst_harness_set_sink_caps_str (h,
+      "audio/mpeg,mpegversion=4,stream-format=adts");
+
+  g_signal_connect (h->element, "pad-added",
+      G_CALLBACK (tsdemux_simple_pad_added), h);
+
+  /* payload only packets of a PID that isn't in the program */
+  memcpy (other_pid_ts, padding_ts, PACKETSIZE);
+  other_pid_ts[1] = 0x01;
+  other_pid_ts[2] = 0x00;
+
+  /* Each packet of the program is followed by a run of packets to skip,
+   * and the stream ends with one of the other PID that has an adaptation
+   * field, which is never skipped */
+  n_packets = aac_ts_packets * 41 + 1;
+  buf = gst_buffer_new_allocate (NULL, n_packets * PACKETSIZE, NULL);
+  gst_buffer_map (buf, &map, GST_MAP_WRITE);
+  data = map.data;
+  for (i = 0; i < aac_ts_packets; i++) {
+    memcpy (data, aac_ts + i * PACKETSIZE, PACKETSIZE);
+    data += PACKETSIZE;
+    for (j = 0; j < 40; j++) {
+      memcpy (data, j % 2 ? padding_ts : other_pid_ts, PACKETSIZE);
+      data[3] = (data[3] & 0xf0) | (j / 2 & 0x0f);
+      data += PACKETSIZE;
+    }
+  }
+  /* adaptation field only, with just the flags byte and stuffing */
+  memcpy (data, other_pid_ts, PACKETSIZE);
+  data[3] = 0x20;
+  data[4] = 183;
+  data[5] = 0x00;
+  memset (data + 6, 0xff, PACKETSIZE - 6);
+  gst_buffer_unmap (buf, &map);
+
+  fail_unless (gst_harness_push (h, buf) == GST_FLOW_OK);
+  gst_harness_push_event (h, gst_event_new_eos ());
+
+  /* the same as without the other packets */
+  buf = gst_harness_take_all_data_as_buffer (h);
+  gst_check_buffer_data (buf, aac_data, sizeof aac_data);
+  gst_buffer_unref (buf);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+#define INDEX_TEST_FRAMES 50
+#define INDEX_TEST_GOP 10
+#define INDEX_TEST_FRAME_DURATION (40 * GST_MSECOND)
+
+/* Muxes an MPEG-2 video stream of @n_frames frames of the given sizes, the
+ * bytes of each filled with its index, and with a keyframe every @gop */
+static GBytes *
+mux_video_stream (const gsize * sizes, guint n_frames, guint gop)
+{
+  GstHarness *h;
+  GstBuffer *buf;
+  GstEvent *event;
+  GBytes *bytes;
+  guint i;
+
+  h = gst_harness_new_with_padnames ("mpegtsmux", "sink_%d", "src");
+  gst_harness_set_src_caps_str (h,
+      "video/mpeg,mpegversion=(int)2,systemstream=(boolean)false");
+
+  for (i = 0; i < n_frames; i++) {
+    buf = gst_buffer_new_allocate (NULL, sizes[i], NULL);
+    gst_buffer_memset (buf, 0, i, sizes[i]);
+    GST_BUFFER_PTS (buf) = GST_BUFFER_DTS (buf) =
+        i * INDEX_TEST_FRAME_DURATION;
+    GST_BUFFER_DURATION (buf) = INDEX_TEST_FRAME_DURATION;
+    if (i % gop)
+      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+  fail_unless (gst_harness_push_event (h, gst_event_new_eos ()));
+
+  /* the muxer outputs from its own thread */
+  do {
+    event = gst_harness_pull_event (h);
+    fail_unless (event != NULL);
+    i = GST_EVENT_TYPE (event);
+    gst_event_unref (event);
+  } while (i != GST_EVENT_EOS);
+
+  bytes = gst_harness_take_all_data_as_bytes (h);
+  gst_harness_teardown (h);
+
+  return bytes;
+}
+
+/* Writes a stream with a keyframe every INDEX_TEST_GOP frames to a
+ * temporary file */
+static gchar *
+index_test_write_stream (void)
+{
+  gsize sizes[INDEX_TEST_FRAMES];
+  GBytes *bytes;
+  gchar *filename;
+  guint i;
+  gint fd;
+
+  for (i = 0; i < INDEX_TEST_FRAMES; i++)
+    sizes[i] = 2000;
+  bytes = mux_video_stream (sizes, INDEX_TEST_FRAMES, INDEX_TEST_GOP);
+
+  fd = g_file_open_tmp ("tsdemux-index-XXXXXX.ts", &filename, NULL);
+  fail_unless (fd >= 0);
+  g_close (fd, NULL);
+  fail_unless (g_file_set_contents (filename,
+          g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), NULL));
+  g_bytes_unref (bytes);
+
+  return filename;
+}
+
+static void
+index_test_handoff (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    GArray * timestamps)
+{
+  GstClockTime pts = GST_BUFFER_PTS (buf);
+
+  g_array_append_val (timestamps, pts);
+}
+
+static GstElement *
+index_test_pipeline (const gchar * filename, const gchar * index,
+    GArray * timestamps, const gchar * signal)
+{
+  GstElement *pipeline, *sink;
+  gchar *desc;
+
+  desc = g_strdup_printf ("filesrc location=\"%s\" ! "
+      "tsdemux index-location=\"%s\" ! fakesink name=sink "
+      "signal-handoffs=true sync=false", filename, index);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_unless (pipeline != NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (sink, signal, G_CALLBACK (index_test_handoff),
+      timestamps);
+  gst_object_unref (sink);
+
+  return pipeline;
+}
+
+static void
+index_test_wait (GstElement * pipeline, GstMessageType type)
+{
+  GstBus *bus = gst_element_get_bus (pipeline);
+  GstMessage *msg;
+
+  msg = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      type | GST_MESSAGE_ERROR);
+  fail_unless (msg != NULL);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), type);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+}
+
+/* Seeks into the middle of the third GOP and returns the timestamp of the
+ * first buffer prerolled after the seek */
+static GstClockTime
+index_test_seek (const gchar * filename, const gchar * index,
+    GstClockTime position)
+{
+  GstElement *pipeline;
+  GArray *timestamps;
+  GstClockTime first;
+
+  timestamps = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  pipeline = index_test_pipeline (filename, index, timestamps,
+      "preroll-handoff");
+
+  fail_if (gst_element_set_state (pipeline, GST_STATE_PAUSED) ==
+      GST_STATE_CHANGE_FAILURE);
+  index_test_wait (pipeline, GST_MESSAGE_ASYNC_DONE);
+
+  g_array_set_size (timestamps, 0);
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH, position));
+  index_test_wait (pipeline, GST_MESSAGE_ASYNC_DONE);
+
+  fail_unless (timestamps->len > 0);
+  first = g_array_index (timestamps, GstClockTime, 0);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  g_array_free (timestamps, TRUE);
+
+  return first;
+}
+
+GST_START_TEST (test_tsdemux_index)
+{
+  GstElement *pipeline;
+  GArray *timestamps;
+  GstClockTime keyframe, target;
+  gchar *filename, *index, *contents, *forged;
+  guint64 last_offset;
+  gsize length;
+  guint i;
+
+  filename = index_test_write_stream ();
+  index = g_strconcat (filename, ".idx", NULL);
+
+  /* Play it once, which builds the index and saves it when stopping */
+  timestamps = g_array_new (FALSE, FALSE, sizeof (GstClockTime));
+  pipeline = index_test_pipeline (filename, index, timestamps, "handoff");
+  fail_if (gst_element_set_state (pipeline, GST_STATE_PLAYING) ==
+      GST_STATE_CHANGE_FAILURE);
+  index_test_wait (pipeline, GST_MESSAGE_EOS);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  fail_unless_equals_int (timestamps->len, INDEX_TEST_FRAMES);
+  keyframe = g_array_index (timestamps, GstClockTime, 2 * INDEX_TEST_GOP);
+  target = g_array_index (timestamps, GstClockTime,
+      2 * INDEX_TEST_GOP + INDEX_TEST_GOP / 2);
+  g_array_free (timestamps, TRUE);
+
+  /* header and one entry per keyframe */
+  fail_unless (g_file_get_contents (index, &contents, &length, NULL));
+  fail_unless_equals_int (length,
+      32 + 16 * (INDEX_TEST_FRAMES / INDEX_TEST_GOP));
+
+  /* Reloaded, a seek starts exactly at the preceding keyframe */
+  fail_unless_equals_uint64 (index_test_seek (filename, index, target),
+      keyframe);
+
+  /* An index for an impossible PID is ignored, seeking still works */
+  forged = g_memdup (contents, length);
+  forged[12] = 0xff;
+  forged[13] = 0xff;
+  fail_unless (g_file_set_contents (index, forged, length, NULL));
+  fail_unless (index_test_seek (filename, index, target) <= target);
+
+  /* ... and so is the index of another program */
+  memcpy (forged, contents, length);
+  GST_WRITE_UINT16_LE (forged + 16, 0x1234);
+  fail_unless (g_file_set_contents (index, forged, length, NULL));
+  fail_unless (index_test_seek (filename, index, target) <= target);
+
+  /* ... or of another recording, with the same program but other offsets.
+   * Here all of them are at the end of the file, where a seek using it
+   * would end up. */
+  memcpy (forged, contents, length);
+  last_offset = GST_READ_UINT64_LE (contents + length - 8);
+  for (i = 0; i < INDEX_TEST_FRAMES / INDEX_TEST_GOP; i++)
+    GST_WRITE_UINT64_LE (forged + 32 + 16 * i + 8, last_offset + i);
+  fail_unless (g_file_set_contents (index, forged, length, NULL));
+  fail_unless (index_test_seek (filename, index, target) <= target);
+
+  g_free (forged);
+  g_free (contents);
+  g_unlink (index);
+  g_unlink (filename);
+  g_free (index);
+  g_free (filename);
+}
+
+GST_END_TEST;
+
+static void
+tsdemux_add_pad_to_harness (GstElement * tsdemux, GstPad * pad,
+    GstHarness * h)
+{
+  gst_harness_add_element_src_pad (h, pad);
+}
+
+GST_START_TEST (test_tsdemux_pes_sizes)
+{
+  /* big keyframes followed by small frames, whose buffers must not be
+   * allocated after the keyframe sizes */
+  static const gsize sizes[] = {
+    300000, 1000, 1200, 800, 250000, 500, 70000, 600, 1000, 400000, 300
+  };
+  GstHarness *h = gst_harness_new_with_padnames ("tsdemux", "sink", NULL);
+  GstBuffer *buf;
+  GstMemory *mem;
+  GBytes *bytes;
+  guint i;
+
+  bytes = mux_video_stream (sizes, G_N_ELEMENTS (sizes), 4);
+
+  gst_harness_set_src_caps_str (h, "video/mpegts,systemstream=true");
+  gst_harness_set_sink_caps_str (h, "video/mpeg");
+  g_signal_connect (h->element, "pad-added",
+      G_CALLBACK (tsdemux_add_pad_to_harness), h);
+
+  buf = gst_buffer_new_wrapped_bytes (bytes);
+  g_bytes_unref (bytes);
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  gst_harness_push_event (h, gst_event_new_eos ());
+
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h),
+      G_N_ELEMENTS (sizes));
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++) {
+    guint8 *expected = g_malloc (sizes[i]);
+
+    memset (expected, i, sizes[i]);
+    buf = gst_harness_pull (h);
+    gst_check_buffer_data (buf, expected, sizes[i]);
+    g_free (expected);
+
+    fail_unless_equals_int (gst_buffer_n_memory (buf), 1);
+    mem = gst_buffer_peek_memory (buf, 0);
+    fail_unless (mem->maxsize <= sizes[i] + 64 * 1024,
+        "buffer %u of %" G_GSIZE_FORMAT " bytes holds %" G_GSIZE_FORMAT,
+        i, sizes[i], mem->maxsize);
+
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 mpegtsdemux_suite (void)
 {
@@ -394,6 +735,9 @@ mpegtsdemux_suite (void)
   tc = tcase_create ("tsdemux");
   suite_add_tcase (s, tc);
   tcase_add_test (tc, test_tsdemux_simple);
+  tcase_add_test (tc, test_tsdemux_skip_other_pids);
+  tcase_add_test (tc, test_tsdemux_pes_sizes);
+  tcase_add_test (tc, test_tsdemux_index);
 
   return s;
 }
@@ -557,6 +557,94 @@ GST_START_TEST (test_align)
 
 GST_END_TEST;
 
+static void
+push_video_buffers (guint n_bufs, GstClockTime * ts)
+{
+  GstQuery *drain;
+  guint i;
+
+  for (i = 0; i < n_bufs; i++) {
+    GstBuffer *inbuffer = gst_buffer_new_and_alloc (2000);
+
+    GST_BUFFER_TIMESTAMP (inbuffer) = *ts;
+    if (i % KEYFRAME_DISTANCE != 0)
+      GST_BUFFER_FLAG_SET (inbuffer, GST_BUFFER_FLAG_DELTA_UNIT);
+    fail_unless_equals_int (gst_pad_push (mysrcpad, inbuffer), GST_FLOW_OK);
+    *ts += 40 * GST_MSECOND;
+  }
+
+  drain = gst_query_new_drain ();
+  gst_pad_peer_query (mysrcpad, drain);
+  gst_query_unref (drain);
+}
+
+GST_START_TEST (test_align_change)
+{
+  GstClockTime ts = 0;
+  GstElement *mux;
+  gchar *padname;
+  GstCaps *caps;
+  guint8 cc[0x2000];
+  gboolean seen[0x2000] = { FALSE, };
+  GList *l;
+
+  mux = setup_tsmux (&video_src_template, "sink_%d", &padname);
+  g_object_set (mux, "alignment", 7, NULL);
+  fail_unless (gst_element_set_state (mux,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  caps = gst_caps_from_string (VIDEO_CAPS_STRING);
+  gst_check_setup_events (mysrcpad, mux, caps, GST_FORMAT_TIME);
+  gst_caps_unref (caps);
+
+  /* the packets left in a partially filled aligned buffer when the
+   * alignment changes must come out before the later ones */
+  push_video_buffers (5, &ts);
+  g_object_set (mux, "alignment", 0, NULL);
+  push_video_buffers (5, &ts);
+  g_object_set (mux, "alignment", 7, NULL);
+  push_video_buffers (5, &ts);
+
+  fail_unless (buffers != NULL);
+
+  /* the continuity counters tell whether packets got reordered */
+  for (l = buffers; l; l = l->next) {
+    GstMapInfo map;
+    gsize offset;
+
+    fail_unless (gst_buffer_map (l->data, &map, GST_MAP_READ));
+    fail_unless_equals_int (map.size % 188, 0);
+
+    for (offset = 0; offset < map.size; offset += 188) {
+      const guint8 *packet = map.data + offset;
+      guint16 pid = GST_READ_UINT16_BE (packet + 1) & 0x1fff;
+      guint8 packet_cc = packet[3] & 0x0f;
+      gboolean has_payload = (packet[3] & 0x10) != 0;
+
+      fail_unless_equals_int (packet[0], 0x47);
+      if (pid == 0x1fff)
+        continue;
+
+      if (seen[pid]) {
+        guint8 expected = has_payload ? (cc[pid] + 1) & 0x0f : cc[pid];
+
+        fail_unless_equals_int (packet_cc, expected);
+      }
+      seen[pid] = TRUE;
+      cc[pid] = packet_cc;
+    }
+
+    gst_buffer_unmap (l->data, &map);
+  }
+
+  gst_check_drop_buffers ();
+  cleanup_tsmux (mux, padname);
+  g_free (padname);
+}
+
+GST_END_TEST;
+
 static void
 test_keyframe_propagation_check_output (GList * bufs)
 {
@@ -598,6 +686,7 @@ mpegtsmux_suite (void)
   tcase_add_test (tc_chain, test_video);
   tcase_add_test (tc_chain, test_multiple_state_change);
   tcase_add_test (tc_chain, test_align);
+  tcase_add_test (tc_chain, test_align_change);
   tcase_add_test (tc_chain, test_keyframe_flag_propagation);
   tcase_add_test (tc_chain, test_reappearing_pad_while_playing);
   tcase_add_test (tc_chain, test_reappearing_pad_while_stopped);
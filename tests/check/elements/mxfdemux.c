@@ -21,6 +21,8 @@
  */
 
 #include <gst/check/gstcheck.h>
+#include <gst/app/app.h>
+#include <glib/gstdio.h>
 #include <string.h>
 #include "mxfdemux.h"
 
@@ -287,6 +289,138 @@ GST_START_TEST (test_push)
 
 GST_END_TEST;
 
+/* More frames than mxfmux puts in one index table segment */
+#define SEEK_N_FRAMES 6000
+#define SEEK_GOP_SIZE 25
+
+static gchar *
+_create_seek_file (void)
+{
+  GstElement *pipeline, *src;
+  GstMessage *msg;
+  GstBus *bus;
+  gchar *location, *desc;
+  gint fd, i;
+
+  fd = g_file_open_tmp ("mxfdemux-XXXXXX.mxf", &location, NULL);
+  fail_unless (fd != -1);
+  g_close (fd, NULL);
+
+  desc = g_strdup_printf ("appsrc name=src format=time caps=\"video/x-h264, "
+      "stream-format=(string)byte-stream, alignment=(string)au, "
+      "width=(int)64, height=(int)64, framerate=(fraction)25/1\" ! "
+      "mxfmux ! filesink location=\"%s\"", location);
+  pipeline = gst_parse_launch (desc, NULL);
+  fail_unless (pipeline != NULL);
+  g_free (desc);
+
+  src = gst_bin_get_by_name (GST_BIN (pipeline), "src");
+  fail_unless (src != NULL);
+  fail_unless (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  /* the payload doesn't matter, the keyframes are taken from the index */
+  for (i = 0; i < SEEK_N_FRAMES; i++) {
+    GstBuffer *buffer = gst_buffer_new_allocate (NULL, 16, NULL);
+
+    gst_buffer_memset (buffer, 0, i & 0xff, 16);
+    GST_BUFFER_PTS (buffer) = gst_util_uint64_scale (i, GST_SECOND, 25);
+    GST_BUFFER_DTS (buffer) = GST_BUFFER_PTS (buffer);
+    GST_BUFFER_DURATION (buffer) = GST_SECOND / 25;
+    if (i % SEEK_GOP_SIZE != 0)
+      GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+
+    fail_unless_equals_int (gst_app_src_push_buffer (GST_APP_SRC (src),
+            buffer), GST_FLOW_OK);
+  }
+  fail_unless_equals_int (gst_app_src_end_of_stream (GST_APP_SRC (src)),
+      GST_FLOW_OK);
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (src);
+  gst_object_unref (pipeline);
+
+  return location;
+}
+
+static void
+_seek_and_check (GstElement * pipeline, GstElement * sink, guint frame,
+    guint expected_frame)
+{
+  GstSample *sample;
+  GstBuffer *buffer;
+  guint8 byte;
+
+  GST_INFO ("seeking to frame %u", frame);
+
+  fail_unless (gst_element_seek_simple (pipeline, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT |
+          GST_SEEK_FLAG_SNAP_BEFORE,
+          gst_util_uint64_scale (frame, GST_SECOND, 25)));
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE), GST_STATE_CHANGE_SUCCESS);
+
+  sample = gst_app_sink_pull_preroll (GST_APP_SINK (sink));
+  fail_unless (sample != NULL);
+  buffer = gst_sample_get_buffer (sample);
+
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer),
+      gst_util_uint64_scale (expected_frame, GST_SECOND, 25));
+  fail_if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT));
+  fail_unless_equals_int (gst_buffer_extract (buffer, 0, &byte, 1), 1);
+  fail_unless_equals_int (byte, expected_frame & 0xff);
+
+  gst_sample_unref (sample);
+}
+
+GST_START_TEST (test_seek_index)
+{
+  GstElement *pipeline, *sink;
+  gchar *location, *desc;
+
+  location = _create_seek_file ();
+
+  desc = g_strdup_printf ("filesrc location=\"%s\" ! mxfdemux ! "
+      "appsink name=sink sync=false", location);
+  pipeline = gst_parse_launch (desc, NULL);
+  fail_unless (pipeline != NULL);
+  g_free (desc);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  fail_unless (sink != NULL);
+  fail_if (gst_element_set_state (pipeline,
+          GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE);
+  fail_unless_equals_int (gst_element_get_state (pipeline, NULL, NULL,
+          GST_CLOCK_TIME_NONE), GST_STATE_CHANGE_SUCCESS);
+
+  /* within the first index table segment */
+  _seek_and_check (pipeline, sink, 1007, 1000);
+  _seek_and_check (pipeline, sink, 3000, 3000);
+  /* in the second segment, with the keyframe still in the first one */
+  _seek_and_check (pipeline, sink, 5960, 5950);
+  /* within the second segment */
+  _seek_and_check (pipeline, sink, 5999, 5975);
+  /* and back */
+  _seek_and_check (pipeline, sink, 30, 25);
+  _seek_and_check (pipeline, sink, 0, 0);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (sink);
+  gst_object_unref (pipeline);
+
+  g_unlink (location);
+  g_free (location);
+}
+
+GST_END_TEST;
+
 static Suite *
 mxfdemux_suite (void)
 {
@@ -302,6 +436,7 @@ mxfdemux_suite (void)
   tcase_set_timeout (tc_chain, 180);
   tcase_add_test (tc_chain, test_pull);
   tcase_add_test (tc_chain, test_push);
+  tcase_add_test (tc_chain, test_seek_index);
 
   return s;
 }
@@ -49,6 +49,86 @@ GST_START_TEST (netsim_stress_delayed)
 
 GST_END_TEST;
 
+GST_START_TEST (netsim_delay_in_order)
+{
+  GstHarness *h = gst_harness_new_parse ("netsim delay-probability=1.0 "
+      "min-delay=20 max-delay=40 allow-reordering=false");
+  guint i;
+
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  for (i = 0; i < 50; i++) {
+    GstBuffer *buf = gst_harness_create_buffer (h, 100);
+    GST_BUFFER_OFFSET (buf) = i;
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h, buf));
+  }
+
+  for (i = 0; i < 50; i++) {
+    GstBuffer *buf = gst_harness_pull (h);
+    fail_unless (buf != NULL);
+    fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), i);
+    gst_buffer_unref (buf);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (netsim_shaping)
+{
+  /* 8 kbps with a 1000 bits bucket: the first 800 bits buffer fits, the
+   * second one waits 75 ms for its tokens and the third one would have
+   * to wait 175 ms and is dropped */
+  GstHarness *h = gst_harness_new_parse ("netsim max-kbps=8 "
+      "max-bucket-size=1 max-queue-delay=100");
+  gint64 start;
+  guint i;
+
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < 3; i++)
+    fail_unless_equals_int (GST_FLOW_OK,
+        gst_harness_push (h, gst_harness_create_buffer (h, 100)));
+
+  gst_buffer_unref (gst_harness_pull (h));
+  gst_buffer_unref (gst_harness_pull (h));
+  fail_unless (g_get_monotonic_time () - start >= 75 * G_TIME_SPAN_MILLISECOND);
+
+  g_usleep (200 * G_TIME_SPAN_MILLISECOND);
+  fail_unless (gst_harness_try_pull (h) == NULL);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (netsim_burst_loss)
+{
+  GstHarness *h = gst_harness_new_parse ("netsim burst-enter-probability=1.0 "
+      "burst-exit-probability=0.0 burst-drop-probability=1.0");
+  guint i;
+
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  for (i = 0; i < 10; i++)
+    fail_unless_equals_int (GST_FLOW_OK,
+        gst_harness_push (h, gst_harness_create_buffer (h, 100)));
+  fail_unless_equals_int (gst_harness_buffers_received (h), 0);
+
+  /* leave the burst, the next buffer goes through */
+  g_object_set (h->element, "burst-enter-probability", 0.0,
+      "burst-exit-probability", 1.0, NULL);
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, gst_harness_create_buffer (h, 100)));
+  fail_unless_equals_int (gst_harness_buffers_received (h), 1);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 netsim_suite (void)
 {
@@ -58,6 +138,9 @@ netsim_suite (void)
   suite_add_tcase (s, (tc_chain = tcase_create ("general")));
   tcase_add_test (tc_chain, netsim_stress);
   tcase_add_test (tc_chain, netsim_stress_delayed);
+  tcase_add_test (tc_chain, netsim_delay_in_order);
+  tcase_add_test (tc_chain, netsim_shaping);
+  tcase_add_test (tc_chain, netsim_burst_loss);
 
   return s;
 }
@@ -115,6 +115,406 @@ GST_START_TEST (test_parse_zerosize_frames)
 
 GST_END_TEST;
 
+/* section header, interface description (ethernet) and enhanced packet
+ * blocks, little-endian, around the packet of pcap_frame_with_eth_padding */
+static const guint8 pcapng_header[] = {
+  0x0a, 0x0d, 0x0d, 0x0a, 0x1c, 0x00, 0x00, 0x00,
+  0x4d, 0x3c, 0x2b, 0x1a, 0x01, 0x00, 0x00, 0x00,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x1c, 0x00, 0x00, 0x00,
+  0x01, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00,
+  0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x14, 0x00, 0x00, 0x00,
+  0x06, 0x00, 0x00, 0x00, 0x5c, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x40, 0x42, 0x0f, 0x00, 0x3c, 0x00, 0x00, 0x00,
+  0x3c, 0x00, 0x00, 0x00
+};
+
+static const guint8 pcapng_trailer[] = {
+  0x5c, 0x00, 0x00, 0x00
+};
+
+GST_START_TEST (test_parse_pcapng)
+{
+  GstBuffer *in_buf, *out_buf;
+  GstHarness *h;
+  guint offset, size;
+
+  h = gst_harness_new ("pcapparse");
+
+  gst_harness_set_src_caps_str (h, "raw/x-pcap");
+
+  in_buf = gst_buffer_new ();
+  gst_buffer_append_memory (in_buf,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+          (gpointer) pcapng_header, sizeof (pcapng_header), 0,
+          sizeof (pcapng_header), NULL, NULL));
+  /* the packet data, without the pcap record header */
+  gst_buffer_append_memory (in_buf,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+          pcap_frame_with_eth_padding + 16,
+          sizeof (pcap_frame_with_eth_padding) - 16, 0,
+          sizeof (pcap_frame_with_eth_padding) - 16, NULL, NULL));
+  gst_buffer_append_memory (in_buf,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+          (gpointer) pcapng_trailer, sizeof (pcapng_trailer), 0,
+          sizeof (pcapng_trailer), NULL, NULL));
+
+  fail_unless_equals_int (gst_harness_push (h, in_buf), GST_FLOW_OK);
+
+  out_buf = gst_harness_pull (h);
+
+  offset = pcap_frame_with_eth_padding_offset;
+  size = sizeof (pcap_frame_with_eth_padding) - offset - 2;
+  fail_unless_equals_int (gst_buffer_get_size (out_buf), size);
+  fail_unless (gst_buffer_memcmp (out_buf, 0,
+          pcap_frame_with_eth_padding + offset, size) == 0);
+  /* 1000000 microseconds, the default resolution */
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (out_buf), GST_SECOND);
+
+  gst_buffer_unref (out_buf);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static GstPadProbeReturn
+count_buffers_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  guint *counts = user_data;
+  guint index;
+
+  fail_unless (g_str_has_prefix (GST_PAD_NAME (pad), "src_"));
+  index = g_ascii_strtoull (GST_PAD_NAME (pad) + 4, NULL, 10);
+  fail_unless (index < 2);
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+    counts[index] +=
+        gst_buffer_list_length (GST_PAD_PROBE_INFO_BUFFER_LIST (info));
+  else
+    counts[index]++;
+
+  return GST_PAD_PROBE_DROP;
+}
+
+static void
+pad_added_cb (GstElement * element, GstPad * pad, guint * counts)
+{
+  gst_pad_add_probe (pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      count_buffers_probe, counts, NULL);
+}
+
+GST_START_TEST (test_parse_demux)
+{
+  GstElement *pcapparse;
+  GstBuffer *in_buf;
+  GstHarness *h;
+  GstCaps *caps;
+  guint8 *other_flow;
+  guint counts[2] = { 0, 0 };
+  gsize frame_size = sizeof (pcap_frame_with_eth_padding);
+
+  pcapparse = gst_element_factory_make ("pcapparse", NULL);
+  caps = gst_caps_from_string ("application/x-rtp");
+  g_object_set (pcapparse, "demux", TRUE, "caps", caps, NULL);
+  gst_caps_unref (caps);
+  g_signal_connect (pcapparse, "pad-added", G_CALLBACK (pad_added_cb),
+      counts);
+
+  h = gst_harness_new_with_element (pcapparse, "sink", NULL);
+  gst_object_unref (pcapparse);
+
+  gst_harness_set_src_caps_str (h, "raw/x-pcap");
+
+  /* same packet, but to another UDP destination port */
+  other_flow = g_memdup (pcap_frame_with_eth_padding, frame_size);
+  other_flow[16 + 14 + 20 + 3]++;
+
+  in_buf = gst_buffer_new ();
+  gst_buffer_append_memory (in_buf,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY, pcap_header,
+          sizeof (pcap_header), 0, sizeof (pcap_header), NULL, NULL));
+  gst_buffer_append_memory (in_buf,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+          pcap_frame_with_eth_padding, frame_size, 0, frame_size, NULL, NULL));
+  gst_buffer_append_memory (in_buf,
+      gst_memory_new_wrapped (0, other_flow, frame_size, 0, frame_size,
+          other_flow, g_free));
+  gst_buffer_append_memory (in_buf,
+      gst_memory_new_wrapped (GST_MEMORY_FLAG_READONLY,
+          pcap_frame_with_eth_padding, frame_size, 0, frame_size, NULL, NULL));
+
+  fail_unless_equals_int (gst_harness_push (h, in_buf), GST_FLOW_OK);
+
+  fail_unless_equals_int (pcapparse->numsrcpads, 3);
+  fail_unless_equals_int (counts[0], 2);
+  fail_unless_equals_int (counts[1], 1);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* pull mode: a pcapng capture with two sections, served from memory */
+static GByteArray *capture;
+static GList *pulled_buffers;
+static gboolean pulled_eos;
+static GMutex pull_lock;
+static GCond pull_cond;
+
+static void
+capture_put_uint16 (guint16 val, gboolean big_endian)
+{
+  val = big_endian ? GUINT16_TO_BE (val) : GUINT16_TO_LE (val);
+  g_byte_array_append (capture, (guint8 *) & val, 2);
+}
+
+static void
+capture_put_uint32 (guint32 val, gboolean big_endian)
+{
+  val = big_endian ? GUINT32_TO_BE (val) : GUINT32_TO_LE (val);
+  g_byte_array_append (capture, (guint8 *) & val, 4);
+}
+
+static void
+capture_put_section_header (gboolean big_endian)
+{
+  capture_put_uint32 (0x0a0d0d0a, big_endian);
+  capture_put_uint32 (28, big_endian);
+  capture_put_uint32 (0x1a2b3c4d, big_endian);
+  capture_put_uint16 (1, big_endian);
+  capture_put_uint16 (0, big_endian);
+  /* unknown section length */
+  capture_put_uint32 (0xffffffff, big_endian);
+  capture_put_uint32 (0xffffffff, big_endian);
+  capture_put_uint32 (28, big_endian);
+}
+
+/* an if_tsresol of 0 keeps the default resolution of microseconds */
+static void
+capture_put_interface (guint16 linktype, guint8 tsresol, gboolean big_endian)
+{
+  guint32 len = tsresol ? 32 : 20;
+
+  capture_put_uint32 (0x00000001, big_endian);
+  capture_put_uint32 (len, big_endian);
+  capture_put_uint16 (linktype, big_endian);
+  capture_put_uint16 (0, big_endian);
+  capture_put_uint32 (0xffff, big_endian);
+  if (tsresol) {
+    const guint8 padding[3] = { 0, };
+
+    capture_put_uint16 (9, big_endian);
+    capture_put_uint16 (1, big_endian);
+    g_byte_array_append (capture, &tsresol, 1);
+    g_byte_array_append (capture, padding, 3);
+    capture_put_uint32 (0, big_endian);
+  }
+  capture_put_uint32 (len, big_endian);
+}
+
+static void
+capture_put_packet (guint32 if_id, guint64 ts, const guint8 * data,
+    guint32 size, gboolean big_endian)
+{
+  const guint8 padding[3] = { 0, };
+  guint32 len = 32 + GST_ROUND_UP_4 (size);
+
+  capture_put_uint32 (0x00000006, big_endian);
+  capture_put_uint32 (len, big_endian);
+  capture_put_uint32 (if_id, big_endian);
+  capture_put_uint32 (ts >> 32, big_endian);
+  capture_put_uint32 (ts & 0xffffffff, big_endian);
+  capture_put_uint32 (size, big_endian);
+  capture_put_uint32 (size, big_endian);
+  g_byte_array_append (capture, data, size);
+  g_byte_array_append (capture, padding, GST_ROUND_UP_4 (size) - size);
+  capture_put_uint32 (len, big_endian);
+}
+
+/* The same UDP packet at 1 to 8 seconds. The first section is
+ * little-endian, with ethernet frames and microsecond timestamps. The
+ * second one is big-endian and its packets are raw IP, with nanosecond
+ * timestamps, on its second interface. */
+static void
+create_capture (void)
+{
+  const guint8 *frame = pcap_frame_with_eth_padding + 16;
+  guint32 frame_size = sizeof (pcap_frame_with_eth_padding) - 16;
+  guint i;
+
+  capture = g_byte_array_new ();
+
+  capture_put_section_header (FALSE);
+  capture_put_interface (1, 0, FALSE);
+  for (i = 1; i <= 4; i++)
+    capture_put_packet (0, i * G_GUINT64_CONSTANT (1000000), frame,
+        frame_size, FALSE);
+
+  capture_put_section_header (TRUE);
+  capture_put_interface (1, 0, TRUE);
+  capture_put_interface (101, 9, TRUE);
+  for (i = 5; i <= 8; i++)
+    capture_put_packet (1, i * GST_SECOND, frame + 14, frame_size - 14,
+        TRUE);
+}
+
+static GstFlowReturn
+capture_getrange (GstPad * pad, GstObject * parent, guint64 offset,
+    guint length, GstBuffer ** buffer)
+{
+  if (offset >= capture->len)
+    return GST_FLOW_EOS;
+
+  length = MIN (length, capture->len - offset);
+  *buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+      capture->data + offset, length, 0, length, NULL, NULL);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+capture_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_SCHEDULING:
+      gst_query_set_scheduling (query, GST_SCHEDULING_FLAG_SEEKABLE, 1, -1, 0);
+      gst_query_add_scheduling_mode (query, GST_PAD_MODE_PULL);
+      return TRUE;
+    case GST_QUERY_DURATION:{
+      GstFormat format;
+
+      gst_query_parse_duration (query, &format, NULL);
+      if (format != GST_FORMAT_BYTES)
+        return FALSE;
+      gst_query_set_duration (query, format, capture->len);
+      return TRUE;
+    }
+    default:
+      return FALSE;
+  }
+}
+
+static GstFlowReturn
+pull_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  g_mutex_lock (&pull_lock);
+  pulled_buffers = g_list_append (pulled_buffers, buffer);
+  g_mutex_unlock (&pull_lock);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+pull_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_EOS) {
+    g_mutex_lock (&pull_lock);
+    pulled_eos = TRUE;
+    g_cond_signal (&pull_cond);
+    g_mutex_unlock (&pull_lock);
+  }
+
+  gst_event_unref (event);
+
+  return TRUE;
+}
+
+/* waits for EOS and checks that the packets from @first_second on came out */
+static void
+check_pulled_buffers (guint first_second)
+{
+  guint offset = pcap_frame_with_eth_padding_offset;
+  guint size = sizeof (pcap_frame_with_eth_padding) - offset - 2;
+  guint second = first_second;
+  GList *l;
+
+  g_mutex_lock (&pull_lock);
+  while (!pulled_eos)
+    g_cond_wait (&pull_cond, &pull_lock);
+
+  fail_unless_equals_int (g_list_length (pulled_buffers), 9 - first_second);
+  for (l = pulled_buffers; l; l = l->next, second++) {
+    GstBuffer *buffer = l->data;
+
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buffer), second * GST_SECOND);
+    fail_unless_equals_int (gst_buffer_get_size (buffer), size);
+    fail_unless (gst_buffer_memcmp (buffer, 0,
+            pcap_frame_with_eth_padding + offset, size) == 0);
+  }
+
+  g_list_free_full (pulled_buffers, (GDestroyNotify) gst_buffer_unref);
+  pulled_buffers = NULL;
+  pulled_eos = FALSE;
+  g_mutex_unlock (&pull_lock);
+}
+
+static void
+seek_and_check (GstElement * pcapparse, GstClockTime position,
+    guint first_second)
+{
+  GST_INFO ("seeking to %" GST_TIME_FORMAT, GST_TIME_ARGS (position));
+
+  fail_unless (gst_element_seek_simple (pcapparse, GST_FORMAT_TIME,
+          GST_SEEK_FLAG_FLUSH, position));
+  check_pulled_buffers (first_second);
+}
+
+GST_START_TEST (test_parse_pull_seek)
+{
+  GstElement *pcapparse;
+  GstPad *srcpad, *sinkpad, *pad;
+
+  create_capture ();
+
+  pcapparse = gst_element_factory_make ("pcapparse", NULL);
+  fail_unless (pcapparse != NULL);
+
+  srcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  gst_pad_set_getrange_function (srcpad, capture_getrange);
+  gst_pad_set_query_function (srcpad, capture_query);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, pull_sink_chain);
+  gst_pad_set_event_function (sinkpad, pull_sink_event);
+
+  pad = gst_element_get_static_pad (pcapparse, "sink");
+  fail_unless_equals_int (gst_pad_link (srcpad, pad), GST_PAD_LINK_OK);
+  gst_object_unref (pad);
+  pad = gst_element_get_static_pad (pcapparse, "src");
+  fail_unless_equals_int (gst_pad_link (pad, sinkpad), GST_PAD_LINK_OK);
+  gst_object_unref (pad);
+
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_set_active (srcpad, TRUE);
+
+  /* a first pass over the whole capture builds the index */
+  fail_unless_equals_int (gst_element_set_state (pcapparse,
+          GST_STATE_PLAYING), GST_STATE_CHANGE_SUCCESS);
+  check_pulled_buffers (1);
+
+  /* back into the first section, from the state of the second one */
+  seek_and_check (pcapparse, 2 * GST_SECOND, 2);
+  /* into the second section, with no index entry at that time */
+  seek_and_check (pcapparse, 6500 * GST_MSECOND, 7);
+  /* before the first index entry, which starts over from the header */
+  seek_and_check (pcapparse, 500 * GST_MSECOND, 1);
+  seek_and_check (pcapparse, 5 * GST_SECOND, 5);
+
+  gst_element_set_state (pcapparse, GST_STATE_NULL);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_pad_set_active (srcpad, FALSE);
+
+  gst_object_unref (pcapparse);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+  g_byte_array_unref (capture);
+  capture = NULL;
+}
+
+GST_END_TEST;
+
 static Suite *
 pcapparse_suite (void)
 {
@@ -133,6 +533,9 @@ pcapparse_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_parse_frames_with_eth_padding);
   tcase_add_test (tc_chain, test_parse_zerosize_frames);
+  tcase_add_test (tc_chain, test_parse_pcapng);
+  tcase_add_test (tc_chain, test_parse_demux);
+  tcase_add_test (tc_chain, test_parse_pull_seek);
 
   return s;
 }
@@ -0,0 +1,385 @@
+/* GStreamer
+ *
+ * unit test for the rtmp2 connection
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <sys/socket.h>
+#include <string.h>
+
+#include <gio/gio.h>
+#include <gst/check/gstcheck.h>
+
+#include "../../../gst/rtmp2/rtmp/rtmpconnection.h"
+#include "../../../gst/rtmp2/rtmp/rtmpmessage.h"
+#include "../../../gst/rtmp2/rtmp/rtmputils.h"
+
+#define VIDEO_CSTREAM 4
+#define VIDEO_MSTREAM 1
+
+typedef struct
+{
+  GMainContext *context;
+  GSocket *peer;
+  GstRtmpConnection *connection;
+} ConnectionTest;
+
+/* A connection on one end of a socket pair, the test reading the other */
+static void
+connection_test_init (ConnectionTest * t)
+{
+  GSocketConnection *socket_connection;
+  GSocket *socket;
+  GError *error = NULL;
+  int fds[2];
+
+  fail_unless_equals_int (socketpair (AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+  socket = g_socket_new_from_fd (fds[0], &error);
+  fail_unless (socket != NULL, "%s", error ? error->message : "");
+  t->peer = g_socket_new_from_fd (fds[1], &error);
+  fail_unless (t->peer != NULL, "%s", error ? error->message : "");
+
+  /* The connection runs in its own context, which is only acquired while
+   * the test iterates it, so that everything queued before is written in
+   * the same batch */
+  t->context = g_main_context_new ();
+  g_main_context_push_thread_default (t->context);
+  socket_connection = g_socket_connection_factory_create_connection (socket);
+  t->connection = gst_rtmp_connection_new (socket_connection, NULL);
+  g_main_context_pop_thread_default (t->context);
+
+  g_object_unref (socket_connection);
+  g_object_unref (socket);
+}
+
+static void
+connection_test_clear (ConnectionTest * t)
+{
+  g_main_context_push_thread_default (t->context);
+  gst_rtmp_connection_close (t->connection);
+  g_object_unref (t->connection);
+  while (g_main_context_iteration (t->context, FALSE));
+  g_main_context_pop_thread_default (t->context);
+
+  g_main_context_unref (t->context);
+  g_object_unref (t->peer);
+}
+
+/* Runs the connection until @size bytes were written, and checks nothing
+ * else was */
+static guint8 *
+connection_test_read (ConnectionTest * t, gsize size)
+{
+  guint8 *data = g_malloc (size + 1);
+  gsize received = 0;
+  gssize ret;
+
+  g_main_context_push_thread_default (t->context);
+  while (received < size) {
+    while (g_main_context_iteration (t->context, FALSE));
+
+    if (!g_socket_condition_timed_wait (t->peer, G_IO_IN, 10 * 1000, NULL))
+      continue;
+
+    ret = g_socket_receive (t->peer, (gchar *) data + received,
+        size + 1 - received, NULL, NULL);
+    fail_unless (ret > 0);
+    received += ret;
+  }
+  while (g_main_context_iteration (t->context, FALSE));
+  g_main_context_pop_thread_default (t->context);
+
+  fail_unless_equals_int (received, size);
+  fail_if (g_socket_condition_timed_wait (t->peer, G_IO_IN, 10 * 1000,
+          NULL));
+
+  return data;
+}
+
+static GstBuffer *
+video_message_new (gsize size)
+{
+  guint8 *data = g_malloc (size);
+  gsize i;
+
+  for (i = 0; i < size; i++)
+    data[i] = i & 0xff;
+
+  return gst_rtmp_message_new_wrapped (GST_RTMP_MESSAGE_TYPE_VIDEO,
+      VIDEO_CSTREAM, VIDEO_MSTREAM, data, size);
+}
+
+/* Checks the chunks of a video message from video_message_new(), whose
+ * first chunk has a @header_size bytes header matching @header */
+static gsize
+check_video_chunks (const guint8 * data, const guint8 * header,
+    gsize header_size, gsize size, gsize chunk_size)
+{
+  gsize offset = 0, i;
+
+  for (i = 0; i < size; i += chunk_size) {
+    gsize j, n = MIN (chunk_size, size - i);
+
+    if (i == 0) {
+      fail_unless (memcmp (data, header, header_size) == 0);
+      offset += header_size;
+    } else {
+      /* type 3 continuation of chunk stream 4 */
+      fail_unless_equals_int (data[offset], 0xc0 | VIDEO_CSTREAM);
+      offset += 1;
+    }
+
+    for (j = 0; j < n; j++)
+      fail_unless_equals_int (data[offset + j], (i + j) & 0xff);
+    offset += n;
+  }
+
+  return offset;
+}
+
+GST_START_TEST (test_connection_write_chunks)
+{
+  ConnectionTest t;
+  GstRtmpProtocolControl pc = { GST_RTMP_MESSAGE_TYPE_SET_CHUNK_SIZE, 256, };
+  /* type 0, chunk stream 4, ts 0, length 1200, video, message stream 1 */
+  static const guint8 first_header[] = {
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x04, 0xb0, 0x09, 0x01, 0x00, 0x00, 0x00,
+  };
+  /* type 0, chunk stream 2, ts 0, length 4, set chunk size, message
+   * stream 0, followed by the payload */
+  static const guint8 set_chunk_size[] = {
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x01, 0x00,
+  };
+  /* type 1, chunk stream 4, ts delta 0, length 600, video */
+  static const guint8 second_header[] = {
+    0x44, 0x00, 0x00, 0x00, 0x00, 0x02, 0x58, 0x09,
+  };
+  gsize size, offset;
+  guint8 *data;
+
+  connection_test_init (&t);
+
+  /* 1200 bytes in 10 chunks of the default size, then the protocol control
+   * which must apply to the 600 bytes message queued after it */
+  gst_rtmp_connection_queue_message (t.connection, video_message_new (1200));
+  gst_rtmp_connection_queue_message (t.connection,
+      gst_rtmp_message_new_protocol_control (&pc));
+  gst_rtmp_connection_queue_message (t.connection, video_message_new (600));
+
+  size = sizeof (first_header) + 1200 + 9 + sizeof (set_chunk_size) +
+      sizeof (second_header) + 600 + 2;
+  data = connection_test_read (&t, size);
+
+  offset = check_video_chunks (data, first_header, sizeof (first_header),
+      1200, GST_RTMP_DEFAULT_CHUNK_SIZE);
+  fail_unless (memcmp (data + offset, set_chunk_size,
+          sizeof (set_chunk_size)) == 0);
+  offset += sizeof (set_chunk_size);
+  offset += check_video_chunks (data + offset, second_header,
+      sizeof (second_header), 600, 256);
+  fail_unless_equals_int (offset, size);
+
+  g_free (data);
+  connection_test_clear (&t);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_connection_write_many_chunks)
+{
+  ConnectionTest t;
+  /* type 0, chunk stream 4, ts 0, length 2100, video, message stream 1 */
+  static const guint8 header[] = {
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x08, 0x34, 0x09, 0x01, 0x00, 0x00, 0x00,
+  };
+  /* type 3, chunk stream 4: same length, type and timestamp delta */
+  static const guint8 repeat_header[] = { 0xc4, };
+  GstStructure *stats;
+  guint64 out_bytes;
+  gsize size, offset;
+  guint8 *data;
+
+  connection_test_init (&t);
+
+  /* 17 chunks each, past the 8 chunks whose memories fit in a GstBuffer
+   * without merging */
+  gst_rtmp_connection_queue_message (t.connection, video_message_new (2100));
+  gst_rtmp_connection_queue_message (t.connection, video_message_new (2100));
+
+  size = sizeof (header) + sizeof (repeat_header) + 2 * (2100 + 16);
+  data = connection_test_read (&t, size);
+
+  offset = check_video_chunks (data, header, sizeof (header), 2100,
+      GST_RTMP_DEFAULT_CHUNK_SIZE);
+  offset += check_video_chunks (data + offset, repeat_header,
+      sizeof (repeat_header), 2100, GST_RTMP_DEFAULT_CHUNK_SIZE);
+  fail_unless_equals_int (offset, size);
+
+  stats = gst_rtmp_connection_get_stats (t.connection);
+  fail_unless (gst_structure_get_uint64 (stats, "out-bytes-total",
+          &out_bytes));
+  fail_unless_equals_uint64 (out_bytes, size);
+  gst_structure_free (stats);
+
+  g_free (data);
+  connection_test_clear (&t);
+}
+
+GST_END_TEST;
+
+#if GLIB_CHECK_VERSION (2, 60, 0)
+/* An output stream without a vectored write of its own, like the TLS ones,
+ * counting how many writes it gets */
+typedef struct
+{
+  GOutputStream parent;
+  GByteArray *data;
+  guint n_writes;
+} TestOutputStream;
+
+typedef struct
+{
+  GOutputStreamClass parent_class;
+} TestOutputStreamClass;
+
+GType test_output_stream_get_type (void);
+G_DEFINE_TYPE (TestOutputStream, test_output_stream, G_TYPE_OUTPUT_STREAM);
+
+static gssize
+test_output_stream_write (GOutputStream * stream, const void *buffer,
+    gsize count, GCancellable * cancellable, GError ** error)
+{
+  TestOutputStream *self = (TestOutputStream *) stream;
+
+  g_byte_array_append (self->data, buffer, count);
+  self->n_writes++;
+
+  return count;
+}
+
+static void
+test_output_stream_finalize (GObject * object)
+{
+  TestOutputStream *self = (TestOutputStream *) object;
+
+  g_byte_array_unref (self->data);
+
+  G_OBJECT_CLASS (test_output_stream_parent_class)->finalize (object);
+}
+
+static void
+test_output_stream_class_init (TestOutputStreamClass * klass)
+{
+  G_OBJECT_CLASS (klass)->finalize = test_output_stream_finalize;
+  G_OUTPUT_STREAM_CLASS (klass)->write_fn = test_output_stream_write;
+}
+
+static void
+test_output_stream_init (TestOutputStream * self)
+{
+  self->data = g_byte_array_new ();
+}
+
+static void
+write_buffers_done (GObject * source, GAsyncResult * result,
+    gpointer user_data)
+{
+  gboolean *done = user_data;
+
+  fail_unless (gst_rtmp_output_stream_write_all_buffers_finish
+      (G_OUTPUT_STREAM (source), result, NULL, NULL));
+  *done = TRUE;
+}
+
+static GstBuffer *
+chunk_part_new (gsize size, guint8 value)
+{
+  GstBuffer *buffer = gst_buffer_new_allocate (NULL, size, NULL);
+
+  gst_buffer_memset (buffer, 0, value, size);
+
+  return buffer;
+}
+
+GST_START_TEST (test_write_buffers_coalesce)
+{
+  TestOutputStream *stream;
+  GPtrArray *buffers;
+  gboolean done = FALSE;
+  gsize offset = 0, i;
+
+  stream = g_object_new (test_output_stream_get_type (), NULL);
+  buffers = g_ptr_array_new_with_free_func ((GDestroyNotify) gst_buffer_unref);
+
+  /* small chunks, a one byte header and a 128 bytes payload each, then a
+   * large one */
+  for (i = 0; i < 10; i++) {
+    GstBuffer *chunk = chunk_part_new (1, 0xc4);
+
+    chunk = gst_buffer_append (chunk, chunk_part_new (128, i));
+    g_ptr_array_add (buffers, chunk);
+  }
+  g_ptr_array_add (buffers, gst_buffer_append (chunk_part_new (1, 0xc4),
+          chunk_part_new (4096, 0xaa)));
+
+  gst_rtmp_output_stream_write_all_buffers_async (G_OUTPUT_STREAM (stream),
+      buffers, G_PRIORITY_DEFAULT, NULL, write_buffers_done, &done);
+  while (!done)
+    g_main_context_iteration (NULL, TRUE);
+
+  /* the small memories, including the header of the large chunk, are
+   * written at once and the large payload on its own */
+  fail_unless_equals_int (stream->n_writes, 2);
+  fail_unless_equals_int (stream->data->len, 10 * 129 + 1 + 4096);
+  for (i = 0; i < 10; i++) {
+    fail_unless_equals_int (stream->data->data[offset], 0xc4);
+    fail_unless_equals_int (stream->data->data[offset + 128], i);
+    offset += 129;
+  }
+  fail_unless_equals_int (stream->data->data[offset], 0xc4);
+  fail_unless_equals_int (stream->data->data[offset + 4096], 0xaa);
+
+  g_ptr_array_unref (buffers);
+  g_object_unref (stream);
+}
+
+GST_END_TEST;
+#endif
+
+static Suite *
+rtmp2_suite (void)
+{
+  Suite *s = suite_create ("rtmp2");
+  TCase *tc_chain = tcase_create ("connection");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_connection_write_chunks);
+  tcase_add_test (tc_chain, test_connection_write_many_chunks);
+#if GLIB_CHECK_VERSION (2, 60, 0)
+  tcase_add_test (tc_chain, test_write_buffers_coalesce);
+#endif
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtmp2);
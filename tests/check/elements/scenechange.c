@@ -0,0 +1,173 @@
+/* GStreamer
+ *
+ * unit test for scenechange
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/video/video.h>
+
+#define WIDTH 640
+#define HEIGHT 480
+#define FRAME_DURATION (GST_SECOND / 25)
+#define CUT_FRAME 10
+#define N_FRAMES 15
+
+/* luma before and after the cut */
+#define LUMA_BEFORE 16
+#define LUMA_AFTER 235
+
+static GstBuffer *
+create_frame (guint i)
+{
+  GstVideoInfo info;
+  GstVideoFrame frame;
+  GstBuffer *buf;
+  guint8 luma = i < CUT_FRAME ? LUMA_BEFORE : LUMA_AFTER;
+  gint y, plane;
+
+  gst_video_info_set_format (&info, GST_VIDEO_FORMAT_I420, WIDTH, HEIGHT);
+  buf = gst_buffer_new_allocate (NULL, GST_VIDEO_INFO_SIZE (&info), NULL);
+  fail_unless (gst_video_frame_map (&frame, &info, buf, GST_MAP_WRITE));
+  for (plane = 0; plane < 3; plane++) {
+    guint8 *data = GST_VIDEO_FRAME_PLANE_DATA (&frame, plane);
+    gint stride = GST_VIDEO_FRAME_PLANE_STRIDE (&frame, plane);
+
+    for (y = 0; y < GST_VIDEO_FRAME_COMP_HEIGHT (&frame, plane); y++)
+      memset (data + y * stride, plane == 0 ? luma : 128,
+          GST_VIDEO_FRAME_COMP_WIDTH (&frame, plane));
+  }
+  gst_video_frame_unmap (&frame);
+
+  GST_BUFFER_PTS (buf) = i * FRAME_DURATION;
+  GST_BUFFER_DURATION (buf) = FRAME_DURATION;
+
+  return buf;
+}
+
+/* Feeds a hard cut to scenechange, checks that it is reported once on the
+ * cut frame and returns the score of the message and the event */
+static void
+check_hard_cut (const gchar * metrics, guint n_threads, gdouble * msg_score,
+    gdouble * event_score)
+{
+  GstHarness *h;
+  GstBus *bus;
+  GstMessage *msg;
+  GstEvent *event;
+  const GstStructure *s;
+  GstClockTime timestamp;
+  guint i, n_events = 0;
+
+  h = gst_harness_new ("scenechange");
+  bus = gst_bus_new ();
+  gst_element_set_bus (h->element, bus);
+  gst_util_set_object_arg (G_OBJECT (h->element), "metrics", metrics);
+  g_object_set (h->element, "n-threads", n_threads, NULL);
+  gst_harness_set_src_caps_str (h, "video/x-raw, format = (string) I420, "
+      "width = (int) 640, height = (int) 480, framerate = (fraction) 25/1");
+
+  for (i = 0; i < N_FRAMES; i++) {
+    fail_unless_equals_int (gst_harness_push (h, create_frame (i)),
+        GST_FLOW_OK);
+    gst_buffer_unref (gst_harness_pull (h));
+  }
+
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT);
+  fail_unless (msg != NULL);
+  s = gst_message_get_structure (msg);
+  fail_unless (gst_structure_has_name (s, "scene-change"));
+  fail_unless (gst_structure_get_uint64 (s, "timestamp", &timestamp));
+  fail_unless_equals_uint64 (timestamp, CUT_FRAME * FRAME_DURATION);
+  fail_unless (gst_structure_get_double (s, "score", msg_score));
+  gst_message_unref (msg);
+  fail_if (gst_bus_have_pending (bus), "more than one scene change");
+
+  while ((event = gst_harness_try_pull_event (h))) {
+    if (gst_video_event_is_force_key_unit (event)) {
+      fail_unless (gst_video_event_parse_downstream_force_key_unit (event,
+              &timestamp, NULL, NULL, NULL, NULL));
+      fail_unless_equals_uint64 (timestamp, CUT_FRAME * FRAME_DURATION);
+      fail_unless (gst_structure_get_double (gst_event_get_structure (event),
+              "scene-change-score", event_score));
+      n_events++;
+    }
+    gst_event_unref (event);
+  }
+  fail_unless_equals_int (n_events, 1);
+
+  gst_element_set_bus (h->element, NULL);
+  gst_object_unref (bus);
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (test_hard_cut_sad)
+{
+  gdouble msg_score, event_score;
+
+  /* uniform frames, every analysed pixel changes by the same amount */
+  check_hard_cut ("sad", 1, &msg_score, &event_score);
+  fail_unless (G_APPROX_VALUE (msg_score, LUMA_AFTER - LUMA_BEFORE, 1e-6));
+  fail_unless (G_APPROX_VALUE (event_score, msg_score, 1e-6));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_hard_cut_all_metrics)
+{
+  gdouble msg_score, event_score;
+
+  /* SAD gives 219 and the histogram 255, flat frames have no edges */
+  check_hard_cut ("sad+histogram+edges", 1, &msg_score, &event_score);
+  fail_unless (msg_score >= 150 && msg_score <= 255, "score %f", msg_score);
+  fail_unless (G_APPROX_VALUE (event_score, msg_score, 1e-6));
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_hard_cut_threads)
+{
+  gdouble single_score, multi_score, event_score;
+
+  /* splitting the frame in bands of rows does not change the score */
+  check_hard_cut ("sad+histogram+edges", 1, &single_score, &event_score);
+  check_hard_cut ("sad+histogram+edges", 4, &multi_score, &event_score);
+  fail_unless (G_APPROX_VALUE (single_score, multi_score, 1e-6));
+}
+
+GST_END_TEST;
+
+static Suite *
+scenechange_suite (void)
+{
+  Suite *s = suite_create ("scenechange");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_hard_cut_sad);
+  tcase_add_test (tc_chain, test_hard_cut_all_metrics);
+  tcase_add_test (tc_chain, test_hard_cut_threads);
+
+  return s;
+}
+
+GST_CHECK_MAIN (scenechange);
@@ -0,0 +1,273 @@
+/* GStreamer
+ *
+ * unit test for srtsink
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+
+#include <srt/srt.h>
+#include <stdbool.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+
+#define MSG_SIZE 1316
+#define QUEUE_SIZE 8
+#define MAX_BUFFERS 20000
+
+/* Small send and receive buffers and no too-late packet drop, so that a
+ * caller that does not read makes the sink queue up buffers quickly */
+#define SINK_URI "srt://127.0.0.1:%u?mode=listener&sndbuf=48000&fc=32" \
+    "&tlpktdrop=false"
+
+static void
+caller_removed_cb (GstElement * sink, gint unused, GSocketAddress * addr,
+    gint * n_removed)
+{
+  g_atomic_int_inc (n_removed);
+}
+
+static GstHarness *
+setup_sink (guint port, const gchar * drop_policy, gint * n_removed)
+{
+  GstElement *sink;
+  gchar *uri;
+
+  sink = gst_element_factory_make ("srtsink", NULL);
+  fail_unless (sink != NULL);
+
+  uri = g_strdup_printf (SINK_URI, port);
+  g_object_set (sink, "uri", uri, "caller-queue-size", QUEUE_SIZE, NULL);
+  gst_util_set_object_arg (G_OBJECT (sink), "caller-drop-policy",
+      drop_policy);
+  g_free (uri);
+
+  g_signal_connect (sink, "caller-removed", G_CALLBACK (caller_removed_cb),
+      n_removed);
+
+  return gst_harness_new_with_element (sink, "sink", NULL);
+}
+
+/* A caller that only reads when told to */
+static SRTSOCKET
+connect_caller (guint port)
+{
+  SRTSOCKET sock;
+  struct sockaddr_in sa;
+  gint fc = 32, rcvbuf = 48000, timeout = 1000;
+  bool no = false;
+
+  sock = srt_create_socket ();
+  fail_unless (sock != SRT_INVALID_SOCK);
+  fail_if (srt_setsockflag (sock, SRTO_FC, &fc, sizeof (fc)));
+  fail_if (srt_setsockflag (sock, SRTO_RCVBUF, &rcvbuf, sizeof (rcvbuf)));
+  fail_if (srt_setsockflag (sock, SRTO_TLPKTDROP, &no, sizeof (no)));
+  fail_if (srt_setsockflag (sock, SRTO_RCVTIMEO, &timeout, sizeof (timeout)));
+
+  memset (&sa, 0, sizeof (sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons (port);
+  sa.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  fail_if (srt_connect (sock, (struct sockaddr *) &sa, sizeof (sa)) ==
+      SRT_ERROR, "%s", srt_getlasterror_str ());
+
+  return sock;
+}
+
+static void
+push_buffer (GstHarness * h, guint32 seq)
+{
+  GstBuffer *buf = gst_harness_create_buffer (h, MSG_SIZE);
+
+  gst_buffer_memset (buf, 0, 0, MSG_SIZE);
+  gst_buffer_fill (buf, 0, &seq, sizeof (seq));
+  fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+}
+
+/* Returns FALSE if the sink has no caller anymore */
+static gboolean
+get_caller_stats (GstHarness * h, guint * queue_depth,
+    guint64 * dropped_buffers)
+{
+  GstStructure *stats;
+  const GValue *callers;
+  GValueArray *array;
+  gboolean ret = FALSE;
+
+  g_object_get (h->element, "stats", &stats, NULL);
+  callers = gst_structure_get_value (stats, "callers");
+  if (callers != NULL) {
+    const GstStructure *s;
+
+    array = g_value_get_boxed (callers);
+    fail_unless_equals_int (array->n_values, 1);
+    s = gst_value_get_structure (&array->values[0]);
+    fail_unless (gst_structure_get_uint (s, "queue-depth", queue_depth));
+    fail_unless (gst_structure_get_uint64 (s, "dropped-buffers",
+            dropped_buffers));
+    ret = TRUE;
+  }
+  gst_structure_free (stats);
+
+  return ret;
+}
+
+/* Pushes buffers to the sink until it could not queue one for the caller,
+ * returns the number of buffers pushed */
+static guint32
+push_until_full (GstHarness * h, gint * n_removed)
+{
+  guint queue_depth = 0;
+  guint64 dropped = 0;
+  guint32 seq;
+
+  for (seq = 0; seq < MAX_BUFFERS; seq++) {
+    push_buffer (h, seq);
+    if (g_atomic_int_get (n_removed) > 0)
+      return seq + 1;
+    if (get_caller_stats (h, &queue_depth, &dropped) && dropped > 0)
+      break;
+  }
+  fail_unless (seq < MAX_BUFFERS, "caller never fell behind");
+  fail_unless_equals_int (queue_depth, QUEUE_SIZE);
+
+  /* the caller still does not read, so this one does not fit either */
+  push_buffer (h, ++seq);
+  fail_unless (get_caller_stats (h, &queue_depth, &dropped));
+  fail_unless_equals_int (queue_depth, QUEUE_SIZE);
+  fail_unless (dropped >= 2);
+
+  return seq + 1;
+}
+
+/* Reads everything the sink sends and returns the sequence number of the
+ * last message */
+static guint32
+read_all (SRTSOCKET sock, guint * n_received)
+{
+  gchar msg[1500];
+  guint32 last = G_MAXUINT32;
+  gint len;
+
+  *n_received = 0;
+  while ((len = srt_recvmsg (sock, msg, sizeof (msg))) > 0) {
+    fail_unless_equals_int (len, MSG_SIZE);
+    memcpy (&last, msg, sizeof (last));
+    (*n_received)++;
+  }
+
+  return last;
+}
+
+static void
+check_drop_policy (guint port, const gchar * drop_policy)
+{
+  GstHarness *h;
+  SRTSOCKET sock;
+  gint n_removed = 0;
+  guint32 n_pushed, last;
+  guint n_received;
+
+  h = setup_sink (port, drop_policy, &n_removed);
+  gst_harness_set_src_caps_str (h, "application/x-test");
+  sock = connect_caller (port);
+
+  n_pushed = push_until_full (h, &n_removed);
+
+  if (g_str_equal (drop_policy, "disconnect")) {
+    guint queue_depth;
+    guint64 dropped;
+
+    fail_unless_equals_int (g_atomic_int_get (&n_removed), 1);
+    fail_if (get_caller_stats (h, &queue_depth, &dropped));
+  } else {
+    fail_unless_equals_int (g_atomic_int_get (&n_removed), 0);
+
+    /* the queue is sent once the caller reads again, with some buffers
+     * missing */
+    last = read_all (sock, &n_received);
+    fail_unless (n_received > QUEUE_SIZE);
+    fail_unless (n_received < n_pushed);
+
+    if (g_str_equal (drop_policy, "oldest")) {
+      /* the newest buffers made it, the older ones were dropped */
+      fail_unless_equals_int (last, n_pushed - 1);
+    } else {
+      /* the buffers pushed while the queue was full were dropped */
+      fail_unless (last < n_pushed - 2);
+    }
+  }
+
+  srt_close (sock);
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (test_caller_drop_oldest)
+{
+  check_drop_policy (17101, "oldest");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_caller_drop_newest)
+{
+  check_drop_policy (17102, "newest");
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_caller_drop_disconnect)
+{
+  check_drop_policy (17103, "disconnect");
+}
+
+GST_END_TEST;
+
+static void
+srt_setup (void)
+{
+  srt_startup ();
+}
+
+static void
+srt_teardown (void)
+{
+  srt_cleanup ();
+}
+
+static Suite *
+srtsink_suite (void)
+{
+  Suite *s = suite_create ("srtsink");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_checked_fixture (tc_chain, srt_setup, srt_teardown);
+  tcase_add_test (tc_chain, test_caller_drop_oldest);
+  tcase_add_test (tc_chain, test_caller_drop_newest);
+  tcase_add_test (tc_chain, test_caller_drop_disconnect);
+
+  return s;
+}
+
+GST_CHECK_MAIN (srtsink);
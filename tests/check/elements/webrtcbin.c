@@ -1417,6 +1417,149 @@ GST_START_TEST (test_session_stats)
 
 GST_END_TEST;
 
+static GstStructure *
+_get_stats_snapshot (GstElement * webrtc, const gchar * type,
+    const gchar * id, guint64 since, guint64 * generation)
+{
+  GstStructure *s = NULL;
+
+  g_signal_emit_by_name (webrtc, "get-stats-snapshot", type, id, since, &s);
+  fail_unless (s != NULL);
+  fail_unless (gst_structure_get_uint64 (s, "generation", generation));
+  gst_structure_remove_field (s, "generation");
+
+  return s;
+}
+
+GST_START_TEST (test_session_stats_snapshot)
+{
+  struct test_webrtc *t = test_webrtc_new ();
+  GstStructure *s;
+  GstPromise *p;
+  guint64 generation, next_generation;
+
+  t->on_negotiation_needed = NULL;
+  test_validate_sdp (t, NULL, NULL);
+
+  /* a complete get-stats fills the snapshot */
+  p = gst_promise_new ();
+  g_signal_emit_by_name (t->webrtc1, "get-stats", NULL, p);
+  fail_unless_equals_int (gst_promise_wait (p), GST_PROMISE_RESULT_REPLIED);
+  gst_promise_unref (p);
+
+  s = _get_stats_snapshot (t->webrtc1, NULL, NULL, 0, &generation);
+  fail_unless (generation > 0);
+  fail_unless (gst_structure_has_field (s, "peer-connection-stats"));
+  validate_stats (s);
+  gst_structure_free (s);
+
+  /* filtering by type and id */
+  s = _get_stats_snapshot (t->webrtc1, "peer-connection", NULL, 0,
+      &next_generation);
+  fail_unless_equals_int (gst_structure_n_fields (s), 1);
+  gst_structure_free (s);
+  s = _get_stats_snapshot (t->webrtc1, "codec", NULL, 0, &next_generation);
+  fail_unless (!gst_structure_has_field (s, "peer-connection-stats"));
+  gst_structure_free (s);
+  s = _get_stats_snapshot (t->webrtc1, NULL, "peer-connection-stats", 0,
+      &next_generation);
+  fail_unless_equals_int (gst_structure_n_fields (s), 1);
+  gst_structure_free (s);
+
+  /* nothing changed in the peer connection stats since, only their
+   * timestamp */
+  p = gst_promise_new ();
+  g_signal_emit_by_name (t->webrtc1, "get-stats", NULL, p);
+  fail_unless_equals_int (gst_promise_wait (p), GST_PROMISE_RESULT_REPLIED);
+  gst_promise_unref (p);
+
+  s = _get_stats_snapshot (t->webrtc1, NULL, NULL, generation,
+      &next_generation);
+  fail_unless (next_generation > generation);
+  fail_unless (!gst_structure_has_field (s, "peer-connection-stats"));
+  gst_structure_free (s);
+
+  /* entries of a released pad are reported as removed to the readers that
+   * could have seen them */
+  {
+    GstPad *pad;
+    const GValue *removed;
+    gchar *codec_id;
+    gboolean reset = FALSE;
+    guint i;
+
+    pad = gst_element_get_request_pad (t->webrtc1, "sink_%u");
+    fail_unless (pad != NULL);
+    codec_id = g_strdup_printf ("codec-stats-%s", GST_PAD_NAME (pad));
+
+    p = gst_promise_new ();
+    g_signal_emit_by_name (t->webrtc1, "get-stats", NULL, p);
+    fail_unless_equals_int (gst_promise_wait (p), GST_PROMISE_RESULT_REPLIED);
+    gst_promise_unref (p);
+
+    s = _get_stats_snapshot (t->webrtc1, NULL, NULL, next_generation,
+        &generation);
+    fail_unless (gst_structure_has_field (s, codec_id));
+    fail_unless (!gst_structure_has_field (s, "removed"));
+    gst_structure_free (s);
+
+    gst_element_release_request_pad (t->webrtc1, pad);
+    gst_object_unref (pad);
+
+    p = gst_promise_new ();
+    g_signal_emit_by_name (t->webrtc1, "get-stats", NULL, p);
+    fail_unless_equals_int (gst_promise_wait (p), GST_PROMISE_RESULT_REPLIED);
+    gst_promise_unref (p);
+
+    s = _get_stats_snapshot (t->webrtc1, "codec", NULL, generation,
+        &next_generation);
+    fail_unless (next_generation > generation);
+    fail_unless (!gst_structure_has_field (s, codec_id));
+    removed = gst_structure_get_value (s, "removed");
+    fail_unless (removed != NULL);
+    fail_unless_equals_int (gst_value_array_get_size (removed), 1);
+    fail_unless_equals_string (g_value_get_string (gst_value_array_get_value
+            (removed, 0)), codec_id);
+    gst_structure_free (s);
+
+    /* readers that never saw the entry aren't told about it */
+    s = _get_stats_snapshot (t->webrtc1, NULL, NULL, 0, &next_generation);
+    fail_unless (!gst_structure_has_field (s, codec_id));
+    fail_unless (!gst_structure_has_field (s, "removed"));
+    gst_structure_free (s);
+
+    /* the removal is eventually forgotten, the readers that could have
+     * missed it are then told to start over */
+    for (i = 0; i < 40; i++) {
+      p = gst_promise_new ();
+      g_signal_emit_by_name (t->webrtc1, "get-stats", NULL, p);
+      fail_unless_equals_int (gst_promise_wait (p),
+          GST_PROMISE_RESULT_REPLIED);
+      gst_promise_unref (p);
+    }
+
+    s = _get_stats_snapshot (t->webrtc1, "codec", NULL, generation,
+        &next_generation);
+    fail_unless (gst_structure_get_boolean (s, "reset", &reset));
+    fail_unless (reset);
+    fail_unless (!gst_structure_has_field (s, codec_id));
+    fail_unless (!gst_structure_has_field (s, "removed"));
+    gst_structure_free (s);
+
+    s = _get_stats_snapshot (t->webrtc1, NULL, NULL, next_generation,
+        &generation);
+    fail_unless (!gst_structure_has_field (s, "reset"));
+    fail_unless (!gst_structure_has_field (s, "removed"));
+    gst_structure_free (s);
+
+    g_free (codec_id);
+  }
+
+  test_webrtc_free (t);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_add_transceiver)
 {
   struct test_webrtc *t = test_webrtc_new ();
@@ -1814,6 +1957,87 @@ GST_START_TEST (test_data_channel_transfer_data)
 
 GST_END_TEST;
 
+#define N_LIST_MESSAGES 3
+
+static void
+on_message_buffer (GObject * channel, GstBuffer * buffer, gboolean is_string,
+    struct test_webrtc *t)
+{
+  guint n = GPOINTER_TO_UINT (g_object_get_data (channel, "n-received"));
+  gsize size = strlen (test_string);
+
+  fail_if (is_string);
+  fail_unless_equals_int (gst_buffer_get_size (buffer), size);
+  fail_unless (gst_buffer_memcmp (buffer, 0, test_string, size) == 0);
+
+  g_object_set_data (channel, "n-received", GUINT_TO_POINTER (++n));
+  if (n == N_LIST_MESSAGES)
+    test_webrtc_signal_state (t, STATE_CUSTOM);
+}
+
+static void
+have_data_channel_transfer_buffer_list (struct test_webrtc *t,
+    GstElement * element, GObject * our, gpointer user_data)
+{
+  GObject *other = user_data;
+  GstBufferList *list = gst_buffer_list_new ();
+  GstWebRTCDataChannelState state;
+  guint i;
+
+  g_object_get (our, "ready-state", &state, NULL);
+  fail_unless_equals_int (GST_WEBRTC_DATA_CHANNEL_STATE_OPEN, state);
+
+  g_signal_connect (our, "on-message-buffer", G_CALLBACK (on_message_buffer),
+      t);
+
+  for (i = 0; i < N_LIST_MESSAGES; i++)
+    gst_buffer_list_add (list,
+        gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+            (gpointer) test_string, strlen (test_string), 0,
+            strlen (test_string), NULL, NULL));
+
+  g_signal_connect (other, "on-error",
+      G_CALLBACK (on_channel_error_not_reached), NULL);
+  g_signal_emit_by_name (other, "send-buffer-list", list, FALSE);
+  gst_buffer_list_unref (list);
+}
+
+GST_START_TEST (test_data_channel_transfer_buffer_list)
+{
+  struct test_webrtc *t = test_webrtc_new ();
+  GObject *channel = NULL;
+  VAL_SDP_INIT (offer, on_sdp_has_datachannel, NULL, NULL);
+  VAL_SDP_INIT (answer, on_sdp_has_datachannel, NULL, NULL);
+
+  t->on_negotiation_needed = NULL;
+  t->on_ice_candidate = NULL;
+  t->on_data_channel = have_data_channel_transfer_buffer_list;
+
+  fail_if (gst_element_set_state (t->webrtc1,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+  fail_if (gst_element_set_state (t->webrtc2,
+          GST_STATE_READY) == GST_STATE_CHANGE_FAILURE);
+
+  g_signal_emit_by_name (t->webrtc1, "create-data-channel", "label", NULL,
+      &channel);
+  g_assert_nonnull (channel);
+  t->data_channel_data = channel;
+  g_signal_connect (channel, "on-error",
+      G_CALLBACK (on_channel_error_not_reached), NULL);
+
+  fail_if (gst_element_set_state (t->webrtc1,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+  fail_if (gst_element_set_state (t->webrtc2,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+
+  test_validate_sdp_full (t, &offer, &answer, 1 << STATE_CUSTOM, FALSE);
+
+  g_object_unref (channel);
+  test_webrtc_free (t);
+}
+
+GST_END_TEST;
+
 static void
 have_data_channel_create_data_channel (struct test_webrtc *t,
     GstElement * element, GObject * our, gpointer user_data)
@@ -2895,6 +3119,7 @@ webrtcbin_suite (void)
   if (nicesrc && nicesink && dtlssrtpenc && dtlssrtpdec) {
     tcase_add_test (tc, test_sdp_no_media);
     tcase_add_test (tc, test_session_stats);
+    tcase_add_test (tc, test_session_stats_snapshot);
     tcase_add_test (tc, test_audio);
     tcase_add_test (tc, test_audio_video);
     tcase_add_test (tc, test_media_direction);
@@ -2919,6 +3144,7 @@ webrtcbin_suite (void)
       tcase_add_test (tc, test_data_channel_remote_notify);
       tcase_add_test (tc, test_data_channel_transfer_string);
       tcase_add_test (tc, test_data_channel_transfer_data);
+      tcase_add_test (tc, test_data_channel_transfer_buffer_list);
       tcase_add_test (tc, test_data_channel_create_after_negotiate);
       tcase_add_test (tc, test_data_channel_low_threshold);
       tcase_add_test (tc, test_data_channel_max_message_size);
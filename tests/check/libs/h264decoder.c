@@ -0,0 +1,193 @@
+/* GStreamer
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <gst/check/gstcheck.h>
+#include <gst/codecs/gsth264picture.h>
+
+static GstH264Picture *
+new_frame (gint frame_num, gint32 poc, GstH264PictureReference ref)
+{
+  GstH264Picture *picture = gst_h264_picture_new ();
+
+  picture->frame_num = picture->pic_num = frame_num;
+  picture->pic_order_cnt = poc;
+  picture->ref = ref;
+  picture->system_frame_number = frame_num;
+
+  return picture;
+}
+
+static void
+check_refs (GstH264Dpb * dpb, GstH264Picture ** expected_short,
+    guint n_short, GstH264Picture ** expected_long, guint n_long)
+{
+  GstH264Picture *refs[GST_H264_DPB_MAX_SIZE];
+  guint n, i;
+
+  n = gst_h264_dpb_get_short_term_refs (dpb, TRUE, TRUE, refs,
+      G_N_ELEMENTS (refs));
+  assert_equals_int (n, n_short);
+  for (i = 0; i < n; i++)
+    fail_unless (refs[i] == expected_short[i]);
+
+  n = gst_h264_dpb_get_long_term_refs (dpb, TRUE, refs, G_N_ELEMENTS (refs));
+  assert_equals_int (n, n_long);
+  for (i = 0; i < n; i++)
+    fail_unless (refs[i] == expected_long[i]);
+
+  assert_equals_int (gst_h264_dpb_num_ref_frames (dpb), n_short + n_long);
+}
+
+static void
+check_bump (GstH264Dpb * dpb, GstH264Picture * expected, gboolean drain)
+{
+  GstH264Picture *picture = gst_h264_dpb_bump (dpb, drain);
+
+  fail_unless (picture == expected);
+  fail_if (picture->needed_for_output);
+  gst_h264_picture_unref (picture);
+}
+
+GST_START_TEST (test_h264_dpb_ref_lists)
+{
+  GstH264Dpb *dpb;
+  GstH264Picture *pic[4];
+  GstH264Picture *refs[2];
+  GstH264RefPicMarking marking = { 0, };
+
+  dpb = gst_h264_dpb_new ();
+  gst_h264_dpb_set_max_num_frames (dpb, 4);
+
+  pic[0] = new_frame (0, 0, GST_H264_PICTURE_REF_SHORT_TERM);
+  pic[1] = new_frame (1, 6, GST_H264_PICTURE_REF_SHORT_TERM);
+  pic[2] = new_frame (2, 2, GST_H264_PICTURE_REF_SHORT_TERM);
+  pic[3] = new_frame (3, 4, GST_H264_PICTURE_REF_NONE);
+
+  /* Adding pictures invalidates the lists built by the previous lookup */
+  gst_h264_dpb_add (dpb, pic[0]);
+  check_refs (dpb, pic, 1, NULL, 0);
+  gst_h264_dpb_add (dpb, pic[1]);
+  gst_h264_dpb_add (dpb, pic[2]);
+  gst_h264_dpb_add (dpb, pic[3]);
+  check_refs (dpb, pic, 3, NULL, 0);
+
+  fail_unless (gst_h264_dpb_get_short_ref_by_pic_num (dpb, 2) == pic[2]);
+  fail_unless (gst_h264_dpb_get_short_ref_by_pic_num (dpb, 3) == NULL);
+
+  /* Only as many pictures as requested are stored */
+  assert_equals_int (gst_h264_dpb_get_short_term_refs (dpb, TRUE, TRUE,
+          refs, G_N_ELEMENTS (refs)), 2);
+  fail_unless (refs[0] == pic[0]);
+  fail_unless (refs[1] == pic[1]);
+
+  /* Output happens in POC order, a drained reference leaves the lists */
+  fail_unless (gst_h264_dpb_needs_bump (dpb, 0, FALSE));
+  check_bump (dpb, pic[0], TRUE);
+  check_refs (dpb, &pic[1], 2, NULL, 0);
+
+  /* MMCO 3: picNumX = 3 - (1 + 1), short-term to long-term */
+  marking.memory_management_control_operation = 3;
+  marking.difference_of_pic_nums_minus1 = 1;
+  marking.long_term_frame_idx = 0;
+  fail_unless (gst_h264_dpb_perform_memory_management_control_operation (dpb,
+          &marking, pic[3]));
+  check_refs (dpb, &pic[2], 1, &pic[1], 1);
+
+  /* MMCO 1: picNumX = 3 - (0 + 1), unmark short-term */
+  marking.memory_management_control_operation = 1;
+  marking.difference_of_pic_nums_minus1 = 0;
+  fail_unless (gst_h264_dpb_perform_memory_management_control_operation (dpb,
+          &marking, pic[3]));
+  check_refs (dpb, NULL, 0, &pic[1], 1);
+
+  gst_h264_dpb_mark_all_non_ref (dpb);
+  check_refs (dpb, NULL, 0, NULL, 0);
+
+  check_bump (dpb, pic[2], FALSE);
+  check_bump (dpb, pic[3], FALSE);
+  check_bump (dpb, pic[1], FALSE);
+  fail_unless (gst_h264_dpb_bump (dpb, FALSE) == NULL);
+
+  gst_h264_dpb_delete_unused (dpb);
+  assert_equals_int (gst_h264_dpb_get_size (dpb), 0);
+
+  gst_h264_dpb_free (dpb);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_h264_dpb_ref_lists_filter)
+{
+  GstH264Dpb *dpb;
+  GstH264Picture *nonexisting, *top, *bottom;
+  GstH264Picture *refs[GST_H264_DPB_MAX_SIZE];
+
+  dpb = gst_h264_dpb_new ();
+  gst_h264_dpb_set_max_num_frames (dpb, 4);
+  gst_h264_dpb_set_interlaced (dpb, TRUE);
+
+  nonexisting = new_frame (0, 0, GST_H264_PICTURE_REF_SHORT_TERM);
+  nonexisting->nonexisting = TRUE;
+  gst_h264_dpb_add (dpb, nonexisting);
+
+  top = new_frame (1, 2, GST_H264_PICTURE_REF_LONG_TERM);
+  top->field = GST_H264_PICTURE_FIELD_TOP_FIELD;
+  gst_h264_dpb_add (dpb, top);
+
+  bottom = new_frame (1, 3, GST_H264_PICTURE_REF_LONG_TERM);
+  bottom->field = GST_H264_PICTURE_FIELD_BOTTOM_FIELD;
+  bottom->second_field = TRUE;
+  bottom->other_field = top;
+  gst_h264_dpb_add (dpb, bottom);
+
+  assert_equals_int (gst_h264_dpb_get_short_term_refs (dpb, FALSE, TRUE,
+          refs, G_N_ELEMENTS (refs)), 0);
+  assert_equals_int (gst_h264_dpb_get_short_term_refs (dpb, TRUE, TRUE,
+          refs, G_N_ELEMENTS (refs)), 1);
+  fail_unless (refs[0] == nonexisting);
+
+  assert_equals_int (gst_h264_dpb_get_long_term_refs (dpb, FALSE,
+          refs, G_N_ELEMENTS (refs)), 1);
+  fail_unless (refs[0] == top);
+  assert_equals_int (gst_h264_dpb_get_long_term_refs (dpb, TRUE,
+          refs, G_N_ELEMENTS (refs)), 2);
+  fail_unless (refs[0] == top);
+  fail_unless (refs[1] == bottom);
+
+  /* The field pair counts as a single reference frame */
+  assert_equals_int (gst_h264_dpb_num_ref_frames (dpb), 2);
+
+  gst_h264_dpb_free (dpb);
+}
+
+GST_END_TEST;
+
+static Suite *
+h264decoder_suite (void)
+{
+  Suite *s = suite_create ("H264 Decoder library");
+
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_h264_dpb_ref_lists);
+  tcase_add_test (tc_chain, test_h264_dpb_ref_lists_filter);
+
+  return s;
+}
+
+GST_CHECK_MAIN (h264decoder);
@@ -163,6 +163,44 @@ GST_START_TEST (test_mis_identified_datas)
 
 GST_END_TEST;
 
+GST_START_TEST (test_mpeg_parse_start_code_offsets)
+{
+  GstMpegVideoPacket packet;
+  guint8 data[128];
+  guint i, sc;
+
+  /* Start codes at every position, so that they fall in and across the
+   * blocks scanned at once, as well as in the scalar tail */
+  for (sc = 0; sc + 4 <= sizeof (data); sc++) {
+    for (i = 0; i < sizeof (data); i++)
+      data[i] = (i & 1) ? 0x01 : 0x80;
+    /* lone zeroes and 00 00 02 patterns must not match */
+    if (sc >= 3) {
+      data[sc - 3] = 0x00;
+      data[sc - 1] = 0x00;
+    }
+    data[sc] = 0x00;
+    data[sc + 1] = 0x00;
+    data[sc + 2] = 0x01;
+    data[sc + 3] = GST_MPEG_VIDEO_PACKET_GOP;
+
+    fail_unless (gst_mpeg_video_parse (&packet, data, sizeof (data), 0));
+    assert_equals_int (packet.offset, sc + 4);
+    assert_equals_int (packet.type, GST_MPEG_VIDEO_PACKET_GOP);
+    fail_unless (packet.size < 0);
+  }
+
+  /* A start code prefix without following byte is not reported */
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = 0xff;
+  data[sizeof (data) - 3] = 0x00;
+  data[sizeof (data) - 2] = 0x00;
+  data[sizeof (data) - 1] = 0x01;
+  fail_if (gst_mpeg_video_parse (&packet, data, sizeof (data), 0));
+}
+
+GST_END_TEST;
+
 static Suite *
 mpegvideoparsers_suite (void)
 {
@@ -175,6 +213,7 @@ mpegvideoparsers_suite (void)
   tcase_add_test (tc_chain, test_mpeg_parse_sequence_header);
   tcase_add_test (tc_chain, test_mpeg_parse_sequence_extension);
   tcase_add_test (tc_chain, test_mis_identified_datas);
+  tcase_add_test (tc_chain, test_mpeg_parse_start_code_offsets);
 
   return s;
 }
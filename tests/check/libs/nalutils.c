@@ -102,6 +102,238 @@ GST_START_TEST (test_nal_writer_emulation_preventation)
 
 GST_END_TEST;
 
+GST_START_TEST (test_nal_reader_emulation_prevention)
+{
+  NalReader nr;
+  guint8 val8;
+  guint32 val;
+  /* 0x000003 sequences, the last one right before the end */
+  static const guint8 data[] = {
+    0x00, 0x00, 0x03, 0x01, 0xff, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x03,
+    0x80, 0x00, 0x00, 0x03
+  };
+
+  nal_reader_init (&nr, data, sizeof (data));
+
+  fail_unless (nal_reader_get_bits_uint32 (&nr, &val, 16));
+  assert_equals_int (val, 0x0000);
+  /* the emulation prevention byte is only accounted for once passed */
+  assert_equals_int (nal_reader_get_pos (&nr), 16);
+  assert_equals_int (nal_reader_get_epb_count (&nr), 0);
+
+  fail_unless (nal_reader_get_bits_uint8 (&nr, &val8, 8));
+  assert_equals_int (val8, 0x01);
+  assert_equals_int (nal_reader_get_pos (&nr), 32);
+  assert_equals_int (nal_reader_get_epb_count (&nr), 1);
+
+  fail_unless (nal_reader_get_bits_uint32 (&nr, &val, 32));
+  assert_equals_int (val, 0xff000000);
+  assert_equals_int (nal_reader_get_epb_count (&nr), 2);
+
+  fail_unless (nal_reader_get_bits_uint32 (&nr, &val, 24));
+  assert_equals_int (val, 0x000380);
+  assert_equals_int (nal_reader_get_epb_count (&nr), 3);
+  assert_equals_int (nal_reader_get_pos (&nr), 13 * 8);
+
+  fail_unless (nal_reader_get_bits_uint32 (&nr, &val, 16));
+  assert_equals_int (val, 0x0000);
+  fail_if (nal_reader_get_bits_uint8 (&nr, &val8, 1));
+}
+
+GST_END_TEST;
+
+/* Reference reader fetching and checking one byte at a time */
+typedef struct
+{
+  const guint8 *data;
+  guint size;
+  guint n_epb;
+  guint byte;
+  guint bits_in_cache;
+  guint32 epb_cache;
+  guint64 cache;
+} RefReader;
+
+static void
+ref_reader_init (RefReader * rr, const guint8 * data, guint size)
+{
+  memset (rr, 0, sizeof (RefReader));
+  rr->data = data;
+  rr->size = size;
+  rr->epb_cache = 0xff;
+}
+
+static gboolean
+ref_reader_get_bits (RefReader * rr, guint32 * val, guint nbits)
+{
+  while (rr->bits_in_cache < nbits) {
+    guint8 byte;
+
+    do {
+      if (rr->byte >= rr->size)
+        return FALSE;
+      byte = rr->data[rr->byte++];
+      rr->epb_cache = (rr->epb_cache << 8) | byte;
+    } while ((rr->epb_cache & 0xffffff) == 0x3 && ++rr->n_epb);
+
+    rr->cache = (rr->cache << 8) | byte;
+    rr->bits_in_cache += 8;
+  }
+
+  rr->bits_in_cache -= nbits;
+  *val = (rr->cache >> rr->bits_in_cache) &
+      ((G_GUINT64_CONSTANT (1) << nbits) - 1);
+
+  return TRUE;
+}
+
+static gboolean
+ref_reader_get_ue (RefReader * rr, guint32 * val)
+{
+  guint i = 0;
+  guint32 bit, value;
+
+  if (!ref_reader_get_bits (rr, &bit, 1))
+    return FALSE;
+  while (bit == 0) {
+    i++;
+    if (!ref_reader_get_bits (rr, &bit, 1))
+      return FALSE;
+  }
+  if (i > 31 || !ref_reader_get_bits (rr, &value, i))
+    return FALSE;
+
+  *val = (1 << i) - 1 + value;
+  return TRUE;
+}
+
+static guint
+ref_reader_get_pos (const RefReader * rr)
+{
+  return rr->byte * 8 - rr->bits_in_cache;
+}
+
+#define READER_DATA_SIZE 4096
+
+GST_START_TEST (test_nal_reader_reference)
+{
+  NalReader nr;
+  RefReader rr;
+  guint8 *data;
+  GRand *rand;
+  guint i, n_reads = 0, n_wide = 0;
+
+  /* Random payload with an emulation prevention byte every 37 bytes, so
+   * that they land at every position relative to the reads */
+  rand = g_rand_new_with_seed (42);
+  data = g_malloc (READER_DATA_SIZE);
+  for (i = 0; i < READER_DATA_SIZE; i++) {
+    data[i] = g_rand_int_range (rand, 0, 256);
+    if (i % 37 == 2) {
+      data[i - 2] = 0x00;
+      data[i - 1] = 0x00;
+      data[i] = 0x03;
+    }
+  }
+
+  nal_reader_init (&nr, data, READER_DATA_SIZE);
+  ref_reader_init (&rr, data, READER_DATA_SIZE);
+
+  for (;;) {
+    guint32 ref_val, val;
+    guint nbits;
+
+    /* alternate exp-golomb codes with fixed size reads of 1 to 32 bits,
+     * going through all the read functions */
+    if (n_reads % 2 == 0) {
+      if (!ref_reader_get_ue (&rr, &ref_val)) {
+        fail_if (nal_reader_get_ue (&nr, &val));
+        break;
+      }
+      fail_unless (nal_reader_get_ue (&nr, &val));
+      assert_equals_uint64 (val, ref_val);
+    } else {
+      nbits = g_rand_int_range (rand, 1, 33);
+      if (nbits > 24)
+        n_wide++;
+
+      if (!ref_reader_get_bits (&rr, &ref_val, nbits)) {
+        fail_if (nal_reader_get_bits_uint32 (&nr, &val, nbits));
+        break;
+      }
+
+      switch (n_reads % 3) {
+        case 0:{
+          guint8 val8;
+
+          /* wider reads are truncated to the storage */
+          fail_unless (nal_reader_get_bits_uint8 (&nr, &val8, nbits));
+          assert_equals_uint64 (val8, ref_val & 0xff);
+          break;
+        }
+        case 1:{
+          guint16 val16;
+
+          fail_unless (nal_reader_get_bits_uint16 (&nr, &val16, nbits));
+          assert_equals_uint64 (val16, ref_val & 0xffff);
+          break;
+        }
+        default:
+          fail_unless (nal_reader_get_bits_uint32 (&nr, &val, nbits));
+          assert_equals_uint64 (val, ref_val);
+          break;
+      }
+    }
+
+    assert_equals_int (nal_reader_get_pos (&nr), ref_reader_get_pos (&rr));
+    assert_equals_int (nal_reader_get_epb_count (&nr), rr.n_epb);
+    n_reads++;
+  }
+
+  fail_unless (n_reads > 1000);
+  fail_unless (n_wide > 100);
+
+  g_rand_free (rand);
+  g_free (data);
+}
+
+GST_END_TEST;
+
+/* 25 to 32 bit reads starting at every bit offset, across byte boundaries
+ * and an emulation prevention byte */
+GST_START_TEST (test_nal_reader_wide_reads)
+{
+  static const guint8 data[] = {
+    0xde, 0xad, 0xbe, 0xef, 0x00, 0x00, 0x03, 0x01, 0xca, 0xfe, 0xba, 0xbe,
+    0x12, 0x34, 0x56, 0x78
+  };
+  guint offset, nbits;
+
+  for (offset = 0; offset < 40; offset++) {
+    for (nbits = 25; nbits <= 32; nbits++) {
+      NalReader nr;
+      RefReader rr;
+      guint32 val, ref_val;
+
+      nal_reader_init (&nr, data, sizeof (data));
+      ref_reader_init (&rr, data, sizeof (data));
+
+      fail_unless (nal_reader_skip_long (&nr, offset));
+      fail_unless (ref_reader_get_bits (&rr, &ref_val, offset % 32));
+      if (offset >= 32)
+        fail_unless (ref_reader_get_bits (&rr, &ref_val, 32));
+
+      fail_unless (ref_reader_get_bits (&rr, &ref_val, nbits));
+      fail_unless (nal_reader_get_bits_uint32 (&nr, &val, nbits));
+      assert_equals_uint64 (val, ref_val);
+      assert_equals_int (nal_reader_get_pos (&nr), ref_reader_get_pos (&rr));
+      assert_equals_int (nal_reader_get_epb_count (&nr), rr.n_epb);
+    }
+  }
+}
+
+GST_END_TEST;
+
 static Suite *
 nalutils_suite (void)
 {
@@ -112,6 +344,9 @@ nalutils_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_nal_writer_init);
   tcase_add_test (tc_chain, test_nal_writer_emulation_preventation);
+  tcase_add_test (tc_chain, test_nal_reader_emulation_prevention);
+  tcase_add_test (tc_chain, test_nal_reader_reference);
+  tcase_add_test (tc_chain, test_nal_reader_wide_reads);
 
   return s;
 }